@@ -31,6 +31,7 @@
 
 #include <pxr/pxr.h>
 
+#include "usdKatana/cookStats.h"
 #include "usdKatana/utils.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -83,6 +84,8 @@ FnAttribute::GroupAttribute UsdKatanaAttrMap::build()
 void UsdKatanaAttrMap::toInterface(FnKat::GeolibCookInterface& interface)
 {
     FnAttribute::GroupAttribute groupAttr = build();
+    UsdKatanaCookStats::RecordAttribute(groupAttr);
+
     size_t numChildren = groupAttr.getNumberOfChildren();
     for (size_t i = 0; i < numChildren; i++)
     {
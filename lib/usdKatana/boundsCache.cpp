@@ -0,0 +1,463 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/boundsCache.h"
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/usd/sdf/attributeSpec.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/primSpec.h>
+#include <pxr/usd/sdf/types.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/boundable.h>
+#include <pxr/usd/usdGeom/imageable.h>
+#include <pxr/usd/usdGeom/modelAPI.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdGeom/xformable.h>
+#include <pxr/usd/usdUtils/stageCache.h>
+
+#include "usdKatana/cookStats.h"
+#include "usdKatana/utils.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace
+{
+bool HasSharedSessionLayer(const UsdStagePtr& stage)
+{
+    const SdfLayerHandle sessionLayer = stage->GetSessionLayer();
+    for (const UsdStageRefPtr& other : UsdUtilsStageCache::Get().GetAllStages())
+    {
+        if (other != stage && other->GetSessionLayer() == sessionLayer)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+size_t UsdKatanaBoundsCache::_KeyHash::operator()(const _Key& key) const
+{
+    size_t hash = SdfPath::Hash()(key.path);
+    boost::hash_combine(hash, key.time);
+    boost::hash_combine(hash, key.purposeMask);
+    boost::hash_combine(hash, key.applyLocalTransform);
+    boost::hash_combine(hash, key.useAuthoredExtents);
+    return hash;
+}
+
+UsdKatanaBoundsCache::UsdKatanaBoundsCache() {}
+
+UsdKatanaBoundsCache::~UsdKatanaBoundsCache() {}
+
+unsigned int UsdKatanaBoundsCache::_GetPurposeMask(const TfTokenVector& purposes)
+{
+    unsigned int mask = 0;
+    for (const TfToken& purpose : purposes)
+    {
+        if (purpose == UsdGeomTokens->default_)
+            mask |= 1u << 0;
+        else if (purpose == UsdGeomTokens->render)
+            mask |= 1u << 1;
+        else if (purpose == UsdGeomTokens->proxy)
+            mask |= 1u << 2;
+        else if (purpose == UsdGeomTokens->guide)
+            mask |= 1u << 3;
+    }
+    return mask;
+}
+
+UsdKatanaBoundsCache::_EntryPtr UsdKatanaBoundsCache::_FindOrInsert(const _Key& key,
+                                                                    bool* inserted)
+{
+    // Avoid allocating an entry for the common case of a hit.
+    _EntryMap::const_iterator it = _entries.find(key);
+    if (it != _entries.end())
+    {
+        *inserted = false;
+        return it->second;
+    }
+
+    std::pair<_EntryMap::iterator, bool> result =
+        _entries.insert(std::make_pair(key, std::make_shared<_Entry>()));
+    *inserted = result.second;
+    return result.first->second;
+}
+
+UsdGeomBBoxCache& UsdKatanaBoundsCache::_GetThreadLocalBBoxCache(double time,
+                                                                 const TfTokenVector& purposes,
+                                                                 unsigned int purposeMask)
+{
+    _BBoxCacheMap& bboxCaches = _threadCaches.local();
+    const std::pair<unsigned int, double> cacheKey(purposeMask, time);
+    _BBoxCacheMap::iterator it = bboxCaches.find(cacheKey);
+    if (it == bboxCaches.end())
+    {
+        it = bboxCaches
+                 .insert(std::make_pair(cacheKey, UsdGeomBBoxCache(time, purposes,
+                                                                   /* useExtentsHint */ true)))
+                 .first;
+    }
+    return it->second;
+}
+
+GfBBox3d UsdKatanaBoundsCache::_Compute(UsdGeomBBoxCache& bboxCache,
+                                        const UsdPrim& prim,
+                                        bool applyLocalTransform)
+{
+    if (applyLocalTransform)
+    {
+        return bboxCache.ComputeLocalBound(prim);
+    }
+    return bboxCache.ComputeUntransformedBound(prim);
+}
+
+bool UsdKatanaBoundsCache::HasAuthoredExtents(const UsdPrim& prim)
+{
+    if (prim.IsModel() && UsdGeomModelAPI(prim).GetExtentsHintAttr().HasAuthoredValue())
+    {
+        return true;
+    }
+    UsdGeomBoundable boundable(prim);
+    return boundable && boundable.GetExtentAttr().HasAuthoredValue();
+}
+
+bool UsdKatanaBoundsCache::HasStaticBounds(const UsdPrim& prim)
+{
+    TRACE_FUNCTION();
+
+    static const TfTokenVector boundAttrNames = {
+        UsdGeomTokens->visibility,   UsdGeomTokens->extent,       UsdGeomTokens->extentsHint,
+        UsdGeomTokens->points,       UsdGeomTokens->positions,    UsdGeomTokens->orientations,
+        UsdGeomTokens->scales,       UsdGeomTokens->protoIndices, UsdGeomTokens->invisibleIds};
+
+    for (const UsdPrim& descendant : UsdPrimRange(prim, UsdTraverseInstanceProxies()))
+    {
+        // The extentsHint of a model does not include its own transform.
+        const UsdGeomXformable xformable(descendant);
+        if (descendant != prim && xformable && xformable.TransformMightBeTimeVarying())
+        {
+            return false;
+        }
+        for (const TfToken& attrName : boundAttrNames)
+        {
+            const UsdAttribute attr = descendant.GetAttribute(attrName);
+            if (attr && attr.ValueMightBeTimeVarying())
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool UsdKatanaBoundsCache::_AuthorExtentsHint(const UsdPrim& prim, const SdfLayerHandle& layer)
+{
+    TRACE_FUNCTION();
+
+    if (!prim.IsModel() || prim.IsInstanceProxy() || prim.IsInPrototype() ||
+        !HasStaticBounds(prim))
+    {
+        return false;
+    }
+
+    // The bounds are the same at every time, the earliest one also picks up
+    // single time samples.
+    UsdGeomBBoxCache bboxCache(UsdTimeCode::EarliestTime(),
+                               UsdGeomImageable::GetOrderedPurposeTokens(),
+                               /* useExtentsHint */ true);
+    const VtVec3fArray extentsHint = UsdGeomModelAPI(prim).ComputeExtentsHint(bboxCache);
+
+    SdfPrimSpecHandle primSpec = SdfCreatePrimInLayer(layer, prim.GetPath());
+    if (!primSpec)
+    {
+        return false;
+    }
+    SdfAttributeSpecHandle attrSpec =
+        layer->GetAttributeAtPath(prim.GetPath().AppendProperty(UsdGeomTokens->extentsHint));
+    if (!attrSpec)
+    {
+        attrSpec = SdfAttributeSpec::New(primSpec, UsdGeomTokens->extentsHint,
+                                         SdfValueTypeNames->Float3Array);
+    }
+    return attrSpec && attrSpec->SetDefaultValue(VtValue(extentsHint));
+}
+
+void UsdKatanaBoundsCache::RecordMissingExtentsHint(const UsdPrim& prim)
+{
+    std::lock_guard<std::mutex> lock(_extentsHintsMutex);
+    _missingExtentsHints.insert(prim.GetPath());
+}
+
+bool UsdKatanaBoundsCache::HasMissingExtentsHints() const
+{
+    std::lock_guard<std::mutex> lock(_extentsHintsMutex);
+    return !_missingExtentsHints.empty();
+}
+
+size_t UsdKatanaBoundsCache::AuthorMissingExtentsHints(const UsdStagePtr& stage)
+{
+    TRACE_FUNCTION();
+
+    std::set<SdfPath> paths;
+    {
+        std::lock_guard<std::mutex> lock(_extentsHintsMutex);
+        paths.swap(_missingExtentsHints);
+    }
+
+    // A hint written for one stage would apply to the prim at the same path
+    // in every other stage using the session layer.
+    const SdfLayerHandle sessionLayer = stage ? stage->GetSessionLayer() : SdfLayerHandle();
+    if (paths.empty() || !sessionLayer || HasSharedSessionLayer(stage))
+    {
+        return 0;
+    }
+
+    if (!_extentsHintsLayer)
+    {
+        _extentsHintsLayer = SdfLayer::CreateAnonymous("extentsHints.usda");
+    }
+    size_t numAuthored = 0;
+    for (const SdfPath& path : paths)
+    {
+        const UsdPrim prim = stage->GetPrimAtPath(path);
+        if (prim && !UsdGeomModelAPI(prim).GetExtentsHintAttr().HasAuthoredValue() &&
+            _AuthorExtentsHint(prim, _extentsHintsLayer))
+        {
+            ++numAuthored;
+        }
+    }
+
+    // Once the layer is a sublayer, the hints authored above and later on
+    // are plain attribute edits for the stage.
+    const std::vector<std::string> subLayerPaths = sessionLayer->GetSubLayerPaths();
+    if (numAuthored > 0 && std::find(subLayerPaths.begin(), subLayerPaths.end(),
+                                     _extentsHintsLayer->GetIdentifier()) == subLayerPaths.end())
+    {
+        sessionLayer->InsertSubLayerPath(_extentsHintsLayer->GetIdentifier());
+    }
+    return numAuthored;
+}
+
+size_t UsdKatanaBoundsCache::RemoveAuthoredExtentsHints(const UsdStagePtr& stage)
+{
+    TRACE_FUNCTION();
+
+    if (!_extentsHintsLayer)
+    {
+        return 0;
+    }
+
+    size_t numRemoved = 0;
+    _extentsHintsLayer->Traverse(SdfPath::AbsoluteRootPath(),
+                                 [&numRemoved](const SdfPath& path) {
+                                     if (path.IsPropertyPath())
+                                     {
+                                         ++numRemoved;
+                                     }
+                                 });
+
+    const SdfLayerHandle sessionLayer = stage ? stage->GetSessionLayer() : SdfLayerHandle();
+    if (sessionLayer)
+    {
+        const std::vector<std::string> subLayerPaths = sessionLayer->GetSubLayerPaths();
+        const auto it = std::find(subLayerPaths.begin(), subLayerPaths.end(),
+                                  _extentsHintsLayer->GetIdentifier());
+        if (it != subLayerPaths.end())
+        {
+            sessionLayer->RemoveSubLayerPath(static_cast<int>(it - subLayerPaths.begin()));
+        }
+    }
+    _extentsHintsLayer.Reset();
+    return numRemoved;
+}
+
+bool UsdKatanaBoundsCache::_ComputeFromAuthoredExtents(const UsdPrim& prim,
+                                                       double time,
+                                                       const TfTokenVector& purposes,
+                                                       bool applyLocalTransform,
+                                                       GfBBox3d* bound)
+{
+    // extentsHint holds one min/max pair per purpose, in the order given by
+    // GetOrderedPurposeTokens(). Trailing empty purposes may be omitted. The
+    // purposes and visibility of the descendants are already folded into
+    // it, but not the visibility the model itself inherits.
+    VtVec3fArray extentsHint;
+    UsdGeomBoundable boundable(prim);
+    VtVec3fArray extent;
+    if (prim.IsModel() && UsdGeomModelAPI(prim).GetExtentsHint(&extentsHint, time) &&
+        extentsHint.size() >= 2)
+    {
+        if (UsdGeomImageable(prim).ComputeVisibility(time) == UsdGeomTokens->invisible)
+        {
+            *bound = GfBBox3d();
+            return true;
+        }
+        const TfTokenVector& orderedPurposes = UsdGeomImageable::GetOrderedPurposeTokens();
+        GfRange3d range;
+        for (size_t i = 0; i < orderedPurposes.size() && 2 * i + 1 < extentsHint.size(); ++i)
+        {
+            if (std::find(purposes.begin(), purposes.end(), orderedPurposes[i]) != purposes.end())
+            {
+                range.UnionWith(
+                    GfRange3d(GfVec3d(extentsHint[2 * i]), GfVec3d(extentsHint[2 * i + 1])));
+            }
+        }
+        *bound = GfBBox3d(range);
+    }
+    else if (boundable && boundable.GetExtentAttr().HasAuthoredValue() &&
+             boundable.GetExtentAttr().Get(&extent, time) && extent.size() == 2)
+    {
+        // A gprim's extent knows nothing about its purpose or visibility.
+        const TfToken purpose = boundable.ComputePurpose();
+        if (std::find(purposes.begin(), purposes.end(), purpose) == purposes.end() ||
+            boundable.ComputeVisibility(time) == UsdGeomTokens->invisible)
+        {
+            *bound = GfBBox3d();
+        }
+        else
+        {
+            *bound = GfBBox3d(GfRange3d(GfVec3d(extent[0]), GfVec3d(extent[1])));
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    if (applyLocalTransform)
+    {
+        GfMatrix4d localXform(1.0);
+        bool resetsXformStack = false;
+        UsdGeomXformable xformable(prim);
+        if (xformable)
+        {
+            xformable.GetLocalTransformation(&localXform, &resetsXformStack, time);
+        }
+        bound->SetMatrix(localXform);
+    }
+    return true;
+}
+
+GfBBox3d UsdKatanaBoundsCache::ComputeBound(const UsdPrim& prim,
+                                            double time,
+                                            const TfTokenVector& purposes,
+                                            bool applyLocalTransform,
+                                            bool useAuthoredExtents)
+{
+    TRACE_FUNCTION();
+
+    const unsigned int purposeMask = _GetPurposeMask(purposes);
+    const _Key key{prim.GetPath(), time, purposeMask, applyLocalTransform, useAuthoredExtents};
+
+    bool inserted = false;
+    _EntryPtr entry = _FindOrInsert(key, &inserted);
+
+    bool computed = false;
+    std::call_once(entry->once, [&]() {
+        computed = true;
+        if (useAuthoredExtents &&
+            _ComputeFromAuthoredExtents(prim, time, purposes, applyLocalTransform, &entry->bound))
+        {
+            return;
+        }
+
+        UsdGeomBBoxCache& bboxCache = _GetThreadLocalBBoxCache(time, purposes, purposeMask);
+        entry->bound = _Compute(bboxCache, prim, applyLocalTransform);
+
+        // The traversal above has left the bounds of the children in this
+        // thread's cache, so publishing them now is cheap. This is not the
+        // case when the bound came from an authored extentsHint, as the
+        // children were never visited.
+        if (prim.IsModel() && UsdGeomModelAPI(prim).GetExtentsHintAttr().HasAuthoredValue())
+        {
+            return;
+        }
+        for (const UsdPrim& child : prim.GetFilteredChildren(UsdTraverseInstanceProxies()))
+        {
+            // Children carrying their own extents are cheaper to answer from
+            // those than from the traversal in this mode.
+            if (!UsdKatanaUtils::IsBoundable(child) ||
+                (useAuthoredExtents && HasAuthoredExtents(child)))
+            {
+                continue;
+            }
+            bool childInserted = false;
+            _EntryPtr childEntry = _FindOrInsert(
+                _Key{child.GetPath(), time, purposeMask, applyLocalTransform, useAuthoredExtents},
+                &childInserted);
+            if (childInserted)
+            {
+                std::call_once(childEntry->once, [&]() {
+                    childEntry->bound = _Compute(bboxCache, child, applyLocalTransform);
+                });
+            }
+        }
+    });
+
+    if (computed)
+    {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        _hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    UsdKatanaCookStats::RecordCacheLookup(!computed);
+    return entry->bound;
+}
+
+void UsdKatanaBoundsCache::Clear()
+{
+    _entries.clear();
+    _threadCaches.clear();
+    _hits.store(0, std::memory_order_relaxed);
+    _misses.store(0, std::memory_order_relaxed);
+}
+
+size_t UsdKatanaBoundsCache::GetNumEntries() const
+{
+    return _entries.size();
+}
+
+size_t UsdKatanaBoundsCache::GetMemoryUsage() const
+{
+    // Node, key and shared entry allocation per element plus the bucket
+    // array. SdfPath is a handle into the shared path table, so the path
+    // storage itself is not owned by this cache.
+    const size_t perEntry = sizeof(_EntryMap::value_type) + sizeof(_Entry) + 4 * sizeof(void*);
+    return _entries.size() * perEntry + _entries.unsafe_bucket_count() * sizeof(void*);
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,221 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_BOUNDSCACHE_H
+#define USDKATANA_BOUNDSCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <pxr/base/gf/bbox3d.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/base/vt/types.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usdGeom/bboxCache.h>
+
+#include <tbb/concurrent_unordered_map.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// \brief A bounds cache shared by every thread cooking locations of a
+/// stage, for all the UsdIn ops reading it, see
+/// UsdKatanaCache::GetBoundsCache().
+///
+/// UsdGeomBBoxCache is not thread safe, so each thread still owns a private
+/// UsdGeomBBoxCache per time to do the actual traversal. The results of those
+/// traversals are published into a concurrent table keyed by
+/// (prim path, time, purposes, local transform) where each entry is computed
+/// exactly once; threads that ask for an entry while it is being computed
+/// wait for the result instead of traversing the same subtree again.
+///
+/// When a bound is computed, the bounds of the prim's children are published
+/// as well. They are already resident in the computing thread's
+/// UsdGeomBBoxCache, and they are what the Katana locations below will ask
+/// for next, most likely from other threads.
+class UsdKatanaBoundsCache
+{
+public:
+    USDKATANA_API UsdKatanaBoundsCache();
+    USDKATANA_API ~UsdKatanaBoundsCache();
+
+    UsdKatanaBoundsCache(const UsdKatanaBoundsCache&) = delete;
+    UsdKatanaBoundsCache& operator=(const UsdKatanaBoundsCache&) = delete;
+
+    /// Returns the bound of \p prim at \p time considering only the given
+    /// \p purposes. If \p applyLocalTransform is true the prim's own local
+    /// transformation is included (UsdGeomBBoxCache::ComputeLocalBound),
+    /// otherwise it is not (UsdGeomBBoxCache::ComputeUntransformedBound).
+    ///
+    /// If \p useAuthoredExtents is true, an authored extentsHint on a model or
+    /// an authored extent on a UsdGeomBoundable is returned as is, without
+    /// composing or visiting any descendants. Prims with neither fall back to
+    /// a traversal, which itself still stops at descendant models that carry
+    /// an extentsHint.
+    USDKATANA_API GfBBox3d ComputeBound(const UsdPrim& prim,
+                                        double time,
+                                        const TfTokenVector& purposes,
+                                        bool applyLocalTransform,
+                                        bool useAuthoredExtents = false);
+
+    /// Returns true if \p prim carries a bound that ComputeBound() can use
+    /// without a traversal when \p useAuthoredExtents is true.
+    USDKATANA_API static bool HasAuthoredExtents(const UsdPrim& prim);
+
+    /// Returns true if nothing below \p prim that contributes to its
+    /// untransformed bound, i.e. the transforms, extents, points, instancer
+    /// attributes and visibility of its descendants, might vary over time.
+    USDKATANA_API static bool HasStaticBounds(const UsdPrim& prim);
+
+    /// Records that the model \p prim was found without an extentsHint, for
+    /// AuthorMissingExtentsHints().
+    USDKATANA_API void RecordMissingExtentsHint(const UsdPrim& prim);
+
+    /// Returns true if RecordMissingExtentsHint() recorded models whose
+    /// extentsHints were not authored yet.
+    USDKATANA_API bool HasMissingExtentsHints() const;
+
+    /// Computes the extentsHints recorded by RecordMissingExtentsHint() for
+    /// the models of \p stage, and returns the number authored. Models whose
+    /// bounds are not static are left alone, as the hints are default values
+    /// used at every time.
+    ///
+    /// The hints go into an anonymous layer owned by this cache rather than
+    /// into the session layer itself, which only gets that layer as a
+    /// sublayer. Inserting it recomposes the stage, so this happens once, the
+    /// first time hints are authored. Stages sharing their session layer with
+    /// another cached stage are skipped. This is meant to run outside of
+    /// cooks, and the caller must hold the stage lock for writing.
+    USDKATANA_API size_t AuthorMissingExtentsHints(const UsdStagePtr& stage);
+
+    /// Removes the layer written by AuthorMissingExtentsHints() from the
+    /// session layer of \p stage, as its hints are stale once the layers they
+    /// were computed from are reloaded. Returns the number of hints removed.
+    /// The caller must hold the stage lock for writing.
+    USDKATANA_API size_t RemoveAuthoredExtentsHints(const UsdStagePtr& stage);
+
+    /// Drops every cached bound, including the thread-local caches. Must not
+    /// be called while other threads are using the cache.
+    USDKATANA_API void Clear();
+
+    /// Number of bounds currently held by the shared table.
+    USDKATANA_API size_t GetNumEntries() const;
+
+    /// Approximate number of bytes held by the shared table. The
+    /// thread-local UsdGeomBBoxCache objects do not expose their size and
+    /// are not accounted for.
+    USDKATANA_API size_t GetMemoryUsage() const;
+
+    /// Number of lookups that were answered without computing a bound.
+    size_t GetNumHits() const
+    {
+        return _hits.load(std::memory_order_relaxed);
+    }
+
+    /// Number of lookups that had to compute a bound.
+    size_t GetNumMisses() const
+    {
+        return _misses.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct _Key
+    {
+        SdfPath path;
+        double time;
+        unsigned int purposeMask;
+        bool applyLocalTransform;
+        bool useAuthoredExtents;
+
+        bool operator==(const _Key& other) const
+        {
+            return path == other.path && time == other.time &&
+                   purposeMask == other.purposeMask &&
+                   applyLocalTransform == other.applyLocalTransform &&
+                   useAuthoredExtents == other.useAuthoredExtents;
+        }
+    };
+
+    struct _KeyHash
+    {
+        size_t operator()(const _Key& key) const;
+    };
+
+    struct _Entry
+    {
+        std::once_flag once;
+        GfBBox3d bound;
+    };
+    typedef std::shared_ptr<_Entry> _EntryPtr;
+
+    static unsigned int _GetPurposeMask(const TfTokenVector& purposes);
+
+    _EntryPtr _FindOrInsert(const _Key& key, bool* inserted);
+
+    static GfBBox3d _Compute(UsdGeomBBoxCache& bboxCache,
+                             const UsdPrim& prim,
+                             bool applyLocalTransform);
+
+    static bool _AuthorExtentsHint(const UsdPrim& prim, const SdfLayerHandle& layer);
+
+    static bool _ComputeFromAuthoredExtents(const UsdPrim& prim,
+                                            double time,
+                                            const TfTokenVector& purposes,
+                                            bool applyLocalTransform,
+                                            GfBBox3d* bound);
+
+    UsdGeomBBoxCache& _GetThreadLocalBBoxCache(double time,
+                                               const TfTokenVector& purposes,
+                                               unsigned int purposeMask);
+
+    typedef tbb::concurrent_unordered_map<_Key, _EntryPtr, _KeyHash> _EntryMap;
+    _EntryMap _entries;
+
+    // Thread-local traversal caches keyed by (purpose mask, time).
+    typedef std::map<std::pair<unsigned int, double>, UsdGeomBBoxCache> _BBoxCacheMap;
+    typedef tbb::enumerable_thread_specific<_BBoxCacheMap> _ThreadLocalBBoxCaches;
+    _ThreadLocalBBoxCaches _threadCaches;
+
+    std::atomic<size_t> _hits{0};
+    std::atomic<size_t> _misses{0};
+
+    // The models cooks found without an extentsHint, and the layer holding
+    // the extentsHints authored for them.
+    mutable std::mutex _extentsHintsMutex;
+    std::set<SdfPath> _missingExtentsHints;
+    SdfLayerRefPtr _extentsHintsLayer;
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_BOUNDSCACHE_H
@@ -29,20 +29,32 @@
 //
 #include "usdKatana/cache.h"
 
+#include <algorithm>
+#include <iterator>
 #include <set>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <pxr/pxr.h>
 
 #include <pxr/base/arch/systemInfo.h>
+#include <pxr/base/tf/getenv.h>
 #include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/base/tf/stringUtils.h>
 #include <pxr/base/trace/trace.h>
+#include <pxr/usd/ar/asset.h>
+#include <pxr/usd/ar/resolvedPath.h>
 #include <pxr/usd/ar/resolver.h>
+#include <pxr/usd/ar/resolverContextBinder.h>
+#include <pxr/usd/kind/registry.h>
 #include <pxr/usd/sdf/attributeSpec.h>
 #include <pxr/usd/sdf/layer.h>
 #include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/modelAPI.h>
 #include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/stageLoadRules.h>
 #include <pxr/usd/usd/stageCacheContext.h>
 #include <pxr/usd/usdUtils/stageCache.h>
 
@@ -50,11 +62,18 @@
 
 #include <pystring/pystring.h>
 
+#include <FnLogging/FnLogging.h>
+
+#include "usdKatana/boundsCache.h"
+#include "usdKatana/cookCache.h"
 #include "usdKatana/debugCodes.h"
 #include "usdKatana/locks.h"
+#include "usdKatana/staticAttrCache.h"
+#include "usdKatana/usdInArgs.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+FnLogSetup("UsdKatanaCache");
 
 TF_INSTANTIATE_SINGLETON(UsdKatanaCache);
 
@@ -118,12 +137,14 @@ SdfLayerRefPtr& UsdKatanaCache::_FindOrCreateSessionLayer(FnAttribute::GroupAttr
                                                           const std::string& rootLocation,
                                                           const std::string& isolatePath)
 {
+    TRACE_FUNCTION();
+
     // Grab a reader lock for reading the _sessionKeyCache
     boost::upgrade_lock<boost::upgrade_mutex>
                 readerLock(UsdKatanaGetSessionCacheLock());
     
     
-    std::string cacheKey = _ComputeCacheKey(sessionAttr, rootLocation);
+    std::string cacheKey = _ComputeCacheKey(sessionAttr, rootLocation, isolatePath);
     
     // Open the usd stage
     
@@ -498,11 +519,23 @@ UsdKatanaCache::_SetMutedLayers(
 
 UsdKatanaCache::UsdKatanaCache() 
 {
+    const int budgetMB = TfGetenvInt("USD_KATANA_CACHE_MEMORY_BUDGET_MB", 0);
+    if (budgetMB > 0)
+    {
+        _memoryBudget = static_cast<size_t>(budgetMB) << 20;
+    }
+}
+
+UsdKatanaCache::~UsdKatanaCache()
+{
+    WaitForPrefetches();
 }
 
 void
 UsdKatanaCache::Flush()
 {
+    TRACE_FUNCTION();
+
     // Flushing is writing, grab writer locks for the caches.
     boost::unique_lock<boost::upgrade_mutex>
                 rendererWriterLock(UsdKatanaGetRendererCacheLock());
@@ -511,6 +544,9 @@ UsdKatanaCache::Flush()
 
     UsdUtilsStageCache::Get().Clear();
     _sessionKeyCache.clear();
+
+    std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+    _stageEntries.clear();
 }
 
 
@@ -520,6 +556,117 @@ _ResolvePath(const std::string& path)
     return ArGetResolver().Resolve(path);
 }
 
+// Like the population mask, the load rules are delivered with the
+// GroupAttribute which describes the session layer so that they are part of
+// the same cache key. "rules" holds pairs of USD prim path and rule: "all",
+// "only" or "none". "maxDepth" and "stopAtKind" then limit the payloads loaded
+// to those on prims at most maxDepth levels deep, and not on or below a prim
+// of kind stopAtKind. The kind of a prim with a payload is only known
+// before the payload is loaded if it is authored outside of it.
+static void ApplyLoadRules(const UsdStageRefPtr& stage,
+                           FnAttribute::GroupAttribute loadRulesAttr)
+{
+    TRACE_FUNCTION();
+
+    UsdStageLoadRules rules;
+    FnAttribute::StringAttribute rulesAttr = loadRulesAttr.getChildByName("rules");
+    if (rulesAttr.getNumberOfValues() > 0)
+    {
+        auto values = rulesAttr.getNearestSample(0.0f);
+        for (size_t i = 0; i + 1 < values.size(); i += 2)
+        {
+            const std::string pathStr = values[i];
+            const std::string ruleStr = values[i + 1];
+            if (!SdfPath::IsValidPathString(pathStr) ||
+                !SdfPath(pathStr).IsAbsoluteRootOrPrimPath())
+            {
+                FnLogWarn("Ignoring load rule for invalid prim path \"" << pathStr << "\"");
+                continue;
+            }
+
+            if (ruleStr == "all")
+            {
+                rules.AddRule(SdfPath(pathStr), UsdStageLoadRules::AllRule);
+            }
+            else if (ruleStr == "only")
+            {
+                rules.AddRule(SdfPath(pathStr), UsdStageLoadRules::OnlyRule);
+            }
+            else if (ruleStr == "none")
+            {
+                rules.AddRule(SdfPath(pathStr), UsdStageLoadRules::NoneRule);
+            }
+            else
+            {
+                FnLogWarn("Ignoring unknown load rule \"" << ruleStr << "\" for " << pathStr);
+            }
+        }
+    }
+
+    const int maxDepth =
+        FnAttribute::IntAttribute(loadRulesAttr.getChildByName("maxDepth")).getValue(-1, false);
+    const TfToken stopAtKind(FnAttribute::StringAttribute(
+        loadRulesAttr.getChildByName("stopAtKind")).getValue("", false));
+
+    if (maxDepth < 0 && stopAtKind.IsEmpty())
+    {
+        stage->SetLoadRules(rules);
+        return;
+    }
+
+    // Whether the limits allow a payload depends on the prims found inside
+    // the payloads above it, so the payloads are loaded one level of nesting
+    // at a time, with a single call for each level.
+    const Usd_PrimFlagsPredicate predicate =
+        UsdTraverseInstanceProxies(UsdPrimIsActive && UsdPrimIsDefined && !UsdPrimIsAbstract);
+
+    UsdStageLoadRules limitedRules = UsdStageLoadRules::LoadNone();
+    std::vector<UsdPrim> roots = {stage->GetPseudoRoot()};
+    while (!roots.empty())
+    {
+        std::vector<UsdPrim> toLoad;
+        for (const UsdPrim& root : roots)
+        {
+            UsdPrimRange range(root, predicate);
+            for (auto it = range.begin(); it != range.end(); ++it)
+            {
+                const UsdPrim& prim = *it;
+                const SdfPath& path = prim.GetPath();
+                if (!rules.IsLoaded(path) ||
+                    (maxDepth >= 0 && path.GetPathElementCount() > static_cast<size_t>(maxDepth)))
+                {
+                    it.PruneChildren();
+                    continue;
+                }
+
+                TfToken kind;
+                if (!stopAtKind.IsEmpty() && UsdModelAPI(prim).GetKind(&kind) &&
+                    KindRegistry::IsA(kind, stopAtKind))
+                {
+                    it.PruneChildren();
+                    continue;
+                }
+
+                if (prim != root && prim.HasAuthoredPayloads() && !prim.IsLoaded())
+                {
+                    toLoad.push_back(prim);
+                    it.PruneChildren();
+                }
+            }
+        }
+
+        for (const UsdPrim& prim : toLoad)
+        {
+            limitedRules.AddRule(prim.GetPath(), UsdStageLoadRules::OnlyRule);
+        }
+        if (!toLoad.empty())
+        {
+            stage->SetLoadRules(limitedRules);
+        }
+        roots = std::move(toLoad);
+    }
+}
+
 // UsdStage::OpenMasked doesn't participate with the active UsdStageCache.
 // Use of a UsdStageCacheRequest subclass lets work with the cache for masked
 // stages without having to manually lock.
@@ -545,12 +692,14 @@ public:
                            SdfLayerHandle const& rootLayer,
                            SdfLayerHandle const& sessionLayer,
                            ArResolverContext const& pathResolverContext,
-                           const UsdStagePopulationMask& mask)
+                           const UsdStagePopulationMask& mask,
+                           FnAttribute::GroupAttribute loadRulesAttr)
         : _rootLayer(rootLayer),
           _sessionLayer(sessionLayer),
           _pathResolverContext(pathResolverContext),
           _initialLoadSet(load),
-          _mask(mask)
+          _mask(mask),
+          _loadRulesAttr(loadRulesAttr)
     {}
 
     virtual ~UsdIn_StageOpenRequest() {}
@@ -580,10 +729,18 @@ public:
     }
     virtual UsdStageRefPtr Manufacture()
     {
-        return UsdStage::OpenMasked(_rootLayer, _sessionLayer, 
+        // The load rules are applied before the stage is handed to the
+        // requests waiting for it.
+        UsdStageRefPtr stage = UsdStage::OpenMasked(_rootLayer, _sessionLayer, 
                             _pathResolverContext,
                             _mask,
                             _initialLoadSet);
+        if (stage && _loadRulesAttr.isValid())
+        {
+            ApplyLoadRules(stage, _loadRulesAttr);
+        }
+        UsdKatanaCache::ExpandPopulationMask(stage);
+        return stage;
     }
     
 private:
@@ -592,6 +749,7 @@ private:
     ArResolverContext _pathResolverContext;
     UsdStage::InitialLoadSet _initialLoadSet;
     const UsdStagePopulationMask & _mask;
+    FnAttribute::GroupAttribute _loadRulesAttr;
 };
 
 // While the population mask is not part of the session layer, it's delivered
@@ -600,6 +758,9 @@ private:
 // may want to keep the mask mutable for a given stage, UsdIn ensures that
 // they are unique copies as it's possible (although usually discouraged) to
 // have simultaneous states active at once.
+//
+// Without an explicit mask, the stage is masked to the isolatePath, which is
+// part of the session layer key too.
 void FillPopulationMaskFromSessionAttr(
         FnAttribute::GroupAttribute sessionAttr,
         const std::string & sessionRootLocation,
@@ -639,12 +800,99 @@ void FillPopulationMaskFromSessionAttr(
         }
     }
     
+    if (mask.IsEmpty() && SdfPath::IsValidPathString(isolatePath))
+    {
+        const SdfPath isolatePrimPath(isolatePath);
+        if (isolatePrimPath.IsAbsolutePath() && isolatePrimPath.IsPrimPath())
+        {
+            mask.Add(isolatePrimPath);
+        }
+    }
+
     if (mask.IsEmpty())
     {
         mask = UsdStagePopulationMask::All();
     }
 }
 
+void UsdKatanaCache::ExpandPopulationMask(const UsdStageRefPtr& stage)
+{
+    if (!stage || stage->GetPopulationMask().IncludesSubtree(SdfPath::AbsoluteRootPath()))
+    {
+        return;
+    }
+
+    TRACE_FUNCTION();
+    stage->ExpandPopulationMask();
+}
+
+void UsdKatanaCache::ExpandPopulationMask(const UsdStageRefPtr& stage, const SdfPath& path)
+{
+    if (!stage || stage->GetPopulationMask().IncludesSubtree(SdfPath::AbsoluteRootPath()))
+    {
+        return;
+    }
+    const UsdPrim prim = stage->GetPrimAtPath(path);
+    if (!prim)
+    {
+        return;
+    }
+
+    TRACE_FUNCTION();
+
+    // The rest of the stage was expanded when it was opened, so only the
+    // targets found below the loaded prim can add to the mask. Only when
+    // they do is the whole mask expanded again, for their own targets.
+    const UsdStagePopulationMask mask = stage->GetPopulationMask();
+    SdfPathVector targets = prim.FindAllRelationshipTargetPaths();
+    const SdfPathVector connections = prim.FindAllAttributeConnectionPaths();
+    targets.insert(targets.end(), connections.begin(), connections.end());
+    UsdStagePopulationMask newMask = mask;
+    for (const SdfPath& target : targets)
+    {
+        const SdfPath targetPrimPath = target.GetPrimPath();
+        if (!targetPrimPath.IsEmpty() && !mask.IncludesSubtree(targetPrimPath))
+        {
+            newMask.Add(targetPrimPath);
+        }
+    }
+    if (newMask == mask)
+    {
+        return;
+    }
+    stage->SetPopulationMask(newMask);
+    stage->ExpandPopulationMask();
+}
+
+namespace
+{
+size_t CountPrims(const UsdPrim& root)
+{
+    const UsdPrimRange range = UsdPrimRange::AllPrims(root);
+    return std::distance(range.begin(), range.end());
+}
+
+size_t CountPrims(const UsdStageRefPtr& stage)
+{
+    size_t numPrims = CountPrims(stage->GetPseudoRoot());
+    for (const UsdPrim& prototype : stage->GetPrototypes())
+    {
+        numPrims += CountPrims(prototype);
+    }
+    return numPrims;
+}
+
+}  // namespace
+
+std::string UsdKatanaCache::_ComputeStageKey(FnAttribute::GroupAttribute sessionAttr,
+                                             const std::string& rootLocation,
+                                             const std::string& isolatePath,
+                                             const SdfLayerHandle& rootLayer)
+{
+    return _ComputeCacheKey(sessionAttr, rootLocation, isolatePath) + "|" +
+           rootLayer->GetIdentifier() + "|" +
+           TfStringify(hash_value(ArGetResolver().GetCurrentContext()));
+}
 
 UsdStageRefPtr UsdKatanaCache::GetStage(
         std::string const& fileName, 
@@ -654,6 +902,8 @@ UsdStageRefPtr UsdKatanaCache::GetStage(
         std::string const& ignoreLayerRegex,
         bool forcePopulate)
 {
+    TRACE_FUNCTION();
+
     TF_DEBUG(USDKATANA_CACHE_STAGE).Msg(
             "{USD STAGE CACHE} Creating and caching UsdStage for "
             "given filePath @%s@, which resolves to @%s@\n", 
@@ -669,16 +919,50 @@ UsdStageRefPtr UsdKatanaCache::GetStage(
         FillPopulationMaskFromSessionAttr(
                 sessionAttr, sessionRootLocation, isolatePath, mask);
         
+        // Load rules, when given, decide which payloads are loaded instead.
+        FnAttribute::GroupAttribute loadRulesAttr = sessionAttr.getChildByName("loadRules");
         const UsdStage::InitialLoadSet load = 
-            (forcePopulate ? UsdStage::LoadAll : UsdStage::LoadNone);
+            (forcePopulate && !loadRulesAttr.isValid() ? UsdStage::LoadAll : UsdStage::LoadNone);
 
-        auto result = stageCache.RequestStage(UsdIn_StageOpenRequest(
-            load, rootLayer, sessionLayer, ArGetResolver().GetCurrentContext(), mask));
+        auto result = stageCache.RequestStage(
+            UsdIn_StageOpenRequest(load, rootLayer, sessionLayer,
+                                   ArGetResolver().GetCurrentContext(), mask,
+                                   loadRulesAttr));
 
         UsdStageRefPtr stage = result.first;
-        
+
+        // The stage may have been evicted since it was found in the stage
+        // cache, in which case it is cached again.
+        const std::string stageKey =
+            _ComputeStageKey(sessionAttr, sessionRootLocation, isolatePath, rootLayer);
+        bool isNewEntry = false;
+        {
+            std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+            const auto it = _stageEntries.find(stageKey);
+            isNewEntry = it == _stageEntries.end() || it->second.stage != stage;
+        }
+        if (isNewEntry)
+        {
+            std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+            _StageEntry& entry = _stageEntries[stageKey];
+            isNewEntry = entry.stage != stage;
+            if (isNewEntry)
+            {
+                entry.stage = stage;
+                entry.numPrims = 0;
+                entry.numPrimsCounted = false;
+                entry.numUsers = 0;
+                if (!result.second)
+                {
+                    stageCache.Insert(stage);
+                }
+            }
+        }
+
         if (result.second)
         {
+            _RecordLayerVersions(stage);
+
             TF_DEBUG(USDKATANA_CACHE_STAGE).Msg(
                     "{USD STAGE CACHE} Loaded stage "
                     "(%s, forcePopulate=%s) "
@@ -701,6 +985,12 @@ UsdStageRefPtr UsdKatanaCache::GetStage(
                     (size_t)stage.operator->(),
                     sessionAttr.getHash().str().c_str());
         }
+
+        // Callers hold the stage lock for reading.
+        if (isNewEntry && _memoryBudget > 0)
+        {
+            _EnforceMemoryBudget(stage);
+        }
         
         // Mute layers according to a regex.
         _SetMutedLayers(stage, ignoreLayerRegex);
@@ -713,6 +1003,223 @@ UsdStageRefPtr UsdKatanaCache::GetStage(
 }
 
 
+namespace
+{
+// Layers which can be reloaded from a file without losing edits.
+bool IsReloadable(const SdfLayerHandle& layer)
+{
+    return layer && !layer->IsAnonymous() && !layer->IsDirty();
+}
+
+ArTimestamp GetLayerTimestamp(const SdfLayerHandle& layer)
+{
+    return ArGetResolver().GetModificationTimestamp(layer->GetIdentifier(),
+                                                    ArResolvedPath(layer->GetResolvedPath()));
+}
+
+}  // namespace
+
+bool UsdKatanaCache::HashLayerContents(const SdfLayerHandle& layer, size_t* hash)
+{
+    const std::shared_ptr<ArAsset> asset =
+        ArGetResolver().OpenAsset(ArResolvedPath(layer->GetResolvedPath()));
+    const std::shared_ptr<const char> buffer = asset ? asset->GetBuffer() : nullptr;
+    if (!buffer)
+    {
+        return false;
+    }
+    *hash = std::hash<std::string_view>()(std::string_view(buffer.get(), asset->GetSize()));
+    return true;
+}
+
+void UsdKatanaCache::_RecordLayerVersions(const UsdStageRefPtr& stage)
+{
+    std::lock_guard<std::mutex> lock(_layerVersionsMutex);
+    for (const SdfLayerHandle& layer : stage->GetUsedLayers())
+    {
+        if (IsReloadable(layer))
+        {
+            _LayerVersion& version = _layerVersions[layer->GetIdentifier()];
+            if (!version.timestamp.IsValid())
+            {
+                version.timestamp = GetLayerTimestamp(layer);
+            }
+        }
+    }
+}
+
+std::vector<std::string> UsdKatanaCache::ReloadChangedLayers(const UsdStageRefPtr& stage,
+                                                             bool compareContents)
+{
+    TRACE_FUNCTION();
+
+    const std::vector<UsdStageRefPtr> stages =
+        stage ? std::vector<UsdStageRefPtr>{stage} : UsdUtilsStageCache::Get().GetAllStages();
+
+    std::set<SdfLayerHandle> candidates;
+    for (const UsdStageRefPtr& candidateStage : stages)
+    {
+        for (const SdfLayerHandle& layer : candidateStage->GetUsedLayers())
+        {
+            if (IsReloadable(layer))
+            {
+                candidates.insert(layer);
+            }
+        }
+    }
+
+    std::set<SdfLayerHandle> changedLayers;
+    {
+        std::lock_guard<std::mutex> lock(_layerVersionsMutex);
+        for (const SdfLayerHandle& layer : candidates)
+        {
+            _LayerVersion& version = _layerVersions[layer->GetIdentifier()];
+            bool changed = false;
+            if (compareContents)
+            {
+                size_t contentHash = 0;
+                if (HashLayerContents(layer, &contentHash))
+                {
+                    changed = version.hasContentHash && contentHash != version.contentHash;
+                    version.contentHash = contentHash;
+                    version.hasContentHash = true;
+                }
+            }
+            else
+            {
+                const ArTimestamp timestamp = GetLayerTimestamp(layer);
+                if (timestamp.IsValid())
+                {
+                    changed = version.timestamp.IsValid() && timestamp != version.timestamp;
+                    version.timestamp = timestamp;
+                }
+            }
+            if (changed)
+            {
+                changedLayers.insert(layer);
+            }
+        }
+    }
+
+    std::vector<std::string> reloadedLayers;
+    if (changedLayers.empty())
+    {
+        return reloadedLayers;
+    }
+
+    // The layers are known to have changed, so there is no need for USD to
+    // compare their modification times again.
+    SdfLayer::ReloadLayers(changedLayers, /* force */ true);
+    for (const SdfLayerHandle& layer : changedLayers)
+    {
+        TF_DEBUG(USDKATANA_CACHE_STAGE).Msg("{USD STAGE CACHE} Reloaded layer @%s@\n",
+                                            layer->GetIdentifier().c_str());
+        reloadedLayers.push_back(layer->GetIdentifier());
+    }
+
+    ++_reloadGeneration;
+
+    // Drop what was derived from the old contents of the layers.
+    UsdKatanaStaticAttrCache::GetInstance().ClearLayers(changedLayers);
+    UsdKatanaCookCache::GetInstance().ClearLayerHashes();
+    for (const UsdStageRefPtr& candidateStage : stages)
+    {
+        const SdfLayerHandleVector usedLayers = candidateStage->GetUsedLayers();
+        if (std::any_of(usedLayers.begin(), usedLayers.end(),
+                        [&changedLayers](const SdfLayerHandle& layer) {
+                            return changedLayers.count(layer) > 0;
+                        }))
+        {
+            // UsdIn args created from now on compute the bounds again.
+            std::vector<std::shared_ptr<UsdKatanaBoundsCache>> boundsCaches;
+            {
+                std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+                for (auto& entry : _stageEntries)
+                {
+                    if (entry.second.stage == candidateStage && entry.second.boundsCache)
+                    {
+                        boundsCaches.push_back(std::move(entry.second.boundsCache));
+                    }
+                }
+            }
+            for (const auto& boundsCache : boundsCaches)
+            {
+                boundsCache->RemoveAuthoredExtentsHints(candidateStage);
+            }
+        }
+    }
+    return reloadedLayers;
+}
+
+size_t UsdKatanaCache::GetReloadGeneration() const
+{
+    return _reloadGeneration;
+}
+
+void UsdKatanaCache::PrefetchStage(std::string const& fileName,
+                                   FnAttribute::GroupAttribute sessionAttr,
+                                   const std::string& sessionRootLocation,
+                                   const std::string& isolatePath,
+                                   std::string const& ignoreLayerRegex,
+                                   bool forcePopulate,
+                                   const ArResolverContext& resolverContext)
+{
+    // UsdIn builds its op chain often, only prefetch once at a time.
+    const std::string prefetchKey =
+        _ComputeCacheKey(sessionAttr, sessionRootLocation, isolatePath) + "|" + fileName + "|" +
+        ignoreLayerRegex + "|" + (forcePopulate ? "1" : "0") + "|" +
+        TfStringify(hash_value(resolverContext));
+    std::lock_guard<std::mutex> lock(_prefetchMutex);
+
+    // Join the threads of the prefetches which are done.
+    for (auto it = _prefetchThreads.begin(); it != _prefetchThreads.end();)
+    {
+        if (_pendingPrefetches.count(it->first) == 0)
+        {
+            it->second.join();
+            it = _prefetchThreads.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (!_pendingPrefetches.insert(prefetchKey).second)
+    {
+        return;
+    }
+
+    // The stage lock is taken before the stage is requested, so a cook
+    // asking for the stage while this thread waits for the lock opens it
+    // itself rather than waiting for this thread.
+    _prefetchThreads[prefetchKey] = std::thread([=]() {
+        TRACE_SCOPE("UsdKatanaCache: prefetch stage");
+        {
+            // GetStage() expects the stage lock to be held for reading.
+            boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+            const ArResolverContextBinder binder(resolverContext);
+            GetStage(fileName, sessionAttr, sessionRootLocation, isolatePath, ignoreLayerRegex,
+                     forcePopulate);
+        }
+        std::lock_guard<std::mutex> lock(_prefetchMutex);
+        _pendingPrefetches.erase(prefetchKey);
+    });
+}
+
+void UsdKatanaCache::WaitForPrefetches()
+{
+    std::map<std::string, std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(_prefetchMutex);
+        threads.swap(_prefetchThreads);
+    }
+    for (auto& thread : threads)
+    {
+        thread.second.join();
+    }
+}
+
 UsdStageRefPtr
 UsdKatanaCache::GetUncachedStage(std::string const& fileName, 
                             FnAttribute::GroupAttribute sessionAttr,
@@ -721,6 +1228,8 @@ UsdKatanaCache::GetUncachedStage(std::string const& fileName,
                             std::string const& ignoreLayerRegex,
                             bool forcePopulate)
 {
+    TRACE_FUNCTION();
+
     TF_DEBUG(USDKATANA_CACHE_STAGE).Msg(
             "{USD STAGE CACHE} Creating UsdStage for "
             "given filePath @%s@, which resolves to @%s@\n", 
@@ -732,13 +1241,19 @@ UsdKatanaCache::GetUncachedStage(std::string const& fileName,
         UsdStagePopulationMask mask;
         FillPopulationMaskFromSessionAttr(sessionAttr, sessionRootLocation, isolatePath, mask);
 
+        FnAttribute::GroupAttribute loadRulesAttr = sessionAttr.getChildByName("loadRules");
         const UsdStage::InitialLoadSet load = 
-            (forcePopulate ? UsdStage::LoadAll : UsdStage::LoadNone);
+            (forcePopulate && !loadRulesAttr.isValid() ? UsdStage::LoadAll : UsdStage::LoadNone);
         
         // OpenMasked is always uncached
         UsdStageRefPtr const stage = UsdStage::OpenMasked(rootLayer, sessionLayer, 
                 ArGetResolver().GetCurrentContext(), mask,
                 load);
+        if (stage && loadRulesAttr.isValid())
+        {
+            ApplyLoadRules(stage, loadRulesAttr);
+        }
+        ExpandPopulationMask(stage);
 
         TF_DEBUG(USDKATANA_CACHE_STAGE).Msg(
                     "{USD STAGE CACHE} Loaded uncached stage "
@@ -762,28 +1277,150 @@ UsdKatanaCache::GetUncachedStage(std::string const& fileName,
 
 void UsdKatanaCache::FlushStage(const UsdStageRefPtr & stage)
 {
+    TRACE_FUNCTION();
+
     UsdStageCache& stageCache = UsdUtilsStageCache::Get();
     
     stageCache.Erase(stage);
+
+    std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+    for (auto it = _stageEntries.begin(); it != _stageEntries.end();)
+    {
+        it = it->second.stage == stage ? _stageEntries.erase(it) : std::next(it);
+    }
+}
+
+void UsdKatanaCache::RecordPayloadLoad(const UsdStageRefPtr& stage, const SdfPath& path)
+{
+    const UsdPrim prim = stage->GetPrimAtPath(path);
+    if (!prim)
+    {
+        return;
+    }
+    _RecordLayerVersions(stage);
+
+    // The prims are counted again when the memory is next reported.
+    std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+    for (auto& entry : _stageEntries)
+    {
+        if (entry.second.stage == stage)
+        {
+            entry.second.numPrimsCounted = false;
+        }
+    }
+}
+
+void UsdKatanaCache::RetainStage(const UsdStageRefPtr& stage)
+{
+    std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+    for (auto& entry : _stageEntries)
+    {
+        if (entry.second.stage == stage)
+        {
+            ++entry.second.numUsers;
+        }
+    }
+}
+
+std::shared_ptr<UsdKatanaBoundsCache> UsdKatanaCache::GetBoundsCache(
+    const UsdStageRefPtr& stage)
+{
+    std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+    for (auto& entry : _stageEntries)
+    {
+        if (entry.second.stage == stage)
+        {
+            if (!entry.second.boundsCache)
+            {
+                entry.second.boundsCache = std::make_shared<UsdKatanaBoundsCache>();
+            }
+            return entry.second.boundsCache;
+        }
+    }
+    return std::make_shared<UsdKatanaBoundsCache>();
+}
+
+bool UsdKatanaCache::HasMissingExtentsHints()
+{
+    std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+    for (const auto& entry : _stageEntries)
+    {
+        if (entry.second.boundsCache && entry.second.boundsCache->HasMissingExtentsHints())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t UsdKatanaCache::AuthorMissingExtentsHints()
+{
+    TRACE_FUNCTION();
+
+    // Authoring composes bounds, so it happens outside of the lock.
+    std::vector<std::pair<UsdStageRefPtr, std::shared_ptr<UsdKatanaBoundsCache>>> boundsCaches;
+    {
+        std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+        for (const auto& entry : _stageEntries)
+        {
+            if (entry.second.boundsCache)
+            {
+                boundsCaches.emplace_back(entry.second.stage, entry.second.boundsCache);
+            }
+        }
+    }
+
+    size_t numAuthored = 0;
+    for (const auto& stageBoundsCache : boundsCaches)
+    {
+        numAuthored += stageBoundsCache.second->AuthorMissingExtentsHints(stageBoundsCache.first);
+    }
+
+    // The hints are authored in a sublayer of the session layer, whose
+    // hash the cook cache would otherwise keep using.
+    if (numAuthored > 0)
+    {
+        UsdKatanaCookCache::GetInstance().ClearLayerHashes();
+    }
+    return numAuthored;
+}
+
+void UsdKatanaCache::ReleaseStage(const UsdStageRefPtr& stage)
+{
+    std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+    for (auto& entry : _stageEntries)
+    {
+        if (entry.second.stage == stage && entry.second.numUsers > 0)
+        {
+            --entry.second.numUsers;
+        }
+    }
 }
 
 
 std::string UsdKatanaCache::_ComputeCacheKey(
     FnAttribute::GroupAttribute sessionAttr,
-    const std::string& rootLocation) {
-    return FnAttribute::GroupAttribute(
-        // replace invalid sessionAttr with empty valid group for consistency
-        // with external queries based on "info.usd.outputSession"
-        "s", sessionAttr.isValid() ? sessionAttr : FnAttribute::GroupAttribute(true),
-        "r", FnAttribute::StringAttribute(rootLocation), true)
-        .getHash()
-        .str();
+    const std::string& rootLocation,
+    const std::string& isolatePath) {
+    FnAttribute::GroupBuilder keyBuilder;
+    // replace invalid sessionAttr with empty valid group for consistency
+    // with external queries based on "info.usd.outputSession"
+    keyBuilder.set("s", sessionAttr.isValid() ? sessionAttr : FnAttribute::GroupAttribute(true));
+    keyBuilder.set("r", FnAttribute::StringAttribute(rootLocation));
+    // The isolatePath decides the population mask and where the session
+    // edits apply. Leave it out when empty so that other keys are unchanged.
+    if (!isolatePath.empty())
+    {
+        keyBuilder.set("i", FnAttribute::StringAttribute(isolatePath));
+    }
+    return keyBuilder.build().getHash().str();
 }
 
 SdfLayerRefPtr UsdKatanaCache::FindSessionLayer(
     FnAttribute::GroupAttribute sessionAttr,
-    const std::string& rootLocation) {
-    std::string cacheKey = _ComputeCacheKey(sessionAttr, rootLocation);
+    const std::string& rootLocation,
+    const std::string& isolatePath) {
+    std::string cacheKey = _ComputeCacheKey(sessionAttr, rootLocation, isolatePath);
     return FindSessionLayer(cacheKey);
 }
 
@@ -817,5 +1454,227 @@ SdfLayerRefPtr UsdKatanaCache::FindOrCreateSessionLayer(
 
 
 
-PXR_NAMESPACE_CLOSE_SCOPE
+namespace
+{
+// Rough cost of a composed prim: its prim data, prim index and share of the
+// layer data it is composed from. USD does not report the memory of a stage.
+const size_t kApproxBytesPerPrim = 1024;
+
+}  // namespace
+
+void UsdKatanaCache::RegisterMemoryReporter(
+    const std::string& cacheName,
+    std::function<void(UsdKatanaCacheMemoryUsageVector*)> report,
+    std::function<size_t(size_t)> evict)
+{
+    std::lock_guard<std::mutex> lock(_memoryReportersMutex);
+    _memoryReporters.push_back({cacheName, std::move(report), std::move(evict)});
+}
+
+UsdKatanaCacheMemoryUsageVector UsdKatanaCache::GetMemoryUsage()
+{
+    boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+    return _GetMemoryUsage();
+}
+
+UsdKatanaCacheMemoryUsageVector UsdKatanaCache::_GetMemoryUsage()
+{
+    TRACE_FUNCTION();
+
+    UsdKatanaCacheMemoryUsageVector usage;
+
+    // Count the prims of the stages opened, or given payloads, since the
+    // memory was last reported. This is done outside of the mutex, as it
+    // walks the whole stage.
+    std::vector<UsdStageRefPtr> uncountedStages;
+    {
+        std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+        for (const auto& entry : _stageEntries)
+        {
+            if (!entry.second.numPrimsCounted)
+            {
+                uncountedStages.push_back(entry.second.stage);
+            }
+        }
+    }
+    std::map<UsdStageRefPtr, size_t> stagePrimCounts;
+    for (const UsdStageRefPtr& stage : uncountedStages)
+    {
+        stagePrimCounts.emplace(stage, CountPrims(stage));
+    }
+
+    std::map<SdfLayerHandle, std::string> sessionLayerStages;
+    {
+        std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+        for (auto& entry : _stageEntries)
+        {
+            const UsdStageRefPtr& stage = entry.second.stage;
+            const auto countIt = stagePrimCounts.find(stage);
+            if (!entry.second.numPrimsCounted && countIt != stagePrimCounts.end())
+            {
+                entry.second.numPrims = countIt->second;
+                entry.second.numPrimsCounted = true;
+            }
+            UsdKatanaCacheMemoryUsage stageUsage;
+            stageUsage.cacheName = "stage";
+            stageUsage.stage = stage->GetRootLayer()->GetIdentifier();
+            stageUsage.numEntries = entry.second.numPrims;
+            stageUsage.bytes = stageUsage.numEntries * kApproxBytesPerPrim;
+            usage.push_back(stageUsage);
+
+            if (const SdfLayerHandle sessionLayer = stage->GetSessionLayer())
+            {
+                sessionLayerStages[sessionLayer] = stageUsage.stage;
+            }
+        }
+    }
+
+    {
+        boost::shared_lock<boost::upgrade_mutex> sessionReaderLock(
+            UsdKatanaGetSessionCacheLock());
+        for (const auto& entry : _sessionKeyCache)
+        {
+            if (!entry.second)
+            {
+                continue;
+            }
+            // Session layers are small, so their text form is a fair measure.
+            std::string layerString;
+            entry.second->ExportToString(&layerString);
+
+            UsdKatanaCacheMemoryUsage layerUsage;
+            layerUsage.cacheName = "sessionLayer";
+            const auto stageIt = sessionLayerStages.find(entry.second);
+            if (stageIt != sessionLayerStages.end())
+            {
+                layerUsage.stage = stageIt->second;
+            }
+            layerUsage.bytes = layerString.size();
+            layerUsage.numEntries = 1;
+            usage.push_back(layerUsage);
+        }
+    }
+
+    UsdKatanaUsdInArgs::ReportMemoryUsage(&usage);
+
+    std::lock_guard<std::mutex> lock(_memoryReportersMutex);
+    for (const _MemoryReporter& reporter : _memoryReporters)
+    {
+        reporter.report(&usage);
+    }
+    return usage;
+}
+
+size_t UsdKatanaCache::GetTotalMemoryUsage()
+{
+    size_t totalBytes = 0;
+    for (const UsdKatanaCacheMemoryUsage& usage : GetMemoryUsage())
+    {
+        totalBytes += usage.bytes;
+    }
+    return totalBytes;
+}
+
+void UsdKatanaCache::SetMemoryBudget(size_t bytes)
+{
+    _memoryBudget = bytes;
+}
+
+size_t UsdKatanaCache::GetMemoryBudget() const
+{
+    return _memoryBudget;
+}
+
+size_t UsdKatanaCache::EnforceMemoryBudget()
+{
+    boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+    return _EnforceMemoryBudget(UsdStageRefPtr());
+}
+
+size_t UsdKatanaCache::_EnforceMemoryBudget(const UsdStageRefPtr& keepStage)
+{
+    TRACE_FUNCTION();
+
+    const size_t budget = _memoryBudget;
+    if (budget == 0)
+    {
+        return 0;
+    }
+
+    const UsdKatanaCacheMemoryUsageVector usage = _GetMemoryUsage();
+    size_t totalBytes = 0;
+    for (const UsdKatanaCacheMemoryUsage& entry : usage)
+    {
+        totalBytes += entry.bytes;
+    }
+    if (totalBytes <= budget)
+    {
+        return 0;
+    }
+
+    size_t freedBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(_memoryReportersMutex);
+        for (const _MemoryReporter& reporter : _memoryReporters)
+        {
+            if (totalBytes - freedBytes <= budget)
+            {
+                break;
+            }
+            if (reporter.evict)
+            {
+                const size_t bytes = reporter.evict(totalBytes - freedBytes - budget);
+                if (bytes > 0)
+                {
+                    FnLogInfo("Evicted " << bytes << " bytes from the " << reporter.cacheName
+                                         << " cache to stay within the memory budget of "
+                                         << budget << " bytes");
+                }
+                freedBytes += bytes;
+            }
+        }
+    }
+
+    // Then drop the stages without users, largest first. A stage still held
+    // by UsdIn args would be opened again rather than freed. The stages are
+    // destroyed once the lock is released.
+    std::vector<UsdStageRefPtr> evictedStages;
+    std::lock_guard<std::mutex> lock(_stageEntriesMutex);
+    std::vector<std::pair<size_t, std::string>> stageKeys;
+    for (const auto& entry : _stageEntries)
+    {
+        if (entry.second.stage != keepStage && entry.second.numUsers == 0)
+        {
+            stageKeys.emplace_back(entry.second.numPrims * kApproxBytesPerPrim, entry.first);
+        }
+    }
+    std::sort(stageKeys.begin(), stageKeys.end(),
+              [](const std::pair<size_t, std::string>& a,
+                 const std::pair<size_t, std::string>& b) { return a.first > b.first; });
+    for (const auto& stageKey : stageKeys)
+    {
+        if (totalBytes - freedBytes <= budget)
+        {
+            break;
+        }
+        const auto it = _stageEntries.find(stageKey.second);
+        FnLogInfo("Evicted stage " << it->second.stage->GetRootLayer()->GetIdentifier() << " ("
+                                   << stageKey.first
+                                   << " bytes) to stay within the memory budget of " << budget
+                                   << " bytes");
+        UsdUtilsStageCache::Get().Erase(it->second.stage);
+        evictedStages.push_back(it->second.stage);
+        _stageEntries.erase(it);
+        freedBytes += stageKey.first;
+    }
+
+    if (totalBytes - freedBytes > budget)
+    {
+        FnLogWarn("USD caches hold about " << totalBytes - freedBytes
+                                           << " bytes, over the memory budget of " << budget
+                                           << " bytes, and nothing else can be evicted");
+    }
+    return freedBytes;
+}
 
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -30,11 +30,19 @@
 #ifndef USDKATANA_CACHE_H
 #define USDKATANA_CACHE_H
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <pxr/base/tf/singleton.h>
 #include <pxr/pxr.h>
+#include <pxr/usd/ar/timestamp.h>
 #include <pxr/usd/sdf/declareHandles.h>
 #include <pxr/usd/usd/stage.h>
 
@@ -48,9 +56,26 @@ PXR_NAMESPACE_OPEN_SCOPE
 // Forward declare pointers.
 SDF_DECLARE_HANDLES(SdfLayer);
 typedef TfRefPtr<class UsdStage> UsdStageRefPtr;
+class ArResolverContext;
 class SdfPath;
+class UsdKatanaBoundsCache;
 class UsdPrim;
 
+/// Approximate memory held by one of the caches of the plug-ins.
+struct UsdKatanaCacheMemoryUsage
+{
+    /// The cache holding the memory, e.g. "stage", "sessionLayer",
+    /// "material", "bounds" or "skinning".
+    std::string cacheName;
+    /// Identifier of the root layer of the stage the memory is held for, or
+    /// empty if it is not held for a particular stage.
+    std::string stage;
+    size_t bytes = 0;
+    size_t numEntries = 0;
+};
+
+typedef std::vector<UsdKatanaCacheMemoryUsage> UsdKatanaCacheMemoryUsageVector;
+
 /*
  * Custom cache singleton class for katana. Hold the usd stage and renderer.
  * The stage returned by this cache helper is meant to be read only. The
@@ -61,6 +86,7 @@ class UsdKatanaCache : public TfSingleton<UsdKatanaCache>
     friend class TfSingleton<UsdKatanaCache>;
 
     UsdKatanaCache();
+    ~UsdKatanaCache();
 
     /// Construct a session layer from the groupAttr encoding of variants
     /// and deactivations -- or return a previously created one
@@ -73,10 +99,71 @@ class UsdKatanaCache : public TfSingleton<UsdKatanaCache>
         const UsdStageRefPtr &stage, const std::string &layerRegex);
 
     std::string _ComputeCacheKey(FnAttribute::GroupAttribute sessionAttr,
-        const std::string& rootLocation);
+        const std::string& rootLocation,
+        const std::string& isolatePath = "");
 
     std::map<std::string, SdfLayerRefPtr> _sessionKeyCache;
 
+    struct _MemoryReporter
+    {
+        std::string cacheName;
+        std::function<void(UsdKatanaCacheMemoryUsageVector*)> report;
+        std::function<size_t(size_t)> evict;
+    };
+
+    /// Implementations of GetMemoryUsage() and EnforceMemoryBudget() for
+    /// callers already holding the stage lock. \p keepStage is not evicted.
+    UsdKatanaCacheMemoryUsageVector _GetMemoryUsage();
+    size_t _EnforceMemoryBudget(const UsdStageRefPtr& keepStage);
+
+    std::mutex _memoryReportersMutex;
+    std::vector<_MemoryReporter> _memoryReporters;
+    std::atomic<size_t> _memoryBudget{0};
+
+    // The stages opened by GetStage(), keyed by _ComputeStageKey(). Their
+    // prims are only counted when the memory is reported, and again after
+    // payloads are loaded, so that cooks without a memory budget never walk
+    // the stage. Their users are the UsdIn args holding them. The bounds
+    // computed for a stage are shared by all of its UsdIn args.
+    struct _StageEntry
+    {
+        UsdStageRefPtr stage;
+        size_t numPrims = 0;
+        bool numPrimsCounted = false;
+        size_t numUsers = 0;
+        std::shared_ptr<UsdKatanaBoundsCache> boundsCache;
+    };
+
+    std::string _ComputeStageKey(FnAttribute::GroupAttribute sessionAttr,
+                                 const std::string& rootLocation,
+                                 const std::string& isolatePath,
+                                 const SdfLayerHandle& rootLayer);
+
+    std::mutex _stageEntriesMutex;
+    std::map<std::string, _StageEntry> _stageEntries;
+
+    // The version of each layer file last seen by ReloadChangedLayers(),
+    // keyed by layer identifier.
+    struct _LayerVersion
+    {
+        ArTimestamp timestamp;
+        size_t contentHash = 0;
+        bool hasContentHash = false;
+    };
+
+    void _RecordLayerVersions(const UsdStageRefPtr& stage);
+
+    std::mutex _layerVersionsMutex;
+    std::map<std::string, _LayerVersion> _layerVersions;
+    std::atomic<size_t> _reloadGeneration{0};
+
+    // Prefetches run on threads of their own rather than in TBB tasks, which
+    // a cook holding the stage lock for reading could pick up while waiting
+    // on work of its own, and then wait on the lock behind a queued writer.
+    std::mutex _prefetchMutex;
+    std::set<std::string> _pendingPrefetches;
+    std::map<std::string, std::thread> _prefetchThreads;
+
 public:
 
     USDKATANA_API static UsdKatanaCache& GetInstance() {
@@ -88,6 +175,17 @@ public:
 
     /// Get (or create) a cached usd stage with a sessionLayer containing
     /// variant selections and activations (so far)
+    ///
+    /// If \p sessionAttr has a "loadRules" group, the stage is opened with
+    /// the payloads it describes loaded, and \p forcePopulate is ignored.
+    /// "rules" holds pairs of prim path and rule ("all", "only" or "none"),
+    /// "maxDepth" limits the depth in the stage of the prims whose payloads
+    /// are loaded and payloads on or below prims of kind "stopAtKind" are not
+    /// loaded.
+    ///
+    /// The stage is masked to the "mask" locations of \p sessionAttr or, if
+    /// there are none, to \p isolatePath, and the mask is then expanded with
+    /// ExpandPopulationMask().
     USDKATANA_API UsdStageRefPtr GetStage(std::string const& fileName,
                             FnAttribute::GroupAttribute sessionAttr,
                             const std::string & sessionRootLocation,
@@ -95,6 +193,23 @@ public:
                             std::string const& ignoreLayerRegex,
                             bool forcePopulate);
 
+    /// Start opening the stage GetStage() would return for the same
+    /// arguments on a thread of its own, and return immediately. A GetStage()
+    /// call made while the stage is being opened waits for it rather than
+    /// opening it again, so stages prefetched as soon as their arguments are
+    /// known open concurrently instead of in the first cook of each.
+    /// \p resolverContext is bound while the stage is opened.
+    USDKATANA_API void PrefetchStage(std::string const& fileName,
+                                     FnAttribute::GroupAttribute sessionAttr,
+                                     const std::string& sessionRootLocation,
+                                     const std::string& isolatePath,
+                                     std::string const& ignoreLayerRegex,
+                                     bool forcePopulate,
+                                     const ArResolverContext& resolverContext);
+
+    /// Wait for the stages started by PrefetchStage() to be opened.
+    USDKATANA_API void WaitForPrefetches();
+
     // Equivalent to GetStage above but without caching
     UsdStageRefPtr GetUncachedStage(std::string const& fileName,
                             FnAttribute::GroupAttribute sessionAttr,
@@ -103,13 +218,90 @@ public:
                             std::string const& ignoreLayerRegex,
                             bool forcePopulate);
 
+    /// Expand the population mask of \p stage, if it has one, to the
+    /// targets of the relationships and attribute connections of the prims
+    /// it includes, recursively, so that materials, skeletons and the prims
+    /// in light linking collections outside of the mask are still composed.
+    /// Prims outside of the mask which target the prims it includes, such as
+    /// lights linked to them, are not added. This is done once, when the
+    /// stage is opened.
+    USDKATANA_API static void ExpandPopulationMask(const UsdStageRefPtr& stage);
+
+    /// Expand the population mask of \p stage after the payload of \p path
+    /// was loaded. Only the prims below \p path are searched for targets,
+    /// and the whole mask is only expanded again if they target prims it
+    /// does not include. The caller must hold the stage lock for writing.
+    USDKATANA_API static void ExpandPopulationMask(const UsdStageRefPtr& stage,
+                                                   const SdfPath& path);
+
     /// Flushes an individual stage if present in the cache
     USDKATANA_API void FlushStage(const UsdStageRefPtr & stage);
 
+    /// Have the prims brought in by loading the payload of \p path, which
+    /// was not loaded before, counted in the size of \p stage the next time
+    /// the memory is reported, and record the versions of the layers the
+    /// payload brought in for ReloadChangedLayers(). The caller must hold the
+    /// stage lock for writing.
+    USDKATANA_API void RecordPayloadLoad(const UsdStageRefPtr& stage, const SdfPath& path);
+
+    /// Add or remove a user of \p stage, typically the UsdIn args holding
+    /// it. Stages with users are not evicted to enforce the memory budget.
+    USDKATANA_API void RetainStage(const UsdStageRefPtr& stage);
+    USDKATANA_API void ReleaseStage(const UsdStageRefPtr& stage);
+
+    /// Returns the bounds cache shared by all the UsdIn args of \p stage, so
+    /// that bounds computed for one UsdIn node or set of op args are reused
+    /// by the others. Its entries are keyed by time. Stages not opened by
+    /// GetStage() get a cache of their own. The cache of a stage is replaced
+    /// when its layers are reloaded.
+    USDKATANA_API std::shared_ptr<UsdKatanaBoundsCache> GetBoundsCache(
+        const UsdStageRefPtr& stage);
+
+    /// Returns true if cooks of a cached stage found models without an
+    /// extentsHint, see UsdKatanaBoundsCache::RecordMissingExtentsHint().
+    USDKATANA_API bool HasMissingExtentsHints();
+
+    /// Authors the missing extentsHints of every cached stage with
+    /// UsdKatanaBoundsCache::AuthorMissingExtentsHints(), and returns the
+    /// number authored. The caller must hold the stage lock for writing.
+    USDKATANA_API size_t AuthorMissingExtentsHints();
+
+    /// Reload the layers used by \p stage, or by every cached stage if
+    /// \p stage is null, whose file changed since the stage was opened or
+    /// since the last call. USD then recomposes only the prims that use those
+    /// layers, instead of the whole stage as after FlushStage().
+    ///
+    /// Changes are detected from the modification time of the files, or from
+    /// a hash of their contents if \p compareContents is true, in which case
+    /// the hashes are recorded by the first call. Anonymous layers and layers
+    /// with unsaved edits are never reloaded. When layers are reloaded, the
+    /// shared static attributes of the prims composed from them, the layer
+    /// hashes of the cook cache, the bounds of the stages and the
+    /// extentsHints authored for them are dropped, as they may be stale, and
+    /// the reload generation is incremented. Returns the identifiers of the
+    /// layers reloaded. The caller must hold the stage lock for writing.
+    USDKATANA_API std::vector<std::string> ReloadChangedLayers(
+        const UsdStageRefPtr& stage = UsdStageRefPtr(),
+        bool compareContents = false);
+
+    /// The number of calls to ReloadChangedLayers() which reloaded layers.
+    /// UsdIn passes it in its op args, so that Katana cooks the locations
+    /// of a stage again once its layers are reloaded.
+    USDKATANA_API size_t GetReloadGeneration() const;
+
+    /// Compute a hash of the contents of the file of \p layer, as it is on
+    /// disk rather than as it is in memory. Returns false if the file
+    /// cannot be read.
+    USDKATANA_API static bool HashLayerContents(const SdfLayerHandle& layer, size_t* hash);
+
     /// \brief Find a cached session layer if it exists.  Does NOT create.
+    ///
+    /// UsdIn publishes \p sessionAttr and \p isolatePath of its stage as
+    /// "info.usd.outputSession" and "info.usd.isolatePath".
     SdfLayerRefPtr FindSessionLayer(
         FnAttribute::GroupAttribute sessionAttr,
-        const std::string& rootLocation);
+        const std::string& rootLocation,
+        const std::string& isolatePath = "");
 
     USDKATANA_API SdfLayerRefPtr FindSessionLayer(
         const std::string& cacheKey) ;
@@ -117,6 +309,42 @@ public:
     USDKATANA_API SdfLayerRefPtr FindOrCreateSessionLayer(
         const std::string& sessionAttrXML,
         const std::string& rootLocation);
+
+    /// Register a cache held by a plug-in, so that its memory is included
+    /// in GetMemoryUsage(). \p report appends the usage of the cache to the
+    /// given vector. \p evict, if provided, drops entries to free at least
+    /// the given number of bytes where possible, and returns the number of
+    /// bytes it freed.
+    USDKATANA_API void RegisterMemoryReporter(
+        const std::string& cacheName,
+        std::function<void(UsdKatanaCacheMemoryUsageVector*)> report,
+        std::function<size_t(size_t)> evict = std::function<size_t(size_t)>());
+
+    /// Report the approximate memory held by the cached stages and session
+    /// layers, the caches of the UsdIn args alive in the process and the
+    /// caches registered with RegisterMemoryReporter(). The size of a stage
+    /// opened by GetStage() is estimated from its number of prims, as USD
+    /// does not report it.
+    ///
+    /// This takes the stage lock for reading.
+    USDKATANA_API UsdKatanaCacheMemoryUsageVector GetMemoryUsage();
+
+    /// Returns the sum of the bytes reported by GetMemoryUsage().
+    USDKATANA_API size_t GetTotalMemoryUsage();
+
+    /// Set the number of bytes the caches should stay under, or 0 for no
+    /// limit. The budget is enforced whenever a new stage is opened and
+    /// whenever EnforceMemoryBudget() is called. It defaults to the value
+    /// of the USD_KATANA_CACHE_MEMORY_BUDGET_MB environment variable.
+    USDKATANA_API void SetMemoryBudget(size_t bytes);
+
+    USDKATANA_API size_t GetMemoryBudget() const;
+
+    /// Evict entries until the caches fit the memory budget. Registered
+    /// caches are evicted first, then the cached stages without users,
+    /// largest first. Returns the number of bytes
+    /// freed. This takes the stage lock for reading.
+    USDKATANA_API size_t EnforceMemoryBudget();
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
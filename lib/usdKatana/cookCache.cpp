@@ -0,0 +1,820 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/cookCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pxr/base/arch/fileSystem.h>
+#include <pxr/base/tf/atomicOfstreamWrapper.h>
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/fileUtils.h>
+#include <pxr/base/tf/getenv.h>
+#include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/base/tf/pathUtils.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/usd/ar/resolver.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/primSpec.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/pointBased.h>
+#include <pxr/usd/usdGeom/primvarsAPI.h>
+#include <pxr/usd/usdShade/tokens.h>
+#include <pxr/usd/usdSkel/bindingAPI.h>
+
+#include <FnLogging/FnLogging.h>
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/cache.h"
+#include "usdKatana/cookStats.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+FnLogSetup("UsdKatanaCookCache");
+
+TF_INSTANTIATE_SINGLETON(UsdKatanaCookCache);
+
+TF_DEFINE_ENV_SETTING(USD_KATANA_COOK_CACHE_MAX_FILE_MB, 4096,
+                      "The size in MB above which a cook cache file is compacted, dropping "
+                      "the entries least recently written or read.");
+
+namespace
+{
+// A cache file is a sequence of segments, each made of:
+// - a header: the magic bytes, the format version, the number of entries,
+//   and the offset and size of the index relative to the segment,
+// - the attributes of each entry, serialized with getBinary(),
+// - the index: for each entry, the offset of its attributes relative to the
+//   segment and their size, then the size of its key and the key.
+// The entries of a segment replace those of earlier segments with the same
+// key.
+//
+// Bump the version whenever the attributes produced by the readers change, as
+// it is part of the file names.
+const char kMagic[4] = {'U', 'K', 'C', 'C'};
+const uint32_t kVersion = 2;
+const size_t kHeaderSize = sizeof(kMagic) + sizeof(uint32_t) + 3 * sizeof(uint64_t);
+
+// New entries are written once they hold this many bytes.
+const size_t kMaxPendingBytes = 256 * 1024 * 1024;
+
+// Set when the process exits, as the Katana logging suite may be gone by the
+// time the remaining entries are written.
+std::atomic<bool> g_isExiting{false};
+
+void LogWarning(const std::string& message)
+{
+    if (g_isExiting)
+    {
+        std::cerr << "UsdKatanaCookCache: " << message << std::endl;
+    }
+    else
+    {
+        FnLogWarn(message);
+    }
+}
+
+template <typename T>
+bool ReadValue(const char* data, size_t size, size_t* offset, T* value)
+{
+    if (*offset + sizeof(T) > size)
+    {
+        return false;
+    }
+    std::memcpy(value, data + *offset, sizeof(T));
+    *offset += sizeof(T);
+    return true;
+}
+
+template <typename T>
+void WriteValue(std::ostream& out, T value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+struct SegmentEntry
+{
+    const std::string* key;
+    const char* data;
+    uint64_t size;
+};
+
+uint64_t GetIndexEntrySize(const std::string& key)
+{
+    return 2 * sizeof(uint64_t) + sizeof(uint32_t) + key.size();
+}
+
+void WriteSegment(std::ostream& out, const std::vector<SegmentEntry>& entries)
+{
+    uint64_t indexOffset = kHeaderSize;
+    uint64_t indexSize = 0;
+    for (const SegmentEntry& entry : entries)
+    {
+        indexOffset += entry.size;
+        indexSize += GetIndexEntrySize(*entry.key);
+    }
+
+    out.write(kMagic, sizeof(kMagic));
+    WriteValue(out, kVersion);
+    WriteValue(out, static_cast<uint64_t>(entries.size()));
+    WriteValue(out, indexOffset);
+    WriteValue(out, indexSize);
+    for (const SegmentEntry& entry : entries)
+    {
+        out.write(entry.data, entry.size);
+    }
+
+    uint64_t entryOffset = kHeaderSize;
+    for (const SegmentEntry& entry : entries)
+    {
+        WriteValue(out, entryOffset);
+        WriteValue(out, entry.size);
+        WriteValue(out, static_cast<uint32_t>(entry.key->size()));
+        out.write(entry.key->data(), entry.key->size());
+        entryOffset += entry.size;
+    }
+}
+
+// Appends \p entries to the file at \p path as a new segment.
+bool AppendSegment(const std::string& path, const std::vector<SegmentEntry>& entries)
+{
+    TRACE_FUNCTION();
+
+    std::ostringstream segment;
+    WriteSegment(segment, entries);
+    const std::string bytes = segment.str();
+
+    FILE* file = ArchOpenFile(path.c_str(), "ab");
+    if (!file)
+    {
+        LogWarning("Cannot append to cook cache file " + path);
+        return false;
+    }
+    // Unbuffered, so that the segment is appended by a single write and the
+    // segments appended by concurrent processes are not interleaved.
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    if (std::fclose(file) != 0 || !written)
+    {
+        LogWarning("Cannot append to cook cache file " + path);
+        return false;
+    }
+    return true;
+}
+
+// Whether the attributes read for \p prim can be cached: they must be the
+// same at every frame, and must not depend on the skeletons, animations and
+// blend shapes applied by UsdSkel, which live on other prims.
+bool IsCacheable(const UsdPrim& prim, const UsdKatanaUsdInPrivateData& privateData)
+{
+    for (const UsdAttribute& attr : prim.GetAttributes())
+    {
+        if (attr.ValueMightBeTimeVarying())
+        {
+            return false;
+        }
+    }
+    for (const UsdGeomPrimvar& primvar : UsdGeomPrimvarsAPI(prim).FindInheritablePrimvars())
+    {
+        if (primvar.ValueMightBeTimeVarying())
+        {
+            return false;
+        }
+    }
+    if (privateData.GetEvaluateUsdSkelBindings())
+    {
+        const UsdSkelBindingAPI binding(prim);
+        if (binding.GetInheritedSkeleton() ||
+            binding.GetBlendShapeTargetsRel().HasAuthoredTargets())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether material bindings through collections apply to \p prim. Their
+// collections and targets may be on any prim of the stage.
+bool HasCollectionBindings(const UsdPrim& prim)
+{
+    for (UsdPrim ancestor = prim; ancestor && !ancestor.IsPseudoRoot();
+         ancestor = ancestor.GetParent())
+    {
+        for (const UsdProperty& property :
+             ancestor.GetAuthoredPropertiesInNamespace(UsdShadeTokens->materialBinding))
+        {
+            if (TfStringContains(property.GetName().GetString(), ":collection"))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+struct UsdKatanaCookCache::_Mapping
+{
+    struct Entry
+    {
+        uint64_t offset;
+        uint64_t size;
+        // The segment the entry was written in, later segments being newer.
+        uint32_t segment;
+    };
+
+    ArchConstFileMapping data;
+    // The size of the valid segments, and whether they fill the file.
+    size_t size = 0;
+    bool isComplete = false;
+    std::unordered_map<std::string, Entry> index;
+
+    FnAttribute::GroupAttribute Find(const std::string& key) const
+    {
+        const auto it = index.find(key);
+        if (it == index.end())
+        {
+            return FnAttribute::GroupAttribute();
+        }
+        return FnAttribute::Attribute::parseBinary(data.get() + it->second.offset,
+                                                   it->second.size);
+    }
+};
+
+struct UsdKatanaCookCache::_File
+{
+    std::string path;
+    std::shared_ptr<const _Mapping> mapping;
+    // Entries added by this process and not written yet.
+    std::map<std::string, std::vector<char>> pending;
+    // Entries of the file read by this process, which are kept when the file
+    // is compacted.
+    std::set<std::string> used;
+};
+
+UsdKatanaCookCache::UsdKatanaCookCache()
+{
+    // Entries added since the last flush are written when the process ends,
+    // typically after a render. They are serialized already, so this only
+    // writes files.
+    std::atexit([]() {
+        g_isExiting = true;
+        UsdKatanaCookCache::GetInstance().Flush();
+    });
+}
+
+UsdKatanaCookCache::~UsdKatanaCookCache() = default;
+
+std::string UsdKatanaCookCache::GetDirectory(const FnAttribute::GroupAttribute& opArgs)
+{
+    const std::string directory =
+        FnAttribute::StringAttribute(opArgs.getChildByName("cookCacheDir")).getValue("", false);
+    return directory.empty() ? TfGetenv("USD_KATANA_COOK_CACHE_DIR") : directory;
+}
+
+std::shared_ptr<const UsdKatanaCookCache::_Mapping> UsdKatanaCookCache::_MapFile(
+    const std::string& path)
+{
+    TRACE_FUNCTION();
+
+    if (!TfIsFile(path))
+    {
+        return nullptr;
+    }
+
+    std::string errorMessage;
+    auto mapping = std::make_shared<_Mapping>();
+    mapping->data = ArchMapFileReadOnly(path, &errorMessage);
+    if (!mapping->data)
+    {
+        LogWarning("Cannot map cook cache file " + path + ": " + errorMessage);
+        return nullptr;
+    }
+
+    const char* data = mapping->data.get();
+    const size_t size = ArchGetFileMappingLength(mapping->data);
+    uint32_t segment = 0;
+    size_t segmentOffset = 0;
+    for (; segmentOffset < size; ++segment)
+    {
+        const char* segmentData = data + segmentOffset;
+        const size_t segmentSize = size - segmentOffset;
+        size_t offset = sizeof(kMagic);
+        uint32_t version = 0;
+        uint64_t numEntries = 0;
+        uint64_t indexOffset = 0;
+        uint64_t indexSize = 0;
+        if (segmentSize < kHeaderSize ||
+            std::memcmp(segmentData, kMagic, sizeof(kMagic)) != 0 ||
+            !ReadValue(segmentData, segmentSize, &offset, &version) || version != kVersion ||
+            !ReadValue(segmentData, segmentSize, &offset, &numEntries) ||
+            !ReadValue(segmentData, segmentSize, &offset, &indexOffset) ||
+            !ReadValue(segmentData, segmentSize, &offset, &indexSize))
+        {
+            if (segment == 0)
+            {
+                LogWarning("Ignoring cook cache file " + path + " with an unknown format");
+                return nullptr;
+            }
+            // Another process may be appending this segment.
+            break;
+        }
+
+        // Entries are only added once the whole index of the segment is
+        // known to be valid.
+        bool valid = indexOffset >= kHeaderSize && indexOffset <= segmentSize &&
+                     indexSize <= segmentSize - indexOffset;
+        const size_t indexEnd = valid ? indexOffset + indexSize : 0;
+        std::vector<std::pair<std::string, _Mapping::Entry>> entries;
+        offset = indexOffset;
+        for (uint64_t i = 0; valid && i < numEntries; ++i)
+        {
+            uint64_t entryOffset = 0;
+            uint64_t entrySize = 0;
+            uint32_t keySize = 0;
+            valid = ReadValue(segmentData, indexEnd, &offset, &entryOffset) &&
+                    ReadValue(segmentData, indexEnd, &offset, &entrySize) &&
+                    ReadValue(segmentData, indexEnd, &offset, &keySize) &&
+                    offset + keySize <= indexEnd && entryOffset <= indexOffset &&
+                    entrySize <= indexOffset - entryOffset;
+            if (valid)
+            {
+                entries.emplace_back(std::string(segmentData + offset, keySize),
+                                     _Mapping::Entry{segmentOffset + entryOffset, entrySize,
+                                                     segment});
+                offset += keySize;
+            }
+        }
+        if (!valid || offset != indexEnd)
+        {
+            if (segment == 0)
+            {
+                LogWarning("Ignoring truncated cook cache file " + path);
+                return nullptr;
+            }
+            break;
+        }
+
+        for (auto& entry : entries)
+        {
+            mapping->index[std::move(entry.first)] = entry.second;
+        }
+        segmentOffset += indexEnd;
+    }
+    mapping->size = segmentOffset;
+    mapping->isComplete = segmentOffset == size;
+    return mapping;
+}
+
+bool UsdKatanaCookCache::_WriteFile(const std::string& path,
+                                    const _Mapping* existing,
+                                    const std::map<std::string, std::vector<char>>& pending,
+                                    const std::set<std::string>& used)
+{
+    TRACE_FUNCTION();
+
+    // Only the entries the file does not hold yet are written, another
+    // process may have written the others since.
+    std::vector<SegmentEntry> newEntries;
+    uint64_t segmentSize = kHeaderSize;
+    for (const auto& entry : pending)
+    {
+        if (!existing || existing->index.find(entry.first) == existing->index.end())
+        {
+            newEntries.push_back({&entry.first, entry.second.data(), entry.second.size()});
+            segmentSize += entry.second.size() + GetIndexEntrySize(entry.first);
+        }
+    }
+    if (newEntries.empty())
+    {
+        return true;
+    }
+
+    const uint64_t maxFileBytes =
+        static_cast<uint64_t>(std::max(TfGetEnvSetting(USD_KATANA_COOK_CACHE_MAX_FILE_MB), 1))
+        << 20;
+    // Segments appended after an invalid one would be ignored.
+    if (existing && existing->isComplete && existing->size + segmentSize <= maxFileBytes)
+    {
+        return AppendSegment(path, newEntries);
+    }
+    return _CompactFile(path, existing, pending, used, maxFileBytes);
+}
+
+bool UsdKatanaCookCache::_CompactFile(const std::string& path,
+                                      const _Mapping* existing,
+                                      const std::map<std::string, std::vector<char>>& pending,
+                                      const std::set<std::string>& used,
+                                      uint64_t maxFileBytes)
+{
+    TRACE_FUNCTION();
+
+    // Keep the new entries, then the entries this process read, then the
+    // others from the most recently written, until the file is three
+    // quarters full so that it is not compacted again at the next flush.
+    const uint64_t maxBytes = maxFileBytes / 4 * 3;
+    uint64_t numBytes = kHeaderSize;
+    std::vector<SegmentEntry> entries;
+    const auto keep = [&](const std::string& key, const char* data, uint64_t size) {
+        const uint64_t entryBytes = size + GetIndexEntrySize(key);
+        if (numBytes + entryBytes <= maxBytes)
+        {
+            entries.push_back({&key, data, size});
+            numBytes += entryBytes;
+        }
+    };
+    for (const auto& entry : pending)
+    {
+        keep(entry.first, entry.second.data(), entry.second.size());
+    }
+
+    size_t numExisting = 0;
+    if (existing)
+    {
+        std::vector<const std::pair<const std::string, _Mapping::Entry>*> candidates;
+        for (const auto& entry : existing->index)
+        {
+            if (pending.find(entry.first) == pending.end())
+            {
+                candidates.push_back(&entry);
+            }
+        }
+        numExisting = candidates.size();
+        std::sort(candidates.begin(), candidates.end(), [&used](const auto* a, const auto* b) {
+            const bool aUsed = used.count(a->first) > 0;
+            const bool bUsed = used.count(b->first) > 0;
+            return aUsed != bUsed ? aUsed : a->second.segment > b->second.segment;
+        });
+        for (const auto* entry : candidates)
+        {
+            keep(entry->first, existing->data.get() + entry->second.offset, entry->second.size);
+        }
+    }
+
+    TfMakeDirs(TfGetPathName(path), -1, /* existOk */ true);
+    TfAtomicOfstreamWrapper wrapper(path);
+    std::string reason;
+    if (!wrapper.Open(&reason))
+    {
+        LogWarning("Cannot write cook cache file " + path + ": " + reason);
+        return false;
+    }
+
+    std::ofstream& out = wrapper.GetStream();
+    WriteSegment(out, entries);
+    if (!out || !wrapper.Commit(&reason))
+    {
+        LogWarning("Cannot write cook cache file " + path + ": " + reason);
+        wrapper.Cancel();
+        return false;
+    }
+
+    const size_t numEvicted = numExisting + pending.size() - entries.size();
+    if (numEvicted > 0 && !g_isExiting)
+    {
+        FnLogInfo("Evicted " << numEvicted << " entries from cook cache file " << path);
+    }
+    return true;
+}
+
+std::shared_ptr<UsdKatanaCookCache::_File> UsdKatanaCookCache::_GetFile(
+    const std::string& directory,
+    const std::string& fileKey)
+{
+    const std::string path = TfStringCatPaths(directory, fileKey + ".ukcc");
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto it = _files.find(path);
+        if (it != _files.end())
+        {
+            return it->second;
+        }
+    }
+
+    // Map the file outside of the lock, another thread may map it too.
+    auto file = std::make_shared<_File>();
+    file->path = path;
+    file->mapping = _MapFile(path);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _files.emplace(path, file).first->second;
+}
+
+std::string UsdKatanaCookCache::_GetLayerHash(const SdfLayerHandle& layer)
+{
+    const std::string& identifier = layer->GetIdentifier();
+    {
+        std::lock_guard<std::mutex> lock(_layerHashesMutex);
+        const auto it = _layerHashes.find(identifier);
+        if (it != _layerHashes.end())
+        {
+            return it->second;
+        }
+    }
+
+    // Layer files are known by their size and modification time, rather
+    // than by their contents, which would have to be read. Anonymous layers,
+    // such as the session layer, have a different identifier in each process
+    // and are only known by their contents.
+    std::string layerHash;
+    if (!layer->IsAnonymous() && !layer->IsDirty())
+    {
+        const std::string& resolvedPath = layer->GetResolvedPath();
+        const ArTimestamp timestamp = ArGetResolver().GetModificationTimestamp(
+            identifier, ArResolvedPath(resolvedPath));
+        if (timestamp.IsValid())
+        {
+            layerHash = identifier + "@" + TfStringify(ArchGetFileLength(resolvedPath.c_str())) +
+                        "@" + TfStringify(timestamp.GetTime());
+        }
+    }
+    if (layerHash.empty())
+    {
+        std::string text;
+        layer->ExportToString(&text);
+        layerHash = "@" + TfStringify(std::hash<std::string>()(text));
+    }
+
+    std::lock_guard<std::mutex> lock(_layerHashesMutex);
+    return _layerHashes.emplace(identifier, layerHash).first->second;
+}
+
+std::string UsdKatanaCookCache::_ComputeEntryKey(const std::string& readerName,
+                                                 const UsdKatanaUsdInPrivateData& privateData)
+{
+    TRACE_FUNCTION();
+
+    const UsdPrim& prim = privateData.GetUsdPrim();
+    const UsdStageWeakPtr stage = prim.GetStage();
+
+    // The readers look at the prim and at what it inherits from its
+    // ancestors, such as primvars and material bindings, and at the stage
+    // metadata. Bindings through collections depend on prims anywhere in the
+    // stage, so all of its layers are hashed then.
+    std::set<SdfLayerHandle> layers = {stage->GetRootLayer(), stage->GetSessionLayer()};
+    if (HasCollectionBindings(prim))
+    {
+        for (const SdfLayerHandle& layer : stage->GetUsedLayers())
+        {
+            layers.insert(layer);
+        }
+    }
+    else
+    {
+        for (UsdPrim ancestor = prim; ancestor && !ancestor.IsPseudoRoot();
+             ancestor = ancestor.GetParent())
+        {
+            for (const SdfPrimSpecHandle& spec : ancestor.GetPrimStack())
+            {
+                layers.insert(spec->GetLayer());
+            }
+        }
+    }
+    layers.erase(SdfLayerHandle());
+    std::vector<std::string> layerHashes;
+    layerHashes.reserve(layers.size());
+    for (const SdfLayerHandle& layer : layers)
+    {
+        layerHashes.push_back(_GetLayerHash(layer));
+    }
+    std::sort(layerHashes.begin(), layerHashes.end());
+
+    std::string key = readerName + "|" + prim.GetPath().GetString() + "|" +
+                      FnAttribute::StringAttribute(layerHashes).getHash().str();
+
+    // Points moved along their velocities are extrapolated to the motion
+    // sample times, which depend on the shutter rather than on the layers.
+    const UsdGeomPointBased points(prim);
+    if (points && privateData.GetUsdInArgs()->GetVelocityBlur() &&
+        points.GetVelocitiesAttr().HasValue())
+    {
+        const std::vector<double> motionSampleTimes = privateData.GetMotionSampleTimes();
+        key += "|" + FnAttribute::DoubleAttribute(motionSampleTimes.data(),
+                                                  motionSampleTimes.size(), 1)
+                         .getHash()
+                         .str();
+        key += privateData.IsMotionBackward() ? "|backward" : "|forward";
+    }
+    return key;
+}
+
+std::string UsdKatanaCookCache::ComputeFileKey(UsdKatanaUsdInArgs& args)
+{
+    FnAttribute::GroupBuilder extraAttributesBuilder;
+    for (const auto& entry : args.GetExtraAttributesOrNamespaces())
+    {
+        extraAttributesBuilder.set(FnAttribute::DelimiterEncode(entry.first),
+                                   FnAttribute::StringAttribute(entry.second));
+    }
+
+    std::vector<std::string> materialBindingPurposes;
+    for (const TfToken& purpose : args.GetMaterialBindingPurposes())
+    {
+        materialBindingPurposes.push_back(purpose.GetString());
+    }
+
+    const std::set<std::string>& outputTargets = args.GetOutputTargets();
+
+    return FnAttribute::GroupBuilder()
+        .set("version", FnAttribute::IntAttribute(kVersion))
+        .set("rootLayer", FnAttribute::StringAttribute(args.GetFileName()))
+        .set("rootLocation", FnAttribute::StringAttribute(args.GetRootLocationPath()))
+        .set("isolatePath", FnAttribute::StringAttribute(args.GetIsolatePath()))
+        .set("sessionLocation", FnAttribute::StringAttribute(args.GetSessionLocationPath()))
+        .set("ignoreLayerRegex", FnAttribute::StringAttribute(args.GetIgnoreLayerRegex()))
+        .set("extraAttributesOrNamespaces", extraAttributesBuilder.build())
+        .set("materialBindingPurposes", FnAttribute::StringAttribute(materialBindingPurposes))
+        .set("outputTargets", FnAttribute::StringAttribute(std::vector<std::string>(
+                                  outputTargets.begin(), outputTargets.end())))
+        .set("evaluateUsdSkelBindings",
+             FnAttribute::IntAttribute(args.GetEvaluateUsdSkelBindings()))
+        .set("deferUsdSkelSkinning", FnAttribute::IntAttribute(args.GetDeferUsdSkelSkinning()))
+        .set("velocityBlur", FnAttribute::IntAttribute(args.GetVelocityBlur()))
+        .set("instanceMode", FnAttribute::StringAttribute(args.GetInstanceMode()))
+        .build()
+        .getHash()
+        .str();
+}
+
+void UsdKatanaCookCache::ReadCached(const FnAttribute::GroupAttribute& opArgs,
+                                    const std::string& readerName,
+                                    const UsdKatanaUsdInPrivateData& privateData,
+                                    UsdKatanaAttrMap& attrs,
+                                    const std::function<void(UsdKatanaAttrMap&)>& read)
+{
+    const std::string directory = GetDirectory(opArgs);
+    if (directory.empty() || privateData.GetUsdPrim().IsInPrototype() ||
+        !IsCacheable(privateData.GetUsdPrim(), privateData))
+    {
+        read(attrs);
+        return;
+    }
+
+    TRACE_FUNCTION();
+
+    const std::shared_ptr<_File> file =
+        _GetFile(directory, privateData.GetUsdInArgs()->GetCookCacheKey());
+    const std::string entryKey = _ComputeEntryKey(readerName, privateData);
+
+    FnAttribute::GroupAttribute cachedAttrs;
+    std::shared_ptr<const _Mapping> mapping;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto pendingIt = file->pending.find(entryKey);
+        if (pendingIt != file->pending.end())
+        {
+            cachedAttrs = FnAttribute::Attribute::parseBinary(pendingIt->second.data(),
+                                                              pendingIt->second.size());
+        }
+        mapping = file->mapping;
+    }
+    if (!cachedAttrs.isValid() && mapping)
+    {
+        cachedAttrs = mapping->Find(entryKey);
+        if (cachedAttrs.isValid())
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            file->used.insert(entryKey);
+        }
+    }
+
+    if (cachedAttrs.isValid())
+    {
+        ++_numHits;
+        UsdKatanaCookStats::RecordCacheLookup(true);
+        for (int64_t i = 0, e = cachedAttrs.getNumberOfChildren(); i != e; ++i)
+        {
+            attrs.set(cachedAttrs.getChildName(i), cachedAttrs.getChildByIndex(i));
+        }
+        return;
+    }
+
+    ++_numMisses;
+    UsdKatanaCookStats::RecordCacheLookup(false);
+    read(attrs);
+
+    const bool readOnly =
+        FnAttribute::IntAttribute(opArgs.getChildByName("cookCacheReadOnly")).getValue(0, false) ||
+        TfGetenvBool("USD_KATANA_COOK_CACHE_READ_ONLY", false);
+    if (readOnly)
+    {
+        return;
+    }
+
+    std::vector<char> buffer;
+    attrs.build().getBinary(&buffer);
+    bool flush = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const size_t numBytes = buffer.size();
+        if (file->pending.emplace(entryKey, std::move(buffer)).second)
+        {
+            _pendingBytes += numBytes;
+        }
+        flush = _pendingBytes > kMaxPendingBytes;
+    }
+    if (flush)
+    {
+        Flush();
+    }
+}
+
+size_t UsdKatanaCookCache::Flush()
+{
+    TRACE_FUNCTION();
+
+    std::lock_guard<std::mutex> flushLock(_flushMutex);
+
+    struct FileToWrite
+    {
+        std::shared_ptr<_File> file;
+        std::map<std::string, std::vector<char>> pending;
+        std::set<std::string> used;
+    };
+    std::vector<FileToWrite> filesToWrite;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& entry : _files)
+        {
+            if (!entry.second->pending.empty())
+            {
+                filesToWrite.push_back(
+                    {entry.second, std::move(entry.second->pending), entry.second->used});
+                entry.second->pending.clear();
+            }
+        }
+        _pendingBytes = 0;
+    }
+
+    size_t numWritten = 0;
+    for (const FileToWrite& fileToWrite : filesToWrite)
+    {
+        const std::shared_ptr<_File>& file = fileToWrite.file;
+
+        // Append to the file as it is now rather than as it was mapped, as
+        // another process may have written it since.
+        const std::shared_ptr<const _Mapping> existing = _MapFile(file->path);
+        if (_WriteFile(file->path, existing.get(), fileToWrite.pending, fileToWrite.used))
+        {
+            numWritten += fileToWrite.pending.size();
+        }
+
+        const std::shared_ptr<const _Mapping> mapping = _MapFile(file->path);
+        std::lock_guard<std::mutex> lock(_mutex);
+        file->mapping = mapping;
+    }
+    return numWritten;
+}
+
+void UsdKatanaCookCache::Clear()
+{
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _files.clear();
+    }
+    ClearLayerHashes();
+}
+
+void UsdKatanaCookCache::ClearLayerHashes()
+{
+    std::lock_guard<std::mutex> lock(_layerHashesMutex);
+    _layerHashes.clear();
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
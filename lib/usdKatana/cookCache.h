@@ -0,0 +1,167 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_COOKCACHE_H
+#define USDKATANA_COOKCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <pxr/base/tf/singleton.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/sdf/declareHandles.h>
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+SDF_DECLARE_HANDLES(SdfLayer);
+class UsdKatanaAttrMap;
+class UsdKatanaUsdInArgs;
+class UsdKatanaUsdInPrivateData;
+
+/// \brief A persistent cache of the attributes produced by the UsdIn readers,
+/// shared by the Katana processes reading the same USD assets.
+///
+/// The cache is a directory holding one file per UsdIn configuration: the root
+/// layer and the UsdIn arguments that affect the readers. Each entry of a file
+/// holds the attributes one reader produced for one prim, keyed by the path of
+/// the prim and a hash of the layers the prim and its ancestors are composed
+/// from, so that editing a layer only invalidates the prims using it. Layer
+/// files are hashed from their identifier, size and modification time, and
+/// anonymous layers from their contents. Prims bound to materials through collections, which may be
+/// authored anywhere, are keyed by all the layers of the stage instead.
+/// Points extrapolated along their velocities for motion blur are also keyed
+/// by the motion sample times.
+/// Entries are shared by all frames, so prims with time varying inputs and
+/// prims skinned by UsdSkel are not cached.
+///
+/// Files are memory mapped for reading. New entries are kept in memory until
+/// Flush() writes them, which happens when UsdIn is flushed, when they grow
+/// large and at exit. Flush() appends the entries the file does not hold yet
+/// as a new segment of the file, in a single write. Readers ignore a segment
+/// still being appended. Once a file would grow over
+/// USD_KATANA_COOK_CACHE_MAX_FILE_MB, it is compacted instead. The new
+/// entries, then the entries read by the process, then the most recently
+/// written ones are kept, up to three quarters of that size. They are written
+/// to a temporary file, which is then renamed, so concurrent writers only
+/// risk losing each other's new entries.
+class UsdKatanaCookCache : public TfSingleton<UsdKatanaCookCache>
+{
+    friend class TfSingleton<UsdKatanaCookCache>;
+
+    UsdKatanaCookCache();
+    ~UsdKatanaCookCache();
+
+public:
+    USDKATANA_API static UsdKatanaCookCache& GetInstance()
+    {
+        return TfSingleton<UsdKatanaCookCache>::GetInstance();
+    }
+
+    /// Returns the cache directory given by the "cookCacheDir" op arg or, if
+    /// not set, the USD_KATANA_COOK_CACHE_DIR environment variable. The cache
+    /// is disabled when empty.
+    USDKATANA_API static std::string GetDirectory(const FnAttribute::GroupAttribute& opArgs);
+
+    /// Fill \p attrs with the attributes \p read produces for the prim of
+    /// \p privateData, taken from the cache if it holds them. Otherwise
+    /// \p read is called and its result is added to the cache, unless the
+    /// "cookCacheReadOnly" op arg or the USD_KATANA_COOK_CACHE_READ_ONLY
+    /// environment variable is set. \p readerName identifies \p read in the
+    /// cache. Prims of instance prototypes are never cached, as the paths of
+    /// prototypes differ between processes, nor are prims whose attributes
+    /// may differ between frames.
+    USDKATANA_API void ReadCached(const FnAttribute::GroupAttribute& opArgs,
+                                  const std::string& readerName,
+                                  const UsdKatanaUsdInPrivateData& privateData,
+                                  UsdKatanaAttrMap& attrs,
+                                  const std::function<void(UsdKatanaAttrMap&)>& read);
+
+    /// Write the entries added since the last call to their files. Returns
+    /// the number of entries written.
+    USDKATANA_API size_t Flush();
+
+    /// Flush, then forget the mapped files and the hashes of the layers, so
+    /// that entries written by other processes and edits to the layers are
+    /// seen.
+    USDKATANA_API void Clear();
+
+    /// Forget the hashes of the layers only, so that entries are looked up
+    /// with the hashes of reloaded layers.
+    USDKATANA_API void ClearLayerHashes();
+
+    /// Returns the name of the cache file for \p args. This is a hash of the
+    /// root layer and of the arguments which affect the readers, but not of
+    /// the time, as only prims which do not vary over time are cached.
+    /// UsdKatanaUsdInArgs::GetCookCacheKey() computes it once per args.
+    USDKATANA_API static std::string ComputeFileKey(UsdKatanaUsdInArgs& args);
+
+    USDKATANA_API size_t GetNumHits() const { return _numHits; }
+    USDKATANA_API size_t GetNumMisses() const { return _numMisses; }
+
+private:
+    struct _Mapping;
+    struct _File;
+
+    static std::shared_ptr<const _Mapping> _MapFile(const std::string& path);
+    static bool _WriteFile(const std::string& path,
+                           const _Mapping* existing,
+                           const std::map<std::string, std::vector<char>>& pending,
+                           const std::set<std::string>& used);
+    static bool _CompactFile(const std::string& path,
+                             const _Mapping* existing,
+                             const std::map<std::string, std::vector<char>>& pending,
+                             const std::set<std::string>& used,
+                             uint64_t maxFileBytes);
+
+    std::shared_ptr<_File> _GetFile(const std::string& directory, const std::string& fileKey);
+    std::string _ComputeEntryKey(const std::string& readerName,
+                                 const UsdKatanaUsdInPrivateData& privateData);
+    std::string _GetLayerHash(const SdfLayerHandle& layer);
+
+    std::mutex _mutex;
+    std::map<std::string, std::shared_ptr<_File>> _files;
+    size_t _pendingBytes = 0;
+
+    // Only one Flush() writes files at a time.
+    std::mutex _flushMutex;
+
+    std::mutex _layerHashesMutex;
+    std::map<std::string, std::string> _layerHashes;
+
+    std::atomic<size_t> _numHits{0};
+    std::atomic<size_t> _numMisses{0};
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_COOKCACHE_H
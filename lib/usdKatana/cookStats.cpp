@@ -0,0 +1,210 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/cookStats.h"
+
+#include <mutex>
+#include <string>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace
+{
+thread_local UsdKatanaCookStats* g_currentStats = nullptr;
+
+// Serializes the merging of task statistics.
+std::mutex g_taskStatsMutex;
+
+// Counts are stored as doubles, as Katana has no 64-bit integer attribute
+// and attribute bytes can exceed the range of an int at the root.
+FnAttribute::DoubleAttribute CountAttr(uint64_t value)
+{
+    return FnAttribute::DoubleAttribute(static_cast<double>(value));
+}
+
+uint64_t GetCount(const FnAttribute::GroupAttribute& attr, const std::string& name)
+{
+    return static_cast<uint64_t>(
+        FnAttribute::DoubleAttribute(attr.getChildByName(name)).getValue(0.0, false));
+}
+
+}  // namespace
+
+void UsdKatanaCookStats::Add(const UsdKatanaCookStats& other)
+{
+    cookSeconds += other.cookSeconds;
+    attributeBytes += other.attributeBytes;
+    attributeCount += other.attributeCount;
+    motionSamples += other.motionSamples;
+    payloadLoads += other.payloadLoads;
+    cacheHits += other.cacheHits;
+    cacheMisses += other.cacheMisses;
+}
+
+FnAttribute::GroupAttribute UsdKatanaCookStats::BuildAttr() const
+{
+    return FnAttribute::GroupBuilder()
+        .set("cookSeconds", FnAttribute::DoubleAttribute(cookSeconds))
+        .set("attributeBytes", CountAttr(attributeBytes))
+        .set("attributeCount", CountAttr(attributeCount))
+        .set("motionSamples", CountAttr(motionSamples))
+        .set("payloadLoads", CountAttr(payloadLoads))
+        .set("cacheHits", CountAttr(cacheHits))
+        .set("cacheMisses", CountAttr(cacheMisses))
+        .build();
+}
+
+UsdKatanaCookStats UsdKatanaCookStats::FromAttr(const FnAttribute::GroupAttribute& attr)
+{
+    UsdKatanaCookStats stats;
+    if (!attr.isValid())
+    {
+        return stats;
+    }
+    stats.cookSeconds =
+        FnAttribute::DoubleAttribute(attr.getChildByName("cookSeconds")).getValue(0.0, false);
+    stats.attributeBytes = GetCount(attr, "attributeBytes");
+    stats.attributeCount = GetCount(attr, "attributeCount");
+    stats.motionSamples = GetCount(attr, "motionSamples");
+    stats.payloadLoads = GetCount(attr, "payloadLoads");
+    stats.cacheHits = GetCount(attr, "cacheHits");
+    stats.cacheMisses = GetCount(attr, "cacheMisses");
+    return stats;
+}
+
+uint64_t UsdKatanaCookStats::MeasureAttribute(const FnAttribute::Attribute& attr,
+                                              uint64_t* numAttributes)
+{
+    FnAttribute::GroupAttribute group = attr;
+    if (group.isValid())
+    {
+        uint64_t bytes = 0;
+        for (int64_t i = 0; i < group.getNumberOfChildren(); ++i)
+        {
+            bytes += MeasureAttribute(group.getChildByIndex(i), numAttributes);
+        }
+        return bytes;
+    }
+
+    FnAttribute::DataAttribute data = attr;
+    if (!data.isValid())
+    {
+        return 0;
+    }
+    if (numAttributes)
+    {
+        ++(*numAttributes);
+    }
+
+    const uint64_t numValues =
+        static_cast<uint64_t>(data.getNumberOfValues()) * data.getNumberOfTimeSamples();
+    switch (data.getType())
+    {
+    case kFnKatAttributeTypeInt:
+        return numValues * sizeof(int32_t);
+    case kFnKatAttributeTypeFloat:
+        return numValues * sizeof(float);
+    case kFnKatAttributeTypeDouble:
+        return numValues * sizeof(double);
+    case kFnKatAttributeTypeString:
+    {
+        uint64_t bytes = 0;
+        FnAttribute::StringAttribute strings = attr;
+        for (int64_t t = 0; t < strings.getNumberOfTimeSamples(); ++t)
+        {
+            for (const std::string& value : strings.getNearestSample(strings.getSampleTime(t)))
+            {
+                bytes += value.size();
+            }
+        }
+        return bytes;
+    }
+    default:
+        return 0;
+    }
+}
+
+UsdKatanaCookStats* UsdKatanaCookStats::GetCurrent()
+{
+    return g_currentStats;
+}
+
+void UsdKatanaCookStats::RecordAttribute(const FnAttribute::Attribute& attr)
+{
+    if (UsdKatanaCookStats* stats = g_currentStats)
+    {
+        stats->attributeBytes += MeasureAttribute(attr, &stats->attributeCount);
+    }
+}
+
+void UsdKatanaCookStats::RecordMotionSamples(size_t numSamples)
+{
+    if (UsdKatanaCookStats* stats = g_currentStats)
+    {
+        stats->motionSamples += numSamples;
+    }
+}
+
+void UsdKatanaCookStats::RecordPayloadLoad()
+{
+    if (UsdKatanaCookStats* stats = g_currentStats)
+    {
+        ++stats->payloadLoads;
+    }
+}
+
+void UsdKatanaCookStats::RecordCacheLookup(bool hit)
+{
+    if (UsdKatanaCookStats* stats = g_currentStats)
+    {
+        ++(hit ? stats->cacheHits : stats->cacheMisses);
+    }
+}
+
+UsdKatanaCookStatsScope::UsdKatanaCookStatsScope(UsdKatanaCookStats* stats)
+    : _previous(g_currentStats)
+{
+    g_currentStats = stats;
+}
+
+UsdKatanaCookStatsScope::~UsdKatanaCookStatsScope()
+{
+    g_currentStats = _previous;
+}
+
+UsdKatanaCookStatsTaskScope::UsdKatanaCookStatsTaskScope(UsdKatanaCookStats* stats)
+    : _stats(stats), _previous(g_currentStats)
+{
+    g_currentStats = _stats ? &_local : nullptr;
+}
+
+UsdKatanaCookStatsTaskScope::~UsdKatanaCookStatsTaskScope()
+{
+    g_currentStats = _previous;
+    if (_stats)
+    {
+        std::lock_guard<std::mutex> lock(g_taskStatsMutex);
+        _stats->Add(_local);
+    }
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,122 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_COOKSTATS_H
+#define USDKATANA_COOKSTATS_H
+
+#include <cstdint>
+
+#include <pxr/pxr.h>
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// Statistics gathered while cooking a single location, or rolled up over
+/// a subtree of locations.
+///
+/// Recording is opt-in: the Record* functions only count while a
+/// UsdKatanaCookStatsScope is active on the calling thread, so that readers
+/// and caches can report what they do without paying for it otherwise.
+struct UsdKatanaCookStats
+{
+    double cookSeconds = 0.0;
+    uint64_t attributeBytes = 0;
+    uint64_t attributeCount = 0;
+    uint64_t motionSamples = 0;
+    uint64_t payloadLoads = 0;
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+
+    /// Accumulate the values of \p other into these statistics.
+    USDKATANA_API void Add(const UsdKatanaCookStats& other);
+
+    /// Build the attribute written to "usdIn.stats".
+    USDKATANA_API FnAttribute::GroupAttribute BuildAttr() const;
+
+    /// Read back statistics built by BuildAttr(). Missing values are zero.
+    USDKATANA_API static UsdKatanaCookStats FromAttr(const FnAttribute::GroupAttribute& attr);
+
+    /// Returns the approximate size in bytes of the values held by \p attr,
+    /// and adds the number of data attributes it contains to
+    /// \p numAttributes.
+    USDKATANA_API static uint64_t MeasureAttribute(const FnAttribute::Attribute& attr,
+                                                   uint64_t* numAttributes);
+
+    /// Returns the statistics being recorded on this thread, or nullptr if
+    /// no UsdKatanaCookStatsScope is active.
+    USDKATANA_API static UsdKatanaCookStats* GetCurrent();
+
+    /// Record an attribute emitted to the output of the location.
+    USDKATANA_API static void RecordAttribute(const FnAttribute::Attribute& attr);
+
+    /// Record motion samples read for an attribute.
+    USDKATANA_API static void RecordMotionSamples(size_t numSamples);
+
+    /// Record a payload loaded on behalf of the location.
+    USDKATANA_API static void RecordPayloadLoad();
+
+    /// Record a lookup into one of the shared caches.
+    USDKATANA_API static void RecordCacheLookup(bool hit);
+};
+
+/// Makes \p stats the statistics recorded on this thread for the lifetime of
+/// the scope. Scopes nest; the previous statistics are restored when the
+/// scope ends.
+class UsdKatanaCookStatsScope
+{
+public:
+    USDKATANA_API explicit UsdKatanaCookStatsScope(UsdKatanaCookStats* stats);
+    USDKATANA_API ~UsdKatanaCookStatsScope();
+
+    UsdKatanaCookStatsScope(const UsdKatanaCookStatsScope&) = delete;
+    UsdKatanaCookStatsScope& operator=(const UsdKatanaCookStatsScope&) = delete;
+
+private:
+    UsdKatanaCookStats* _previous;
+};
+
+/// Records the statistics of a task run on a worker thread into \p stats,
+/// which is captured with UsdKatanaCookStats::GetCurrent() on the thread
+/// dispatching the task, as the scope of that thread is not visible to the
+/// workers. Statistics are gathered locally and added to \p stats when the
+/// scope ends, so concurrent tasks may share the same \p stats.
+class UsdKatanaCookStatsTaskScope
+{
+public:
+    USDKATANA_API explicit UsdKatanaCookStatsTaskScope(UsdKatanaCookStats* stats);
+    USDKATANA_API ~UsdKatanaCookStatsTaskScope();
+
+    UsdKatanaCookStatsTaskScope(const UsdKatanaCookStatsTaskScope&) = delete;
+    UsdKatanaCookStatsTaskScope& operator=(const UsdKatanaCookStatsTaskScope&) = delete;
+
+private:
+    UsdKatanaCookStats _local;
+    UsdKatanaCookStats* _stats;
+    UsdKatanaCookStats* _previous;
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_COOKSTATS_H
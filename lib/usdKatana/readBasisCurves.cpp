@@ -30,6 +30,7 @@
 #include "usdKatana/readBasisCurves.h"
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usdGeom/basisCurves.h>
 
 #include <FnAPI/FnAPI.h>
@@ -123,6 +124,8 @@ void UsdKatanaReadBasisCurves(const UsdGeomBasisCurves& basisCurves,
                               const UsdKatanaUsdInPrivateData& data,
                               UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     const bool prmanOutputTarget = data.hasOutputTarget("prman");
     //
     // Set all general attributes for a gprim type.
@@ -212,7 +215,12 @@ void UsdKatanaReadBasisCurves(const UsdGeomBasisCurves& basisCurves,
     _SetCurveAttrs(attrs, basisCurves, data.GetCurrentTime());
     
     // position
-    attrs.set("geometry.point.P", UsdKatanaGeomGetPAttr(basisCurves, data));
+    FnKat::GroupAttribute skinningAttr;
+    attrs.set("geometry.point.P", UsdKatanaGeomGetPAttr(basisCurves, data, &skinningAttr));
+    if (skinningAttr.isValid())
+    {
+        attrs.set("geometry.skinning", skinningAttr);
+    }
 
     // normals
     FnKat::Attribute normalsAttr = UsdKatanaGeomGetNormalAttr(basisCurves, data);
@@ -30,6 +30,7 @@
 #include "usdKatana/readBlindData.h"
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 
 #include <FnLogging/FnLogging.h>
 
@@ -45,6 +46,8 @@ FnLogSetup("UsdKatanaReadBlindData");
 
 void UsdKatanaReadBlindData(const UsdKatanaBlindDataObject& kbd, UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     std::vector<UsdProperty> blindProps = kbd.GetKbdAttributes();
     TF_FOR_ALL(blindPropIter, blindProps) {
         UsdProperty blindProp = *blindPropIter;
@@ -31,6 +31,7 @@
 
 #include <pxr/base/gf/camera.h>
 #include <pxr/base/gf/range2f.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/imaging/cameraUtil/screenWindowParameters.h>
 #include <pxr/pxr.h>
 #include <pxr/usd/usdGeom/camera.h>
@@ -51,6 +52,8 @@ void UsdKatanaReadCamera(const UsdGeomCamera& camera,
                          const UsdKatanaUsdInPrivateData& data,
                          UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     const double currentTime = data.GetCurrentTime();
     const bool prmanOutputTarget = data.hasOutputTarget("prman");
 
@@ -31,6 +31,7 @@
 
 #include <vector>
 
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usd/attribute.h>
 #include <pxr/usd/usd/property.h>
 #include <pxr/usd/usdGeom/constraintTarget.h>
@@ -136,6 +137,8 @@ void UsdKatanaReadConstraintTarget(const UsdGeomConstraintTarget& constraintTarg
                                    const UsdKatanaUsdInPrivateData& data,
                                    UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     //
     // Give constraint target locations a generic 'locator' type.
     //
@@ -34,6 +34,7 @@
 #include "usdKatana/usdInPrivateData.h"
 #include "usdKatana/utils.h"
 
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/usd/usdGeom/subset.h>
 #include <pxr/usd/usdShade/material.h>
@@ -48,6 +49,8 @@ void UsdKatanaReadGeomSubset(const UsdGeomSubset& geomSubset,
                              const UsdKatanaUsdInPrivateData& data,
                              UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     UsdKatanaReadPrim(geomSubset.GetPrim(), data, attrs);
 
     // We only import facesets.
@@ -27,10 +27,13 @@
 // KIND, either express or implied. See the Apache License for the specific
 // language governing permissions and limitations under the Apache License.
 //
+#include <map>
 #include <vector>
 
 #include <pxr/base/gf/gamma.h>
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/usd/usd/timeCode.h>
 #include <pxr/usd/usdGeom/curves.h>
 #include <pxr/usd/usdGeom/gprim.h>
 #include <pxr/usd/usdGeom/pointBased.h>
@@ -40,6 +43,7 @@
 #include "usdKatana/attrMap.h"
 #include "usdKatana/readGprim.h"
 #include "usdKatana/readXformable.h"
+#include "usdKatana/staticAttrCache.h"
 #include "usdKatana/usdInPrivateData.h"
 #include "usdKatana/utils.h"
 
@@ -57,6 +61,8 @@ void UsdKatanaReadGprim(const UsdGeomGprim& gprim,
                         const UsdKatanaUsdInPrivateData& data,
                         UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     UsdKatanaReadXformable(gprim, data, attrs);
 }
 
@@ -121,7 +127,8 @@ namespace {
 template <typename T_USD, typename T_ATTR>
 FnKat::Attribute _ConvertGeomAttr(const UsdAttribute& usdAttr,
                                   const int tupleSize,
-                                  const UsdKatanaUsdInPrivateData& data)
+                                  const UsdKatanaUsdInPrivateData& data,
+                                  const bool currentTimeOnly)
 {
     if (!usdAttr.HasValue())
     {
@@ -129,7 +136,8 @@ FnKat::Attribute _ConvertGeomAttr(const UsdAttribute& usdAttr,
     }
 
     const double currentTime = data.GetCurrentTime();
-    const std::vector<double>& motionSampleTimes = data.GetMotionSampleTimes(usdAttr);
+    const std::vector<double> motionSampleTimes =
+        currentTimeOnly ? std::vector<double>{0.0} : data.GetMotionSampleTimes(usdAttr);
 
     // Flag to check if we discovered the topology is varying, in
     // which case we only output the sample at the curent frame.
@@ -163,6 +171,8 @@ FnKat::Attribute _ConvertGeomAttr(const UsdAttribute& usdAttr,
         usdAttr.Get(&attrArray, currentTime);
         return VtKatanaMapOrCopy<T_USD>(attrArray);
     } else {
+        // Samples baked on every frame are often identical.
+        UsdKatanaUtils::CollapseIdenticalSamples(&timeToSampleMap);
         return VtKatanaMapOrCopy<T_USD>(timeToSampleMap);
     }
 }
@@ -172,7 +182,8 @@ FnKat::Attribute _ConvertGeomAttr(const UsdAttribute& usdAttr,
 template <typename T_USD, typename T_ATTR>
 FnKat::Attribute _ConvertGeomAttr(const UsdAttribute& usdAttr,
                                   const int tupleSize,
-                                  const UsdKatanaUsdInPrivateData& data)
+                                  const UsdKatanaUsdInPrivateData& data,
+                                  const bool currentTimeOnly)
 {
     if (!usdAttr.HasValue())
     {
@@ -180,7 +191,8 @@ FnKat::Attribute _ConvertGeomAttr(const UsdAttribute& usdAttr,
     }
 
     const double currentTime = data.GetCurrentTime();
-    const std::vector<double>& motionSampleTimes = data.GetMotionSampleTimes(usdAttr);
+    const std::vector<double> motionSampleTimes =
+        currentTimeOnly ? std::vector<double>{0.0} : data.GetMotionSampleTimes(usdAttr);
 
     // Flag to check if we discovered the topology is varying, in
     // which case we only output the sample at the curent frame.
@@ -233,45 +245,139 @@ FnKat::Attribute _ConvertGeomAttr(const UsdAttribute& usdAttr,
 
 #endif // KATANA_VERSION_MAJOR >= 3
 
+// Static points, normals, velocities and accelerations are converted once for
+// every frame when UsdKatanaUsdInArgs::GetShareStaticData() is set.
+FnKat::Attribute _ConvertVec3fGeomAttr(const UsdAttribute& usdAttr,
+                                       const UsdKatanaUsdInPrivateData& data,
+                                       const bool currentTimeOnly = false)
+{
+    return UsdKatanaStaticAttrCache::GetInstance().GetOrConvert(
+        data, {usdAttr}, "vec3fGeomAttr", [&]() {
+            return _ConvertGeomAttr<GfVec3f, FnKat::FloatAttribute>(usdAttr, 3, data,
+                                                                    currentTimeOnly);
+        });
+}
+
+// Whether the motion of \p points is given by their velocities rather than
+// by the samples of their points, see UsdKatanaUsdInArgs::GetVelocityBlur().
+bool _UseVelocityBlur(const UsdGeomPointBased& points, const UsdKatanaUsdInPrivateData& data)
+{
+    return data.GetUsdInArgs()->GetVelocityBlur() && points.GetVelocitiesAttr().HasValue();
+}
+
+// Reads the points of \p points at the current time only and moves them to
+// each motion sample time along their velocities and accelerations. Returns
+// an invalid attribute if USD cannot extrapolate them, e.g. if the number of
+// velocities does not match the number of points.
+FnKat::Attribute _ExtrapolatePAttr(const UsdGeomPointBased& points,
+                                   const UsdKatanaUsdInPrivateData& data)
+{
+    TRACE_FUNCTION();
+
+    const double currentTime = data.GetCurrentTime();
+    // Velocities give motion even to points with a single sample.
+    const std::vector<double> motionSampleTimes = data.GetMotionSampleTimes();
+    std::vector<UsdTimeCode> sampleTimes;
+    sampleTimes.reserve(motionSampleTimes.size());
+    for (double relSampleTime : motionSampleTimes)
+    {
+        sampleTimes.emplace_back(currentTime + relSampleTime);
+    }
+
+    std::vector<VtVec3fArray> pointsSamples;
+    if (!points.ComputePointsAtTimes(&pointsSamples, sampleTimes, UsdTimeCode(currentTime)) ||
+        pointsSamples.size() != motionSampleTimes.size())
+    {
+        return FnKat::Attribute();
+    }
+
+    const bool isMotionBackward = data.IsMotionBackward();
+#if KATANA_VERSION_MAJOR >= 3
+    std::map<float, VtVec3fArray> timeToSampleMap;
+    for (size_t i = 0; i < motionSampleTimes.size(); ++i)
+    {
+        const double relSampleTime = motionSampleTimes[i];
+        timeToSampleMap.insert(
+            {isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime) : relSampleTime,
+             pointsSamples[i]});
+    }
+    UsdKatanaUtils::CollapseIdenticalSamples(&timeToSampleMap);
+    return VtKatanaMapOrCopy<GfVec3f>(timeToSampleMap);
+#else
+    FnKat::FloatBuilder attrBuilder(3);
+    for (size_t i = 0; i < motionSampleTimes.size(); ++i)
+    {
+        const double relSampleTime = motionSampleTimes[i];
+        std::vector<float>& attrVec = attrBuilder.get(
+            isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime) : relSampleTime);
+        UsdKatanaUtils::ConvertArrayToVector(pointsSamples[i], &attrVec);
+    }
+    return attrBuilder.build();
+#endif  // KATANA_VERSION_MAJOR >= 3
+}
+
 } // anon namespace
 
 FnKat::Attribute UsdKatanaGeomGetPAttr(const UsdGeomPointBased& points,
                                        const UsdKatanaUsdInPrivateData& data)
+{
+    return UsdKatanaGeomGetPAttr(points, data, nullptr);
+}
+
+FnKat::Attribute UsdKatanaGeomGetPAttr(const UsdGeomPointBased& points,
+                                       const UsdKatanaUsdInPrivateData& data,
+                                       FnKat::GroupAttribute* skinningAttr)
 {
     FnKat::Attribute skinnedPointsAttr;
     if (data.GetEvaluateUsdSkelBindings())
     {
-        skinnedPointsAttr = UsdKatanaUtils::ApplySkinningToPoints(points, data);
+        if (skinningAttr && data.GetDeferUsdSkelSkinning())
+        {
+            *skinningAttr =
+                UsdKatanaUtils::BuildDeferredSkinningAttr(points, data, &skinnedPointsAttr);
+        }
+        if (!skinningAttr || !skinningAttr->isValid())
+        {
+            skinnedPointsAttr = UsdKatanaUtils::ApplySkinningToPoints(points, data);
+        }
     }
 
     if (skinnedPointsAttr.isValid())
     {
         return skinnedPointsAttr;
     }
-    return _ConvertGeomAttr<GfVec3f, FnKat::FloatAttribute>(
-        points.GetPointsAttr(), 3, data);
+    if (_UseVelocityBlur(points, data))
+    {
+        const FnKat::Attribute extrapolatedPointsAttr = _ExtrapolatePAttr(points, data);
+        if (extrapolatedPointsAttr.isValid())
+        {
+            return extrapolatedPointsAttr;
+        }
+        // The points cannot be extrapolated, so their samples would not
+        // match the velocities read at the current time only.
+        return _ConvertVec3fGeomAttr(points.GetPointsAttr(), data, true);
+    }
+    return _ConvertVec3fGeomAttr(points.GetPointsAttr(), data);
 }
 
 Foundry::Katana::Attribute UsdKatanaGeomGetNormalAttr(const UsdGeomPointBased& points,
                                                       const UsdKatanaUsdInPrivateData& data)
 {
-    return _ConvertGeomAttr<GfVec3f, FnKat::FloatAttribute>(
-            points.GetNormalsAttr(), 3, data);
+    return _ConvertVec3fGeomAttr(points.GetNormalsAttr(), data, _UseVelocityBlur(points, data));
 }
 
 Foundry::Katana::Attribute UsdKatanaGeomGetVelocityAttr(const UsdGeomPointBased& points,
                                                         const UsdKatanaUsdInPrivateData& data)
 {
-    return _ConvertGeomAttr<GfVec3f, FnKat::FloatAttribute>(
-            points.GetVelocitiesAttr(), 3, data);
-
+    return _ConvertVec3fGeomAttr(points.GetVelocitiesAttr(), data,
+                                 _UseVelocityBlur(points, data));
 }
 
 Foundry::Katana::Attribute UsdKatanaGeomGetAccelerationAttr(const UsdGeomPointBased& points,
                                                             const UsdKatanaUsdInPrivateData& data)
 {
-    return _ConvertGeomAttr<GfVec3f, FnKat::FloatAttribute>(
-            points.GetAccelerationsAttr(), 3, data);
+    return _ConvertVec3fGeomAttr(points.GetAccelerationsAttr(), data,
+                                 _UseVelocityBlur(points, data));
 }
 
 PXR_NAMESPACE_CLOSE_SCOPE
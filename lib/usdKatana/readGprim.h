@@ -51,6 +51,14 @@ Foundry::Katana::Attribute UsdKatanaGeomGetDisplayColorAttr(const UsdGeomGprim&
 Foundry::Katana::Attribute UsdKatanaGeomGetPAttr(const UsdGeomPointBased& points,
                                                  const UsdKatanaUsdInPrivateData& data);
 
+/// Variant of UsdKatanaGeomGetPAttr for readers that support deferred UsdSkel
+/// skinning. When deferred skinning is enabled and the prim is bound to a
+/// skeleton with linear blend skinning, \p skinningAttr is set to the group
+/// to author at "geometry.skinning" and the rest points are returned.
+Foundry::Katana::Attribute UsdKatanaGeomGetPAttr(const UsdGeomPointBased& points,
+                                                 const UsdKatanaUsdInPrivateData& data,
+                                                 Foundry::Katana::GroupAttribute* skinningAttr);
+
 Foundry::Katana::Attribute UsdKatanaGeomGetWindingOrderAttr(const UsdGeomGprim& gprim,
                                                             const UsdKatanaUsdInPrivateData& data);
 
@@ -36,6 +36,7 @@
 
 #include <pxr/base/tf/stringUtils.h>
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/ndr/declare.h>
 #include <pxr/usd/sdr/registry.h>
 #include <pxr/usd/sdr/shaderProperty.h>
@@ -245,6 +246,8 @@ void UsdKatanaReadLight(const UsdPrim& prim,
                         const UsdKatanaUsdInPrivateData& data,
                         UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     const UsdTimeCode currentTimeCode = data.GetCurrentTime();
     attrs.SetUSDTimeCode(currentTimeCode);
     UsdKatanaAttrMap geomBuilder;
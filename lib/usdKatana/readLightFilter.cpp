@@ -35,6 +35,7 @@
 
 #include <pxr/base/tf/stringUtils.h>
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/sdr/registry.h>
 #include <pxr/usd/usd/schemaRegistry.h>
 #include <pxr/usd/usd/tokens.h>
@@ -112,6 +113,8 @@ void UsdKatanaReadLightFilter(const UsdPrim& filterPrim,
                               const UsdKatanaUsdInPrivateData& data,
                               UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     const SdfPath primPath = filterPrim.GetPath();
     const double currentTime = data.GetCurrentTime();
 
@@ -45,6 +45,7 @@
 #include <FnRendererInfo/FnRendererInfoPluginClient.h>
 
 #include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/sdf/layerUtils.h>
 
 #include <pxr/usd/usdGeom/scope.h>
@@ -113,6 +114,8 @@ void UsdKatanaReadMaterial(const UsdShadeMaterial& material,
                            const std::string& looksGroupLocation,
                            const std::string& materialDestinationLocation)
 {
+    TRACE_FUNCTION();
+
     UsdPrim prim = material.GetPrim();
     UsdStageRefPtr stage = prim.GetStage();
     SdfPath primPath = prim.GetPath();
@@ -823,6 +826,8 @@ std::string _CreateShadingNode(UsdPrim shadingNode,
                                const ShadingNodeTraversalData& traversalData,
                                bool flatten)
 {
+    TRACE_FUNCTION();
+
     std::string handle = UsdKatanaUtils::GenerateShadingNodeHandle(shadingNode);
     if (handle.empty()) {
         return "";
@@ -1064,6 +1069,8 @@ FnKat::Attribute _GetMaterialAttr(const UsdShadeMaterial& materialSchema,
                                   const bool prmanOutputTarget,
                                   bool flatten)
 {
+    TRACE_FUNCTION();
+
     flatten |= !UsdKatana_IsPrimDefFromSiblingBaseMaterial(materialSchema.GetPrim());
     UsdPrim materialPrim = materialSchema.GetPrim();
 
@@ -1365,6 +1372,8 @@ void _UnrollInterfaceFromPrim(const UsdPrim& prim,
                               FnKat::GroupBuilder& layoutBuilder,
                               FnKat::GroupBuilder& interfaceBuilder)
 {
+    TRACE_FUNCTION();
+
     UsdStageRefPtr stage = prim.GetStage();
 
     // TODO: Right now, the exporter doesn't always move thing into
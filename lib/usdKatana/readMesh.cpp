@@ -30,6 +30,7 @@
 #include "usdKatana/readMesh.h"
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/usd/usdGeom/xform.h>
 #include <pxr/usd/usdRi/rmanUtilities.h>
@@ -39,6 +40,7 @@
 #include "usdKatana/attrMap.h"
 #include "usdKatana/debugCodes.h"
 #include "usdKatana/readGprim.h"
+#include "usdKatana/staticAttrCache.h"
 #include "usdKatana/usdInPrivateData.h"
 #include "usdKatana/utils.h"
 
@@ -219,6 +221,8 @@ void UsdKatanaReadMesh(const UsdGeomMesh& mesh,
                        const UsdKatanaUsdInPrivateData& data,
                        UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     const double currentTime = data.GetCurrentTime();
 
     //
@@ -248,7 +252,12 @@ void UsdKatanaReadMesh(const UsdGeomMesh& mesh,
     //
 
     // position
-    attrs.set("geometry.point.P", UsdKatanaGeomGetPAttr(mesh, data));
+    FnKat::GroupAttribute skinningAttr;
+    attrs.set("geometry.point.P", UsdKatanaGeomGetPAttr(mesh, data, &skinningAttr));
+    if (skinningAttr.isValid())
+    {
+        attrs.set("geometry.skinning", skinningAttr);
+    }
 
     /// Only use custom normals if the object is a polymesh.
     if (!isSubd){
@@ -282,7 +291,11 @@ void UsdKatanaReadMesh(const UsdGeomMesh& mesh,
         attrs.set("geometry.point.accel", accelAttr);
     }
 
-    FnKat::GroupAttribute polyAttr = _GetPolyAttr(mesh, currentTime);
+    // Static topology is converted once for every frame when
+    // UsdKatanaUsdInArgs::GetShareStaticData() is set.
+    FnKat::GroupAttribute polyAttr = UsdKatanaStaticAttrCache::GetInstance().GetOrConvert(
+        data, {mesh.GetFaceVertexIndicesAttr(), mesh.GetFaceVertexCountsAttr()}, "poly",
+        [&]() { return _GetPolyAttr(mesh, currentTime); });
     
     attrs.set("geometry.poly", polyAttr);
 
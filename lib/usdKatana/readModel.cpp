@@ -30,6 +30,7 @@
 #include "usdKatana/readModel.h"
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usd/modelAPI.h>
 #include <pxr/usd/usd/variantSets.h>
 #include <pxr/usd/usdGeom/xform.h>
@@ -98,6 +99,8 @@ void UsdKatanaReadModel(const UsdPrim& prim,
                         const UsdKatanaUsdInPrivateData& data,
                         UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     attrs.set("modelName", FnKat::StringAttribute(UsdKatanaUtils::GetAssetName(prim)));
 
     //
@@ -30,6 +30,7 @@
 #include "usdKatana/readNurbsPatch.h"
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usdGeom/nurbsPatch.h>
 
 #include <FnLogging/FnLogging.h>
@@ -312,6 +313,8 @@ void UsdKatanaReadNurbsPatch(const UsdGeomNurbsPatch& nurbsPatch,
                              const UsdKatanaUsdInPrivateData& data,
                              UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     const double currentTime = data.GetCurrentTime();
     const std::vector<double>& motionSampleTimes = 
         data.GetMotionSampleTimes(UsdGeomPointBased(nurbsPatch).GetPointsAttr());
@@ -23,6 +23,7 @@
 #include "usdKatana/readOpenVDBAsset.h"
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usdVol/openVDBAsset.h>
 
 #include <FnLogging/FnLogging.h>
@@ -40,6 +41,8 @@ void UsdKatanaReadOpenVDBAsset(const UsdVolOpenVDBAsset& field,
                                const UsdKatanaUsdInPrivateData& data,
                                UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     UsdKatanaReadXformable(field, data, attrs);
     attrs.set("type", FnKat::StringAttribute("openvdbasset"));
     attrs.set("tabs.scenegraph.stopExpand", FnKat::IntAttribute(1));
@@ -29,13 +29,29 @@
 //
 #include "usdKatana/readPointInstancer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+
+#include <pxr/base/gf/camera.h>
+#include <pxr/base/gf/frustum.h>
 #include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/quatd.h>
+#include <pxr/base/gf/range2d.h>
+#include <pxr/base/gf/rotation.h>
 #include <pxr/base/gf/transform.h>
 #include <pxr/base/tf/envSetting.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/base/work/sort.h>
+#include <pxr/base/work/threadLimits.h>
 #include <pxr/usd/kind/registry.h>
 #include <pxr/usd/usd/modelAPI.h>
+#include <pxr/usd/usdGeom/camera.h>
 #include <pxr/usd/usdGeom/pointInstancer.h>
 #include <pxr/usd/usdGeom/xform.h>
+#include <pxr/usd/usdGeom/xformable.h>
 #include <pxr/usd/usdShade/material.h>
 
 #include <FnAPI/FnAPI.h>
@@ -48,6 +64,7 @@
 #include <pystring/pystring.h>
 
 #include "usdKatana/attrMap.h"
+#include "usdKatana/cookStats.h"
 #include "usdKatana/readXformable.h"
 #include "usdKatana/usdInPrivateData.h"
 #include "usdKatana/utils.h"
@@ -73,6 +90,21 @@ namespace
     typedef std::map<TfToken, GfRange3d, TfTokenFastArbitraryLessThan>
         _PurposeToRangeMap;
 
+    // WorkParallelForN, recording the cook statistics of the workers into
+    // those of the calling thread.
+    template <typename Fn>
+    void _ParallelForN(size_t n, Fn&& fn, size_t grainSize = 1)
+    {
+        UsdKatanaCookStats* stats = UsdKatanaCookStats::GetCurrent();
+        WorkParallelForN(
+            n,
+            [&fn, stats](size_t begin, size_t end) {
+                UsdKatanaCookStatsTaskScope statsScope(stats);
+                fn(begin, end);
+            },
+            grainSize);
+    }
+
     // Log an error and set attrs to show an error message in the Scene Graph.
     //
     void _LogAndSetError(UsdKatanaAttrMap& attrs, const std::string& message)
@@ -90,53 +122,511 @@ namespace
                   FnKat::StringAttribute("[WARNING UsdKatanaReadPointInstancer]: " + message));
     }
 
+    // Returns the distinct values of \p protoIndices in order of first use.
+    //
+    std::vector<int> _GetUsedProtoIndices(const VtIntArray& protoIndices, size_t numProtos)
+    {
+        std::vector<int> usedProtoIndices;
+        std::vector<bool> isUsed(numProtos, false);
+        for (size_t i = 0; i < protoIndices.size() && usedProtoIndices.size() < numProtos; ++i)
+        {
+            const int protoIndex = protoIndices[i];
+            if (!isUsed[protoIndex])
+            {
+                isUsed[protoIndex] = true;
+                usedProtoIndices.push_back(protoIndex);
+            }
+        }
+        return usedProtoIndices;
+    }
+
+    // Smallest number of instances handed to a single task.
+    const size_t _kMinInstanceGrain = 16384;
+
+    // The inputs of the transforms of the instances at one motion sample
+    // time. Positions and orientations with matching velocities are read at
+    // their time sample at or before the current time and moved along their
+    // velocities by a time delta, in seconds.
+    //
+    struct _InstanceXformSample
+    {
+        VtVec3fArray positions;
+        VtVec3fArray velocities;
+        VtVec3fArray accelerations;
+        float positionsTimeDelta = 0.0f;
+        VtQuathArray orientations;
+        VtVec3fArray angularVelocities;
+        float orientationsTimeDelta = 0.0f;
+        VtVec3fArray scales;
+        // The local transform of each prototype, the identity for prototypes
+        // without a prim.
+        std::vector<GfMatrix4d> protoXforms;
+    };
+
+    // Reads \p valuesAttr and \p velocitiesAttr at the time sample of
+    // \p valuesAttr at or before \p baseTime, returned in \p sampleTime.
+    // \p velocities is cleared unless it is sampled at the same time and
+    // matches \p values.
+    //
+    template <typename T>
+    void _ReadValuesAndVelocities(const UsdAttribute& valuesAttr,
+                                  const UsdAttribute& velocitiesAttr,
+                                  double baseTime,
+                                  VtArray<T>* values,
+                                  VtVec3fArray* velocities,
+                                  double* sampleTime)
+    {
+        double lower = baseTime;
+        double upper = baseTime;
+        bool hasSamples = false;
+        valuesAttr.GetBracketingTimeSamples(baseTime, &lower, &upper, &hasSamples);
+        *sampleTime = hasSamples ? lower : baseTime;
+        valuesAttr.Get(values, *sampleTime);
+
+        double velocitiesLower = baseTime;
+        bool velocitiesHaveSamples = false;
+        velocitiesAttr.GetBracketingTimeSamples(baseTime, &velocitiesLower, &upper,
+                                                &velocitiesHaveSamples);
+        if (!velocitiesAttr.Get(velocities, *sampleTime) ||
+            velocities->size() != values->size() || velocitiesHaveSamples != hasSamples ||
+            velocitiesLower != lower) {
+            velocities->clear();
+        }
+    }
+
+    // Reads the inputs of the transforms of the instances of \p instancer at
+    // every motion sample time, following the rules of
+    // UsdGeomPointInstancer::ComputeInstanceTransformsAtTimes, prototype
+    // transforms included. Returns false if the number of instances varies.
+    //
+    bool _ReadInstanceXformSamples(const UsdGeomPointInstancer& instancer,
+                                   const std::vector<double>& motionSampleTimes,
+                                   double currentTime,
+                                   const VtIntArray& protoIndices,
+                                   const SdfPathVector& protoPaths,
+                                   const _PathToPrimMap& primCache,
+                                   std::vector<_InstanceXformSample>* samples)
+    {
+        TRACE_FUNCTION();
+
+        const size_t numInstances = protoIndices.size();
+        const double timeCodesPerSecond =
+            instancer.GetPrim().GetStage()->GetTimeCodesPerSecond();
+
+        VtVec3fArray positions;
+        VtVec3fArray velocities;
+        double positionsSampleTime = currentTime;
+        _ReadValuesAndVelocities(instancer.GetPositionsAttr(), instancer.GetVelocitiesAttr(),
+                                 currentTime, &positions, &velocities, &positionsSampleTime);
+        VtVec3fArray accelerations;
+        if (!velocities.empty()) {
+            instancer.GetAccelerationsAttr().Get(&accelerations, positionsSampleTime);
+            if (accelerations.size() != positions.size()) {
+                accelerations.clear();
+            }
+        }
+
+        VtQuathArray orientations;
+        VtVec3fArray angularVelocities;
+        double orientationsSampleTime = currentTime;
+        _ReadValuesAndVelocities(instancer.GetOrientationsAttr(),
+                                 instancer.GetAngularVelocitiesAttr(), currentTime,
+                                 &orientations, &angularVelocities, &orientationsSampleTime);
+
+        const std::vector<int> usedProtoIndices =
+            _GetUsedProtoIndices(protoIndices, protoPaths.size());
+
+        samples->assign(motionSampleTimes.size(), _InstanceXformSample());
+        for (size_t a = 0; a < samples->size(); ++a) {
+            _InstanceXformSample& sample = (*samples)[a];
+            const double time = currentTime + motionSampleTimes[a];
+
+            if (!velocities.empty()) {
+                sample.positions = positions;
+                sample.velocities = velocities;
+                sample.accelerations = accelerations;
+                sample.positionsTimeDelta =
+                    static_cast<float>((time - positionsSampleTime) / timeCodesPerSecond);
+            } else {
+                instancer.GetPositionsAttr().Get(&sample.positions, time);
+            }
+            if (!angularVelocities.empty()) {
+                sample.orientations = orientations;
+                sample.angularVelocities = angularVelocities;
+                sample.orientationsTimeDelta =
+                    static_cast<float>((time - orientationsSampleTime) / timeCodesPerSecond);
+            } else {
+                instancer.GetOrientationsAttr().Get(&sample.orientations, time);
+            }
+            instancer.GetScalesAttr().Get(&sample.scales, time);
+
+            if (sample.positions.size() != numInstances ||
+                (!sample.orientations.empty() && sample.orientations.size() != numInstances) ||
+                (!sample.scales.empty() && sample.scales.size() != numInstances)) {
+                return false;
+            }
+
+            sample.protoXforms.assign(protoPaths.size(), GfMatrix4d(1.0));
+            for (int protoIndex : usedProtoIndices) {
+                const UsdGeomXformable protoXformable(
+                    primCache.find(protoPaths[protoIndex])->second);
+                bool resetsXformStack = false;
+                if (protoXformable &&
+                    !protoXformable.GetLocalTransformation(&sample.protoXforms[protoIndex],
+                                                           &resetsXformStack, time)) {
+                    sample.protoXforms[protoIndex].SetIdentity();
+                }
+            }
+        }
+        return true;
+    }
+
+    // Returns the transform of instance \p i, of prototype \p protoIndex, at
+    // \p sample: the local transform of its prototype, then its scale,
+    // orientation and position.
+    //
+    GfMatrix4d _ComposeInstanceXform(const _InstanceXformSample& sample,
+                                     int protoIndex,
+                                     size_t i)
+    {
+        GfMatrix4d xform(1.0);
+        if (!sample.orientations.empty()) {
+            GfRotation rotation(GfQuatd(sample.orientations.cdata()[i]));
+            if (!sample.angularVelocities.empty()) {
+                const GfVec3f& angularVelocity = sample.angularVelocities.cdata()[i];
+                const float speed = angularVelocity.GetLength();
+                if (speed > 0.0f) {
+                    rotation *= GfRotation(GfVec3d(angularVelocity),
+                                           sample.orientationsTimeDelta * speed);
+                }
+            }
+            xform.SetRotate(rotation);
+        }
+        if (!sample.scales.empty()) {
+            const GfVec3f& scale = sample.scales.cdata()[i];
+            for (int row = 0; row < 3; ++row) {
+                for (int column = 0; column < 3; ++column) {
+                    xform[row][column] *= scale[row];
+                }
+            }
+        }
+
+        GfVec3f translation = sample.positions.cdata()[i];
+        if (!sample.velocities.empty()) {
+            const float timeDelta = sample.positionsTimeDelta;
+            translation += sample.velocities.cdata()[i] * timeDelta;
+            if (!sample.accelerations.empty()) {
+                translation += sample.accelerations.cdata()[i] * (0.5f * timeDelta * timeDelta);
+            }
+        }
+        xform.SetTranslateOnly(GfVec3d(translation));
+
+        return sample.protoXforms[protoIndex] * xform;
+    }
+
+    // Returns the frame-relative times of the instance matrices, sorted as
+    // Katana expects them, and in \p sampleSlots the position among them of
+    // the sample of each of \p motionSampleTimes. If motion is backwards,
+    // the sample times are reversed.
+    //
+    std::vector<float> _GetInstanceMatrixTimes(const std::vector<double>& motionSampleTimes,
+                                               bool isMotionBackward,
+                                               std::vector<size_t>* sampleSlots)
+    {
+        const size_t numSampleTimes = motionSampleTimes.size();
+        std::vector<float> sampleTimes(numSampleTimes);
+        for (size_t a = 0; a < numSampleTimes; ++a) {
+            sampleTimes[a] = static_cast<float>(
+                isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(motionSampleTimes[a])
+                                 : motionSampleTimes[a]);
+        }
+
+        std::vector<size_t> order(numSampleTimes);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&sampleTimes](size_t a, size_t b) {
+            return sampleTimes[a] < sampleTimes[b];
+        });
+
+        std::vector<float> times(numSampleTimes);
+        sampleSlots->resize(numSampleTimes);
+        for (size_t slot = 0; slot < numSampleTimes; ++slot) {
+            times[slot] = sampleTimes[order[slot]];
+            (*sampleSlots)[order[slot]] = slot;
+        }
+        return times;
+    }
+
+    // Composes the transforms of all the instances at every sample of
+    // \p samples in a single parallel pass, one chunk of instances of one
+    // time sample per task, straight into the single buffer handed to
+    // Katana. The instances of each sample are held one after the other, at
+    // the position given by \p sampleSlots.
+    //
+    VtArray<GfMatrix4d> _ComposeInstanceXforms(
+        const std::vector<_InstanceXformSample>& samples,
+        const std::vector<size_t>& sampleSlots,
+        const VtIntArray& protoIndices)
+    {
+        TRACE_FUNCTION();
+
+        const size_t numSampleTimes = samples.size();
+        const size_t numInstances = protoIndices.size();
+        const size_t numTasks = static_cast<size_t>(WorkGetConcurrencyLimit()) * 4;
+        const size_t grainSize = std::max(
+            _kMinInstanceGrain, numInstances * numSampleTimes / numTasks);
+        const size_t numChunks = (numInstances + grainSize - 1) / grainSize;
+        const int* protoIndicesData = protoIndices.cdata();
+
+        VtArray<GfMatrix4d> xforms(numSampleTimes * numInstances);
+        GfMatrix4d* xformsData = xforms.data();
+
+        _ParallelForN(numSampleTimes * numChunks, [&](size_t beginTask, size_t endTask) {
+            for (size_t task = beginTask; task < endTask; ++task) {
+                const size_t a = task / numChunks;
+                const size_t chunk = task % numChunks;
+                const _InstanceXformSample& sample = samples[a];
+                GfMatrix4d* sampleXforms = xformsData + sampleSlots[a] * numInstances;
+                const size_t end = std::min(numInstances, (chunk + 1) * grainSize);
+                for (size_t i = chunk * grainSize; i < end; ++i) {
+                    sampleXforms[i] = _ComposeInstanceXform(sample, protoIndicesData[i], i);
+                }
+            }
+        });
+        return xforms;
+    }
+
+    // Gathers the instance source index of every instance from the index of
+    // its prototype into \p instanceIndices, in parallel, and lists in
+    // \p omitList the instances pruned by \p mask, flagged in \p isCulled or
+    // whose prototype has no instance source.
+    //
+    void _GatherInstanceIndices(const VtIntArray& protoIndices,
+                                const std::vector<int>& protoSourceIndices,
+                                const std::vector<bool>& mask,
+                                const std::vector<char>& isCulled,
+                                VtIntArray* instanceIndices,
+                                std::vector<int>* omitList)
+    {
+        TRACE_FUNCTION();
+
+        const size_t numInstances = protoIndices.size();
+        const size_t numTasks = static_cast<size_t>(WorkGetConcurrencyLimit()) * 4;
+        const size_t grainSize = std::max(_kMinInstanceGrain, numInstances / numTasks);
+        const size_t numChunks = (numInstances + grainSize - 1) / grainSize;
+
+        instanceIndices->resize(numInstances);
+        const int* protoIndicesData = protoIndices.cdata();
+        int* instanceIndicesData = instanceIndices->data();
+
+        // Omitted instances are listed per chunk, then concatenated in order.
+        std::vector<std::vector<int>> chunkOmitLists(numChunks);
+        _ParallelForN(numChunks, [&](size_t beginChunk, size_t endChunk) {
+            for (size_t chunk = beginChunk; chunk < endChunk; ++chunk)
+            {
+                const size_t end = std::min(numInstances, (chunk + 1) * grainSize);
+                for (size_t i = chunk * grainSize; i < end; ++i)
+                {
+                    const int sourceIndex = protoSourceIndices[protoIndicesData[i]];
+                    // Omitted instances may use any valid source.
+                    instanceIndicesData[i] = std::max(sourceIndex, 0);
+                    if (sourceIndex < 0 || (!mask.empty() && !mask[i]) ||
+                        (!isCulled.empty() && isCulled[i]))
+                    {
+                        chunkOmitLists[chunk].push_back(static_cast<int>(i));
+                    }
+                }
+            }
+        });
+
+        omitList->clear();
+        for (const std::vector<int>& chunkOmitList : chunkOmitLists)
+        {
+            omitList->insert(omitList->end(), chunkOmitList.begin(), chunkOmitList.end());
+        }
+    }
+
+    // Leverage usdInArgs for calculating the bound of each prototype used by
+    // the instances at every time sample, once. Note that we apply the
+    // prototype's local transform to account for any offsets. Prototypes
+    // without a prim keep no bounds.
+    //
+    std::vector<std::vector<GfBBox3d>> _ComputeProtoBounds(
+        UsdKatanaUsdInArgsRefPtr usdInArgs,
+        const std::vector<double>& motionSampleTimes,
+        const VtIntArray& protoIndices,
+        const SdfPathVector& protoPaths,
+        const _PathToPrimMap& primCache)
+    {
+        TRACE_FUNCTION();
+
+        std::vector<std::vector<GfBBox3d>> protoBounds(protoPaths.size());
+        for (int protoIndex : _GetUsedProtoIndices(protoIndices, protoPaths.size())) {
+            _PathToPrimMap::const_iterator pcIt = primCache.find(protoPaths[protoIndex]);
+            const UsdPrim &protoPrim = pcIt->second;
+            if (protoPrim) {
+                protoBounds[protoIndex] = usdInArgs->ComputeBounds(
+                    protoPrim, motionSampleTimes, /* applyLocalTransform */ true);
+            }
+        }
+        return protoBounds;
+    }
+
+    // Returns the frustum of \p camera that the render sees: its window is
+    // widened or heightened to enclose both the aperture of the camera and
+    // \p aspectRatio, if greater than 0, since the render conforms the
+    // aperture to the aspect ratio of its images, then enlarged by
+    // \p overscan times its size on each side.
+    //
+    GfFrustum _ComputeCullingFrustum(const GfCamera& camera,
+                                     double aspectRatio,
+                                     double overscan)
+    {
+        GfFrustum frustum = camera.GetFrustum();
+        const GfRange2d& window = frustum.GetWindow();
+        const GfVec2d center = window.GetMidpoint();
+        GfVec2d size = window.GetSize();
+        if (aspectRatio > 0.0 && size[0] > 0.0 && size[1] > 0.0)
+        {
+            if (aspectRatio > size[0] / size[1])
+            {
+                size[0] = size[1] * aspectRatio;
+            }
+            else
+            {
+                size[1] = size[0] / aspectRatio;
+            }
+        }
+        size *= 0.5 + std::max(overscan, 0.0);
+        frustum.SetWindow(GfRange2d(center - size, center + size));
+        return frustum;
+    }
+
+    // Returns a flag per instance, set for the instances whose bounds, padded
+    // by \p margin, lie outside of \p frustum or are smaller than \p minSize
+    // times their distance to it at every time sample. Instances whose
+    // prototype has no bounds are kept. \p instancerToWorld brings the
+    // instance transforms, composed from \p xformSamples, to the space of
+    // \p frustum.
+    //
+    std::vector<char> _CullInstances(const GfFrustum& frustum,
+                                     const GfMatrix4d& instancerToWorld,
+                                     double margin,
+                                     double minSize,
+                                     const std::vector<_InstanceXformSample>& xformSamples,
+                                     const VtIntArray& protoIndices,
+                                     const std::vector<std::vector<GfBBox3d>>& protoBounds)
+    {
+        TRACE_FUNCTION();
+
+        const size_t numInstances = protoIndices.size();
+        const int* protoIndicesData = protoIndices.cdata();
+        const GfVec3d padding(margin);
+
+        // The planes of a frustum are computed on first use, so compute them
+        // before the frustum is copied to the tasks.
+        GfFrustum cullingFrustum = frustum;
+        cullingFrustum.Intersects(cullingFrustum.GetPosition());
+        const GfVec3d cameraPosition = cullingFrustum.GetPosition();
+
+        std::vector<char> isCulled(numInstances, 0);
+        const size_t numTasks = static_cast<size_t>(WorkGetConcurrencyLimit()) * 4;
+        _ParallelForN(
+            numInstances,
+            [&](size_t begin, size_t end) {
+                const GfFrustum taskFrustum = cullingFrustum;
+                for (size_t i = begin; i < end; ++i) {
+                    const std::vector<GfBBox3d>& sampledBounds =
+                        protoBounds[protoIndicesData[i]];
+                    bool isVisible = sampledBounds.empty();
+                    for (size_t a = 0; a < sampledBounds.size() && !isVisible; ++a) {
+                        GfBBox3d thisBounds(sampledBounds[a]);
+                        thisBounds.Transform(
+                            _ComposeInstanceXform(xformSamples[a], protoIndicesData[i], i) *
+                            instancerToWorld);
+                        GfRange3d range = thisBounds.ComputeAlignedRange();
+                        if (range.IsEmpty()) {
+                            isVisible = true;
+                            break;
+                        }
+                        range.SetMin(range.GetMin() - padding);
+                        range.SetMax(range.GetMax() + padding);
+
+                        if (minSize > 0.0 &&
+                            range.GetSize().GetLength() <
+                                minSize * (range.GetMidpoint() - cameraPosition).GetLength()) {
+                            continue;
+                        }
+                        isVisible = taskFrustum.Intersects(GfBBox3d(range));
+                    }
+                    isCulled[i] = !isVisible;
+                }
+            },
+            std::max(_kMinInstanceGrain, numInstances / numTasks));
+        return isCulled;
+    }
+
     // XXX This is based on UsdGeomPointInstancer::ComputeExtentAtTime. Ideally,
     // we would just use UsdGeomPointInstancer, however it does not account for
-    // multi-sampled transforms (see bug 147526).
+    // multi-sampled transforms (see bug 147526). \p xforms and \p sampleSlots
+    // are those of _ComposeInstanceXforms().
     //
     bool _ComputeExtentAtTime(VtVec3fArray& extent,
-                              UsdKatanaUsdInArgsRefPtr usdInArgs,
-                              const std::vector<VtArray<GfMatrix4d>>& xforms,
+                              const VtArray<GfMatrix4d>& xforms,
+                              const std::vector<size_t>& sampleSlots,
                               const std::vector<double>& motionSampleTimes,
                               const VtIntArray& protoIndices,
-                              const SdfPathVector& protoPaths,
-                              const _PathToPrimMap& primCache,
-                              const std::vector<bool>& mask)
+                              const std::vector<std::vector<GfBBox3d>>& protoBounds,
+                              const std::vector<bool>& mask,
+                              const std::vector<char>& isCulled)
     {
-        GfRange3d extentRange;
+        TRACE_FUNCTION();
 
         const size_t numSampleTimes = motionSampleTimes.size();
+        const size_t numInstances = protoIndices.size();
 
-        for (size_t i = 0; i < protoIndices.size(); ++i) {
-            if (!mask.empty() && !mask[i]) {
-                continue;
-            }
+        // Bound the instances of every time sample in parallel, one chunk of
+        // instances of one time sample per task, then union the ranges of
+        // the tasks.
+        //
+        const size_t numTasks = static_cast<size_t>(WorkGetConcurrencyLimit()) * 4;
+        const size_t grainSize = std::max(
+            _kMinInstanceGrain, numInstances * numSampleTimes / numTasks);
+        const size_t numChunks = (numInstances + grainSize - 1) / grainSize;
+        const int* protoIndicesData = protoIndices.cdata();
+
+        std::vector<GfRange3d> taskRanges(numSampleTimes * numChunks);
+        _ParallelForN(taskRanges.size(), [&](size_t beginTask, size_t endTask) {
+            for (size_t task = beginTask; task < endTask; ++task) {
+                const size_t a = task / numChunks;
+                const size_t chunk = task % numChunks;
+                const GfMatrix4d* sampleXforms = xforms.cdata() + sampleSlots[a] * numInstances;
+                const size_t end = std::min(numInstances, (chunk + 1) * grainSize);
+                GfRange3d& taskRange = taskRanges[task];
+                for (size_t i = chunk * grainSize; i < end; ++i) {
+                    if ((!mask.empty() && !mask[i]) || (!isCulled.empty() && isCulled[i])) {
+                        continue;
+                    }
 
-            const int protoIndex = protoIndices[i];
-            const SdfPath &protoPath = protoPaths[protoIndex];
+                    const std::vector<GfBBox3d>& sampledBounds =
+                        protoBounds[protoIndicesData[i]];
+                    if (sampledBounds.empty()) {
+                        continue;
+                    }
 
-            _PathToPrimMap::const_iterator pcIt = primCache.find(protoPath);
-            const UsdPrim &protoPrim = pcIt->second;
-            if (!protoPrim) {
-                continue;
+                    // Apply the instance transform to the bounding box for
+                    // this time sample. We don't apply the parent transform
+                    // here, as the bounds need to be in parent-local space.
+                    //
+                    GfBBox3d thisBounds(sampledBounds[a]);
+                    thisBounds.Transform(sampleXforms[i]);
+                    taskRange.UnionWith(thisBounds.ComputeAlignedRange());
+                }
             }
+        });
 
-            // Leverage usdInArgs for calculating the proto prim's bound. Note
-            // that we apply the prototype's local transform to account for any
-            // offsets.
-            //
-            std::vector<GfBBox3d> sampledBounds = usdInArgs->ComputeBounds(
-                protoPrim, motionSampleTimes, /* applyLocalTransform */ true);
-
-            for (size_t a = 0; a < numSampleTimes; ++a) {
-                // Apply the instance transform to the bounding box for this
-                // time sample. We don't apply the parent transform here, as the
-                // bounds need to be in parent-local space.
-                //
-                GfBBox3d thisBounds(sampledBounds[a]);
-                thisBounds.Transform(xforms[a][i]);
-                extentRange.UnionWith(thisBounds.ComputeAlignedRange());
-            }
+        GfRange3d extentRange;
+        for (const GfRange3d& taskRange : taskRanges) {
+            extentRange.UnionWith(taskRange);
         }
 
         if (extentRange.IsEmpty()) {
@@ -153,6 +643,369 @@ namespace
         return true;
     }
 
+    // Splits \p instances, in place, into tiles of at most \p tileSize
+    // instances by recursively splitting them in halves along the longest
+    // axis of the range of their \p positions. Returns the end of each tile
+    // in \p instances. The instances of each tile are sorted.
+    //
+    std::vector<size_t> _PartitionInstances(std::vector<int>* instances,
+                                            const std::vector<GfVec3d>& positions,
+                                            size_t tileSize)
+    {
+        TRACE_FUNCTION();
+
+        std::vector<size_t> tileEnds;
+        std::vector<std::pair<size_t, size_t>> ranges = {{0, instances->size()}};
+        while (!ranges.empty()) {
+            const auto [begin, end] = ranges.back();
+            ranges.pop_back();
+
+            const auto first = instances->begin() + begin;
+            const auto last = instances->begin() + end;
+            if (end - begin <= tileSize) {
+                std::sort(first, last);
+                tileEnds.push_back(end);
+                continue;
+            }
+
+            GfRange3d range;
+            for (auto it = first; it != last; ++it) {
+                range.UnionWith(positions[*it]);
+            }
+            const GfVec3d size = range.GetSize();
+            const int axis =
+                size[0] >= size[1] && size[0] >= size[2] ? 0 : (size[1] >= size[2] ? 1 : 2);
+
+            const size_t middle = begin + (end - begin) / 2;
+            std::nth_element(first, instances->begin() + middle, last, [&](int lhs, int rhs) {
+                return positions[lhs][axis] < positions[rhs][axis];
+            });
+
+            // Split the lower half first, so that the tiles are in order.
+            ranges.emplace_back(middle, end);
+            ranges.emplace_back(begin, middle);
+        }
+        return tileEnds;
+    }
+
+    // Returns the values of \p attr for \p instances, for every time sample,
+    // given that \p attr has \p valuesPerInstance values per instance.
+    //
+    template <typename ATTR_T>
+    ATTR_T _SliceInstanceValues(const ATTR_T& attr,
+                                const int* instances,
+                                size_t numInstances,
+                                int64_t valuesPerInstance)
+    {
+        FnKat::DataBuilder<ATTR_T> builder(attr.getTupleSize());
+        for (int64_t s = 0; s < attr.getNumberOfTimeSamples(); ++s) {
+            const float sampleTime = attr.getSampleTime(s);
+            const typename ATTR_T::array_type values = attr.getNearestSample(sampleTime);
+            std::vector<typename ATTR_T::value_type>& tileValues = builder.get(sampleTime);
+            tileValues.reserve(numInstances * valuesPerInstance);
+            for (size_t i = 0; i < numInstances; ++i) {
+                const size_t first = static_cast<size_t>(instances[i] * valuesPerInstance);
+                tileValues.insert(tileValues.end(), values.begin() + first,
+                                  values.begin() + first + valuesPerInstance);
+            }
+        }
+        return builder.build();
+    }
+
+    // Returns \p primvarAttr, a primvar of the instance array of
+    // \p numAllInstances instances, for \p instances only. Primvars which
+    // do not have a value per instance are returned unchanged.
+    //
+    FnKat::GroupAttribute _SliceInstancePrimvar(const FnKat::GroupAttribute& primvarAttr,
+                                                const int* instances,
+                                                size_t numInstances,
+                                                size_t numAllInstances)
+    {
+        // Indexed primvars have an index per instance into their values.
+        const bool isIndexed = primvarAttr.getChildByName("index").isValid();
+        const std::string valueName = isIndexed ? "index" : "value";
+        const FnKat::DataAttribute valueAttr = primvarAttr.getChildByName(valueName);
+        if (!valueAttr.isValid()) {
+            return primvarAttr;
+        }
+
+        const int64_t elementSize = isIndexed ? 1 :
+            FnKat::IntAttribute(primvarAttr.getChildByName("elementSize")).getValue(1, false);
+        const int64_t valuesPerInstance = valueAttr.getTupleSize() * elementSize;
+        if (valuesPerInstance <= 0 ||
+            valueAttr.getNumberOfValues() !=
+                static_cast<int64_t>(numAllInstances) * valuesPerInstance) {
+            return primvarAttr;
+        }
+
+        FnKat::Attribute tileValueAttr;
+        switch (valueAttr.getType()) {
+            case kFnKatAttributeTypeInt:
+                tileValueAttr = _SliceInstanceValues(FnKat::IntAttribute(valueAttr), instances,
+                                                     numInstances, valuesPerInstance);
+                break;
+            case kFnKatAttributeTypeFloat:
+                tileValueAttr = _SliceInstanceValues(FnKat::FloatAttribute(valueAttr), instances,
+                                                     numInstances, valuesPerInstance);
+                break;
+            case kFnKatAttributeTypeDouble:
+                tileValueAttr = _SliceInstanceValues(FnKat::DoubleAttribute(valueAttr),
+                                                     instances, numInstances, valuesPerInstance);
+                break;
+            case kFnKatAttributeTypeString:
+                tileValueAttr = _SliceInstanceValues(FnKat::StringAttribute(valueAttr),
+                                                     instances, numInstances, valuesPerInstance);
+                break;
+            default:
+                return primvarAttr;
+        }
+        return FnKat::GroupBuilder().update(primvarAttr).set(valueName, tileValueAttr).build();
+    }
+
+    // The attributes of one tile of the instance array of a point instancer.
+    //
+    struct _InstanceTile
+    {
+        FnKat::IntAttribute instanceIndex;
+        FnKat::Attribute instanceMatrix;
+        FnKat::IntAttribute ids;
+        FnKat::GroupAttribute arbitrary;
+        GfRange3d range;
+    };
+
+    // Splits the instances not in \p omitList into spatial tiles of at most
+    // \p tileSize instances, see UsdKatanaUsdInArgs::GetInstanceTileSize(),
+    // and builds the attributes of their instance arrays in parallel. The
+    // transforms of the instances are composed from \p xformSamples straight
+    // into the single buffer of their tile, at the times and positions given
+    // by \p instanceMatrixTimes and \p sampleSlots, see
+    // _GetInstanceMatrixTimes(). \p primvarsAttr and \p idsAttr, if valid,
+    // are sliced per tile.
+    //
+    std::vector<_InstanceTile> _BuildInstanceTiles(
+        size_t tileSize,
+        const VtIntArray& instanceIndices,
+        const std::vector<int>& omitList,
+        const std::vector<_InstanceXformSample>& xformSamples,
+        const std::vector<float>& instanceMatrixTimes,
+        const std::vector<size_t>& sampleSlots,
+        const VtIntArray& protoIndices,
+        const std::vector<std::vector<GfBBox3d>>& protoBounds,
+        const FnKat::GroupAttribute& primvarsAttr,
+        const FnKat::IntAttribute& idsAttr)
+    {
+        TRACE_FUNCTION();
+
+        const size_t numAllInstances = instanceIndices.size();
+        const int* protoIndicesData = protoIndices.cdata();
+
+        // Tiles are split by the positions of the instances at the first
+        // time sample.
+        std::vector<GfVec3d> positions(numAllInstances);
+        _ParallelForN(numAllInstances, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                positions[i] =
+                    _ComposeInstanceXform(xformSamples[0], protoIndicesData[i], i)
+                        .ExtractTranslation();
+            }
+        });
+
+        std::vector<int> instances;
+        instances.reserve(numAllInstances - std::min(omitList.size(), numAllInstances));
+        auto omitIt = omitList.begin();
+        for (size_t i = 0; i < numAllInstances; ++i) {
+            if (omitIt != omitList.end() && *omitIt == static_cast<int>(i)) {
+                ++omitIt;
+                continue;
+            }
+            instances.push_back(static_cast<int>(i));
+        }
+        if (instances.empty()) {
+            return {};
+        }
+
+        const std::vector<size_t> tileEnds =
+            _PartitionInstances(&instances, positions, tileSize);
+
+        std::vector<_InstanceTile> tiles(tileEnds.size());
+        _ParallelForN(tiles.size(), [&](size_t beginTile, size_t endTile) {
+            for (size_t t = beginTile; t < endTile; ++t) {
+                const size_t first = t == 0 ? 0 : tileEnds[t - 1];
+                const int* tileInstances = instances.data() + first;
+                const size_t numTileInstances = tileEnds[t] - first;
+                _InstanceTile& tile = tiles[t];
+
+                std::vector<int> tileIndices(numTileInstances);
+                for (size_t i = 0; i < numTileInstances; ++i) {
+                    tileIndices[i] = instanceIndices[tileInstances[i]];
+                }
+                tile.instanceIndex =
+                    FnKat::IntAttribute(tileIndices.data(), tileIndices.size(), 1);
+                if (idsAttr.isValid()) {
+                    tile.ids = _SliceInstanceValues(idsAttr, tileInstances, numTileInstances, 1);
+                }
+
+                VtArray<GfMatrix4d> tileXforms(xformSamples.size() * numTileInstances);
+                for (size_t a = 0; a < xformSamples.size(); ++a) {
+                    GfMatrix4d* tileSampleXforms =
+                        tileXforms.data() + sampleSlots[a] * numTileInstances;
+                    for (size_t i = 0; i < numTileInstances; ++i) {
+                        const int instance = tileInstances[i];
+                        const int protoIndex = protoIndicesData[instance];
+                        tileSampleXforms[i] =
+                            _ComposeInstanceXform(xformSamples[a], protoIndex, instance);
+
+                        GfRange3d instanceRange;
+                        const std::vector<GfBBox3d>& sampledBounds = protoBounds[protoIndex];
+                        if (!sampledBounds.empty()) {
+                            GfBBox3d thisBounds(sampledBounds[a]);
+                            thisBounds.Transform(tileSampleXforms[i]);
+                            instanceRange = thisBounds.ComputeAlignedRange();
+                        }
+
+                        // Instances whose prototype has no bounds, such as a
+                        // missing or empty prototype, still bound the tile
+                        // by their position, so that it is not skipped.
+                        if (instanceRange.IsEmpty()) {
+                            instanceRange.UnionWith(tileSampleXforms[i].ExtractTranslation());
+                        }
+                        tile.range.UnionWith(instanceRange);
+                    }
+                }
+
+#if KATANA_VERSION_MAJOR >= 3
+                std::vector<float> tileTimes = instanceMatrixTimes;
+                UsdKatanaUtils::CollapseIdenticalSamples(&tileTimes, &tileXforms);
+                tile.instanceMatrix = VtKatanaMapOrCopy(tileTimes, tileXforms);
+#else
+                FnKat::DoubleBuilder instanceMatrixBldr(16);
+                for (size_t slot = 0; slot < instanceMatrixTimes.size(); ++slot) {
+                    std::vector<double>& matVec =
+                        instanceMatrixBldr.get(instanceMatrixTimes[slot]);
+                    const double* matArray =
+                        tileXforms.cdata()[slot * numTileInstances].GetArray();
+                    matVec.assign(matArray, matArray + 16 * numTileInstances);
+                }
+                tile.instanceMatrix = instanceMatrixBldr.build();
+#endif // KATANA_VERSION_MAJOR >= 3
+            }
+        });
+
+        // The primvars of all the tiles are sliced in a single parallel pass
+        // over (tile x primvar) tasks, through the same partition.
+        const size_t numPrimvars = static_cast<size_t>(primvarsAttr.getNumberOfChildren());
+        std::vector<FnKat::GroupAttribute> tilePrimvars(tiles.size() * numPrimvars);
+        _ParallelForN(tilePrimvars.size(), [&](size_t beginTask, size_t endTask) {
+            for (size_t task = beginTask; task < endTask; ++task) {
+                const size_t t = task / numPrimvars;
+                const size_t first = t == 0 ? 0 : tileEnds[t - 1];
+                tilePrimvars[task] = _SliceInstancePrimvar(
+                    primvarsAttr.getChildByIndex(static_cast<int64_t>(task % numPrimvars)),
+                    instances.data() + first, tileEnds[t] - first, numAllInstances);
+            }
+        });
+        for (size_t t = 0; t < tiles.size(); ++t) {
+            FnKat::GroupBuilder arbitraryBldr;
+            for (size_t p = 0; p < numPrimvars; ++p) {
+                arbitraryBldr.set(primvarsAttr.getChildName(static_cast<int64_t>(p)),
+                                  tilePrimvars[t * numPrimvars + p]);
+            }
+            if (tiles[t].ids.isValid()) {
+                arbitraryBldr.set("ids", tiles[t].ids);
+            }
+            tiles[t].arbitrary = arbitraryBldr.build();
+        }
+        return tiles;
+    }
+
+    // Returns whether all of \p ids fit in 32-bit integers. The range of
+    // each chunk is scanned without early exit so that the loop vectorizes.
+    //
+    bool _IdsFitIn32Bit(const VtArray<int64_t>& ids)
+    {
+        TRACE_FUNCTION();
+
+        const size_t numIds = ids.size();
+        const size_t numTasks = static_cast<size_t>(WorkGetConcurrencyLimit()) * 4;
+        const size_t grainSize = std::max(_kMinInstanceGrain, numIds / numTasks);
+        const int64_t* idsData = ids.cdata();
+
+        std::atomic<bool> fits(true);
+        _ParallelForN(
+            numIds,
+            [&](size_t begin, size_t end) {
+                int64_t minId = 0;
+                int64_t maxId = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    minId = std::min(minId, idsData[i]);
+                    maxId = std::max(maxId, idsData[i]);
+                }
+                if (minId < std::numeric_limits<int32_t>::min() ||
+                    maxId > std::numeric_limits<int32_t>::max()) {
+                    fits = false;
+                }
+            },
+            grainSize);
+        return fits;
+    }
+
+    // Converts \p ids to 32-bit integers in parallel, truncating values
+    // which do not fit.
+    //
+    VtIntArray _CastIds(const VtArray<int64_t>& ids)
+    {
+        TRACE_FUNCTION();
+
+        const size_t numIds = ids.size();
+        const size_t numTasks = static_cast<size_t>(WorkGetConcurrencyLimit()) * 4;
+        const int64_t* idsData = ids.cdata();
+
+        VtIntArray result(numIds);
+        int* resultData = result.data();
+        _ParallelForN(
+            numIds,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    resultData[i] = static_cast<int>(idsData[i]);
+                }
+            },
+            std::max(_kMinInstanceGrain, numIds / numTasks));
+        return result;
+    }
+
+    // Replaces each of \p ids by its index among the sorted unique ids,
+    // which are returned in \p table, sorted by original id so that the
+    // remapped ids keep the order of the original ones. The indices only
+    // hold for this set of ids, so they change between frames as instances
+    // appear or disappear. See UsdKatanaUsdInArgs::GetRemapInstanceIds().
+    //
+    VtIntArray _RemapIds(const VtArray<int64_t>& ids, std::vector<int64_t>* table)
+    {
+        TRACE_FUNCTION();
+
+        table->assign(ids.cbegin(), ids.cend());
+        WorkParallelSort(table);
+        table->erase(std::unique(table->begin(), table->end()), table->end());
+
+        const size_t numIds = ids.size();
+        const size_t numTasks = static_cast<size_t>(WorkGetConcurrencyLimit()) * 4;
+        const int64_t* idsData = ids.cdata();
+
+        VtIntArray result(numIds);
+        int* resultData = result.data();
+        _ParallelForN(
+            numIds,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    resultData[i] = static_cast<int>(
+                        std::lower_bound(table->begin(), table->end(), idsData[i]) -
+                        table->begin());
+                }
+            },
+            std::max(_kMinInstanceGrain, numIds / numTasks));
+        return result;
+    }
+
 } // anon namespace
 
 void UsdKatanaReadPointInstancer(const UsdGeomPointInstancer& instancer,
@@ -162,6 +1015,8 @@ void UsdKatanaReadPointInstancer(const UsdGeomPointInstancer& instancer,
                                  UsdKatanaAttrMap& instancesAttrMap,
                                  UsdKatanaAttrMap& inputAttrMap)
 {
+    TRACE_FUNCTION();
+
     const double currentTime = data.GetCurrentTime();
 
     UsdKatanaReadXformable(instancer, data, instancerAttrMap);
@@ -287,28 +1142,28 @@ void UsdKatanaReadPointInstancer(const UsdGeomPointInstancer& instancer,
         }
     }
 
-    // Gather frame-relative sample times and add them to the current time to
-    // generate absolute sample times.
+    // In velocity blur mode, the instances are moved to every motion sample
+    // time along their velocities and angular velocities from their current
+    // positions and orientations, even if those have a single sample.
     //
-    const std::vector<double> &motionSampleTimes =
-        data.GetMotionSampleTimes(positionsAttr, ensureMotion);
-    const size_t sampleCount = motionSampleTimes.size();
-    std::vector<UsdTimeCode> sampleTimes(sampleCount);
-    std::transform(motionSampleTimes.begin(), motionSampleTimes.end(), 
-                   sampleTimes.begin(), [currentTime](double motionSampleTime){
-                        return UsdTimeCode(currentTime + motionSampleTime);});
+    const bool velocityBlur =
+        data.GetUsdInArgs()->GetVelocityBlur() &&
+        (ensureMotion || instancer.GetAngularVelocitiesAttr().HasValue());
 
-    std::vector<VtArray<GfMatrix4d>> xformSamples(sampleCount);
-
-    instancer.ComputeInstanceTransformsAtTimes(
-            &xformSamples,
-            sampleTimes,
-            UsdTimeCode(currentTime),
-            UsdGeomPointInstancer::IncludeProtoXform,
-            UsdGeomPointInstancer::IgnoreMask);
-    const size_t numXformSamples = xformSamples.size();
+    // Gather frame-relative sample times.
+    //
+    const std::vector<double> motionSampleTimes =
+        velocityBlur ? data.GetMotionSampleTimes()
+                     : data.GetMotionSampleTimes(positionsAttr, ensureMotion);
 
-    if (numXformSamples == 0) {
+    // The inputs of the transforms are read once per sample time. The
+    // transforms themselves are composed in parallel where they are used:
+    // straight into the instance matrices, or into those of each tile.
+    //
+    std::vector<_InstanceXformSample> instanceXformSamples;
+    if (!_ReadInstanceXformSamples(instancer, motionSampleTimes, currentTime, protoIndices,
+                                   protoPaths, primCache, &instanceXformSamples) ||
+        instanceXformSamples.empty()) {
         _LogAndSetError(instancerAttrMap, "Could not compute "
                                           "sample/topology-invarying instance "
                                           "transform matrix");
@@ -319,60 +1174,67 @@ void UsdKatanaReadPointInstancer(const UsdGeomPointInstancer& instancer,
     // Compute prototype bounds.
     //
 
-    bool aggregateBoundsValid = false;
-    std::vector<double> aggregateBounds;
+    const std::vector<std::vector<GfBBox3d>> protoBounds = _ComputeProtoBounds(
+        data.GetUsdInArgs(), motionSampleTimes, protoIndices, protoPaths, primCache);
 
-    // XXX Replace with UsdGeomPointInstancer::ComputeExtentAtTime.
+    // Cull the instances outside of the frustum of the culling camera, if any.
     //
-    VtVec3fArray aggregateExtent;
-    if (_ComputeExtentAtTime(
-            aggregateExtent, data.GetUsdInArgs(), xformSamples,
-            motionSampleTimes, protoIndices, protoPaths, primCache,
-            pruneMaskValues)) {
-        aggregateBoundsValid = true;
-        aggregateBounds.resize(6);
-        aggregateBounds[0] = aggregateExtent[0][0]; // min x
-        aggregateBounds[1] = aggregateExtent[1][0]; // max x
-        aggregateBounds[2] = aggregateExtent[0][1]; // min y
-        aggregateBounds[3] = aggregateExtent[1][1]; // max y
-        aggregateBounds[4] = aggregateExtent[0][2]; // min z
-        aggregateBounds[5] = aggregateExtent[1][2]; // max z
+    std::vector<char> isCulled;
+    const std::string& cullingCameraPath = data.GetUsdInArgs()->GetInstanceCullingCamera();
+    if (!cullingCameraPath.empty())
+    {
+        const UsdGeomCamera cullingCamera(
+            stage->GetPrimAtPath(SdfPath(cullingCameraPath)));
+        if (cullingCamera)
+        {
+            const GfMatrix4d instancerToWorld =
+                instancer.ComputeLocalToWorldTransform(currentTime);
+            const GfFrustum cullingFrustum = _ComputeCullingFrustum(
+                cullingCamera.GetCamera(currentTime),
+                data.GetUsdInArgs()->GetInstanceCullingAspectRatio(),
+                data.GetUsdInArgs()->GetInstanceCullingOverscan());
+            isCulled = _CullInstances(
+                cullingFrustum, instancerToWorld,
+                data.GetUsdInArgs()->GetInstanceCullingMargin(),
+                data.GetUsdInArgs()->GetInstanceCullingMinSize(), instanceXformSamples,
+                protoIndices, protoBounds);
+            instancerAttrMap.set(
+                "info.usd.numCulledInstances",
+                FnKat::IntAttribute(static_cast<int>(
+                    std::count(isCulled.begin(), isCulled.end(), 1))));
+        }
+        else
+        {
+            _LogAndSetWarning(instancerAttrMap, "Instance culling camera " +
+                                                    cullingCameraPath + " is not a camera");
+        }
     }
 
+    bool aggregateBoundsValid = false;
+    std::vector<double> aggregateBounds;
+
     //
     // Build sources (prototypes). Keep track of which instances use them.
     //
 
     FnGeolibServices::StaticSceneCreateOpArgsBuilder sourcesBldr(true);
 
-    std::vector<int> instanceIndices;
-    instanceIndices.reserve(numInstances);
-
     std::vector<std::string> instanceSources;
     instanceSources.reserve(protoPaths.size());
 
     std::map<std::string, int> instanceSourceIndexMap;
 
-    std::vector<int> omitList;
-    omitList.reserve(numInstances);
-
     std::map<SdfPath, std::string> protoPathsToKatPaths;
     std::map<std::string, std::vector<std::string>> usdPrimPathsTracker;
 
-
-    for (size_t i = 0; i < numInstances; ++i)
+    // Each prototype used by the instances is resolved to its instance source
+    // once, in order of first use, so that the instances only have to look up
+    // their source index in protoSourceIndices. Prototypes without a source
+    // keep a negative index.
+    //
+    std::vector<int> protoSourceIndices(protoPaths.size(), -1);
+    for (int index : _GetUsedProtoIndices(protoIndices, protoPaths.size()))
     {
-        int index = protoIndices[i];
-
-        // Check to see if we are pruned.
-        //
-        bool isPruned = (!pruneMaskValues.empty() and
-                         pruneMaskValues[i] == false);
-        if (isPruned)
-        {
-            omitList.push_back(i);
-        }
-
         const SdfPath &protoPath = protoPaths[index];
 
         // Compute the Katana path to this prototype.
@@ -600,76 +1462,165 @@ void UsdKatanaReadPointInstancer(const UsdGeomPointInstancer& instancer,
             protoPathsToKatPaths[protoPath] = katProtoPath;
         }
 
-        instanceIndices.push_back(instanceSourceIndexMap[katProtoPath]);
+        protoSourceIndices[index] = instanceSourceIndexMap[katProtoPath];
     }
 
+    VtIntArray instanceIndices;
+    std::vector<int> omitList;
+    _GatherInstanceIndices(protoIndices, protoSourceIndices, pruneMaskValues, isCulled,
+                           &instanceIndices, &omitList);
+
     //
     // Build instances.
     //
 
     FnGeolibServices::StaticSceneCreateOpArgsBuilder instancesBldr(false);
 
-    instancesBldr.createEmptyLocation("instances", "instance array");
+    // Large instancers are split into tiles below, once their primvars are
+    // known.
+    //
+    const size_t tileSize =
+        static_cast<size_t>(std::max(data.GetUsdInArgs()->GetInstanceTileSize(), 0));
+    const bool isTiled = tileSize > 0 && numInstances > tileSize;
 
-    instancesBldr.setAttrAtLocation("instances",
-            "geometry.instanceSource",
-                    FnKat::StringAttribute(instanceSources, 1));
+    // The instance matrices of all the sample times are held in a single
+    // buffer, which Katana maps without copying it.
+    //
+    std::vector<size_t> sampleSlots;
+    std::vector<float> instanceMatrixTimes =
+        _GetInstanceMatrixTimes(motionSampleTimes, data.IsMotionBackward(), &sampleSlots);
+    if (!isTiled)
+    {
+        VtArray<GfMatrix4d> xforms =
+            _ComposeInstanceXforms(instanceXformSamples, sampleSlots, protoIndices);
 
-    instancesBldr.setAttrAtLocation("instances",
-            "geometry.instanceIndex",
-                    FnKat::IntAttribute(&instanceIndices[0],
-                            instanceIndices.size(), 1));
+        // XXX Replace with UsdGeomPointInstancer::ComputeExtentAtTime.
+        //
+        VtVec3fArray aggregateExtent;
+        if (_ComputeExtentAtTime(
+                aggregateExtent, xforms, sampleSlots, motionSampleTimes, protoIndices,
+                protoBounds, pruneMaskValues, isCulled)) {
+            aggregateBoundsValid = true;
+            aggregateBounds.resize(6);
+            aggregateBounds[0] = aggregateExtent[0][0]; // min x
+            aggregateBounds[1] = aggregateExtent[1][0]; // max x
+            aggregateBounds[2] = aggregateExtent[0][1]; // min y
+            aggregateBounds[3] = aggregateExtent[1][1]; // max y
+            aggregateBounds[4] = aggregateExtent[0][2]; // min z
+            aggregateBounds[5] = aggregateExtent[1][2]; // max z
+        }
 
-#if KATANA_VERSION_MAJOR >= 3
-    // If motion is backwards, make sure to reverse time samples.
-    std::map<float, VtArray<GfMatrix4d>> timeToSampleMap;
-    for (size_t a = 0; a < numXformSamples; ++a) {
-        double relSampleTime = motionSampleTimes[a];
-        timeToSampleMap.insert({data.IsMotionBackward()
-                                    ? UsdKatanaUtils::ReverseTimeSample(relSampleTime)
-                                    : relSampleTime,
-                                xformSamples[a]});
-    }
-    auto instanceMatrixAttr = VtKatanaMapOrCopy(timeToSampleMap);
-    instancesBldr.setAttrAtLocation("instances", "geometry.instanceMatrix",
-                                    instanceMatrixAttr);
-#else
-    FnKat::DoubleBuilder instanceMatrixBldr(16);
-    for (size_t a = 0; a < numXformSamples; ++a) {
+        instancesBldr.createEmptyLocation("instances", "instance array");
 
-        double relSampleTime = motionSampleTimes[a];
+        instancesBldr.setAttrAtLocation("instances",
+                "geometry.instanceSource",
+                        FnKat::StringAttribute(instanceSources, 1));
 
-        // Shove samples into the builder at the frame-relative sample time. If
-        // motion is backwards, make sure to reverse time samples.
-        std::vector<double>& matVec = instanceMatrixBldr.get(
-            data.IsMotionBackward() ? UsdKatanaUtils::ReverseTimeSample(relSampleTime)
-                                    : relSampleTime);
+#if KATANA_VERSION_MAJOR >= 3
+        instancesBldr.setAttrAtLocation("instances", "geometry.instanceIndex",
+                                        VtKatanaMapOrCopy(instanceIndices));
+#else
+        instancesBldr.setAttrAtLocation("instances",
+                "geometry.instanceIndex",
+                        FnKat::IntAttribute(instanceIndices.cdata(),
+                                instanceIndices.size(), 1));
+#endif // KATANA_VERSION_MAJOR >= 3
 
-        matVec.reserve(16 * numInstances);
-        for (size_t i = 0; i < numInstances; ++i) {
+#if KATANA_VERSION_MAJOR >= 3
+        UsdKatanaUtils::CollapseIdenticalSamples(&instanceMatrixTimes, &xforms);
+        auto instanceMatrixAttr = VtKatanaMapOrCopy(instanceMatrixTimes, xforms);
+        instancesBldr.setAttrAtLocation("instances", "geometry.instanceMatrix",
+                                        instanceMatrixAttr);
+#else
+        FnKat::DoubleBuilder instanceMatrixBldr(16);
+        for (size_t slot = 0; slot < instanceMatrixTimes.size(); ++slot) {
 
-            GfMatrix4d instanceXform = xformSamples[a][i];
-            const double *matArray = instanceXform.GetArray();
+            // Shove samples into the builder at the frame-relative sample time.
+            std::vector<double>& matVec = instanceMatrixBldr.get(instanceMatrixTimes[slot]);
 
-            for (int j = 0; j < 16; ++j) {
-                matVec.push_back(matArray[j]);
-            }
+            const double* matArray = xforms.cdata()[slot * numInstances].GetArray();
+            matVec.assign(matArray, matArray + 16 * numInstances);
         }
-    }
-    instancesBldr.setAttrAtLocation("instances",
-            "geometry.instanceMatrix", instanceMatrixBldr.build());
+        instancesBldr.setAttrAtLocation("instances",
+                "geometry.instanceMatrix", instanceMatrixBldr.build());
 #endif // KATANA_VERSION_MAJOR > 3
 
-    if (!omitList.empty())
-    {
+        if (!omitList.empty())
+        {
+            instancesBldr.setAttrAtLocation("instances",
+                    "geometry.omitList",
+                            FnKat::IntAttribute(&omitList[0], omitList.size(), 1));
+        }
+
         instancesBldr.setAttrAtLocation("instances",
-                "geometry.omitList",
-                        FnKat::IntAttribute(&omitList[0], omitList.size(), 1));
+                "geometry.pointInstancerId",
+                        FnKat::StringAttribute(katOutputPath));
     }
 
-    instancesBldr.setAttrAtLocation("instances",
-            "geometry.pointInstancerId",
-                    FnKat::StringAttribute(katOutputPath));
+    //
+    // IDs (optional)
+    //
+    FnKat::IntAttribute instanceIdsAttr;
+    const UsdAttribute idsAttr = instancer.GetIdsAttr();
+    if (idsAttr.HasValue())
+    {
+        VtArray<int64_t> idsArray{};
+        if (idsAttr.Get(&idsArray, currentTime))
+        {
+            static const bool allowUnsafeCast =
+                TfGetEnvSetting(KATANA_USD_INSTANCER_ID_ALLOW_UNSAFE_CAST);
+            const bool remapIds = data.GetUsdInArgs()->GetRemapInstanceIds();
+            const bool allValues32Bit = allowUnsafeCast || _IdsFitIn32Bit(idsArray);
+
+            VtIntArray ids;
+            bool idsConverted = true;
+            if (allValues32Bit)
+            {
+                if (allowUnsafeCast)
+                {
+                    _LogAndSetWarning(instancerAttrMap,
+                                      "The IDs attribute is an array of 64-bit integers. The "
+                                      "values cannot be safely cast to IntAttribute. This may "
+                                      "result in integer wraparound.");
+                }
+                ids = _CastIds(idsArray);
+            }
+            else if (remapIds)
+            {
+                // The original ids are split into their high and low 32 bits.
+                std::vector<int64_t> table;
+                ids = _RemapIds(idsArray, &table);
+                std::vector<int> tableValues(table.size() * 2);
+                for (size_t i = 0; i < table.size(); ++i)
+                {
+                    tableValues[2 * i] = static_cast<int>(table[i] >> 32);
+                    tableValues[2 * i + 1] = static_cast<int>(table[i] & 0xffffffff);
+                }
+                instancerAttrMap.set(
+                    "info.usd.idsTable",
+                    FnKat::IntAttribute(tableValues.data(), tableValues.size(), 2));
+            }
+            else
+            {
+                idsConverted = false;
+                _LogAndSetWarning(
+                    instancerAttrMap,
+                    "The IDs attribute contains values outside the 32-bit precision range "
+                    "and cannot be safely cast to IntAttribute. Values not converted. Enable "
+                    "remapInstanceIds on UsdIn to remap them to their index.");
+            }
+            if (idsConverted)
+            {
+                instanceIdsAttr = VtKatanaMapOrCopy(ids);
+                if (idsArray.size() != protoIndices.size())
+                {
+                    _LogAndSetWarning(
+                        instancerAttrMap,
+                        "IDs attribute array does not match the index array in length.");
+                }
+            }
+        }
+    }
 
     //
     // Transfer primvars.
@@ -701,58 +1652,70 @@ void UsdKatanaReadPointInstancer(const UsdGeomPointInstancer& instancer,
         }
     }
     instancerAttrMap.set("geometry.arbitrary", instancerPrimvarsBldr.build());
-    instancesBldr.setAttrAtLocation("instances",
-            "geometry.arbitrary", instancesPrimvarsBldr.build());
+    const FnKat::GroupAttribute instancesPrimvarsAttr = instancesPrimvarsBldr.build();
 
+    // Tiles list their instances in an order of their own, so they carry
+    // the ids of their instances, like their primvars.
     //
-    // IDs (optional)
-    //
-    const UsdAttribute idsAttr = instancer.GetIdsAttr();
-    if (idsAttr.HasValue())
+    const bool isTiledIds =
+        isTiled && instanceIdsAttr.isValid() &&
+        instanceIdsAttr.getNumberOfValues() == static_cast<int64_t>(numInstances);
+    if (instanceIdsAttr.isValid() && !isTiledIds)
     {
-        VtArray<int64_t> idsArray{};
-        if (idsAttr.Get(&idsArray, currentTime))
+        instancerAttrMap.set("geometry.arbitrary.ids", instanceIdsAttr);
+    }
+    if (!isTiled)
+    {
+        instancesBldr.setAttrAtLocation("instances",
+                "geometry.arbitrary", instancesPrimvarsAttr);
+    }
+    else
+    {
+        // Each tile is an instance array with its own bound, relative to the
+        // instancer like the instance matrices. The tiles hold all the
+        // instances which are not omitted, so the bounds of the instancer
+        // and of the group of the tiles are the union of theirs.
+        //
+        instancesBldr.createEmptyLocation("instances", "group");
+
+        const std::vector<_InstanceTile> tiles = _BuildInstanceTiles(
+            tileSize, instanceIndices, omitList, instanceXformSamples, instanceMatrixTimes,
+            sampleSlots, protoIndices, protoBounds, instancesPrimvarsAttr,
+            isTiledIds ? instanceIdsAttr : FnKat::IntAttribute());
+        GfRange3d tilesRange;
+        for (size_t t = 0; t < tiles.size(); ++t)
         {
-            bool allValues32Bit = true;
-            static const bool allowUnsafeCast =
-                TfGetEnvSetting(KATANA_USD_INSTANCER_ID_ALLOW_UNSAFE_CAST);
-            if (!allowUnsafeCast)
-            {
-                allValues32Bit =
-                    !std::any_of(idsArray.cbegin(),
-                                 idsArray.cend(),
-                                 [](const int64_t val)
-                                 {
-                                     return val < std::numeric_limits<int32_t>::min() ||
-                                            val > std::numeric_limits<int32_t>::max();
-                                 });
-
-                if (!allValues32Bit)
-                {
-                    _LogAndSetWarning(
-                        instancerAttrMap,
-                        "The IDs attribute contains values outside the 32-bit precision range "
-                        "and cannot be safely cast to IntAttribute. Values not converted.");
-                }
-            }
-            else
+            const _InstanceTile& tile = tiles[t];
+            tilesRange.UnionWith(tile.range);
+            const std::string tilePath = "instances/tile" + std::to_string(t);
+            instancesBldr.createEmptyLocation(tilePath, "instance array");
+            instancesBldr.setAttrAtLocation(tilePath, "geometry.instanceSource",
+                                            FnKat::StringAttribute(instanceSources, 1));
+            instancesBldr.setAttrAtLocation(tilePath, "geometry.instanceIndex",
+                                            tile.instanceIndex);
+            instancesBldr.setAttrAtLocation(tilePath, "geometry.instanceMatrix",
+                                            tile.instanceMatrix);
+            instancesBldr.setAttrAtLocation(tilePath, "geometry.pointInstancerId",
+                                            FnKat::StringAttribute(katOutputPath));
+            instancesBldr.setAttrAtLocation(tilePath, "geometry.arbitrary", tile.arbitrary);
+            if (!tile.range.IsEmpty())
             {
-                _LogAndSetWarning(instancerAttrMap,
-                                  "The IDs attribute is an array of 64-bit integers. The values "
-                                  "cannot be safely cast to IntAttribute. This may result in "
-                                  "integer wraparound.");
-            }
-            if (allowUnsafeCast || allValues32Bit)
-            {
-                instancerAttrMap.set("geometry.arbitrary.ids", VtKatanaMapOrCopy(idsArray));
-                if (idsArray.size() != protoIndices.size())
-                {
-                    _LogAndSetWarning(
-                        instancerAttrMap,
-                        "IDs attribute array does not match the index array in length.");
-                }
+                const GfVec3d& min = tile.range.GetMin();
+                const GfVec3d& max = tile.range.GetMax();
+                const double bound[6] = {min[0], max[0], min[1], max[1], min[2], max[2]};
+                instancesBldr.setAttrAtLocation(tilePath, "bound",
+                                                FnKat::DoubleAttribute(bound, 6, 2));
             }
         }
+        if (!tilesRange.IsEmpty())
+        {
+            const GfVec3d& min = tilesRange.GetMin();
+            const GfVec3d& max = tilesRange.GetMax();
+            aggregateBoundsValid = true;
+            aggregateBounds = {min[0], max[0], min[1], max[1], min[2], max[2]};
+            instancesBldr.setAttrAtLocation(
+                "instances", "bound", FnKat::DoubleAttribute(aggregateBounds.data(), 6, 2));
+        }
     }
 
     //
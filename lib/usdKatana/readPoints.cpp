@@ -30,6 +30,7 @@
 #include "usdKatana/readPoints.h"
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usdGeom/points.h>
 
 #include <FnAPI/FnAPI.h>
@@ -70,6 +71,8 @@ void UsdKatanaReadPoints(const UsdGeomPoints& points,
                          const UsdKatanaUsdInPrivateData& data,
                          UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     const double currentTime = data.GetCurrentTime();
 
     //
@@ -89,7 +92,12 @@ void UsdKatanaReadPoints(const UsdGeomPoints& points,
     //
 
     // position
-    attrs.set("geometry.point.P", UsdKatanaGeomGetPAttr(points, data));
+    FnKat::GroupAttribute skinningAttr;
+    attrs.set("geometry.point.P", UsdKatanaGeomGetPAttr(points, data, &skinningAttr));
+    if (skinningAttr.isValid())
+    {
+        attrs.set("geometry.skinning", skinningAttr);
+    }
 
     // velocity
     FnKat::Attribute velocitiesAttr = UsdKatanaGeomGetVelocityAttr(points, data);
@@ -33,6 +33,8 @@
 #include <pxr/base/tf/getenv.h>
 #include <pxr/base/tf/stringUtils.h>
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/base/work/loops.h>
 #include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/collectionAPI.h>
 #include <pxr/usd/usd/inherits.h>
@@ -53,6 +55,8 @@
 
 #include "usdKatana/attrMap.h"
 #include "usdKatana/blindDataObject.h"
+#include "usdKatana/cookStats.h"
+#include "usdKatana/staticAttrCache.h"
 #include "usdKatana/tokens.h"
 #include "usdKatana/usdInPrivateData.h"
 #include "usdKatana/utils.h"
@@ -776,6 +780,12 @@ FnKat::Attribute UsdKatanaGeomGetPrimvarGroup(const UsdGeomImageable& imageable,
     FnKat::GroupBuilder gdBuilder;
 
     std::vector<UsdGeomPrimvar> primvarAttrs = UsdGeomPrimvarsAPI(imageable).GetPrimvars();
+
+    // If there is a block from blind data, skip to avoid the cost
+    UsdKatanaBlindDataObject kbd(imageable.GetPrim());
+
+    std::vector<UsdGeomPrimvar> primvars;
+    primvars.reserve(primvarAttrs.size());
     TF_FOR_ALL(primvar, primvarAttrs) {
         // Katana backends (such as RFK) are not prepared to handle
         // groups of primvars under geometry.arbitrary, which leaves us
@@ -785,9 +795,6 @@ FnKat::Attribute UsdKatanaGeomGetPrimvarGroup(const UsdGeomImageable& imageable,
         if (primvar->NameContainsNamespaces())
             continue;
 
-        // If there is a block from blind data, skip to avoid the cost
-        UsdKatanaBlindDataObject kbd(imageable.GetPrim());
-
         // XXX If we allow namespaced primvars (by eliminating the
         // short-circuit above), we will require GetKbdAttribute to be able
         // to translate namespaced names...
@@ -798,6 +805,16 @@ FnKat::Attribute UsdKatanaGeomGetPrimvarGroup(const UsdGeomImageable& imageable,
             continue;
         }
 
+        primvars.push_back(*primvar);
+    }
+
+    // The primvars are converted in parallel, as point instancers and meshes
+    // may carry many large ones, then added to the group in order.
+    std::vector<std::string> gdNames(primvars.size());
+    std::vector<FnKat::Attribute> gdAttrs(primvars.size());
+    auto convertPrimvar = [&](size_t i) {
+        const UsdGeomPrimvar* primvar = &primvars[i];
+
         TfToken          name, interpolation;
         SdfValueTypeName typeName;
         int              elementSize;
@@ -810,79 +827,107 @@ FnKat::Attribute UsdKatanaGeomGetPrimvarGroup(const UsdGeomImageable& imageable,
         // Name: this will eventually need to know how to translate namespaces
         std::string gdName = name;
 
-        VtValue vtValue;
-        VtIntArray indices;
-        bool isFaceVarying = false;
-        // Convert interpolation -> scope
-        FnKat::StringAttribute scopeAttr;
-        const bool isCurve = imageable.GetPrim().IsA<UsdGeomCurves>();
-        if (isCurve && interpolation == UsdGeomTokens->varying)
-        {
-            // it's a curve, so "varying" == "vertex"
-            scopeAttr = FnKat::StringAttribute("vertex");
-        }
-        else if (interpolation == UsdGeomTokens->faceVarying)
-        {
-            scopeAttr = FnKat::StringAttribute("vertex");
-            if (primvar->GetAttr().Get(&vtValue, data.GetCurrentTime()) &&
-                primvar->GetIndices(&indices, data.GetCurrentTime())) {
-                isFaceVarying = true;
-            }
-        }
-        else
-        {
-            scopeAttr = FnKat::StringAttribute(
-                    (interpolation == UsdGeomTokens->faceVarying) ? "vertex" :
-                    (interpolation == UsdGeomTokens->varying)     ? "point" :
-                    (interpolation == UsdGeomTokens->vertex)      ? "point" /*see below*/ :
-                    (interpolation == UsdGeomTokens->uniform)     ? "face" :
-                    "primitive" );
-        }
+        // The conversion of static primvars is shared by every frame when
+        // UsdKatanaUsdInArgs::GetShareStaticData() is set.
+        const FnKat::Attribute primvarAttr = UsdKatanaStaticAttrCache::GetInstance().GetOrConvert(
+            data, {primvar->GetAttr(), primvar->GetIndicesAttr()}, "primvar",
+            [&]() -> FnKat::Attribute {
+                VtValue vtValue;
+                VtIntArray indices;
+                bool isFaceVarying = false;
+                // Convert interpolation -> scope
+                FnKat::StringAttribute scopeAttr;
+                const bool isCurve = imageable.GetPrim().IsA<UsdGeomCurves>();
+                if (isCurve && interpolation == UsdGeomTokens->varying)
+                {
+                    // it's a curve, so "varying" == "vertex"
+                    scopeAttr = FnKat::StringAttribute("vertex");
+                }
+                else if (interpolation == UsdGeomTokens->faceVarying)
+                {
+                    scopeAttr = FnKat::StringAttribute("vertex");
+                    if (primvar->GetAttr().Get(&vtValue, data.GetCurrentTime()) &&
+                        primvar->GetIndices(&indices, data.GetCurrentTime())) {
+                        isFaceVarying = true;
+                    }
+                }
+                else
+                {
+                    scopeAttr = FnKat::StringAttribute(
+                            (interpolation == UsdGeomTokens->faceVarying) ? "vertex" :
+                            (interpolation == UsdGeomTokens->varying)     ? "point" :
+                            (interpolation == UsdGeomTokens->vertex)      ? "point" /*see below*/ :
+                            (interpolation == UsdGeomTokens->uniform)     ? "face" :
+                            "primitive" );
+                }
 
-        // Resolve the value if not face-varying
-        if (!isFaceVarying && !primvar->ComputeFlattened(
-                &vtValue, data.GetCurrentTime()))
-        {
-            continue;
-        }
+                // Resolve the value if not face-varying
+                if (!isFaceVarying && !primvar->ComputeFlattened(
+                        &vtValue, data.GetCurrentTime()))
+                {
+                    return FnKat::Attribute();
+                }
 
-        // Convert value to the required Katana attributes to describe it.
-        FnKat::Attribute valueAttr, inputTypeAttr, elementSizeAttr;
-        UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr(
-            vtValue, elementSize, typeName.GetRole(), &valueAttr, &inputTypeAttr, &elementSizeAttr);
-
-        // Bundle them into a group attribute
-        FnKat::GroupBuilder attrBuilder;
-        attrBuilder.set("scope", scopeAttr);
-        attrBuilder.set("inputType", inputTypeAttr);
-        // Retain the usd type name so that we can use this attribute when converting back to USD
-        attrBuilder.set("usd.usdType", FnKat::StringAttribute(typeName.GetAsToken().GetString()));
-
-        if (!typeName.GetRole().GetString().empty()) {
-            attrBuilder.set("usd.role",
-                            FnKat::StringAttribute(typeName.GetRole().GetString()));
-        }
+                // Convert value to the required Katana attributes to describe it.
+                FnKat::Attribute valueAttr, inputTypeAttr, elementSizeAttr;
+                UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr(
+                    vtValue, elementSize, typeName.GetRole(), &valueAttr, &inputTypeAttr,
+                    &elementSizeAttr);
+
+                // Bundle them into a group attribute
+                FnKat::GroupBuilder attrBuilder;
+                attrBuilder.set("scope", scopeAttr);
+                attrBuilder.set("inputType", inputTypeAttr);
+                // Retain the usd type name so that we can use this attribute when converting
+                // back to USD
+                attrBuilder.set("usd.usdType",
+                                FnKat::StringAttribute(typeName.GetAsToken().GetString()));
+
+                if (!typeName.GetRole().GetString().empty()) {
+                    attrBuilder.set("usd.role",
+                                    FnKat::StringAttribute(typeName.GetRole().GetString()));
+                }
 
-        if (elementSizeAttr.isValid()) {
-            attrBuilder.set("elementSize", elementSizeAttr);
-        }
+                if (elementSizeAttr.isValid()) {
+                    attrBuilder.set("elementSize", elementSizeAttr);
+                }
 
-        if (isFaceVarying) {
-            attrBuilder.set("indexedValue", valueAttr);
-            attrBuilder.set("index", FnAttribute::IntAttribute(indices.data(), indices.size(), 1));
-        } else {
-            attrBuilder.set("value", valueAttr);
-            // Note that 'varying' vs 'vertex' require special handling, as in
-            // Katana they are both expressed as 'point' scope above. To get
-            // 'vertex' interpolation we must set an additional
-            // 'interpolationType' attribute.  So we will flag that here.
-            if (interpolation == UsdGeomTokens->vertex) {
-                attrBuilder.set("interpolationType",
-                                FnKat::StringAttribute("subdiv"));
-            }
+                if (isFaceVarying) {
+                    attrBuilder.set("indexedValue", valueAttr);
+                    attrBuilder.set("index",
+                                    FnAttribute::IntAttribute(indices.data(), indices.size(), 1));
+                } else {
+                    attrBuilder.set("value", valueAttr);
+                    // Note that 'varying' vs 'vertex' require special handling, as
+                    // in Katana they are both expressed as 'point' scope above. To get
+                    // 'vertex' interpolation we must set an additional
+                    // 'interpolationType' attribute.  So we will flag that here.
+                    if (interpolation == UsdGeomTokens->vertex) {
+                        attrBuilder.set("interpolationType",
+                                        FnKat::StringAttribute("subdiv"));
+                    }
+                }
+
+                return attrBuilder.build();
+            });
+        gdNames[i] = gdName;
+        gdAttrs[i] = primvarAttr;
+    };
+    UsdKatanaCookStats* stats = UsdKatanaCookStats::GetCurrent();
+    WorkParallelForN(primvars.size(), [&](size_t begin, size_t end) {
+        UsdKatanaCookStatsTaskScope statsScope(stats);
+        for (size_t i = begin; i < end; ++i)
+        {
+            convertPrimvar(i);
         }
+    });
 
-        gdBuilder.set(gdName, attrBuilder.build());
+    for (size_t i = 0; i < primvars.size(); ++i)
+    {
+        if (gdAttrs[i].isValid())
+        {
+            gdBuilder.set(gdNames[i], gdAttrs[i]);
+        }
     }
 
     return gdBuilder.build();
@@ -892,6 +937,8 @@ void UsdKatanaReadPrim(const UsdPrim& prim,
                        const UsdKatanaUsdInPrivateData& data,
                        UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     const double currentTime = data.GetCurrentTime();
 
     const bool prmanOutputTarget = data.hasOutputTarget("prman");
@@ -33,6 +33,7 @@
 #include <utility>
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usdGeom/capsule.h>
 #include <pxr/usd/usdGeom/cone.h>
 #include <pxr/usd/usdGeom/cube.h>
@@ -194,6 +195,8 @@ void UsdKatanaReadPrimitive(const UsdPrim& prim,
                             UsdKatanaAttrMap& attrs,
                             std::string& attrsFilePath)
 {
+    TRACE_FUNCTION();
+
     UsdKatanaReadGprim(UsdGeomGprim(prim), data, attrs);
 
     static std::string resourcesDir;
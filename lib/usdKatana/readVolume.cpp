@@ -26,6 +26,7 @@
 #include <string>
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usdVol/openVDBAsset.h>
 #include <pxr/usd/usdVol/volume.h>
 
@@ -46,6 +47,8 @@ void UsdKatanaReadVolume(const UsdVolVolume& volume,
                          const UsdKatanaUsdInPrivateData& data,
                          UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     UsdKatanaReadGprim(volume, data, attrs);
 
     attrs.set("type", FnKat::StringAttribute("volume"));
@@ -29,9 +29,12 @@
 //
 #include "usdKatana/readXformable.h"
 
+#include <map>
 #include <sstream>
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/base/vt/types.h>
 #include <pxr/usd/usdGeom/xform.h>
 
 #include <FnAttribute/FnDataBuilder.h>
@@ -79,25 +82,27 @@ bool UsdKatanaReadXformable(const UsdGeomXformable& xformable,
         const std::vector<double>& motionSampleTimes = 
             data.GetMotionSampleTimes(xformOp.GetAttr());
 
-        FnKat::DoubleBuilder matBuilder(16);
+        std::map<float, VtMatrix4dArray> timeToSampleMap;
         TF_FOR_ALL(iter, motionSampleTimes)
         {
             double relSampleTime = *iter;
             double time = currentTime + relSampleTime;
 
-            GfMatrix4d mat = xformOp.GetOpTransform(time);
+            timeToSampleMap.insert(
+                {isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime)
+                                  : relSampleTime,
+                 VtMatrix4dArray(1, xformOp.GetOpTransform(time))});
+        }
+
+        // Ops with a time sample on every frame often do not move.
+        UsdKatanaUtils::CollapseIdenticalSamples(&timeToSampleMap);
 
+        FnKat::DoubleBuilder matBuilder(16);
+        for (const auto& sample : timeToSampleMap)
+        {
             // Convert to vector.
-            const double *matArray = mat.GetArray();
-            std::vector<double>& matVec =
-                matBuilder.get(isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime)
-                                                : relSampleTime);
-
-            matVec.resize(16);
-            for (int i = 0; i < 16; ++i)
-            {
-                matVec[i] = matArray[i];
-            }
+            const double *matArray = sample.second[0].GetArray();
+            matBuilder.get(sample.first).assign(matArray, matArray + 16);
         }
 
         std::stringstream ss;
@@ -144,6 +149,8 @@ void UsdKatanaReadXformable(const UsdGeomXformable& xformable,
                             const UsdKatanaUsdInPrivateData& data,
                             UsdKatanaAttrMap& attrs)
 {
+    TRACE_FUNCTION();
+
     UsdKatanaReadPrim(xformable.GetPrim(), data, attrs);
 
     FnAttribute::GroupAttribute attr;
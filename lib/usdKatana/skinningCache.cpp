@@ -0,0 +1,582 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/skinningCache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/gf/vec4d.h>
+#include <pxr/base/tf/diagnostic.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/base/work/threadLimits.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/usdGeom/xformable.h>
+#include <pxr/usd/usdSkel/animMapper.h>
+#include <pxr/usd/usdSkel/bindingAPI.h>
+
+#include "usdKatana/cookStats.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace
+{
+// Below this many point/influence pairs, skinning runs on the calling thread.
+const size_t kSerialSkinningWork = 16384;
+
+// Smallest number of points handed to a single task.
+const size_t kMinSkinningGrain = 512;
+
+size_t ComputeSkinningGrainSize(size_t numPoints)
+{
+    // Aim for a few tasks per worker so stragglers can be balanced, but keep
+    // tasks large enough to amortize the scheduling cost.
+    const size_t numTasks = static_cast<size_t>(WorkGetConcurrencyLimit()) * 4;
+    return std::max(kMinSkinningGrain, numPoints / std::max<size_t>(numTasks, 1));
+}
+
+template <typename Fn>
+void ParallelForPoints(size_t numPoints, size_t work, Fn&& fn)
+{
+    if (work < kSerialSkinningWork)
+    {
+        fn(0, numPoints);
+    }
+    else
+    {
+        // The cook statistics of the workers go to those of the calling
+        // thread.
+        UsdKatanaCookStats* stats = UsdKatanaCookStats::GetCurrent();
+        WorkParallelForN(
+            numPoints,
+            [&fn, stats](size_t begin, size_t end) {
+                UsdKatanaCookStatsTaskScope statsScope(stats);
+                fn(begin, end);
+            },
+            ComputeSkinningGrainSize(numPoints));
+    }
+}
+
+template <typename T>
+inline void TransformAffine(const double* m, const T& p, double* out)
+{
+    // Row vector convention, as in GfMatrix4d::Transform.
+    out[0] = p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12];
+    out[1] = p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13];
+    out[2] = p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + m[14];
+}
+
+void TransformPoints(const GfMatrix4d& xform, TfSpan<GfVec3f> points)
+{
+    const double* m = xform.data();
+    ParallelForPoints(points.size(), points.size(), [&](size_t start, size_t end) {
+        double out[3];
+        for (size_t i = start; i < end; ++i)
+        {
+            TransformAffine(m, points[i], out);
+            points[i].Set(static_cast<float>(out[0]), static_cast<float>(out[1]),
+                          static_cast<float>(out[2]));
+        }
+    });
+}
+}  // namespace
+
+size_t UsdKatanaSkinningCache::_KeyHash::operator()(const _Key& key) const
+{
+    size_t hash = SdfPath::Hash()(key.skelInstancePath);
+    boost::hash_combine(hash, key.time);
+    return hash;
+}
+
+size_t UsdKatanaSkinningCache::_BlendShapeKeyHash::operator()(const _BlendShapeKey& key) const
+{
+    size_t hash = SdfPath::Hash()(key.meshPath);
+    for (const SdfPath& target : key.targets)
+    {
+        boost::hash_combine(hash, SdfPath::Hash()(target));
+    }
+    return hash;
+}
+
+UsdKatanaSkinningCache::UsdKatanaSkinningCache() {}
+
+UsdKatanaSkinningCache::~UsdKatanaSkinningCache() {}
+
+void UsdKatanaSkinningCache::PopulateSkelRoot(const UsdSkelRoot& skelRoot,
+                                              UsdSkelCache& skelCache)
+{
+    TRACE_FUNCTION();
+
+    const SdfPath& rootPath = skelRoot.GetPath();
+    _PopulatedRootMap::const_iterator it = _populatedRoots.find(rootPath);
+    std::shared_ptr<std::once_flag> once;
+    if (it != _populatedRoots.end())
+    {
+        once = it->second;
+    }
+    else
+    {
+        once = _populatedRoots.insert(std::make_pair(rootPath, std::make_shared<std::once_flag>()))
+                   .first->second;
+    }
+    bool computed = false;
+    std::call_once(*once, [&]() {
+        computed = true;
+        skelCache.Populate(skelRoot, UsdTraverseInstanceProxies());
+    });
+    UsdKatanaCookStats::RecordCacheLookup(!computed);
+}
+
+const UsdKatanaSkinningCache::SkelTransforms& UsdKatanaSkinningCache::GetSkelTransforms(
+    const UsdSkelSkeletonQuery& skelQuery,
+    const UsdPrim& skelInstancePrim,
+    double time)
+{
+    TRACE_FUNCTION();
+
+    const _Key key{skelInstancePrim.GetPath(), time};
+    std::shared_ptr<_Entry> entry;
+    _EntryMap::const_iterator it = _entries.find(key);
+    if (it != _entries.end())
+    {
+        entry = it->second;
+    }
+    else
+    {
+        entry = _entries.insert(std::make_pair(key, std::make_shared<_Entry>())).first->second;
+    }
+
+    bool computed = false;
+    std::call_once(entry->once, [&]() {
+        computed = true;
+        SkelTransforms& transforms = entry->transforms;
+        transforms.valid = skelQuery.ComputeSkinningTransforms(&transforms.skinningXforms, time);
+        transforms.skelLocalToWorld =
+            UsdGeomXformable(skelInstancePrim).ComputeLocalToWorldTransform(time);
+        _numTransforms.fetch_add(transforms.skinningXforms.size(), std::memory_order_relaxed);
+    });
+    UsdKatanaCookStats::RecordCacheLookup(!computed);
+    return entry->transforms;
+}
+
+bool UsdKatanaSkinningCache::UsesLinearBlendSkinning(const UsdSkelSkinningQuery& skinningQuery)
+{
+    static const TfToken skinningMethodName("primvars:skel:skinningMethod");
+    static const TfToken classicLinear("classicLinear");
+    const UsdAttribute skinningMethodAttr = skinningQuery.GetPrim().GetAttribute(skinningMethodName);
+    TfToken skinningMethod;
+    return !skinningMethodAttr || !skinningMethodAttr.Get(&skinningMethod) ||
+           skinningMethod.IsEmpty() || skinningMethod == classicLinear;
+}
+
+bool UsdKatanaSkinningCache::ComputeJointXforms(const UsdSkelSkinningQuery& skinningQuery,
+                                                const UsdSkelSkeletonQuery& skelQuery,
+                                                const UsdPrim& skelInstancePrim,
+                                                double time,
+                                                std::vector<GfMatrix4d>* jointXforms)
+{
+    TRACE_FUNCTION();
+
+    if (!UsesLinearBlendSkinning(skinningQuery))
+    {
+        return false;
+    }
+    const SkelTransforms& skelTransforms = GetSkelTransforms(skelQuery, skelInstancePrim, time);
+    if (!skelTransforms.valid)
+    {
+        return false;
+    }
+
+    // Bring the transforms into the joint order of the mesh.
+    VtMatrix4dArray skinningXforms;
+    const UsdSkelAnimMapperRefPtr& jointMapper = skinningQuery.GetJointMapper();
+    if (jointMapper && !jointMapper->IsIdentity())
+    {
+        if (!jointMapper->RemapTransforms(skelTransforms.skinningXforms, &skinningXforms))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        skinningXforms = skelTransforms.skinningXforms;
+    }
+
+    // Fold the bind and skinning transforms into a single matrix per joint,
+    // so the per point work is a weighted sum of affine transforms. Skinned
+    // points are in skeleton space and need to be brought into the local
+    // space of the mesh afterwards.
+    *skelToPrimLocal =
+        skelTransforms.skelLocalToWorld *
+        UsdGeomXformable(skinningQuery.GetPrim()).ComputeLocalToWorldTransform(time).GetInverse();
+    const GfMatrix4d geomBindXform = skinningQuery.GetGeomBindTransform(time);
+    jointXforms->resize(skinningXforms.size());
+    for (size_t i = 0; i < skinningXforms.size(); ++i)
+    {
+        (*jointXforms)[i] = geomBindXform * skinningXforms[i];
+    }
+    return true;
+}
+
+bool UsdKatanaSkinningCache::SkinPoints(const UsdSkelSkinningQuery& skinningQuery,
+                                        const UsdSkelSkeletonQuery& skelQuery,
+                                        const UsdPrim& skelInstancePrim,
+                                        double time,
+                                        VtVec3fArray& points)
+{
+    TRACE_FUNCTION();
+
+    if (!UsesLinearBlendSkinning(skinningQuery))
+    {
+        const SkelTransforms& skelTransforms =
+            GetSkelTransforms(skelQuery, skelInstancePrim, time);
+        if (!skelTransforms.valid ||
+            !skinningQuery.ComputeSkinnedPoints(skelTransforms.skinningXforms, &points, time))
+        {
+            return false;
+        }
+        const GfMatrix4d skelToPrimLocal =
+            skelTransforms.skelLocalToWorld *
+            UsdGeomXformable(skinningQuery.GetPrim())
+                .ComputeLocalToWorldTransform(time)
+                .GetInverse();
+        TransformPoints(skelToPrimLocal, TfMakeSpan(points));
+        return true;
+    }
+
+    std::vector<GfMatrix4d> jointXforms;
+    GfMatrix4d skelToPrimLocal;
+    if (!ComputeJointXforms(skinningQuery, skelQuery, skelInstancePrim, time, &jointXforms,
+                            &skelToPrimLocal))
+    {
+        return false;
+    }
+
+    VtIntArray jointIndices;
+    VtFloatArray jointWeights;
+    if (!skinningQuery.ComputeJointInfluences(&jointIndices, &jointWeights, time))
+    {
+        return false;
+    }
+
+    return SkinPointsLBS(TfMakeConstSpan(jointXforms), skelToPrimLocal,
+                         TfMakeConstSpan(jointIndices), TfMakeConstSpan(jointWeights),
+                         skinningQuery.GetNumInfluencesPerComponent(),
+                         skinningQuery.IsRigidlyDeformed(), TfMakeSpan(points));
+}
+
+bool UsdKatanaSkinningCache::SkinPointsLBS(TfSpan<const GfMatrix4d> jointXforms,
+                                           const GfMatrix4d& skelToPrimLocal,
+                                           TfSpan<const int> jointIndices,
+                                           TfSpan<const float> jointWeights,
+                                           int numInfluencesPerPoint,
+                                           bool constantInfluences,
+                                           TfSpan<GfVec3f> points)
+{
+    TRACE_FUNCTION();
+
+    if (numInfluencesPerPoint <= 0 || jointIndices.size() != jointWeights.size())
+    {
+        return false;
+    }
+    const size_t numInfluences = static_cast<size_t>(numInfluencesPerPoint);
+    const size_t numJoints = jointXforms.size();
+    if (jointIndices.size() != (constantInfluences ? numInfluences : points.size() * numInfluences))
+    {
+        return false;
+    }
+
+    // Checked up front so that the points are left alone on failure, rather
+    // than in the loops below like UsdSkel does.
+    const int* badIndex =
+        std::find_if(jointIndices.begin(), jointIndices.end(), [numJoints](int jointIndex) {
+            return jointIndex < 0 || static_cast<size_t>(jointIndex) >= numJoints;
+        });
+    if (badIndex != jointIndices.end())
+    {
+        TF_WARN("Out of range joint index %d at index %zu (num joints = %zu).", *badIndex,
+                static_cast<size_t>(badIndex - jointIndices.begin()), numJoints);
+        return false;
+    }
+
+    if (constantInfluences)
+    {
+        // Every point shares the same influences: blend them once. The
+        // blended matrix only transforms points as an affine matrix, which
+        // makes it safe to compose with the skeleton to mesh transform.
+        GfMatrix4d blended(0.0);
+        for (size_t i = 0; i < numInfluences; ++i)
+        {
+            blended += jointXforms[jointIndices[i]] * static_cast<double>(jointWeights[i]);
+        }
+        blended.SetColumn(3, GfVec4d(0.0, 0.0, 0.0, 1.0));
+        TransformPoints(blended * skelToPrimLocal, points);
+        return true;
+    }
+
+    const GfMatrix4d* xforms = jointXforms.data();
+    const int* indices = jointIndices.data();
+    const float* weights = jointWeights.data();
+    GfVec3f* pointsData = points.data();
+    const double* primLocal = skelToPrimLocal.data();
+    const bool hasSkelToPrimLocal = skelToPrimLocal != GfMatrix4d(1.0);
+
+    // Influences and points are streamed in order; the joint matrices are the
+    // only randomly accessed data and are small enough to stay in cache.
+    ParallelForPoints(points.size(), points.size() * numInfluences, [&](size_t start, size_t end) {
+        double transformed[3];
+        for (size_t i = start; i < end; ++i)
+        {
+            const GfVec3f restPoint = pointsData[i];
+            const int* pointIndices = indices + i * numInfluences;
+            const float* pointWeights = weights + i * numInfluences;
+            double sum[3] = {0.0, 0.0, 0.0};
+            for (size_t j = 0; j < numInfluences; ++j)
+            {
+                const float weight = pointWeights[j];
+                if (weight == 0.0f)
+                {
+                    continue;
+                }
+                TransformAffine(xforms[pointIndices[j]].data(), restPoint, transformed);
+                sum[0] += weight * transformed[0];
+                sum[1] += weight * transformed[1];
+                sum[2] += weight * transformed[2];
+            }
+            if (hasSkelToPrimLocal)
+            {
+                TransformAffine(primLocal, sum, transformed);
+                std::copy(transformed, transformed + 3, sum);
+            }
+            pointsData[i].Set(static_cast<float>(sum[0]), static_cast<float>(sum[1]),
+                              static_cast<float>(sum[2]));
+        }
+    });
+    return true;
+}
+
+UsdKatanaSkinningCache::BlendShapeDataPtr UsdKatanaSkinningCache::GetBlendShapeData(
+    const UsdSkelBlendShapeQuery& blendShapeQuery,
+    const UsdPrim& meshPrim)
+{
+    TRACE_FUNCTION();
+
+    _BlendShapeKey key{meshPrim.GetPath(), SdfPathVector()};
+    UsdSkelBindingAPI(meshPrim).GetBlendShapeTargetsRel().GetTargets(&key.targets);
+
+    std::shared_ptr<_BlendShapeEntry> entry;
+    _BlendShapeMap::const_iterator it = _blendShapes.find(key);
+    if (it != _blendShapes.end())
+    {
+        entry = it->second;
+    }
+    else
+    {
+        entry = _blendShapes.insert(std::make_pair(key, std::make_shared<_BlendShapeEntry>()))
+                    .first->second;
+    }
+
+    bool computed = false;
+    std::call_once(entry->once, [&]() {
+        computed = true;
+        const std::vector<VtIntArray> blendShapePointIndices =
+            blendShapeQuery.ComputeBlendShapePointIndices();
+        const std::vector<VtVec3fArray> subShapePointOffsets =
+            blendShapeQuery.ComputeSubShapePointOffsets();
+
+        auto data = std::make_shared<BlendShapeData>();
+
+        // Sort the indices of sparse blend shapes, remembering the
+        // permutation so the offsets of their sub-shapes can follow.
+        std::vector<std::vector<size_t>> permutations(blendShapePointIndices.size());
+        data->indexStarts.reserve(blendShapePointIndices.size() + 1);
+        data->indexStarts.push_back(0);
+        for (size_t b = 0; b < blendShapePointIndices.size(); ++b)
+        {
+            const VtIntArray& indices = blendShapePointIndices[b];
+            std::vector<size_t>& permutation = permutations[b];
+            permutation.resize(indices.size());
+            for (size_t i = 0; i < permutation.size(); ++i)
+            {
+                permutation[i] = i;
+            }
+            std::stable_sort(permutation.begin(), permutation.end(),
+                             [&](size_t lhs, size_t rhs) { return indices[lhs] < indices[rhs]; });
+            for (size_t i : permutation)
+            {
+                data->pointIndices.push_back(indices[i]);
+            }
+            data->indexStarts.push_back(data->pointIndices.size());
+        }
+
+        data->offsetStarts.reserve(subShapePointOffsets.size() + 1);
+        data->offsetStarts.push_back(0);
+        for (size_t s = 0; s < subShapePointOffsets.size(); ++s)
+        {
+            const VtVec3fArray& offsets = subShapePointOffsets[s];
+            const size_t b = blendShapeQuery.GetBlendShapeIndex(s);
+            const std::vector<size_t>* permutation =
+                b < permutations.size() ? &permutations[b] : nullptr;
+            if (permutation && !permutation->empty())
+            {
+                // Sparse offsets must match their indices one to one.
+                if (offsets.size() == permutation->size())
+                {
+                    for (size_t i : *permutation)
+                    {
+                        data->offsets.push_back(offsets[i]);
+                    }
+                }
+            }
+            else
+            {
+                data->offsets.insert(data->offsets.end(), offsets.cbegin(), offsets.cend());
+            }
+            data->offsetStarts.push_back(data->offsets.size());
+        }
+
+        _blendShapeBytes.fetch_add(data->offsets.size() * sizeof(GfVec3f) +
+                                       data->pointIndices.size() * sizeof(int) +
+                                       (data->offsetStarts.size() + data->indexStarts.size()) *
+                                           sizeof(size_t),
+                                   std::memory_order_relaxed);
+        entry->data = data;
+    });
+    UsdKatanaCookStats::RecordCacheLookup(!computed);
+    return entry->data;
+}
+
+bool UsdKatanaSkinningCache::ApplyBlendShapes(const BlendShapeData& data,
+                                              TfSpan<const float> subShapeWeights,
+                                              TfSpan<const unsigned> blendShapeIndices,
+                                              TfSpan<const unsigned> subShapeIndices,
+                                              TfSpan<GfVec3f> points)
+{
+    TRACE_FUNCTION();
+
+    if (subShapeWeights.size() != blendShapeIndices.size() ||
+        subShapeWeights.size() != subShapeIndices.size())
+    {
+        return false;
+    }
+
+    struct ActiveShape
+    {
+        float weight;
+        size_t offsetStart;
+        size_t offsetEnd;
+        size_t indexStart;
+        size_t indexEnd;
+    };
+
+    // Most weights of a large rig are zero on any given frame; only the
+    // shapes that contribute are visited below.
+    std::vector<ActiveShape> activeShapes;
+    size_t work = 0;
+    for (size_t i = 0; i < subShapeWeights.size(); ++i)
+    {
+        const float weight = subShapeWeights[i];
+        const size_t subShape = subShapeIndices[i];
+        const size_t blendShape = blendShapeIndices[i];
+        if (weight == 0.0f || subShape + 1 >= data.offsetStarts.size() ||
+            blendShape + 1 >= data.indexStarts.size())
+        {
+            continue;
+        }
+        const ActiveShape shape{weight, data.offsetStarts[subShape],
+                                data.offsetStarts[subShape + 1], data.indexStarts[blendShape],
+                                data.indexStarts[blendShape + 1]};
+        if (shape.offsetEnd == shape.offsetStart)
+        {
+            continue;
+        }
+        activeShapes.push_back(shape);
+        work += shape.offsetEnd - shape.offsetStart;
+    }
+    if (activeShapes.empty())
+    {
+        return true;
+    }
+
+    const GfVec3f* offsets = data.offsets.data();
+    const int* pointIndices = data.pointIndices.data();
+    GfVec3f* pointsData = points.data();
+
+    // Each task owns a range of points and applies every active shape to
+    // that range, so no two tasks write the same point and the per point
+    // accumulation order matches a serial evaluation.
+    ParallelForPoints(points.size(), work, [&](size_t start, size_t end) {
+        for (const ActiveShape& shape : activeShapes)
+        {
+            if (shape.indexStart == shape.indexEnd)
+            {
+                const size_t numOffsets = shape.offsetEnd - shape.offsetStart;
+                const GfVec3f* shapeOffsets = offsets + shape.offsetStart;
+                for (size_t i = start, n = std::min(end, numOffsets); i < n; ++i)
+                {
+                    pointsData[i] += shapeOffsets[i] * shape.weight;
+                }
+                continue;
+            }
+
+            const int* first = pointIndices + shape.indexStart;
+            const int* last = pointIndices + shape.indexEnd;
+            const int* it = std::lower_bound(first, last, static_cast<int>(start));
+            const GfVec3f* shapeOffsets = offsets + shape.offsetStart;
+            for (; it != last && static_cast<size_t>(*it) < end; ++it)
+            {
+                pointsData[*it] += shapeOffsets[it - first] * shape.weight;
+            }
+        }
+    });
+    return true;
+}
+
+void UsdKatanaSkinningCache::Clear()
+{
+    _entries.clear();
+    _populatedRoots.clear();
+    _blendShapes.clear();
+    _numTransforms.store(0, std::memory_order_relaxed);
+    _blendShapeBytes.store(0, std::memory_order_relaxed);
+}
+
+size_t UsdKatanaSkinningCache::GetNumEntries() const
+{
+    return _entries.size() + _blendShapes.size();
+}
+
+size_t UsdKatanaSkinningCache::GetMemoryUsage() const
+{
+    return _entries.size() * (sizeof(_EntryMap::value_type) + sizeof(_Entry)) +
+           _numTransforms.load(std::memory_order_relaxed) * sizeof(GfMatrix4d) +
+           _blendShapes.size() *
+               (sizeof(_BlendShapeMap::value_type) + sizeof(_BlendShapeEntry)) +
+           _blendShapeBytes.load(std::memory_order_relaxed);
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
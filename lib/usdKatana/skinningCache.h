@@ -0,0 +1,251 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_SKINNINGCACHE_H
+#define USDKATANA_SKINNINGCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/tf/span.h>
+#include <pxr/base/vt/types.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usdSkel/blendShapeQuery.h>
+#include <pxr/usd/usdSkel/cache.h>
+#include <pxr/usd/usdSkel/root.h>
+#include <pxr/usd/usdSkel/skeletonQuery.h>
+#include <pxr/usd/usdSkel/skinningQuery.h>
+
+#include <tbb/concurrent_unordered_map.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// \brief Skinning state shared by every mesh cooked by a single UsdIn op
+/// instance.
+///
+/// Skinning transforms only depend on the skeleton and the time, so they are
+/// computed once per (skeleton instance, time) and reused by every mesh bound
+/// to that skeleton. Each entry is computed exactly once, even when several
+/// threads ask for it at the same time.
+///
+/// Blend shape offsets and point indices are static, so they are packed once
+/// per mesh and reused for every time sample.
+///
+/// The linear blend skinning itself is done by SkinPointsLBS(), which folds
+/// the geom bind transform and the skinning transform into one matrix per
+/// joint, blends those matrices per point in parallel blocks, and then brings
+/// the blended points from skeleton space into the local space of the mesh.
+/// That last transform is not folded into the joint matrices, as the result
+/// would differ from UsdSkel for weights that do not sum to one.
+class UsdKatanaSkinningCache
+{
+public:
+    /// Transforms of a skeleton instance at a given time.
+    struct SkelTransforms
+    {
+        /// Skinning transforms in skeleton space, in skeleton joint order.
+        VtMatrix4dArray skinningXforms;
+        /// Local to world transform of the skeleton instance.
+        GfMatrix4d skelLocalToWorld;
+        bool valid = false;
+    };
+
+    /// Blend shape data of a mesh, packed for accumulation.
+    ///
+    /// Offsets of all sub-shapes (blend shapes and their inbetweens) are
+    /// stored back to back. Sparse blend shapes have their point indices
+    /// sorted, with the offsets of every sub-shape permuted to match, so a
+    /// range of points can be updated without visiting the whole shape.
+    struct BlendShapeData
+    {
+        /// Offsets of sub-shape i are offsets[offsetStarts[i]..offsetStarts[i+1]).
+        std::vector<GfVec3f> offsets;
+        std::vector<size_t> offsetStarts;
+        /// Sorted point indices of blend shape b are
+        /// pointIndices[indexStarts[b]..indexStarts[b+1]). An empty range
+        /// means the blend shape applies to every point, in order.
+        std::vector<int> pointIndices;
+        std::vector<size_t> indexStarts;
+    };
+    typedef std::shared_ptr<const BlendShapeData> BlendShapeDataPtr;
+
+    USDKATANA_API UsdKatanaSkinningCache();
+    USDKATANA_API ~UsdKatanaSkinningCache();
+
+    UsdKatanaSkinningCache(const UsdKatanaSkinningCache&) = delete;
+    UsdKatanaSkinningCache& operator=(const UsdKatanaSkinningCache&) = delete;
+
+    /// Populates \p skelCache for \p skelRoot the first time a given root is
+    /// seen, instance proxies included.
+    USDKATANA_API void PopulateSkelRoot(const UsdSkelRoot& skelRoot, UsdSkelCache& skelCache);
+
+    /// Returns the transforms of \p skelQuery at \p time. \p skelInstancePrim
+    /// is the skeleton prim outside of any prototype, it identifies the
+    /// skeleton instance and provides its world transform.
+    USDKATANA_API const SkelTransforms& GetSkelTransforms(const UsdSkelSkeletonQuery& skelQuery,
+                                                          const UsdPrim& skelInstancePrim,
+                                                          double time);
+
+    /// Skins \p points, given in the rest pose of the mesh, at \p time and
+    /// returns them in the local space of the mesh. Falls back to
+    /// UsdSkelSkinningQuery::ComputeSkinnedPoints() for skinning methods
+    /// other than linear blend skinning.
+    USDKATANA_API bool SkinPoints(const UsdSkelSkinningQuery& skinningQuery,
+                                  const UsdSkelSkeletonQuery& skelQuery,
+                                  const UsdPrim& skelInstancePrim,
+                                  double time,
+                                  VtVec3fArray& points);
+
+    /// Computes one transform per joint of the mesh, in the joint order of
+    /// the mesh, which takes a rest point of the mesh to its skinned position
+    /// in skeleton space at \p time, and the transform \p skelToPrimLocal
+    /// from skeleton space to the local space of the mesh. These are the
+    /// transforms expected by SkinPointsLBS(). Returns false if the mesh does
+    /// not use linear blend skinning.
+    USDKATANA_API bool ComputeJointXforms(const UsdSkelSkinningQuery& skinningQuery,
+                                          const UsdSkelSkeletonQuery& skelQuery,
+                                          const UsdPrim& skelInstancePrim,
+                                          double time,
+                                          std::vector<GfMatrix4d>* jointXforms,
+                                          GfMatrix4d* skelToPrimLocal);
+
+    /// Returns true if \p skinningQuery uses linear blend skinning, the
+    /// only method SkinPointsLBS() implements.
+    USDKATANA_API static bool UsesLinearBlendSkinning(const UsdSkelSkinningQuery& skinningQuery);
+
+    /// Linear blend skinning of \p points, in place.
+    ///
+    /// \p jointXforms holds one transform per joint that takes a rest point
+    /// to its skinned position in skeleton space, and \p skelToPrimLocal
+    /// takes the blended points to the local space of the mesh.
+    /// \p jointIndices and \p jointWeights hold \p numInfluencesPerPoint
+    /// entries per point, or a single set of influences applied to every
+    /// point if \p constantInfluences is true. As in UsdSkel, a joint index
+    /// out of range is an error and issues a warning. \p points are left
+    /// untouched on failure.
+    USDKATANA_API static bool SkinPointsLBS(TfSpan<const GfMatrix4d> jointXforms,
+                                            const GfMatrix4d& skelToPrimLocal,
+                                            TfSpan<const int> jointIndices,
+                                            TfSpan<const float> jointWeights,
+                                            int numInfluencesPerPoint,
+                                            bool constantInfluences,
+                                            TfSpan<GfVec3f> points);
+
+    /// Returns the packed blend shape data for \p meshPrim, computing it the
+    /// first time the mesh and its blend shape targets are seen. Blend shape
+    /// offsets and indices are uniform, so the data is shared across times.
+    USDKATANA_API BlendShapeDataPtr GetBlendShapeData(const UsdSkelBlendShapeQuery& blendShapeQuery,
+                                                      const UsdPrim& meshPrim);
+
+    /// Adds the weighted offsets of the sub-shapes given by
+    /// \p blendShapeIndices and \p subShapeIndices to \p points, as
+    /// UsdSkelBlendShapeQuery::ComputeDeformedPoints() does. Sub-shapes with
+    /// a zero weight are skipped.
+    USDKATANA_API static bool ApplyBlendShapes(const BlendShapeData& data,
+                                               TfSpan<const float> subShapeWeights,
+                                               TfSpan<const unsigned> blendShapeIndices,
+                                               TfSpan<const unsigned> subShapeIndices,
+                                               TfSpan<GfVec3f> points);
+
+    /// Drops every cached entry. Must not be called while other threads are
+    /// using the cache.
+    USDKATANA_API void Clear();
+
+    /// Number of (skeleton instance, time) and blend shape entries held.
+    USDKATANA_API size_t GetNumEntries() const;
+
+    /// Approximate number of bytes held by the cached transforms.
+    USDKATANA_API size_t GetMemoryUsage() const;
+
+private:
+    struct _Key
+    {
+        SdfPath skelInstancePath;
+        double time;
+
+        bool operator==(const _Key& other) const
+        {
+            return skelInstancePath == other.skelInstancePath && time == other.time;
+        }
+    };
+
+    struct _KeyHash
+    {
+        size_t operator()(const _Key& key) const;
+    };
+
+    struct _Entry
+    {
+        std::once_flag once;
+        SkelTransforms transforms;
+    };
+
+    typedef tbb::concurrent_unordered_map<_Key, std::shared_ptr<_Entry>, _KeyHash> _EntryMap;
+    _EntryMap _entries;
+
+    typedef tbb::concurrent_unordered_map<SdfPath, std::shared_ptr<std::once_flag>, SdfPath::Hash>
+        _PopulatedRootMap;
+    _PopulatedRootMap _populatedRoots;
+
+    struct _BlendShapeKey
+    {
+        SdfPath meshPath;
+        SdfPathVector targets;
+
+        bool operator==(const _BlendShapeKey& other) const
+        {
+            return meshPath == other.meshPath && targets == other.targets;
+        }
+    };
+
+    struct _BlendShapeKeyHash
+    {
+        size_t operator()(const _BlendShapeKey& key) const;
+    };
+
+    struct _BlendShapeEntry
+    {
+        std::once_flag once;
+        BlendShapeDataPtr data;
+    };
+
+    typedef tbb::concurrent_unordered_map<_BlendShapeKey,
+                                          std::shared_ptr<_BlendShapeEntry>,
+                                          _BlendShapeKeyHash>
+        _BlendShapeMap;
+    _BlendShapeMap _blendShapes;
+
+    std::atomic<size_t> _numTransforms{0};
+    std::atomic<size_t> _blendShapeBytes{0};
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_SKINNINGCACHE_H
@@ -0,0 +1,281 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/staticAttrCache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/usd/pcp/layerStack.h>
+#include <pxr/usd/pcp/primIndex.h>
+#include <pxr/usd/usd/prim.h>
+
+#include "usdKatana/cookStats.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+TF_INSTANTIATE_SINGLETON(UsdKatanaStaticAttrCache);
+
+size_t UsdKatanaStaticAttrCache::_KeyHash::operator()(const _Key& key) const
+{
+    size_t hash = SdfPath::Hash()(key.attrPath);
+    boost::hash_combine(hash, key.name);
+    return hash;
+}
+
+UsdKatanaStaticAttrCache::UsdKatanaStaticAttrCache()
+{
+    UsdKatanaCache::GetInstance().RegisterMemoryReporter(
+        "staticAttr",
+        [this](UsdKatanaCacheMemoryUsageVector* usage) { _ReportMemoryUsage(usage); },
+        [this](size_t bytesToFree) { return _Evict(bytesToFree); });
+}
+
+UsdKatanaStaticAttrCache::~UsdKatanaStaticAttrCache() = default;
+
+FnAttribute::Attribute UsdKatanaStaticAttrCache::GetOrConvert(
+    const UsdKatanaUsdInPrivateData& data,
+    std::initializer_list<UsdAttribute> usdAttrs,
+    const char* name,
+    const std::function<FnAttribute::Attribute()>& convert)
+{
+    if (!data.GetUsdInArgs()->GetShareStaticData() || usdAttrs.size() == 0)
+    {
+        return convert();
+    }
+    for (const UsdAttribute& usdAttr : usdAttrs)
+    {
+        if (usdAttr && usdAttr.ValueMightBeTimeVarying())
+        {
+            return convert();
+        }
+    }
+
+    const UsdAttribute& keyAttr = *usdAttrs.begin();
+    if (!keyAttr)
+    {
+        return convert();
+    }
+    const UsdStagePtr stage = keyAttr.GetStage();
+    _Key key{keyAttr.GetPath(), name};
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto stageIt = _stages.find(get_pointer(stage));
+        if (stageIt != _stages.end() && stageIt->second.stage == stage)
+        {
+            const auto it = stageIt->second.entries.find(key);
+            if (it != stageIt->second.entries.end())
+            {
+                ++_numHits;
+                UsdKatanaCookStats::RecordCacheLookup(true);
+                return it->second;
+            }
+        }
+    }
+
+    TRACE_FUNCTION();
+
+    // Convert outside of the lock. Threads converting the same attribute
+    // concurrently produce the same result, the first one is kept.
+    ++_numMisses;
+    UsdKatanaCookStats::RecordCacheLookup(false);
+    FnAttribute::Attribute attr = convert();
+    uint64_t numAttributes = 0;
+    const size_t bytes = UsdKatanaCookStats::MeasureAttribute(attr, &numAttributes);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Drop the entries of the stages destroyed since.
+    for (auto it = _stages.begin(); it != _stages.end();)
+    {
+        it = it->second.stage ? std::next(it) : _stages.erase(it);
+    }
+
+    _StageEntries& stageEntries = _stages[get_pointer(stage)];
+    if (stageEntries.stage != stage)
+    {
+        // A stage destroyed since shared the address of this one.
+        stageEntries = _StageEntries();
+        stageEntries.stage = stage;
+    }
+    if (stageEntries.entries.emplace(std::move(key), attr).second)
+    {
+        stageEntries.bytes += bytes;
+    }
+    return attr;
+}
+
+void UsdKatanaStaticAttrCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stages.clear();
+}
+
+void UsdKatanaStaticAttrCache::ClearLayers(const std::set<SdfLayerHandle>& layers)
+{
+    TRACE_FUNCTION();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto stageIt = _stages.begin(); stageIt != _stages.end();)
+    {
+        _StageEntries& stageEntries = stageIt->second;
+        if (!stageEntries.stage)
+        {
+            stageIt = _stages.erase(stageIt);
+            continue;
+        }
+        const SdfLayerHandleVector usedLayers = stageEntries.stage->GetUsedLayers();
+        if (std::none_of(usedLayers.begin(), usedLayers.end(),
+                         [&layers](const SdfLayerHandle& layer) {
+                             return layers.count(layer) > 0;
+                         }))
+        {
+            ++stageIt;
+            continue;
+        }
+
+        // A layer in the layer stack of any node of the prim index may now
+        // hold opinions about the attribute, even if it held none before.
+        std::map<SdfPath, bool> primUsesLayers;
+        const auto usesLayers = [&](const SdfPath& primPath) {
+            const auto it = primUsesLayers.find(primPath);
+            if (it != primUsesLayers.end())
+            {
+                return it->second;
+            }
+            bool uses = true;
+            const UsdPrim prim = stageEntries.stage->GetPrimAtPath(primPath);
+            if (prim)
+            {
+                uses = false;
+                for (const PcpNodeRef& node : prim.GetPrimIndex().GetNodeRange())
+                {
+                    const PcpLayerStackPtr& layerStack = node.GetLayerStack();
+                    for (const SdfLayerHandle& layer : layers)
+                    {
+                        if (layerStack && layerStack->HasLayer(layer))
+                        {
+                            uses = true;
+                            break;
+                        }
+                    }
+                    if (uses)
+                    {
+                        break;
+                    }
+                }
+            }
+            primUsesLayers.emplace(primPath, uses);
+            return uses;
+        };
+
+        for (auto it = stageEntries.entries.begin(); it != stageEntries.entries.end();)
+        {
+            if (!usesLayers(it->first.attrPath.GetPrimPath()))
+            {
+                ++it;
+                continue;
+            }
+            uint64_t numAttributes = 0;
+            const size_t bytes = UsdKatanaCookStats::MeasureAttribute(it->second, &numAttributes);
+            stageEntries.bytes -= std::min(bytes, stageEntries.bytes);
+            it = stageEntries.entries.erase(it);
+        }
+        stageIt = stageEntries.entries.empty() ? _stages.erase(stageIt) : std::next(stageIt);
+    }
+}
+
+size_t UsdKatanaStaticAttrCache::GetNumEntries() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t numEntries = 0;
+    for (const auto& stageEntries : _stages)
+    {
+        numEntries += stageEntries.second.entries.size();
+    }
+    return numEntries;
+}
+
+size_t UsdKatanaStaticAttrCache::GetMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t bytes = 0;
+    for (const auto& stageEntries : _stages)
+    {
+        bytes += stageEntries.second.bytes;
+    }
+    return bytes;
+}
+
+void UsdKatanaStaticAttrCache::_ReportMemoryUsage(UsdKatanaCacheMemoryUsageVector* usage)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _stages.begin(); it != _stages.end();)
+    {
+        if (!it->second.stage)
+        {
+            it = _stages.erase(it);
+            continue;
+        }
+        UsdKatanaCacheMemoryUsage stageUsage;
+        stageUsage.cacheName = "staticAttr";
+        stageUsage.stage = it->second.stage->GetRootLayer()->GetIdentifier();
+        stageUsage.bytes = it->second.bytes;
+        stageUsage.numEntries = it->second.entries.size();
+        usage->push_back(stageUsage);
+        ++it;
+    }
+}
+
+size_t UsdKatanaStaticAttrCache::_Evict(size_t bytesToFree)
+{
+    // Drop the entries of whole stages, those of destroyed stages first.
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<std::map<const UsdStage*, _StageEntries>::iterator> stages;
+    for (auto it = _stages.begin(); it != _stages.end(); ++it)
+    {
+        stages.push_back(it);
+    }
+    std::stable_partition(stages.begin(), stages.end(),
+                          [](const auto& it) { return !it->second.stage; });
+
+    size_t bytesFreed = 0;
+    for (const auto& it : stages)
+    {
+        if (bytesFreed >= bytesToFree)
+        {
+            break;
+        }
+        bytesFreed += it->second.bytes;
+        _stages.erase(it);
+    }
+    return bytesFreed;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
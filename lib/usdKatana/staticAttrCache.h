@@ -0,0 +1,145 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_STATICATTRCACHE_H
+#define USDKATANA_STATICATTRCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include <pxr/base/tf/singleton.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/attribute.h>
+#include <pxr/usd/usd/stage.h>
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/api.h"
+#include "usdKatana/cache.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+class UsdKatanaUsdInPrivateData;
+
+/// \brief Katana attributes converted from time invariant USD attributes,
+/// shared by the cooks of every frame in the process.
+///
+/// Each frame is cooked with its own UsdKatanaUsdInArgs, so the caches those
+/// hold start empty at every frame. When a process renders a range of frames,
+/// the static attributes of the gprims, such as their topology, rest points
+/// and primvars, would then be read and converted again at every frame. With
+/// UsdKatanaUsdInArgs::GetShareStaticData() set, the readers convert the USD
+/// attributes which cannot vary over time once per stage instead, and only
+/// read the others at every frame.
+///
+/// The entries of a destroyed stage are dropped the next time an attribute is
+/// converted, or when the memory is reported. All entries are dropped when
+/// Clear() is called, the entries composed from reloaded layers when
+/// ClearLayers() is called, and the entries of whole stages when the memory
+/// budget of UsdKatanaCache needs the memory.
+class UsdKatanaStaticAttrCache : public TfSingleton<UsdKatanaStaticAttrCache>
+{
+    friend class TfSingleton<UsdKatanaStaticAttrCache>;
+
+    UsdKatanaStaticAttrCache();
+    ~UsdKatanaStaticAttrCache();
+
+public:
+    USDKATANA_API static UsdKatanaStaticAttrCache& GetInstance()
+    {
+        return TfSingleton<UsdKatanaStaticAttrCache>::GetInstance();
+    }
+
+    /// Returns the result of \p convert, which reads \p usdAttrs for the prim
+    /// of \p data. If the args of \p data share static data and none of
+    /// \p usdAttrs might vary over time, the result is computed once per
+    /// stage, first attribute and \p name, which identifies \p convert.
+    /// The first attribute must exist, the others do not have to.
+    USDKATANA_API FnAttribute::Attribute GetOrConvert(
+        const UsdKatanaUsdInPrivateData& data,
+        std::initializer_list<UsdAttribute> usdAttrs,
+        const char* name,
+        const std::function<FnAttribute::Attribute()>& convert);
+
+    /// Drops every entry.
+    USDKATANA_API void Clear();
+
+    /// Drops the entries of the prims whose composition uses any of
+    /// \p layers, such as after UsdKatanaCache::ReloadChangedLayers()
+    /// reloaded them, and keeps the others. The caller must hold the stage
+    /// lock.
+    USDKATANA_API void ClearLayers(const std::set<SdfLayerHandle>& layers);
+
+    USDKATANA_API size_t GetNumEntries() const;
+
+    /// Approximate number of bytes held by the cached attributes.
+    USDKATANA_API size_t GetMemoryUsage() const;
+
+    size_t GetNumHits() const { return _numHits; }
+    size_t GetNumMisses() const { return _numMisses; }
+
+private:
+    struct _Key
+    {
+        SdfPath attrPath;
+        std::string name;
+
+        bool operator==(const _Key& other) const
+        {
+            return attrPath == other.attrPath && name == other.name;
+        }
+    };
+
+    struct _KeyHash
+    {
+        size_t operator()(const _Key& key) const;
+    };
+
+    struct _StageEntries
+    {
+        UsdStageWeakPtr stage;
+        std::unordered_map<_Key, FnAttribute::Attribute, _KeyHash> entries;
+        size_t bytes = 0;
+    };
+
+    void _ReportMemoryUsage(UsdKatanaCacheMemoryUsageVector* usage);
+    size_t _Evict(size_t bytesToFree);
+
+    mutable std::mutex _mutex;
+    std::map<const UsdStage*, _StageEntries> _stages;
+
+    std::atomic<size_t> _numHits{0};
+    std::atomic<size_t> _numMisses{0};
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_STATICATTRCACHE_H
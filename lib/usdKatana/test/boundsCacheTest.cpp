@@ -0,0 +1,203 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "pxr/base/gf/range3d.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/bboxCache.h"
+#include "pxr/usd/usdGeom/modelAPI.h"
+#include "pxr/usd/usdGeom/tokens.h"
+
+#include "usdKatana/boundsCache.h"
+#include "usdKatana/usdInArgs.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace BoundsCacheTests
+{
+const TfTokenVector kPurposes = {UsdGeomTokens->default_, UsdGeomTokens->render};
+
+TEST(BoundsCacheTest, MatchesBBoxCache)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/bounds1.usda");
+    UsdPrim setPrim = stage->GetPrimAtPath(SdfPath("/root/set"));
+    ASSERT_TRUE(static_cast<bool>(setPrim));
+
+    UsdKatanaBoundsCache boundsCache;
+    for (double time : {1.0, 2.0})
+    {
+        UsdGeomBBoxCache bboxCache(time, kPurposes, true);
+        const GfRange3d expected = bboxCache.ComputeUntransformedBound(setPrim).ComputeAlignedRange();
+        const GfRange3d actual =
+            boundsCache.ComputeBound(setPrim, time, kPurposes, false).ComputeAlignedRange();
+        ASSERT_EQ(expected, actual);
+    }
+
+    // The proxy cube must not contribute with the default purposes.
+    const GfRange3d range =
+        boundsCache.ComputeBound(setPrim, 2.0, kPurposes, false).ComputeAlignedRange();
+    ASSERT_EQ(range.GetMin(), GfVec3d(-1, -1, -1));
+    ASSERT_EQ(range.GetMax(), GfVec3d(6, 11, 1));
+}
+
+TEST(BoundsCacheTest, ComputesEachEntryOnce)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/bounds1.usda");
+    UsdPrim setPrim = stage->GetPrimAtPath(SdfPath("/root/set"));
+    UsdPrim cubePrim = stage->GetPrimAtPath(SdfPath("/root/set/cubeA"));
+    ASSERT_TRUE(static_cast<bool>(cubePrim));
+
+    UsdKatanaBoundsCache boundsCache;
+    boundsCache.ComputeBound(setPrim, 1.0, kPurposes, false);
+    ASSERT_EQ(boundsCache.GetNumMisses(), 1u);
+
+    // Children are published when their parent is computed.
+    boundsCache.ComputeBound(cubePrim, 1.0, kPurposes, false);
+    boundsCache.ComputeBound(setPrim, 1.0, kPurposes, false);
+    ASSERT_EQ(boundsCache.GetNumMisses(), 1u);
+    ASSERT_EQ(boundsCache.GetNumHits(), 2u);
+    ASSERT_GT(boundsCache.GetNumEntries(), 1u);
+    ASSERT_GT(boundsCache.GetMemoryUsage(), 0u);
+
+    boundsCache.Clear();
+    ASSERT_EQ(boundsCache.GetNumEntries(), 0u);
+}
+
+TEST(BoundsCacheTest, ConcurrentLookups)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/bounds1.usda");
+    UsdPrim rootPrim = stage->GetPrimAtPath(SdfPath("/root"));
+    UsdGeomBBoxCache bboxCache(2.0, kPurposes, true);
+    const GfRange3d expected = bboxCache.ComputeUntransformedBound(rootPrim).ComputeAlignedRange();
+
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.currentTime = 1.0;
+    auto usdInArgs = usdInArgsBuilder.build();
+
+    const size_t numLookups = 256;
+    std::vector<GfRange3d> results(numLookups);
+    WorkParallelForN(numLookups, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            results[i] = usdInArgs->ComputeBounds(rootPrim, {1.0})[0].ComputeAlignedRange();
+        }
+    });
+
+    for (const GfRange3d& result : results)
+    {
+        ASSERT_EQ(result, expected);
+    }
+    ASSERT_EQ(usdInArgs->GetBoundsCache().GetNumMisses(), 1u);
+}
+
+TEST(BoundsCacheTest, AuthoredExtentsMode)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/bounds1.usda");
+    UsdPrim hintedPrim = stage->GetPrimAtPath(SdfPath("/root/hinted"));
+    UsdPrim unhintedPrim = stage->GetPrimAtPath(SdfPath("/root/unhinted"));
+    ASSERT_TRUE(static_cast<bool>(hintedPrim));
+    ASSERT_TRUE(static_cast<bool>(unhintedPrim));
+    ASSERT_TRUE(UsdKatanaBoundsCache::HasAuthoredExtents(hintedPrim));
+    ASSERT_FALSE(UsdKatanaBoundsCache::HasAuthoredExtents(unhintedPrim));
+
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.currentTime = 1.0;
+    usdInArgsBuilder.useAuthoredExtents = true;
+    usdInArgsBuilder.authorExtentsHints = true;
+    auto usdInArgs = usdInArgsBuilder.build();
+    UsdKatanaBoundsCache& boundsCache = usdInArgs->GetBoundsCache();
+
+    GfRange3d range = usdInArgs->ComputeBounds(hintedPrim, {0.0})[0].ComputeAlignedRange();
+    ASSERT_EQ(range, GfRange3d(GfVec3d(-3, -3, -3), GfVec3d(3, 3, 3)));
+    ASSERT_FALSE(boundsCache.HasMissingExtentsHints());
+
+    range = usdInArgs->ComputeBounds(unhintedPrim, {0.0})[0].ComputeAlignedRange();
+    ASSERT_EQ(range, GfRange3d(GfVec3d(-1, -1, -1), GfVec3d(1, 1, 1)));
+    ASSERT_TRUE(boundsCache.HasMissingExtentsHints());
+
+    ASSERT_EQ(boundsCache.AuthorMissingExtentsHints(stage), 1u);
+    ASSERT_FALSE(boundsCache.HasMissingExtentsHints());
+
+    // The hint lives in a sublayer, the session layer itself is left alone.
+    const SdfLayerHandle sessionLayer = stage->GetSessionLayer();
+    ASSERT_EQ(sessionLayer->GetNumSubLayerPaths(), 1u);
+    ASSERT_FALSE(sessionLayer->GetPrimAtPath(unhintedPrim.GetPath()));
+
+    // The authored hint is a default value, valid at every time.
+    VtVec3fArray extentsHint;
+    ASSERT_TRUE(UsdGeomModelAPI(unhintedPrim).GetExtentsHint(&extentsHint, 2.0));
+    ASSERT_GE(extentsHint.size(), 2u);
+    ASSERT_EQ(extentsHint[0], GfVec3f(-1, -1, -1));
+    ASSERT_EQ(extentsHint[1], GfVec3f(1, 1, 1));
+    ASSERT_EQ(UsdGeomModelAPI(unhintedPrim).GetExtentsHintAttr().GetNumTimeSamples(), 0u);
+}
+
+TEST(BoundsCacheTest, AuthoredExtentsHintsAtOtherTimes)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/bounds1.usda");
+    UsdPrim animatedPrim = stage->GetPrimAtPath(SdfPath("/root/animated"));
+    UsdPrim unhintedPrim = stage->GetPrimAtPath(SdfPath("/root/unhinted"));
+    ASSERT_TRUE(static_cast<bool>(animatedPrim));
+    ASSERT_FALSE(UsdKatanaBoundsCache::HasStaticBounds(animatedPrim));
+    ASSERT_TRUE(UsdKatanaBoundsCache::HasStaticBounds(unhintedPrim));
+
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.currentTime = 1.0;
+    usdInArgsBuilder.useAuthoredExtents = true;
+    usdInArgsBuilder.authorExtentsHints = true;
+    auto authoringArgs = usdInArgsBuilder.build();
+    authoringArgs->ComputeBounds(animatedPrim, {0.0});
+    authoringArgs->ComputeBounds(unhintedPrim, {0.0});
+
+    // Only the static model gets a hint.
+    UsdKatanaBoundsCache& boundsCache = authoringArgs->GetBoundsCache();
+    ASSERT_EQ(boundsCache.AuthorMissingExtentsHints(stage), 1u);
+    ASSERT_FALSE(UsdGeomModelAPI(animatedPrim).GetExtentsHintAttr().HasAuthoredValue());
+    ASSERT_TRUE(UsdGeomModelAPI(unhintedPrim).GetExtentsHintAttr().HasAuthoredValue());
+
+    // Bounds computed at another time still follow the animation.
+    usdInArgsBuilder.currentTime = 2.0;
+    auto usdInArgs = usdInArgsBuilder.build();
+    UsdGeomBBoxCache bboxCache(2.0, kPurposes, /* useExtentsHint */ false);
+    for (const UsdPrim& prim : {animatedPrim, unhintedPrim})
+    {
+        ASSERT_EQ(usdInArgs->ComputeBounds(prim, {0.0})[0].ComputeAlignedRange(),
+                  bboxCache.ComputeUntransformedBound(prim).ComputeAlignedRange());
+    }
+    const GfRange3d range =
+        usdInArgs->ComputeBounds(animatedPrim, {0.0})[0].ComputeAlignedRange();
+    ASSERT_EQ(range, GfRange3d(GfVec3d(-1, 9, -1), GfVec3d(1, 11, 1)));
+
+    // The authored hints are removed when the layers are reloaded.
+    ASSERT_EQ(boundsCache.RemoveAuthoredExtentsHints(stage), 1u);
+    ASSERT_FALSE(UsdGeomModelAPI(unhintedPrim).GetExtentsHintAttr().HasAuthoredValue());
+    ASSERT_EQ(stage->GetSessionLayer()->GetNumSubLayerPaths(), 0u);
+    ASSERT_EQ(boundsCache.RemoveAuthoredExtentsHints(stage), 0u);
+}
+
+TEST(BoundsCacheTest, AuthoredExtentsHintOfHiddenModel)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/bounds1.usda");
+    UsdPrim hiddenPrim = stage->GetPrimAtPath(SdfPath("/root/hidden/hinted"));
+    ASSERT_TRUE(UsdKatanaBoundsCache::HasAuthoredExtents(hiddenPrim));
+
+    // The model inherits the visibility of its parent, which its extentsHint
+    // knows nothing about.
+    UsdKatanaBoundsCache boundsCache;
+    const GfBBox3d bound = boundsCache.ComputeBound(hiddenPrim, 1.0, kPurposes, false,
+                                                    /* useAuthoredExtents */ true);
+    ASSERT_TRUE(bound.GetRange().IsEmpty());
+}
+
+}  // namespace BoundsCacheTests
+PXR_NAMESPACE_CLOSE_SCOPE
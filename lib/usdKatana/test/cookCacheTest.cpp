@@ -0,0 +1,222 @@
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "pxr/base/arch/fileSystem.h"
+#include "pxr/base/tf/fileUtils.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/mesh.h"
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/cookCache.h"
+#include "usdKatana/readMesh.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace CookCacheTests
+{
+// Reads the mesh at \p path at \p time through the cook cache, and returns
+// whether the reader had to run.
+bool ReadMesh(const UsdStageRefPtr& stage,
+              const std::string& path,
+              double time,
+              const FnAttribute::GroupAttribute& opArgs,
+              FnAttribute::GroupAttribute* result)
+{
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.currentTime = time;
+    usdInArgsBuilder.motionSampleTimes = {0.0};
+    auto usdInArgs = usdInArgsBuilder.build();
+
+    const UsdPrim prim = stage->GetPrimAtPath(SdfPath(path));
+    const UsdKatanaUsdInPrivateData privateData(prim, usdInArgs);
+    UsdKatanaAttrMap attrs;
+    bool read = false;
+    UsdKatanaCookCache::GetInstance().ReadCached(
+        opArgs, "UsdKatanaReadMesh", privateData, attrs, [&](UsdKatanaAttrMap& meshAttrs) {
+            read = true;
+            UsdKatanaReadMesh(UsdGeomMesh(prim), privateData, meshAttrs);
+        });
+    *result = attrs.build();
+    return read;
+}
+
+TEST(CookCacheTest, RoundTrip)
+{
+    const std::string cacheDir = ArchMakeTmpSubdir(ArchGetTmpDir(), "cookCacheTest");
+    ASSERT_FALSE(cacheDir.empty());
+    const FnAttribute::GroupAttribute opArgs(
+        "cookCacheDir", FnAttribute::StringAttribute(cacheDir), true);
+
+    UsdStageRefPtr stage = UsdStage::Open("test/cookCache1.usda");
+    UsdKatanaCookCache& cookCache = UsdKatanaCookCache::GetInstance();
+
+    FnAttribute::GroupAttribute expected;
+    FnAttribute::GroupAttribute cached;
+    ASSERT_TRUE(ReadMesh(stage, "/root/static", 1.0, opArgs, &expected));
+    ASSERT_TRUE(ReadMesh(stage, "/root/animated", 1.0, opArgs, &cached));
+
+    // Static prims are shared by all frames, animated ones are not cached.
+    ASSERT_FALSE(ReadMesh(stage, "/root/static", 2.0, opArgs, &cached));
+    ASSERT_EQ(cached.getHash(), expected.getHash());
+    ASSERT_TRUE(ReadMesh(stage, "/root/animated", 1.0, opArgs, &cached));
+
+    // Written entries are read back from the file.
+    ASSERT_EQ(cookCache.Flush(), 1u);
+    cookCache.Clear();
+    ASSERT_FALSE(ReadMesh(stage, "/root/static", 1.0, opArgs, &cached));
+    ASSERT_EQ(cached.getHash(), expected.getHash());
+    ASSERT_TRUE(ReadMesh(stage, "/root/animated", 1.0, opArgs, &cached));
+
+    // Editing the layer invalidates the entries of the prims composed from it.
+    stage->GetRootLayer()->SetComment("edited");
+    cookCache.Clear();
+    ASSERT_TRUE(ReadMesh(stage, "/root/static", 1.0, opArgs, &cached));
+
+    // Without a directory the cache is not used.
+    ASSERT_TRUE(ReadMesh(stage, "/root/static", 1.0, FnAttribute::GroupAttribute(), &cached));
+
+    cookCache.Clear();
+    TfRmTree(cacheDir);
+}
+
+TEST(CookCacheTest, CollectionBindings)
+{
+    const std::string cacheDir = ArchMakeTmpSubdir(ArchGetTmpDir(), "cookCacheTest");
+    ASSERT_FALSE(cacheDir.empty());
+    const FnAttribute::GroupAttribute opArgs(
+        "cookCacheDir", FnAttribute::StringAttribute(cacheDir), true);
+
+    // The collection and the material live in a layer the bound prim is not
+    // composed from.
+    SdfLayerRefPtr looksLayer = SdfLayer::CreateAnonymous(".usda");
+    ASSERT_TRUE(looksLayer->ImportFromString(R"(#usda 1.0
+def Scope "looks" (
+    prepend apiSchemas = ["CollectionAPI:red"]
+)
+{
+    rel collection:red:includes = </root/bound>
+    def Material "red"
+    {
+    }
+}
+)"));
+    SdfLayerRefPtr rootLayer = SdfLayer::CreateAnonymous(".usda");
+    ASSERT_TRUE(rootLayer->ImportFromString(R"(#usda 1.0
+def Xform "root"
+{
+    def Mesh "bound" (
+        prepend apiSchemas = ["MaterialBindingAPI"]
+    )
+    {
+        rel material:binding:collection:red = [</looks.collection:red>, </looks/red>]
+        int[] faceVertexCounts = [3]
+        int[] faceVertexIndices = [0, 1, 2]
+        point3f[] points = [(0, 0, 0), (1, 0, 0), (1, 1, 0)]
+    }
+
+    def Mesh "unbound"
+    {
+        int[] faceVertexCounts = [3]
+        int[] faceVertexIndices = [0, 1, 2]
+        point3f[] points = [(0, 0, 0), (1, 0, 0), (1, 1, 0)]
+    }
+}
+)"));
+    rootLayer->SetSubLayerPaths({looksLayer->GetIdentifier()});
+    UsdStageRefPtr stage = UsdStage::Open(rootLayer);
+    UsdKatanaCookCache& cookCache = UsdKatanaCookCache::GetInstance();
+
+    FnAttribute::GroupAttribute result;
+    ASSERT_TRUE(ReadMesh(stage, "/root/bound", 1.0, opArgs, &result));
+    ASSERT_TRUE(ReadMesh(stage, "/root/unbound", 1.0, opArgs, &result));
+    ASSERT_FALSE(ReadMesh(stage, "/root/bound", 1.0, opArgs, &result));
+
+    // Editing the layer of the collection only invalidates the bound prim.
+    looksLayer->SetComment("edited");
+    cookCache.ClearLayerHashes();
+    ASSERT_TRUE(ReadMesh(stage, "/root/bound", 1.0, opArgs, &result));
+    ASSERT_FALSE(ReadMesh(stage, "/root/unbound", 1.0, opArgs, &result));
+
+    cookCache.Clear();
+    TfRmTree(cacheDir);
+}
+
+TEST(CookCacheTest, AppendsNewEntries)
+{
+    const std::string cacheDir = ArchMakeTmpSubdir(ArchGetTmpDir(), "cookCacheTest");
+    ASSERT_FALSE(cacheDir.empty());
+    const FnAttribute::GroupAttribute opArgs(
+        "cookCacheDir", FnAttribute::StringAttribute(cacheDir), true);
+
+    SdfLayerRefPtr rootLayer = SdfLayer::CreateAnonymous(".usda");
+    ASSERT_TRUE(rootLayer->ImportFromString(R"(#usda 1.0
+def Xform "root"
+{
+    def Mesh "first"
+    {
+        int[] faceVertexCounts = [3]
+        int[] faceVertexIndices = [0, 1, 2]
+        point3f[] points = [(0, 0, 0), (1, 0, 0), (1, 1, 0)]
+    }
+
+    def Mesh "second"
+    {
+        int[] faceVertexCounts = [3]
+        int[] faceVertexIndices = [0, 1, 2]
+        point3f[] points = [(0, 0, 1), (1, 0, 1), (1, 1, 1)]
+    }
+}
+)"));
+    UsdStageRefPtr stage = UsdStage::Open(rootLayer);
+    UsdKatanaCookCache& cookCache = UsdKatanaCookCache::GetInstance();
+
+    FnAttribute::GroupAttribute result;
+    ASSERT_TRUE(ReadMesh(stage, "/root/first", 1.0, opArgs, &result));
+    ASSERT_EQ(cookCache.Flush(), 1u);
+    const std::vector<std::string> files = TfListDir(cacheDir);
+    ASSERT_EQ(files.size(), 1u);
+    const int64_t firstSize = ArchGetFileLength(files[0].c_str());
+
+    // The second flush appends the new entry only.
+    cookCache.Clear();
+    ASSERT_FALSE(ReadMesh(stage, "/root/first", 1.0, opArgs, &result));
+    ASSERT_TRUE(ReadMesh(stage, "/root/second", 1.0, opArgs, &result));
+    ASSERT_EQ(cookCache.Flush(), 1u);
+    const int64_t secondSize = ArchGetFileLength(files[0].c_str());
+    ASSERT_GT(secondSize, firstSize);
+    ASSERT_LT(secondSize, 2 * firstSize);
+
+    // A segment another process is still appending is ignored.
+    {
+        std::ofstream file(files[0], std::ios::binary | std::ios::app);
+        file.write("UKCC", 4);
+    }
+    cookCache.Clear();
+    ASSERT_FALSE(ReadMesh(stage, "/root/first", 1.0, opArgs, &result));
+    ASSERT_FALSE(ReadMesh(stage, "/root/second", 1.0, opArgs, &result));
+
+    // Entries are not appended after it, where they would be ignored, the
+    // file is compacted instead.
+    rootLayer->SetComment("edited");
+    cookCache.ClearLayerHashes();
+    ASSERT_TRUE(ReadMesh(stage, "/root/first", 1.0, opArgs, &result));
+    ASSERT_EQ(cookCache.Flush(), 1u);
+    cookCache.Clear();
+    ASSERT_FALSE(ReadMesh(stage, "/root/first", 1.0, opArgs, &result));
+
+    cookCache.Clear();
+    TfRmTree(cacheDir);
+}
+
+}  // namespace CookCacheTests
+PXR_NAMESPACE_CLOSE_SCOPE
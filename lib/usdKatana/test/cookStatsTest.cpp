@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+
+#include "pxr/base/work/loops.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/tokens.h"
+
+#include "usdKatana/boundsCache.h"
+#include "usdKatana/cookStats.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace CookStatsTests
+{
+TEST(CookStatsTest, RecordsOnlyInScope)
+{
+    const FnAttribute::FloatAttribute attr(1.0f);
+    UsdKatanaCookStats::RecordAttribute(attr);
+    ASSERT_EQ(UsdKatanaCookStats::GetCurrent(), nullptr);
+
+    UsdKatanaCookStats outer;
+    UsdKatanaCookStats inner;
+    {
+        UsdKatanaCookStatsScope outerScope(&outer);
+        UsdKatanaCookStats::RecordAttribute(FnAttribute::GroupBuilder()
+                                                .set("a", FnAttribute::DoubleAttribute(1.0))
+                                                .set("b.c", FnAttribute::IntAttribute(1))
+                                                .build());
+        {
+            UsdKatanaCookStatsScope innerScope(&inner);
+            UsdKatanaCookStats::RecordMotionSamples(2);
+            UsdKatanaCookStats::RecordPayloadLoad();
+        }
+        ASSERT_EQ(UsdKatanaCookStats::GetCurrent(), &outer);
+        UsdKatanaCookStats::RecordCacheLookup(true);
+    }
+    ASSERT_EQ(UsdKatanaCookStats::GetCurrent(), nullptr);
+
+    ASSERT_EQ(outer.attributeCount, 2u);
+    ASSERT_EQ(outer.attributeBytes, sizeof(double) + sizeof(int32_t));
+    ASSERT_EQ(outer.motionSamples, 0u);
+    ASSERT_EQ(outer.cacheHits, 1u);
+    ASSERT_EQ(inner.motionSamples, 2u);
+    ASSERT_EQ(inner.payloadLoads, 1u);
+    ASSERT_EQ(inner.attributeCount, 0u);
+}
+
+TEST(CookStatsTest, RecordsFromTasks)
+{
+    UsdKatanaCookStats stats;
+    {
+        UsdKatanaCookStatsScope scope(&stats);
+        UsdKatanaCookStats* current = UsdKatanaCookStats::GetCurrent();
+        WorkParallelForN(
+            1000,
+            [current](size_t begin, size_t end) {
+                UsdKatanaCookStatsTaskScope taskScope(current);
+                for (size_t i = begin; i < end; ++i)
+                {
+                    UsdKatanaCookStats::RecordCacheLookup(i % 2 == 0);
+                }
+            },
+            1);
+        ASSERT_EQ(UsdKatanaCookStats::GetCurrent(), &stats);
+    }
+
+    ASSERT_EQ(stats.cacheHits, 500u);
+    ASSERT_EQ(stats.cacheMisses, 500u);
+
+    // Tasks dispatched without statistics record nothing.
+    WorkParallelForN(10, [](size_t, size_t) {
+        UsdKatanaCookStatsTaskScope taskScope(nullptr);
+        ASSERT_EQ(UsdKatanaCookStats::GetCurrent(), nullptr);
+    });
+}
+
+TEST(CookStatsTest, AttrRoundTrip)
+{
+    UsdKatanaCookStats stats;
+    stats.cookSeconds = 0.5;
+    stats.attributeBytes = 1024;
+    stats.cacheMisses = 3;
+
+    UsdKatanaCookStats total = UsdKatanaCookStats::FromAttr(stats.BuildAttr());
+    total.Add(stats);
+    ASSERT_EQ(total.cookSeconds, 1.0);
+    ASSERT_EQ(total.attributeBytes, 2048u);
+    ASSERT_EQ(total.cacheMisses, 6u);
+    ASSERT_EQ(total.cacheHits, 0u);
+}
+
+TEST(CookStatsTest, CountsCacheLookups)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/bounds1.usda");
+    UsdPrim setPrim = stage->GetPrimAtPath(SdfPath("/root/set"));
+    ASSERT_TRUE(static_cast<bool>(setPrim));
+    const TfTokenVector purposes = {UsdGeomTokens->default_};
+
+    UsdKatanaBoundsCache boundsCache;
+    UsdKatanaCookStats stats;
+    {
+        UsdKatanaCookStatsScope statsScope(&stats);
+        boundsCache.ComputeBound(setPrim, 1.0, purposes, false);
+        boundsCache.ComputeBound(setPrim, 1.0, purposes, false);
+    }
+    ASSERT_EQ(stats.cacheMisses, 1u);
+    ASSERT_EQ(stats.cacheHits, 1u);
+}
+
+}  // namespace CookStatsTests
+PXR_NAMESPACE_CLOSE_SCOPE
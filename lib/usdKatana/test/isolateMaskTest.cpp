@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/cache.h"
+#include "usdKatana/locks.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace IsolateMaskTests
+{
+UsdStageRefPtr GetStage(const std::string& isolatePath)
+{
+    boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+    return UsdKatanaCache::GetInstance().GetStage("test/isolate1.usda",
+                                                  FnAttribute::GroupAttribute(true), "/root/world",
+                                                  isolatePath, "", true);
+}
+
+TEST(IsolateMaskTest, MasksToIsolatePathAndTargets)
+{
+    const UsdStageRefPtr stage = GetStage("/World/charA");
+    ASSERT_TRUE(static_cast<bool>(stage));
+    ASSERT_TRUE(stage->GetPrimAtPath(SdfPath("/World/charA/body")));
+    ASSERT_FALSE(stage->GetPrimAtPath(SdfPath("/World/charB")));
+
+    // The bound material and the shaders it connects to are included.
+    ASSERT_TRUE(stage->GetPrimAtPath(SdfPath("/Looks/skin/surface")));
+    ASSERT_FALSE(stage->GetPrimAtPath(SdfPath("/Looks/unused")));
+}
+
+TEST(IsolateMaskTest, PartOfCacheKey)
+{
+    const UsdStageRefPtr stage = GetStage("/World/charA");
+    ASSERT_EQ(GetStage("/World/charA"), stage);
+
+    const UsdStageRefPtr otherStage = GetStage("/World/charB");
+    ASSERT_NE(otherStage, stage);
+    ASSERT_TRUE(otherStage->GetPrimAtPath(SdfPath("/World/charB/body")));
+    ASSERT_FALSE(otherStage->GetPrimAtPath(SdfPath("/Looks/skin")));
+
+    const UsdStageRefPtr fullStage = GetStage("");
+    ASSERT_TRUE(fullStage->GetPrimAtPath(SdfPath("/Looks/unused")));
+}
+
+// The targets of the prims brought in by a payload are added to the mask once
+// the payload is loaded.
+TEST(IsolateMaskTest, ExpandedAfterPayloadLoad)
+{
+    boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetStageLock());
+    const UsdStageRefPtr stage = UsdKatanaCache::GetInstance().GetStage(
+        "test/isolatePayload1.usda", FnAttribute::GroupAttribute(true), "/root/world",
+        "/World/charA", "", false);
+    ASSERT_TRUE(static_cast<bool>(stage));
+    ASSERT_FALSE(stage->GetPrimAtPath(SdfPath("/World/charA/body")));
+    ASSERT_FALSE(stage->GetPrimAtPath(SdfPath("/Looks/skin")));
+
+    // Nothing below an unloaded prim targets prims outside of the mask.
+    const UsdStagePopulationMask mask = stage->GetPopulationMask();
+    UsdKatanaCache::ExpandPopulationMask(stage, SdfPath("/World/charA"));
+    ASSERT_EQ(stage->GetPopulationMask(), mask);
+
+    const SdfPath charAPath("/World/charA");
+    stage->Load(charAPath);
+    UsdKatanaCache::ExpandPopulationMask(stage, charAPath);
+    ASSERT_TRUE(stage->GetPrimAtPath(SdfPath("/World/charA/body")));
+    ASSERT_TRUE(stage->GetPrimAtPath(SdfPath("/Looks/skin/surface")));
+    ASSERT_FALSE(stage->GetPrimAtPath(SdfPath("/Looks/unused")));
+}
+
+}  // namespace IsolateMaskTests
+PXR_NAMESPACE_CLOSE_SCOPE
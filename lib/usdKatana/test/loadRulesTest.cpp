@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/cache.h"
+#include "usdKatana/locks.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace LoadRulesTests
+{
+UsdStageRefPtr GetStage(const FnAttribute::GroupAttribute& loadRulesAttr)
+{
+    boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+    return UsdKatanaCache::GetInstance().GetStage(
+        "test/loadRules1.usda", FnAttribute::GroupAttribute("loadRules", loadRulesAttr, true),
+        "/root/world", "", "", true);
+}
+
+bool IsLoaded(const UsdStageRefPtr& stage, const char* path)
+{
+    const UsdPrim prim = stage->GetPrimAtPath(SdfPath(path));
+    return prim && prim.IsLoaded();
+}
+
+TEST(LoadRulesTest, PathRules)
+{
+    const UsdStageRefPtr stage = GetStage(FnAttribute::GroupAttribute(
+        "rules", FnAttribute::StringAttribute(std::vector<std::string>{"/World/setA", "none"}, 2),
+        true));
+    ASSERT_TRUE(static_cast<bool>(stage));
+    ASSERT_FALSE(IsLoaded(stage, "/World/setA"));
+    ASSERT_FALSE(stage->GetPrimAtPath(SdfPath("/World/setA/propA")));
+    ASSERT_TRUE(IsLoaded(stage, "/World/propB"));
+}
+
+TEST(LoadRulesTest, StopAtKind)
+{
+    const UsdStageRefPtr stage = GetStage(FnAttribute::GroupAttribute(
+        "stopAtKind", FnAttribute::StringAttribute("subcomponent"), true));
+    ASSERT_TRUE(IsLoaded(stage, "/World/setA"));
+    ASSERT_TRUE(IsLoaded(stage, "/World/setA/propA"));
+    ASSERT_TRUE(IsLoaded(stage, "/World/propB"));
+    ASSERT_FALSE(IsLoaded(stage, "/World/setA/detail"));
+}
+
+TEST(LoadRulesTest, MaxDepth)
+{
+    UsdStageRefPtr stage =
+        GetStage(FnAttribute::GroupAttribute("maxDepth", FnAttribute::IntAttribute(1), true));
+    ASSERT_FALSE(IsLoaded(stage, "/World/setA"));
+    ASSERT_FALSE(IsLoaded(stage, "/World/propB"));
+
+    stage = GetStage(FnAttribute::GroupAttribute("maxDepth", FnAttribute::IntAttribute(2), true));
+    ASSERT_TRUE(IsLoaded(stage, "/World/setA"));
+    ASSERT_TRUE(IsLoaded(stage, "/World/propB"));
+    ASSERT_FALSE(IsLoaded(stage, "/World/setA/propA"));
+}
+
+TEST(LoadRulesTest, PartOfCacheKey)
+{
+    const FnAttribute::GroupAttribute stopAtSubcomponent(
+        "stopAtKind", FnAttribute::StringAttribute("subcomponent"), true);
+    const FnAttribute::GroupAttribute stopAtComponent(
+        "stopAtKind", FnAttribute::StringAttribute("component"), true);
+
+    const UsdStageRefPtr stage = GetStage(stopAtSubcomponent);
+    ASSERT_EQ(GetStage(stopAtSubcomponent), stage);
+    ASSERT_NE(GetStage(stopAtComponent), stage);
+    ASSERT_FALSE(IsLoaded(GetStage(stopAtComponent), "/World/propB"));
+}
+
+}  // namespace LoadRulesTests
+PXR_NAMESPACE_CLOSE_SCOPE
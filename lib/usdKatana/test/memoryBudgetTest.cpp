@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/primRange.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdUtils/stageCache.h"
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/cache.h"
+#include "usdKatana/locks.h"
+#include "usdKatana/staticAttrCache.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace MemoryBudgetTests
+{
+UsdStageRefPtr GetStage(const std::string& fileName)
+{
+    return UsdKatanaCache::GetInstance().GetStage(fileName, FnAttribute::GroupAttribute(true),
+                                                  "/root", "", "", true);
+}
+
+size_t GetStageEntries(const UsdKatanaCacheMemoryUsageVector& usage, const UsdStageRefPtr& stage)
+{
+    for (const UsdKatanaCacheMemoryUsage& entry : usage)
+    {
+        if (entry.cacheName == "stage" && entry.stage == stage->GetRootLayer()->GetIdentifier())
+        {
+            return entry.numEntries;
+        }
+    }
+    return 0;
+}
+
+size_t GetTotalBytes(const UsdKatanaCacheMemoryUsageVector& usage)
+{
+    size_t totalBytes = 0;
+    for (const UsdKatanaCacheMemoryUsage& entry : usage)
+    {
+        totalBytes += entry.bytes;
+    }
+    return totalBytes;
+}
+
+class MemoryBudgetTest : public ::testing::Test
+{
+protected:
+    // The static attributes cached by other tests would be evicted before
+    // any stage.
+    void SetUp() override
+    {
+        UsdKatanaCache::GetInstance().SetMemoryBudget(0);
+        UsdKatanaCache::GetInstance().Flush();
+        UsdKatanaStaticAttrCache::GetInstance().Clear();
+    }
+
+    void TearDown() override
+    {
+        UsdKatanaCache::GetInstance().SetMemoryBudget(0);
+        UsdKatanaCache::GetInstance().Flush();
+    }
+};
+
+TEST_F(MemoryBudgetTest, ReportsThePrimsOfEachStage)
+{
+    UsdStageRefPtr stage;
+    {
+        boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+        stage = GetStage("test/bounds1.usda");
+    }
+    ASSERT_TRUE(static_cast<bool>(stage));
+
+    const UsdPrimRange range = UsdPrimRange::AllPrims(stage->GetPseudoRoot());
+    const size_t numPrims = std::distance(range.begin(), range.end());
+    const UsdKatanaCacheMemoryUsageVector usage = UsdKatanaCache::GetInstance().GetMemoryUsage();
+    ASSERT_EQ(GetStageEntries(usage, stage), numPrims);
+    ASSERT_EQ(UsdKatanaCache::GetInstance().GetTotalMemoryUsage(), GetTotalBytes(usage));
+}
+
+TEST_F(MemoryBudgetTest, EvictsTheLargestStageFirst)
+{
+    UsdStageRefPtr smallStage;
+    UsdStageRefPtr largeStage;
+    UsdStageRefPtr mediumStage;
+    {
+        boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+        smallStage = GetStage("test/cookCache1.usda");
+        largeStage = GetStage("test/bounds1.usda");
+        mediumStage = GetStage("test/isolate1.usda");
+    }
+
+    UsdKatanaCache& cache = UsdKatanaCache::GetInstance();
+    const UsdKatanaCacheMemoryUsageVector usage = cache.GetMemoryUsage();
+    ASSERT_GT(GetStageEntries(usage, largeStage), GetStageEntries(usage, mediumStage));
+    ASSERT_GT(GetStageEntries(usage, mediumStage), GetStageEntries(usage, smallStage));
+
+    // Going over the budget by a byte only evicts the largest stage.
+    cache.SetMemoryBudget(GetTotalBytes(usage) - 1);
+    ASSERT_GT(cache.EnforceMemoryBudget(), 0u);
+    UsdStageCache& stageCache = UsdUtilsStageCache::Get();
+    ASSERT_FALSE(stageCache.Contains(largeStage));
+    ASSERT_TRUE(stageCache.Contains(mediumStage));
+    ASSERT_TRUE(stageCache.Contains(smallStage));
+
+    // Within the budget, nothing else is evicted.
+    ASSERT_EQ(cache.EnforceMemoryBudget(), 0u);
+    ASSERT_TRUE(stageCache.Contains(mediumStage));
+    ASSERT_TRUE(stageCache.Contains(smallStage));
+}
+
+TEST_F(MemoryBudgetTest, KeepsTheStageBeingOpened)
+{
+    boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+    const UsdStageRefPtr largeStage = GetStage("test/bounds1.usda");
+    const UsdStageRefPtr retainedStage = GetStage("test/isolate1.usda");
+    UsdKatanaCache& cache = UsdKatanaCache::GetInstance();
+    cache.RetainStage(retainedStage);
+
+    // A budget nothing fits in evicts every other stage without users when
+    // a stage is opened, but never the stage being opened.
+    cache.SetMemoryBudget(1);
+    const UsdStageRefPtr smallStage = GetStage("test/cookCache1.usda");
+    ASSERT_TRUE(static_cast<bool>(smallStage));
+
+    UsdStageCache& stageCache = UsdUtilsStageCache::Get();
+    ASSERT_TRUE(stageCache.Contains(smallStage));
+    ASSERT_TRUE(stageCache.Contains(retainedStage));
+    ASSERT_FALSE(stageCache.Contains(largeStage));
+
+    cache.ReleaseStage(retainedStage);
+}
+
+}  // namespace MemoryBudgetTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <thread>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/ar/resolver.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdUtils/stageCache.h"
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/cache.h"
+#include "usdKatana/locks.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace PrefetchStageTests
+{
+void Prefetch()
+{
+    UsdKatanaCache::GetInstance().PrefetchStage(
+        "test/isolate1.usda", FnAttribute::GroupAttribute(true), "/root/world", "", "", true,
+        ArGetResolver().GetCurrentContext());
+}
+
+UsdStageRefPtr GetStage()
+{
+    return UsdKatanaCache::GetInstance().GetStage(
+        "test/isolate1.usda", FnAttribute::GroupAttribute(true), "/root/world", "", "", true);
+}
+
+TEST(PrefetchStageTest, CachesTheStage)
+{
+    UsdKatanaCache& cache = UsdKatanaCache::GetInstance();
+    cache.Flush();
+
+    Prefetch();
+    // Prefetching the same stage again while it opens is ignored.
+    Prefetch();
+    cache.WaitForPrefetches();
+    ASSERT_EQ(UsdUtilsStageCache::Get().Size(), 1u);
+
+    boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+    const UsdStageRefPtr stage = GetStage();
+    ASSERT_TRUE(static_cast<bool>(stage));
+    ASSERT_EQ(UsdUtilsStageCache::Get().Size(), 1u);
+}
+
+// A cook holding the stage lock for reading, while a writer waits for it,
+// must not wait for a prefetch which cannot take the lock.
+TEST(PrefetchStageTest, DoesNotBlockCooksBehindWriters)
+{
+    UsdKatanaCache& cache = UsdKatanaCache::GetInstance();
+    {
+        boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetStageLock());
+        cache.Flush();
+    }
+
+    boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetStageLock());
+    std::thread writer([]() {
+        boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetStageLock());
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    Prefetch();
+    const UsdStageRefPtr stage = GetStage();
+    ASSERT_TRUE(static_cast<bool>(stage));
+
+    readerLock.unlock();
+    writer.join();
+    cache.WaitForPrefetches();
+    ASSERT_EQ(UsdUtilsStageCache::Get().Size(), 1u);
+}
+
+}  // namespace PrefetchStageTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,308 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "pxr/pxr.h"
+#include "pxr/base/gf/range3d.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/pointInstancer.h"
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/readPointInstancer.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace ReadPointInstancerTests
+{
+struct ReadResult
+{
+    FnAttribute::GroupAttribute instancer;
+    // The StaticSceneCreate op args building the instance arrays.
+    FnAttribute::GroupAttribute instances;
+};
+
+ReadResult ReadInstancer(const UsdStageRefPtr& stage,
+                         const std::string& path,
+                         ArgsBuilder usdInArgsBuilder)
+{
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.motionSampleTimes = {0.0};
+    auto usdInArgs = usdInArgsBuilder.build();
+
+    const UsdPrim prim = stage->GetPrimAtPath(SdfPath(path));
+    const UsdKatanaUsdInPrivateData privateData(prim, usdInArgs);
+    UsdKatanaAttrMap instancerAttrs;
+    UsdKatanaAttrMap sourcesAttrs;
+    UsdKatanaAttrMap instancesAttrs;
+    UsdKatanaAttrMap inputAttrs;
+    inputAttrs.set("outputLocationPath", FnAttribute::StringAttribute(path));
+    UsdKatanaReadPointInstancer(UsdGeomPointInstancer(prim), privateData, instancerAttrs,
+                                sourcesAttrs, instancesAttrs, inputAttrs);
+    return {instancerAttrs.build(), instancesAttrs.build()};
+}
+
+ReadResult ReadInstancer(const UsdStageRefPtr& stage,
+                         const std::string& path,
+                         const std::string& cullingCamera,
+                         int tileSize)
+{
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.instanceCullingCamera = cullingCamera;
+    usdInArgsBuilder.instanceTileSize = tileSize;
+    return ReadInstancer(stage, path, usdInArgsBuilder);
+}
+
+int GetNumCulledInstances(const ReadResult& result)
+{
+    return FnAttribute::IntAttribute(
+               result.instancer.getChildByName("info.usd.numCulledInstances"))
+        .getValue(0, false);
+}
+
+std::vector<int> GetInts(const FnAttribute::IntAttribute& attr)
+{
+    const FnAttribute::IntConstVector values = attr.getNearestSample(0.0f);
+    return std::vector<int>(values.begin(), values.end());
+}
+
+// Checks that the instanceNumber and tint primvars of \p arbitrary, sliced
+// for \p numInstances instances, describe the same instances, and appends
+// their numbers to \p instanceNumbers.
+void CheckPrimvars(const FnAttribute::GroupAttribute& arbitrary,
+                   size_t numInstances,
+                   std::vector<int>* instanceNumbers)
+{
+    const std::vector<int> numbers = GetInts(arbitrary.getChildByName("instanceNumber.value"));
+    ASSERT_EQ(numbers.size(), numInstances);
+    EXPECT_EQ(FnAttribute::StringAttribute(arbitrary.getChildByName("instanceNumber.scope"))
+                  .getValue("", false),
+              "primitive");
+
+    const FnAttribute::FloatAttribute tintAttr = arbitrary.getChildByName("tint.value");
+    const FnAttribute::FloatConstVector tint = tintAttr.getNearestSample(0.0f);
+    ASSERT_EQ(tint.size(), 3 * numInstances);
+    for (size_t i = 0; i < numInstances; ++i)
+    {
+        EXPECT_FLOAT_EQ(tint[3 * i], static_cast<float>(numbers[i]));
+    }
+    instanceNumbers->insert(instanceNumbers->end(), numbers.begin(), numbers.end());
+}
+
+TEST(ReadPointInstancerTest, CullsInstancesOutsideOfTheCamera)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/pointInstancer1.usda");
+
+    const ReadResult all = ReadInstancer(stage, "/root/instancer", "", 0);
+    ASSERT_TRUE(all.instances.getChildByName("c.instances").isValid());
+    EXPECT_FALSE(all.instancer.getChildByName("info.usd.numCulledInstances").isValid());
+    EXPECT_FALSE(all.instances.getChildByName("c.instances.a.geometry.omitList").isValid());
+
+    // The instance far to the side and the instance behind the camera are
+    // culled, and left out of the bound.
+    const ReadResult culled = ReadInstancer(stage, "/root/instancer", "/root/camera", 0);
+    EXPECT_EQ(FnAttribute::IntAttribute(
+                  culled.instancer.getChildByName("info.usd.numCulledInstances"))
+                  .getValue(0, false),
+              2);
+    EXPECT_EQ(GetInts(culled.instances.getChildByName("c.instances.a.geometry.omitList")),
+              (std::vector<int>{3, 4}));
+
+    const FnAttribute::DoubleAttribute boundAttr = culled.instancer.getChildByName("bound");
+    const FnAttribute::DoubleConstVector bound = boundAttr.getNearestSample(0.0f);
+    ASSERT_EQ(bound.size(), 6u);
+    EXPECT_DOUBLE_EQ(bound[0], -1.5);
+    EXPECT_DOUBLE_EQ(bound[1], 1.5);
+    EXPECT_DOUBLE_EQ(bound[4], -10.5);
+    EXPECT_DOUBLE_EQ(bound[5], -9.5);
+}
+
+TEST(ReadPointInstancerTest, CullsAgainstTheFrameOfTheRender)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/pointInstancer1.usda");
+
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.instanceCullingCamera = "/root/camera";
+
+    // A frame taller than the aperture keeps its width.
+    usdInArgsBuilder.instanceCullingAspectRatio = 0.5;
+    EXPECT_EQ(GetNumCulledInstances(ReadInstancer(stage, "/root/instancer", usdInArgsBuilder)),
+              2);
+
+    // A frame wide enough to see the instance far to the side keeps it.
+    usdInArgsBuilder.instanceCullingAspectRatio = 1000.0;
+    EXPECT_EQ(GetNumCulledInstances(ReadInstancer(stage, "/root/instancer", usdInArgsBuilder)),
+              1);
+
+    // So does an overscan large enough.
+    usdInArgsBuilder.instanceCullingAspectRatio = 0.0;
+    usdInArgsBuilder.instanceCullingOverscan = 500.0;
+    EXPECT_EQ(GetNumCulledInstances(ReadInstancer(stage, "/root/instancer", usdInArgsBuilder)),
+              1);
+}
+
+TEST(ReadPointInstancerTest, MovesPrimvarsToTheInstances)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/pointInstancer1.usda");
+    const ReadResult result = ReadInstancer(stage, "/root/instancer", "", 0);
+
+    EXPECT_FALSE(result.instancer.getChildByName("geometry.arbitrary.instanceNumber").isValid());
+    EXPECT_FALSE(result.instancer.getChildByName("geometry.arbitrary.tint").isValid());
+
+    std::vector<int> instanceNumbers;
+    CheckPrimvars(result.instances.getChildByName("c.instances.a.geometry.arbitrary"), 5,
+                  &instanceNumbers);
+    EXPECT_EQ(instanceNumbers, (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+TEST(ReadPointInstancerTest, TilesPartitionTheKeptInstances)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/pointInstancer1.usda");
+
+    for (const std::string cullingCamera : {"", "/root/camera"})
+    {
+        const ReadResult result = ReadInstancer(stage, "/root/instancer", cullingCamera, 2);
+        const FnAttribute::StringAttribute typeAttr =
+            result.instances.getChildByName("c.instances.a.type");
+        EXPECT_EQ(typeAttr.getValue("", false), "group");
+
+        // The group of the tiles is bounded like the instancer.
+        const FnAttribute::DoubleAttribute boundAttr =
+            result.instances.getChildByName("c.instances.a.bound");
+        ASSERT_TRUE(boundAttr.isValid());
+        EXPECT_EQ(boundAttr.getHash(), result.instancer.getChildByName("bound").getHash());
+
+        const FnAttribute::GroupAttribute tiles =
+            result.instances.getChildByName("c.instances.c");
+        ASSERT_GT(tiles.getNumberOfChildren(), 1);
+
+        std::vector<int> instanceNumbers;
+        for (int64_t t = 0; t < tiles.getNumberOfChildren(); ++t)
+        {
+            const FnAttribute::GroupAttribute tileAttrs =
+                FnAttribute::GroupAttribute(tiles.getChildByIndex(t)).getChildByName("a");
+            const std::vector<int> instanceIndex =
+                GetInts(tileAttrs.getChildByName("geometry.instanceIndex"));
+            ASSERT_LE(instanceIndex.size(), 2u);
+            EXPECT_FALSE(tileAttrs.getChildByName("geometry.omitList").isValid());
+            EXPECT_TRUE(tileAttrs.getChildByName("bound").isValid());
+
+            const FnAttribute::DoubleAttribute matrixAttr =
+                tileAttrs.getChildByName("geometry.instanceMatrix");
+            EXPECT_EQ(matrixAttr.getNumberOfValues(),
+                      static_cast<int64_t>(16 * instanceIndex.size()));
+
+            CheckPrimvars(tileAttrs.getChildByName("geometry.arbitrary"), instanceIndex.size(),
+                          &instanceNumbers);
+        }
+
+        std::sort(instanceNumbers.begin(), instanceNumbers.end());
+        EXPECT_EQ(instanceNumbers, cullingCamera.empty() ? (std::vector<int>{0, 1, 2, 3, 4})
+                                                         : (std::vector<int>{0, 1, 2}));
+    }
+}
+
+TEST(ReadPointInstancerTest, BoundsTilesOfPrototypesWithoutBounds)
+{
+    const UsdStageRefPtr stage = UsdStage::CreateInMemory();
+    ASSERT_TRUE(stage->GetRootLayer()->ImportFromString(R"(#usda 1.0
+def Xform "root"
+{
+    def PointInstancer "instancer"
+    {
+        point3f[] positions = [(0, 0, 0), (1, 0, 0), (10, 0, 0)]
+        int[] protoIndices = [0, 0, 0]
+        rel prototypes = </root/instancer/prototypes/empty>
+
+        def Scope "prototypes"
+        {
+            def Xform "empty"
+            {
+            }
+        }
+    }
+}
+)"));
+
+    const ReadResult result = ReadInstancer(stage, "/root/instancer", "", 2);
+    const FnAttribute::GroupAttribute tiles = result.instances.getChildByName("c.instances.c");
+    ASSERT_EQ(tiles.getNumberOfChildren(), 2);
+
+    // Every tile is bounded by the positions of its instances.
+    GfRange3d tilesRange;
+    for (int64_t t = 0; t < tiles.getNumberOfChildren(); ++t)
+    {
+        const FnAttribute::DoubleAttribute boundAttr =
+            FnAttribute::GroupAttribute(tiles.getChildByIndex(t)).getChildByName("a.bound");
+        ASSERT_TRUE(boundAttr.isValid());
+        const FnAttribute::DoubleConstVector bound = boundAttr.getNearestSample(0.0f);
+        ASSERT_EQ(bound.size(), 6u);
+        tilesRange.UnionWith(GfRange3d(GfVec3d(bound[0], bound[2], bound[4]),
+                                       GfVec3d(bound[1], bound[3], bound[5])));
+    }
+    EXPECT_EQ(tilesRange, GfRange3d(GfVec3d(0, 0, 0), GfVec3d(10, 0, 0)));
+}
+
+TEST(ReadPointInstancerTest, RemapsIdsOutOfRange)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/pointInstancer1.usda");
+
+    // Ids out of range are only remapped on request.
+    const ReadResult unmapped = ReadInstancer(stage, "/root/idsInstancer", "", 0);
+    EXPECT_TRUE(unmapped.instancer.getChildByName("warningMessage").isValid());
+    EXPECT_FALSE(unmapped.instancer.getChildByName("geometry.arbitrary.ids").isValid());
+
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.remapInstanceIds = true;
+    const ReadResult result = ReadInstancer(stage, "/root/idsInstancer", usdInArgsBuilder);
+    EXPECT_FALSE(result.instancer.getChildByName("warningMessage").isValid());
+
+    // The ids are replaced by their index among the sorted unique ids, so
+    // that they keep the order of the original ids.
+    EXPECT_EQ(GetInts(result.instancer.getChildByName("geometry.arbitrary.ids")),
+              (std::vector<int>{1, 0, 2}));
+
+    // The table holds the high and low 32 bits of each of those, sorted.
+    const FnAttribute::IntAttribute tableAttr =
+        result.instancer.getChildByName("info.usd.idsTable");
+    ASSERT_EQ(tableAttr.getTupleSize(), 2);
+    EXPECT_EQ(GetInts(tableAttr), (std::vector<int>{0, 7, 1, 705032704, 2, 410065408}));
+}
+
+TEST(ReadPointInstancerTest, SlicesIdsPerTile)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/pointInstancer1.usda");
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.instanceTileSize = 2;
+    usdInArgsBuilder.remapInstanceIds = true;
+    const ReadResult result = ReadInstancer(stage, "/root/idsInstancer", usdInArgsBuilder);
+
+    // The ids are in the order of the instances of each tile instead of on
+    // the instancer.
+    EXPECT_FALSE(result.instancer.getChildByName("geometry.arbitrary.ids").isValid());
+
+    const FnAttribute::GroupAttribute tiles = result.instances.getChildByName("c.instances.c");
+    ASSERT_GT(tiles.getNumberOfChildren(), 1);
+    std::vector<int> ids;
+    for (int64_t t = 0; t < tiles.getNumberOfChildren(); ++t)
+    {
+        const FnAttribute::GroupAttribute tileAttrs =
+            FnAttribute::GroupAttribute(tiles.getChildByIndex(t)).getChildByName("a");
+        const std::vector<int> tileIds =
+            GetInts(tileAttrs.getChildByName("geometry.arbitrary.ids"));
+        EXPECT_EQ(tileIds.size(),
+                  GetInts(tileAttrs.getChildByName("geometry.instanceIndex")).size());
+        ids.insert(ids.end(), tileIds.begin(), tileIds.end());
+    }
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(ids, (std::vector<int>{0, 1, 2}));
+}
+
+}  // namespace ReadPointInstancerTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
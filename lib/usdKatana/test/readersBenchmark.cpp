@@ -0,0 +1,494 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pxr/base/gf/half.h"
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/gf/quatf.h"
+#include "pxr/base/gf/quath.h"
+#include "pxr/base/gf/rotation.h"
+#include "pxr/base/gf/vec2f.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/gf/vec3h.h"
+#include "pxr/base/tf/getenv.h"
+#include "pxr/base/tf/pathUtils.h"
+#include "pxr/base/vt/array.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/kind/registry.h"
+#include "pxr/usd/sdf/types.h"
+#include "pxr/usd/usd/modelAPI.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/cube.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/pointInstancer.h"
+#include "pxr/usd/usdGeom/primvarsAPI.h"
+#include "pxr/usd/usdGeom/tokens.h"
+#include "pxr/usd/usdLux/lightAPI.h"
+#include "pxr/usd/usdLux/sphereLight.h"
+#include "pxr/usd/usdShade/material.h"
+#include "pxr/usd/usdShade/shader.h"
+#include "pxr/usd/usdSkel/animation.h"
+#include "pxr/usd/usdSkel/bindingAPI.h"
+#include "pxr/usd/usdSkel/root.h"
+#include "pxr/usd/usdSkel/skeleton.h"
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/cache.h"
+#include "usdKatana/readMaterial.h"
+#include "usdKatana/readMesh.h"
+#include "usdKatana/readPointInstancer.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+#include "usdKatana/utils.h"
+#include "vtKatana/array.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+// Throughput benchmarks for the readers and attribute conversions.
+//
+// The fixtures are generated when the suite starts, so that the benchmark
+// does not depend on production assets. Each benchmark runs for at least
+// USD_KATANA_BENCHMARK_MIN_TIME seconds (0.5 by default) and records its
+// results as test properties; run with --gtest_output=json:<file> to get them
+// in machine-readable form.
+class ReadersBenchmark : public ::testing::Test
+{
+protected:
+    static constexpr int kGridSize = 512;
+    static constexpr int kNumJoints = 64;
+    static constexpr int kNumInstances = 100000;
+    static constexpr int kNumPrototypes = 4;
+    static constexpr int kNumMaterials = 100;
+    static constexpr int kNumLights = 1000;
+
+    static void SetUpTestSuite()
+    {
+        UsdStageRefPtr stage = UsdStage::CreateInMemory();
+        UsdPrim root = stage->DefinePrim(SdfPath("/root"));
+        UsdModelAPI(root).SetKind(KindTokens->group);
+
+        _DefineMesh(stage, SdfPath("/root/mesh"));
+        _DefineSkinnedMesh(stage, SdfPath("/root/skel"));
+        _DefinePointInstancer(stage, SdfPath("/root/instancer"));
+        _DefineMaterials(stage, SdfPath("/root/materials"));
+        _DefineLights(stage, SdfPath("/root/lights"));
+
+        stage->Export(kUsdaFixture);
+        stage->Export(kUsdcFixture);
+    }
+
+    static UsdKatanaUsdInArgsRefPtr _MakeUsdInArgs(const UsdStageRefPtr& stage)
+    {
+        ArgsBuilder usdInArgsBuilder;
+        usdInArgsBuilder.stage = stage;
+        usdInArgsBuilder.rootLocation = "/root";
+        usdInArgsBuilder.isolatePath = "";
+        usdInArgsBuilder.sessionLocation = "";
+        usdInArgsBuilder.currentTime = 1.0;
+        return usdInArgsBuilder.build();
+    }
+
+    // Run \p fn until the minimum benchmark time has elapsed and record the
+    // time per iteration and the throughput in items per second.
+    template <typename Fn>
+    static void _Run(const std::string& label, size_t itemsPerIteration, Fn&& fn)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const double minSeconds = std::atof(
+            TfGetenv("USD_KATANA_BENCHMARK_MIN_TIME", "0.5").c_str());
+
+        // Warm up caches before timing.
+        fn();
+
+        size_t iterations = 0;
+        double seconds = 0.0;
+        const Clock::time_point start = Clock::now();
+        while (iterations < 3 || seconds < minSeconds)
+        {
+            fn();
+            ++iterations;
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        const double nsPerIteration = seconds * 1e9 / iterations;
+        const double itemsPerSecond = itemsPerIteration * iterations / seconds;
+        RecordProperty(label + ".iterations", static_cast<int>(iterations));
+        RecordProperty(label + ".nsPerIteration", std::to_string(nsPerIteration));
+        RecordProperty(label + ".itemsPerSecond", std::to_string(itemsPerSecond));
+        std::cout << label << ": " << nsPerIteration / 1e6 << " ms/iteration, "
+                  << itemsPerSecond << " items/s" << std::endl;
+    }
+
+    template <typename T>
+    static void _RunMapOrCopy(const std::string& typeName, const T& value)
+    {
+        const VtArray<T> array(kGridSize * kGridSize, value);
+        _Run("VtKatanaMapOrCopy." + typeName, array.size(), [&array]() {
+            auto attr = VtKatanaMapOrCopy(array);
+            ASSERT_TRUE(attr.isValid());
+        });
+    }
+
+    static const std::string kUsdaFixture;
+    static const std::string kUsdcFixture;
+
+private:
+    static VtVec3fArray _GridPoints(float height)
+    {
+        VtVec3fArray points(kGridSize * kGridSize);
+        for (int y = 0; y < kGridSize; ++y)
+        {
+            for (int x = 0; x < kGridSize; ++x)
+            {
+                points[y * kGridSize + x] =
+                    GfVec3f(float(x) / kGridSize, height * y / kGridSize, 0.0f);
+            }
+        }
+        return points;
+    }
+
+    static UsdGeomMesh _DefineGrid(const UsdStageRefPtr& stage, const SdfPath& path, float height)
+    {
+        const int numFaces = (kGridSize - 1) * (kGridSize - 1);
+        VtIntArray faceVertexCounts(numFaces, 4);
+        VtIntArray faceVertexIndices;
+        faceVertexIndices.reserve(numFaces * 4);
+        for (int y = 0; y < kGridSize - 1; ++y)
+        {
+            for (int x = 0; x < kGridSize - 1; ++x)
+            {
+                const int i = y * kGridSize + x;
+                faceVertexIndices.push_back(i);
+                faceVertexIndices.push_back(i + 1);
+                faceVertexIndices.push_back(i + kGridSize + 1);
+                faceVertexIndices.push_back(i + kGridSize);
+            }
+        }
+
+        const VtVec3fArray points = _GridPoints(height);
+        VtVec2fArray st(points.size());
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            st[i] = GfVec2f(points[i][0], points[i][1] / height);
+        }
+
+        UsdGeomMesh mesh = UsdGeomMesh::Define(stage, path);
+        mesh.CreatePointsAttr().Set(points);
+        mesh.CreateFaceVertexCountsAttr().Set(faceVertexCounts);
+        mesh.CreateFaceVertexIndicesAttr().Set(faceVertexIndices);
+        mesh.CreateNormalsAttr().Set(VtVec3fArray(points.size(), GfVec3f(0.0f, 0.0f, 1.0f)));
+        mesh.SetNormalsInterpolation(UsdGeomTokens->vertex);
+        UsdGeomPrimvarsAPI(mesh.GetPrim())
+            .CreatePrimvar(TfToken("st"), SdfValueTypeNames->TexCoord2fArray,
+                           UsdGeomTokens->vertex)
+            .Set(st);
+        return mesh;
+    }
+
+    static void _DefineMesh(const UsdStageRefPtr& stage, const SdfPath& path)
+    {
+        _DefineGrid(stage, path, 1.0f);
+    }
+
+    // A grid bound to a chain of joints, with four influences per point and
+    // two animated frames.
+    static void _DefineSkinnedMesh(const UsdStageRefPtr& stage, const SdfPath& path)
+    {
+        UsdSkelRoot::Define(stage, path);
+
+        VtTokenArray joints(kNumJoints);
+        VtMatrix4dArray bindTransforms(kNumJoints);
+        VtMatrix4dArray restTransforms(kNumJoints);
+        std::string jointPath;
+        for (int j = 0; j < kNumJoints; ++j)
+        {
+            jointPath = j == 0 ? "j0" : jointPath + "/j" + std::to_string(j);
+            joints[j] = TfToken(jointPath);
+            bindTransforms[j].SetTranslate(GfVec3d(0.0, j, 0.0));
+            restTransforms[j].SetTranslate(GfVec3d(0.0, j == 0 ? 0.0 : 1.0, 0.0));
+        }
+
+        UsdSkelSkeleton skel = UsdSkelSkeleton::Define(stage, path.AppendChild(TfToken("skel")));
+        skel.CreateJointsAttr().Set(joints);
+        skel.CreateBindTransformsAttr().Set(bindTransforms);
+        skel.CreateRestTransformsAttr().Set(restTransforms);
+
+        UsdSkelAnimation anim = UsdSkelAnimation::Define(stage, path.AppendChild(TfToken("anim")));
+        anim.CreateJointsAttr().Set(joints);
+        VtVec3fArray translations(kNumJoints, GfVec3f(0.0f, 1.0f, 0.0f));
+        translations[0] = GfVec3f(0.0f);
+        anim.CreateTranslationsAttr().Set(translations);
+        anim.CreateScalesAttr().Set(VtVec3hArray(kNumJoints, GfVec3h(1.0f)));
+        UsdAttribute rotationsAttr = anim.CreateRotationsAttr();
+        for (double time : {1.0, 2.0})
+        {
+            const GfQuatf rotation(GfRotation(GfVec3d::ZAxis(), 2.0 * time).GetQuat());
+            rotationsAttr.Set(VtQuatfArray(kNumJoints, rotation), time);
+        }
+        UsdSkelBindingAPI::Apply(skel.GetPrim())
+            .CreateAnimationSourceRel()
+            .SetTargets({anim.GetPath()});
+
+        UsdGeomMesh mesh = _DefineGrid(stage, path.AppendChild(TfToken("mesh")), kNumJoints);
+        const size_t numPoints = kGridSize * kGridSize;
+        VtIntArray jointIndices(numPoints * 4);
+        VtFloatArray jointWeights(numPoints * 4, 0.25f);
+        for (size_t i = 0; i < numPoints; ++i)
+        {
+            const int row = static_cast<int>(i / kGridSize) * kNumJoints / kGridSize;
+            for (int k = 0; k < 4; ++k)
+            {
+                jointIndices[i * 4 + k] = std::min(row + k, kNumJoints - 1);
+            }
+        }
+        UsdSkelBindingAPI binding = UsdSkelBindingAPI::Apply(mesh.GetPrim());
+        binding.CreateSkeletonRel().SetTargets({skel.GetPath()});
+        binding.CreateJointIndicesPrimvar(false, 4).Set(jointIndices);
+        binding.CreateJointWeightsPrimvar(false, 4).Set(jointWeights);
+        binding.CreateGeomBindTransformAttr().Set(GfMatrix4d(1.0));
+    }
+
+    static void _DefinePointInstancer(const UsdStageRefPtr& stage, const SdfPath& path)
+    {
+        UsdGeomPointInstancer instancer = UsdGeomPointInstancer::Define(stage, path);
+        SdfPathVector prototypes;
+        for (int i = 0; i < kNumPrototypes; ++i)
+        {
+            const SdfPath prototypePath =
+                path.AppendPath(SdfPath("prototypes/cube" + std::to_string(i)));
+            UsdGeomCube::Define(stage, prototypePath).CreateSizeAttr().Set(0.5 + i);
+            prototypes.push_back(prototypePath);
+        }
+        instancer.CreatePrototypesRel().SetTargets(prototypes);
+
+        VtIntArray protoIndices(kNumInstances);
+        VtVec3fArray positions(kNumInstances);
+        VtQuathArray orientations(kNumInstances);
+        VtVec3fArray scales(kNumInstances);
+        for (int i = 0; i < kNumInstances; ++i)
+        {
+            protoIndices[i] = i % kNumPrototypes;
+            positions[i] = GfVec3f(i % 317, (i / 317) % 317, i / (317 * 317));
+            orientations[i] =
+                GfQuath(GfQuatf(GfRotation(GfVec3d::YAxis(), i % 360).GetQuat()));
+            scales[i] = GfVec3f(1.0f + (i % 7) * 0.1f);
+        }
+        instancer.CreateProtoIndicesAttr().Set(protoIndices);
+        instancer.CreatePositionsAttr().Set(positions);
+        instancer.CreateOrientationsAttr().Set(orientations);
+        instancer.CreateScalesAttr().Set(scales);
+    }
+
+    static void _DefineMaterials(const UsdStageRefPtr& stage, const SdfPath& path)
+    {
+        stage->DefinePrim(path, TfToken("Scope"));
+        for (int i = 0; i < kNumMaterials; ++i)
+        {
+            const SdfPath materialPath = path.AppendChild(TfToken("mat" + std::to_string(i)));
+            UsdShadeMaterial material = UsdShadeMaterial::Define(stage, materialPath);
+
+            UsdShadeShader texture =
+                UsdShadeShader::Define(stage, materialPath.AppendChild(TfToken("texture")));
+            texture.CreateIdAttr(VtValue(TfToken("UsdUVTexture")));
+            texture.CreateInput(TfToken("file"), SdfValueTypeNames->Asset)
+                .Set(SdfAssetPath("texture" + std::to_string(i) + ".exr"));
+            texture.CreateOutput(TfToken("rgb"), SdfValueTypeNames->Float3);
+
+            UsdShadeShader surface =
+                UsdShadeShader::Define(stage, materialPath.AppendChild(TfToken("surface")));
+            surface.CreateIdAttr(VtValue(TfToken("UsdPreviewSurface")));
+            surface.CreateInput(TfToken("roughness"), SdfValueTypeNames->Float).Set(0.5f);
+            surface.CreateInput(TfToken("diffuseColor"), SdfValueTypeNames->Color3f)
+                .ConnectToSource(texture.ConnectableAPI(), TfToken("rgb"));
+            surface.CreateOutput(TfToken("surface"), SdfValueTypeNames->Token);
+
+            material.CreateSurfaceOutput().ConnectToSource(surface.ConnectableAPI(),
+                                                           TfToken("surface"));
+        }
+    }
+
+    // Lights linked to the mesh, and casting no shadows on the skinned mesh.
+    static void _DefineLights(const UsdStageRefPtr& stage, const SdfPath& path)
+    {
+        UsdModelAPI(stage->DefinePrim(path, TfToken("Xform"))).SetKind(KindTokens->group);
+        for (int i = 0; i < kNumLights; ++i)
+        {
+            UsdLuxSphereLight light = UsdLuxSphereLight::Define(
+                stage, path.AppendChild(TfToken("light" + std::to_string(i))));
+            light.CreateRadiusAttr().Set(0.1f * (i % 10 + 1));
+            UsdLuxLightAPI lightAPI(light.GetPrim());
+            lightAPI.GetLightLinkCollectionAPI().CreateIncludesRel().SetTargets(
+                {SdfPath("/root/mesh")});
+            lightAPI.GetShadowLinkCollectionAPI().CreateExcludesRel().SetTargets(
+                {SdfPath("/root/skel")});
+        }
+    }
+};
+
+const std::string ReadersBenchmark::kUsdaFixture = "test/benchmark.usda";
+const std::string ReadersBenchmark::kUsdcFixture = "test/benchmark.usdc";
+
+namespace ReadersBenchmarks
+{
+TEST_F(ReadersBenchmark, VtKatanaMapOrCopy)
+{
+    _RunMapOrCopy<bool>("bool", true);
+    _RunMapOrCopy<int>("int", 1);
+    _RunMapOrCopy<float>("float", 1.0f);
+    _RunMapOrCopy<double>("double", 1.0);
+    _RunMapOrCopy<GfHalf>("half", GfHalf(1.0f));
+    _RunMapOrCopy<GfVec3f>("GfVec3f", GfVec3f(1.0f));
+    _RunMapOrCopy<GfVec3h>("GfVec3h", GfVec3h(1.0f));
+    _RunMapOrCopy<GfMatrix4d>("GfMatrix4d", GfMatrix4d(1.0));
+    _RunMapOrCopy<std::string>("string", std::string("value"));
+}
+
+TEST_F(ReadersBenchmark, ReadMesh)
+{
+    UsdStageRefPtr stage = UsdStage::Open(kUsdcFixture);
+    UsdGeomMesh mesh(stage->GetPrimAtPath(SdfPath("/root/mesh")));
+    ASSERT_TRUE(static_cast<bool>(mesh));
+
+    auto usdInArgs = _MakeUsdInArgs(stage);
+    UsdKatanaUsdInPrivateData privateData(mesh.GetPrim(), usdInArgs);
+    _Run("UsdKatanaReadMesh", kGridSize * kGridSize, [&]() {
+        UsdKatanaAttrMap attrs;
+        UsdKatanaReadMesh(mesh, privateData, attrs);
+        attrs.build();
+    });
+}
+
+TEST_F(ReadersBenchmark, ReadPointInstancer)
+{
+    UsdStageRefPtr stage = UsdStage::Open(kUsdcFixture);
+    UsdGeomPointInstancer instancer(stage->GetPrimAtPath(SdfPath("/root/instancer")));
+    ASSERT_TRUE(static_cast<bool>(instancer));
+
+    auto usdInArgs = _MakeUsdInArgs(stage);
+    UsdKatanaUsdInPrivateData privateData(instancer.GetPrim(), usdInArgs);
+    _Run("UsdKatanaReadPointInstancer", kNumInstances, [&]() {
+        UsdKatanaAttrMap instancerAttrs;
+        UsdKatanaAttrMap sourcesAttrs;
+        UsdKatanaAttrMap instancesAttrs;
+        UsdKatanaAttrMap inputAttrs;
+        inputAttrs.set("outputLocationPath", FnAttribute::StringAttribute("/root/instancer"));
+        UsdKatanaReadPointInstancer(instancer, privateData, instancerAttrs, sourcesAttrs,
+                                    instancesAttrs, inputAttrs);
+        instancesAttrs.build();
+    });
+}
+
+TEST_F(ReadersBenchmark, ApplySkinningToPoints)
+{
+    UsdStageRefPtr stage = UsdStage::Open(kUsdcFixture);
+    UsdGeomMesh mesh(stage->GetPrimAtPath(SdfPath("/root/skel/mesh")));
+    ASSERT_TRUE(static_cast<bool>(mesh));
+
+    auto usdInArgs = _MakeUsdInArgs(stage);
+    UsdKatanaUsdInPrivateData privateData(mesh.GetPrim(), usdInArgs);
+    ASSERT_TRUE(UsdKatanaUtils::ApplySkinningToPoints(mesh, privateData).isValid());
+    _Run("UsdKatanaUtils::ApplySkinningToPoints", kGridSize * kGridSize, [&]() {
+        UsdKatanaUtils::ApplySkinningToPoints(mesh, privateData);
+    });
+}
+
+TEST_F(ReadersBenchmark, ReadMaterial)
+{
+    UsdStageRefPtr stage = UsdStage::Open(kUsdcFixture);
+    std::vector<UsdShadeMaterial> materials;
+    for (int i = 0; i < kNumMaterials; ++i)
+    {
+        materials.emplace_back(
+            stage->GetPrimAtPath(SdfPath("/root/materials/mat" + std::to_string(i))));
+        ASSERT_TRUE(static_cast<bool>(materials.back()));
+    }
+
+    auto usdInArgs = _MakeUsdInArgs(stage);
+    UsdKatanaUsdInPrivateData privateData(materials.front().GetPrim(), usdInArgs);
+    _Run("UsdKatanaReadMaterial", materials.size(), [&]() {
+        for (const UsdShadeMaterial& material : materials)
+        {
+            UsdKatanaAttrMap attrs;
+            UsdKatanaReadMaterial(material, /* flatten */ true, privateData, attrs);
+            attrs.build();
+        }
+    });
+}
+
+TEST_F(ReadersBenchmark, GetStage)
+{
+    UsdKatanaCache& cache = UsdKatanaCache::GetInstance();
+    for (const std::string& fileName : {kUsdaFixture, kUsdcFixture})
+    {
+        const std::string format = TfGetExtension(fileName);
+        _Run("UsdKatanaCache::GetStage.cold." + format, 1, [&]() {
+            UsdStageRefPtr stage =
+                cache.GetStage(fileName, FnAttribute::GroupAttribute(), "/root", "", "", true);
+            ASSERT_TRUE(static_cast<bool>(stage));
+            cache.FlushStage(stage);
+        });
+        _Run("UsdKatanaCache::GetStage.warm." + format, 1, [&]() {
+            cache.GetStage(fileName, FnAttribute::GroupAttribute(), "/root", "", "", true);
+        });
+    }
+    cache.Flush();
+}
+
+TEST_F(ReadersBenchmark, FindLightPaths)
+{
+    UsdStageRefPtr stage = UsdStage::Open(kUsdcFixture);
+    ASSERT_EQ(UsdKatanaUtils::FindLightPaths(stage).size(), static_cast<size_t>(kNumLights));
+    _Run("UsdKatanaUtils::FindLightPaths", kNumLights,
+         [&]() { UsdKatanaUtils::FindLightPaths(stage); });
+    _Run("UsdKatanaUtils::FindCameraPaths", 1,
+         [&]() { UsdKatanaUtils::FindCameraPaths(stage); });
+}
+
+TEST_F(ReadersBenchmark, LightList)
+{
+    UsdStageRefPtr stage = UsdStage::Open(kUsdcFixture);
+    const SdfPathVector lightPaths = UsdKatanaUtils::FindLightPaths(stage);
+    ASSERT_EQ(lightPaths.size(), static_cast<size_t>(kNumLights));
+    auto usdInArgs = _MakeUsdInArgs(stage);
+
+    // What the light list function registered by usdInShipped does for every
+    // light.
+    const auto addLight = [](UsdKatanaUtilsLightListAccess& lightList) {
+        UsdLuxLightAPI light(lightList.GetPrim());
+        lightList.Set("path", lightList.GetLocation());
+        lightList.SetLinks(light.GetLightLinkCollectionAPI(), "enable");
+        lightList.Set("enable", true);
+        lightList.SetLinks(light.GetShadowLinkCollectionAPI(), "geoShadowEnable");
+    };
+
+    UsdKatanaUtilsLightListEditor lightListEditor(usdInArgs);
+    _Run("UsdKatanaUtilsLightListAccess", kNumLights, [&]() {
+        for (const SdfPath& lightPath : lightPaths)
+        {
+            lightListEditor.SetPath(lightPath);
+            addLight(lightListEditor);
+        }
+    });
+    ASSERT_EQ(lightListEditor.Build().getNumberOfChildren(), kNumLights);
+
+    // Building the light list as well, as the UsdIn light list op does.
+    _Run("UsdKatanaUtilsLightListEditor", kNumLights, [&]() {
+        UsdKatanaUtilsLightListEditor editor(usdInArgs);
+        for (const SdfPath& lightPath : lightPaths)
+        {
+            editor.SetPath(lightPath);
+            addLight(editor);
+        }
+        editor.Build();
+    });
+}
+
+}  // namespace ReadersBenchmarks
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/mesh.h"
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/cache.h"
+#include "usdKatana/locks.h"
+#include "usdKatana/readMesh.h"
+#include "usdKatana/staticAttrCache.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace ReloadLayersTests
+{
+void WriteMeshLayer(const std::string& fileName, float x)
+{
+    std::ofstream file(fileName, std::ios::trunc);
+    file << "#usda 1.0\n"
+            "(\n"
+            "    defaultPrim = \"mesh\"\n"
+            ")\n"
+            "\n"
+            "def Mesh \"mesh\"\n"
+            "{\n"
+            "    int[] faceVertexCounts = [3]\n"
+            "    int[] faceVertexIndices = [0, 1, 2]\n"
+            "    point3f[] points = [("
+         << x << ", 0, 0), (1, 0, 0), (1, 1, 0)]\n"
+         << "}\n";
+}
+
+void WriteRootLayer(const std::string& fileName)
+{
+    std::ofstream file(fileName, std::ios::trunc);
+    file << "#usda 1.0\n"
+            "\n"
+            "def Xform \"root\"\n"
+            "{\n"
+            "    def \"edited\" (references = @./reloadEdited.usda@) {}\n"
+            "    def \"kept\" (references = @./reloadKept.usda@) {}\n"
+            "}\n";
+}
+
+FnAttribute::GroupAttribute ReadMesh(const UsdStageRefPtr& stage, const std::string& path)
+{
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.currentTime = 1.0;
+    usdInArgsBuilder.motionSampleTimes = {0.0};
+    usdInArgsBuilder.shareStaticData = true;
+    auto usdInArgs = usdInArgsBuilder.build();
+
+    const UsdPrim prim = stage->GetPrimAtPath(SdfPath(path));
+    const UsdKatanaUsdInPrivateData privateData(prim, usdInArgs);
+    UsdKatanaAttrMap attrs;
+    UsdKatanaReadMesh(UsdGeomMesh(prim), privateData, attrs);
+    return attrs.build();
+}
+
+float GetFirstPointX(const FnAttribute::GroupAttribute& meshAttrs)
+{
+    return FnAttribute::FloatAttribute(meshAttrs.getChildByName("geometry.point.P"))
+        .getValue(-1.0f, false);
+}
+
+// Edits a layer on disk, as another application would, and checks that only
+// what was read from that layer is read again once it is reloaded.
+TEST(ReloadLayersTest, ReadsTheEditedLayerAgain)
+{
+    WriteRootLayer("test/reloadRoot.usda");
+    WriteMeshLayer("test/reloadEdited.usda", 0.0f);
+    WriteMeshLayer("test/reloadKept.usda", 0.0f);
+
+    UsdKatanaCache& cache = UsdKatanaCache::GetInstance();
+    UsdKatanaStaticAttrCache& staticAttrCache = UsdKatanaStaticAttrCache::GetInstance();
+    boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetStageLock());
+    cache.Flush();
+    staticAttrCache.Clear();
+
+    const UsdStageRefPtr stage = cache.GetStage(
+        "test/reloadRoot.usda", FnAttribute::GroupAttribute(true), "/root", "", "", true);
+    ASSERT_TRUE(static_cast<bool>(stage));
+    ASSERT_EQ(GetFirstPointX(ReadMesh(stage, "/root/edited")), 0.0f);
+    ASSERT_EQ(GetFirstPointX(ReadMesh(stage, "/root/kept")), 0.0f);
+    const size_t numEntries = staticAttrCache.GetNumEntries();
+    ASSERT_GT(numEntries, 0u);
+
+    // The first comparison of the contents records them.
+    ASSERT_TRUE(cache.ReloadChangedLayers(stage, true).empty());
+    const size_t reloadGeneration = cache.GetReloadGeneration();
+
+    WriteMeshLayer("test/reloadEdited.usda", 5.0f);
+    const std::vector<std::string> reloadedLayers = cache.ReloadChangedLayers(stage, true);
+    ASSERT_EQ(reloadedLayers.size(), 1u);
+    ASSERT_NE(reloadedLayers[0].find("reloadEdited.usda"), std::string::npos);
+    ASSERT_EQ(cache.GetReloadGeneration(), reloadGeneration + 1);
+
+    // The static attributes of the kept mesh are still shared, those of the
+    // edited mesh are read from the new contents of its layer.
+    ASSERT_LT(staticAttrCache.GetNumEntries(), numEntries);
+    ASSERT_GT(staticAttrCache.GetNumEntries(), 0u);
+    const size_t numHits = staticAttrCache.GetNumHits();
+    ASSERT_EQ(GetFirstPointX(ReadMesh(stage, "/root/kept")), 0.0f);
+    ASSERT_GT(staticAttrCache.GetNumHits(), numHits);
+    ASSERT_EQ(GetFirstPointX(ReadMesh(stage, "/root/edited")), 5.0f);
+    ASSERT_EQ(staticAttrCache.GetNumEntries(), numEntries);
+
+    // Nothing changed since.
+    ASSERT_TRUE(cache.ReloadChangedLayers(stage, true).empty());
+    ASSERT_EQ(cache.GetReloadGeneration(), reloadGeneration + 1);
+
+    staticAttrCache.Clear();
+    cache.Flush();
+}
+
+}  // namespace ReloadLayersTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/pxr.h"
+
+#include "usdKatana/skinningCache.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace SkinningCacheTests
+{
+const GfMatrix4d kIdentity(1.0);
+
+TEST(SkinningCacheTest, BlendsInfluences)
+{
+    const std::vector<GfMatrix4d> jointXforms = {
+        GfMatrix4d(1.0).SetTranslate(GfVec3d(10, 0, 0)),
+        GfMatrix4d(1.0).SetTranslate(GfVec3d(0, 10, 0)),
+    };
+    const std::vector<int> jointIndices = {0, 1, 1, 0};
+    const std::vector<float> jointWeights = {0.5f, 0.5f, 1.0f, 0.0f};
+    std::vector<GfVec3f> points = {GfVec3f(1, 1, 1), GfVec3f(2, 2, 2)};
+
+    ASSERT_TRUE(UsdKatanaSkinningCache::SkinPointsLBS(
+        TfMakeConstSpan(jointXforms), kIdentity, TfMakeConstSpan(jointIndices),
+        TfMakeConstSpan(jointWeights), 2, false, TfMakeSpan(points)));
+
+    ASSERT_EQ(points[0], GfVec3f(6, 6, 1));
+    ASSERT_EQ(points[1], GfVec3f(2, 12, 2));
+}
+
+TEST(SkinningCacheTest, AppliesSkelToPrimLocalAfterBlending)
+{
+    // With weights that do not sum to one, the skeleton to mesh transform
+    // must not be weighted along with the joints, as in UsdSkel.
+    const std::vector<GfMatrix4d> jointXforms = {
+        GfMatrix4d(1.0).SetTranslate(GfVec3d(10, 0, 0)),
+    };
+    const GfMatrix4d skelToPrimLocal = GfMatrix4d(1.0).SetTranslate(GfVec3d(0, 0, 100));
+    const std::vector<int> jointIndices = {0, 0};
+    const std::vector<float> jointWeights = {0.5f, 0.5f};
+    std::vector<GfVec3f> points = {GfVec3f(0, 0, 0), GfVec3f(2, 2, 2)};
+
+    const std::vector<int> rigidIndices = {0};
+    const std::vector<float> rigidWeights = {0.5f};
+    std::vector<GfVec3f> rigidPoints = points;
+
+    ASSERT_TRUE(UsdKatanaSkinningCache::SkinPointsLBS(
+        TfMakeConstSpan(jointXforms), skelToPrimLocal, TfMakeConstSpan(jointIndices),
+        TfMakeConstSpan(jointWeights), 1, false, TfMakeSpan(points)));
+    ASSERT_EQ(points[0], GfVec3f(5, 0, 100));
+    ASSERT_EQ(points[1], GfVec3f(6, 1, 101));
+
+    ASSERT_TRUE(UsdKatanaSkinningCache::SkinPointsLBS(
+        TfMakeConstSpan(jointXforms), skelToPrimLocal, TfMakeConstSpan(rigidIndices),
+        TfMakeConstSpan(rigidWeights), 1, true, TfMakeSpan(rigidPoints)));
+    ASSERT_EQ(rigidPoints, points);
+}
+
+TEST(SkinningCacheTest, RejectsOutOfRangeJoints)
+{
+    const std::vector<GfMatrix4d> jointXforms = {GfMatrix4d(1.0).SetScale(2.0)};
+    const std::vector<int> jointIndices = {0, 5};
+    const std::vector<float> jointWeights = {1.0f, 0.0f};
+    std::vector<GfVec3f> points(2, GfVec3f(1, 1, 1));
+
+    // Even with a zero weight, as in UsdSkel. The points are left alone.
+    ASSERT_FALSE(UsdKatanaSkinningCache::SkinPointsLBS(
+        TfMakeConstSpan(jointXforms), kIdentity, TfMakeConstSpan(jointIndices),
+        TfMakeConstSpan(jointWeights), 1, false, TfMakeSpan(points)));
+    ASSERT_EQ(points[0], GfVec3f(1, 1, 1));
+    ASSERT_EQ(points[1], GfVec3f(1, 1, 1));
+}
+
+TEST(SkinningCacheTest, ConstantInfluences)
+{
+    const std::vector<GfMatrix4d> jointXforms = {
+        GfMatrix4d(1.0).SetScale(2.0),
+    };
+    const std::vector<int> jointIndices = {0};
+    const std::vector<float> jointWeights = {1.0f};
+    std::vector<GfVec3f> points(100000, GfVec3f(1, 2, 3));
+
+    ASSERT_TRUE(UsdKatanaSkinningCache::SkinPointsLBS(
+        TfMakeConstSpan(jointXforms), kIdentity, TfMakeConstSpan(jointIndices),
+        TfMakeConstSpan(jointWeights), 1, true, TfMakeSpan(points)));
+    for (const GfVec3f& point : points)
+    {
+        ASSERT_EQ(point, GfVec3f(2, 4, 6));
+    }
+}
+
+TEST(SkinningCacheTest, RejectsMismatchedInfluences)
+{
+    const std::vector<GfMatrix4d> jointXforms = {GfMatrix4d(1.0)};
+    const std::vector<int> jointIndices = {0, 0, 0};
+    const std::vector<float> jointWeights = {1.0f, 1.0f, 1.0f};
+    std::vector<GfVec3f> points(2, GfVec3f(1, 1, 1));
+
+    ASSERT_FALSE(UsdKatanaSkinningCache::SkinPointsLBS(
+        TfMakeConstSpan(jointXforms), kIdentity, TfMakeConstSpan(jointIndices),
+        TfMakeConstSpan(jointWeights), 1, false, TfMakeSpan(points)));
+    ASSERT_EQ(points[0], GfVec3f(1, 1, 1));
+}
+
+TEST(SkinningCacheTest, AppliesSparseAndDenseBlendShapes)
+{
+    // Blend shape 0 is dense with a single sub-shape. Blend shape 1 is
+    // sparse on points 1 and 3 (sorted) and has two sub-shapes.
+    UsdKatanaSkinningCache::BlendShapeData data;
+    data.offsets = {GfVec3f(1, 0, 0), GfVec3f(1, 0, 0), GfVec3f(1, 0, 0), GfVec3f(1, 0, 0),
+                    GfVec3f(0, 1, 0), GfVec3f(0, 2, 0),
+                    GfVec3f(0, 0, 1), GfVec3f(0, 0, 2)};
+    data.offsetStarts = {0, 4, 6, 8};
+    data.pointIndices = {1, 3};
+    data.indexStarts = {0, 0, 2};
+
+    const std::vector<float> weights = {0.5f, 1.0f, 0.0f};
+    const std::vector<unsigned> blendShapeIndices = {0, 1, 1};
+    const std::vector<unsigned> subShapeIndices = {0, 1, 2};
+    std::vector<GfVec3f> points(4, GfVec3f(0, 0, 0));
+
+    ASSERT_TRUE(UsdKatanaSkinningCache::ApplyBlendShapes(
+        data, TfMakeConstSpan(weights), TfMakeConstSpan(blendShapeIndices),
+        TfMakeConstSpan(subShapeIndices), TfMakeSpan(points)));
+
+    ASSERT_EQ(points[0], GfVec3f(0.5f, 0, 0));
+    ASSERT_EQ(points[1], GfVec3f(0.5f, 1, 0));
+    ASSERT_EQ(points[2], GfVec3f(0.5f, 0, 0));
+    ASSERT_EQ(points[3], GfVec3f(0.5f, 2, 0));
+}
+
+}  // namespace SkinningCacheTests
+PXR_NAMESPACE_CLOSE_SCOPE
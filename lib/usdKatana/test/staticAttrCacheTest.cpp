@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/mesh.h"
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/readMesh.h"
+#include "usdKatana/staticAttrCache.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace StaticAttrCacheTests
+{
+FnAttribute::GroupAttribute ReadMesh(const UsdStageRefPtr& stage,
+                                     const std::string& path,
+                                     double time,
+                                     bool shareStaticData)
+{
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.currentTime = time;
+    usdInArgsBuilder.motionSampleTimes = {0.0};
+    usdInArgsBuilder.shareStaticData = shareStaticData;
+    auto usdInArgs = usdInArgsBuilder.build();
+
+    const UsdPrim prim = stage->GetPrimAtPath(SdfPath(path));
+    const UsdKatanaUsdInPrivateData privateData(prim, usdInArgs);
+    UsdKatanaAttrMap attrs;
+    UsdKatanaReadMesh(UsdGeomMesh(prim), privateData, attrs);
+    return attrs.build();
+}
+
+TEST(StaticAttrCacheTest, SharedAcrossFrames)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/cookCache1.usda");
+    UsdKatanaStaticAttrCache& staticAttrCache = UsdKatanaStaticAttrCache::GetInstance();
+    staticAttrCache.Clear();
+
+    const FnAttribute::GroupAttribute expected = ReadMesh(stage, "/root/static", 1.0, true);
+    const size_t numMisses = staticAttrCache.GetNumMisses();
+    const size_t numHits = staticAttrCache.GetNumHits();
+    ASSERT_GT(staticAttrCache.GetNumEntries(), 0u);
+    ASSERT_GT(staticAttrCache.GetMemoryUsage(), 0u);
+
+    // Every static attribute of the static mesh is shared by the next frame.
+    const FnAttribute::GroupAttribute cached = ReadMesh(stage, "/root/static", 2.0, true);
+    ASSERT_EQ(cached.getHash(), expected.getHash());
+    ASSERT_EQ(staticAttrCache.GetNumMisses(), numMisses);
+    ASSERT_GT(staticAttrCache.GetNumHits(), numHits);
+
+    // The animated points are read at every frame, the topology is not.
+    const FnAttribute::GroupAttribute frame1 = ReadMesh(stage, "/root/animated", 1.0, true);
+    const size_t numEntries = staticAttrCache.GetNumEntries();
+    const FnAttribute::GroupAttribute frame2 = ReadMesh(stage, "/root/animated", 2.0, true);
+    ASSERT_EQ(staticAttrCache.GetNumEntries(), numEntries);
+    ASSERT_NE(frame1.getChildByName("geometry.point.P").getHash(),
+              frame2.getChildByName("geometry.point.P").getHash());
+    ASSERT_EQ(frame1.getChildByName("geometry.poly").getHash(),
+              frame2.getChildByName("geometry.poly").getHash());
+
+    // The cache is only used when the args share static data.
+    const size_t numLookups = staticAttrCache.GetNumHits() + staticAttrCache.GetNumMisses();
+    ReadMesh(stage, "/root/static", 3.0, false);
+    ASSERT_EQ(staticAttrCache.GetNumHits() + staticAttrCache.GetNumMisses(), numLookups);
+
+    staticAttrCache.Clear();
+    ASSERT_EQ(staticAttrCache.GetNumEntries(), 0u);
+}
+
+}  // namespace StaticAttrCacheTests
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,185 @@
+#include "gtest/gtest.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <FnAttribute/FnAttribute.h>
+#include <FnAttribute/FnDataBuilder.h>
+
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/vt/array.h"
+#include "pxr/pxr.h"
+
+#include "usdKatana/utils.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace UtilsTests
+{
+namespace
+{
+FnAttribute::DoubleAttribute BuildJointMatrices(
+    const std::map<float, std::vector<GfMatrix4d>>& samples)
+{
+    FnAttribute::DoubleBuilder builder(16);
+    for (const auto& sample : samples)
+    {
+        std::vector<double>& values = builder.get(sample.first);
+        for (const GfMatrix4d& matrix : sample.second)
+        {
+            values.insert(values.end(), matrix.data(), matrix.data() + 16);
+        }
+    }
+    return builder.build();
+}
+
+// Two points, each fully bound to its own joint.
+FnAttribute::GroupAttribute BuildSkinningAttr(const FnAttribute::DoubleAttribute& jointMatrices,
+                                              const std::vector<float>& jointWeights)
+{
+    const std::vector<int> jointIndices = {0, 1};
+    return FnAttribute::GroupBuilder()
+        .set("method", FnAttribute::StringAttribute("classicLinear"))
+        .set("numInfluencesPerPoint", FnAttribute::IntAttribute(1))
+        .set("constantInfluences", FnAttribute::IntAttribute(0))
+        .set("jointIndices", FnAttribute::IntAttribute(jointIndices.data(), 2, 1))
+        .set("jointWeights",
+             FnAttribute::FloatAttribute(jointWeights.data(), jointWeights.size(), 1))
+        .set("jointMatrices", jointMatrices)
+        .build();
+}
+
+const GfMatrix4d kIdentity(1.0);
+
+GfMatrix4d Translation(double x, double y, double z)
+{
+    return GfMatrix4d(1.0).SetTranslate(GfVec3d(x, y, z));
+}
+}  // namespace
+
+TEST(UtilsTest, CollapseIdenticalSamples)
+{
+    const VtVec3fArray points = {GfVec3f(0, 0, 0), GfVec3f(1, 0, 0)};
+    VtVec3fArray copy = points;
+    copy.MakeUnique();
+
+    std::map<float, VtVec3fArray> samples = {{-0.25f, points}, {0.25f, copy}};
+    ASSERT_TRUE(UsdKatanaUtils::CollapseIdenticalSamples(&samples));
+    ASSERT_EQ(samples.size(), 1u);
+    ASSERT_EQ(samples.begin()->first, 0.0f);
+    ASSERT_EQ(samples.begin()->second, points);
+
+    // A single sample is left alone.
+    ASSERT_FALSE(UsdKatanaUtils::CollapseIdenticalSamples(&samples));
+
+    VtVec3fArray moved = points;
+    moved[1] = GfVec3f(2, 0, 0);
+    samples = {{-0.25f, points}, {0.25f, moved}};
+    ASSERT_FALSE(UsdKatanaUtils::CollapseIdenticalSamples(&samples));
+    ASSERT_EQ(samples.size(), 2u);
+
+    // Samples of different sizes are never identical.
+    samples = {{-0.25f, points}, {0.25f, VtVec3fArray(1)}};
+    ASSERT_FALSE(UsdKatanaUtils::CollapseIdenticalSamples(&samples));
+}
+
+TEST(UtilsTest, CollapseIdenticalSamplesOfASingleBuffer)
+{
+    const VtVec3fArray points = {GfVec3f(0, 0, 0), GfVec3f(1, 0, 0)};
+
+    std::vector<float> times = {-0.25f, 0.25f};
+    VtVec3fArray samples = {points[0], points[1], points[0], points[1]};
+    ASSERT_TRUE(UsdKatanaUtils::CollapseIdenticalSamples(&times, &samples));
+    ASSERT_EQ(times, std::vector<float>{0.0f});
+    ASSERT_EQ(samples, points);
+
+    // A single sample is left alone.
+    ASSERT_FALSE(UsdKatanaUtils::CollapseIdenticalSamples(&times, &samples));
+
+    times = {-0.25f, 0.25f};
+    samples = {points[0], points[1], points[0], GfVec3f(2, 0, 0)};
+    ASSERT_FALSE(UsdKatanaUtils::CollapseIdenticalSamples(&times, &samples));
+    ASSERT_EQ(times.size(), 2u);
+    ASSERT_EQ(samples.size(), 4u);
+}
+
+TEST(UtilsTest, ApplyDeferredSkinning)
+{
+    const float restPoints[] = {0, 0, 0, 1, 1, 1};
+    const FnAttribute::FloatAttribute pointsAttr(restPoints, 6, 3);
+    const FnAttribute::GroupAttribute skinningAttr = BuildSkinningAttr(
+        BuildJointMatrices({{-0.25f, {Translation(1, 0, 0), Translation(1, 0, 0)}},
+                            {0.25f, {Translation(2, 0, 0), Translation(0, 3, 0)}}}),
+        {1.0f, 1.0f});
+
+    std::string errorMessage;
+    const FnAttribute::FloatAttribute skinnedAttr =
+        UsdKatanaUtils::ApplyDeferredSkinning(skinningAttr, pointsAttr, &errorMessage);
+    ASSERT_TRUE(skinnedAttr.isValid()) << errorMessage;
+    ASSERT_EQ(skinnedAttr.getNumberOfTimeSamples(), 2);
+
+    const FnAttribute::FloatConstVector open = skinnedAttr.getNearestSample(-0.25f);
+    ASSERT_EQ(std::vector<float>(open.begin(), open.end()),
+              std::vector<float>({1, 0, 0, 2, 1, 1}));
+    const FnAttribute::FloatConstVector close = skinnedAttr.getNearestSample(0.25f);
+    ASSERT_EQ(std::vector<float>(close.begin(), close.end()),
+              std::vector<float>({2, 0, 0, 1, 4, 1}));
+}
+
+TEST(UtilsTest, ApplyDeferredSkinningToAnimatedRestPoints)
+{
+    // Points animated by blend shapes under a still skeleton keep every
+    // sample of the points.
+    FnAttribute::FloatBuilder pointsBuilder(3);
+    pointsBuilder.get(-0.25f) = {0, 0, 0, 1, 1, 1};
+    pointsBuilder.get(0.25f) = {0, 1, 0, 1, 2, 1};
+    const FnAttribute::GroupAttribute skinningAttr = BuildSkinningAttr(
+        BuildJointMatrices({{0.0f, {Translation(1, 0, 0), kIdentity}}}), {1.0f, 1.0f});
+
+    std::string errorMessage;
+    const FnAttribute::FloatAttribute skinnedAttr =
+        UsdKatanaUtils::ApplyDeferredSkinning(skinningAttr, pointsBuilder.build(), &errorMessage);
+    ASSERT_TRUE(skinnedAttr.isValid()) << errorMessage;
+    ASSERT_EQ(skinnedAttr.getNumberOfTimeSamples(), 2);
+
+    const FnAttribute::FloatConstVector close = skinnedAttr.getNearestSample(0.25f);
+    ASSERT_EQ(std::vector<float>(close.begin(), close.end()),
+              std::vector<float>({1, 1, 0, 1, 2, 1}));
+}
+
+TEST(UtilsTest, ApplyDeferredSkinningFailures)
+{
+    const float restPoints[] = {0, 0, 0, 1, 1, 1};
+    const FnAttribute::FloatAttribute pointsAttr(restPoints, 6, 3);
+    const FnAttribute::DoubleAttribute jointMatrices =
+        BuildJointMatrices({{0.0f, {kIdentity, kIdentity}}});
+
+    // Influences that do not match the points.
+    std::string errorMessage;
+    ASSERT_FALSE(UsdKatanaUtils::ApplyDeferredSkinning(
+                     BuildSkinningAttr(jointMatrices, {1.0f, 1.0f, 1.0f}), pointsAttr,
+                     &errorMessage)
+                     .isValid());
+    ASSERT_FALSE(errorMessage.empty());
+
+    // Missing joint matrices.
+    errorMessage.clear();
+    ASSERT_FALSE(UsdKatanaUtils::ApplyDeferredSkinning(
+                     BuildSkinningAttr(FnAttribute::DoubleAttribute(), {1.0f, 1.0f}),
+                     pointsAttr, &errorMessage)
+                     .isValid());
+    ASSERT_FALSE(errorMessage.empty());
+
+    // Missing points.
+    errorMessage.clear();
+    ASSERT_FALSE(UsdKatanaUtils::ApplyDeferredSkinning(
+                     BuildSkinningAttr(jointMatrices, {1.0f, 1.0f}),
+                     FnAttribute::FloatAttribute(), &errorMessage)
+                     .isValid());
+    ASSERT_FALSE(errorMessage.empty());
+}
+
+}  // namespace UtilsTests
+PXR_NAMESPACE_CLOSE_SCOPE
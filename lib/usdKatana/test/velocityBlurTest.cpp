@@ -0,0 +1,69 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/points.h"
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/readPoints.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace VelocityBlurTests
+{
+FnAttribute::GroupAttribute ReadPoints(const UsdStageRefPtr& stage, bool velocityBlur)
+{
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.currentTime = 1.0;
+    usdInArgsBuilder.shutterClose = 0.5;
+    usdInArgsBuilder.motionSampleTimes = {0.0, 0.5};
+    usdInArgsBuilder.velocityBlur = velocityBlur;
+    auto usdInArgs = usdInArgsBuilder.build();
+
+    const UsdPrim prim = stage->GetPrimAtPath(SdfPath("/root/points"));
+    const UsdKatanaUsdInPrivateData privateData(prim, usdInArgs);
+    UsdKatanaAttrMap attrs;
+    UsdKatanaReadPoints(UsdGeomPoints(prim), privateData, attrs);
+    return attrs.build();
+}
+
+TEST(VelocityBlurTest, PointsExtrapolatedFromVelocities)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/velocityBlur1.usda");
+
+    // The points have a single sample, so they have no motion by default.
+    const FnAttribute::FloatAttribute staticP =
+        ReadPoints(stage, false).getChildByName("geometry.point.P");
+    ASSERT_TRUE(staticP.isValid());
+    ASSERT_EQ(staticP.getNumberOfTimeSamples(), 1);
+
+    const FnAttribute::GroupAttribute attrs = ReadPoints(stage, true);
+    const FnAttribute::FloatAttribute pointsAttr = attrs.getChildByName("geometry.point.P");
+    ASSERT_TRUE(pointsAttr.isValid());
+    ASSERT_EQ(pointsAttr.getNumberOfTimeSamples(), 2);
+
+    const FnAttribute::FloatConstVector p0 = pointsAttr.getNearestSample(0.0f);
+    const FnAttribute::FloatConstVector p1 = pointsAttr.getNearestSample(0.5f);
+    ASSERT_EQ(p0.size(), 6u);
+    ASSERT_EQ(p1.size(), 6u);
+    // Velocities are in units per second, half a frame at 24 fps.
+    EXPECT_FLOAT_EQ(p0[0], 0.0f);
+    EXPECT_FLOAT_EQ(p1[0], 0.5f);
+    EXPECT_FLOAT_EQ(p1[3], 1.0f);
+    EXPECT_FLOAT_EQ(p1[4], 1.0f);
+
+    // The velocities are read at the current time only.
+    const FnAttribute::FloatAttribute velocitiesAttr = attrs.getChildByName("geometry.point.v");
+    ASSERT_TRUE(velocitiesAttr.isValid());
+    ASSERT_EQ(velocitiesAttr.getNumberOfTimeSamples(), 1);
+}
+
+}  // namespace VelocityBlurTests
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,163 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/tracing.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/pathUtils.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/trace/collector.h>
+#include <pxr/base/trace/reporter.h>
+#include <pxr/usd/sdf/path.h>
+
+#include <FnLogging/FnLogging.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+FnLogSetup("UsdKatanaTracing");
+
+TF_DEFINE_ENV_SETTING(USD_KATANA_TRACE_LOCATIONS_PER_FILE,
+                      10000,
+                      "Number of cooked locations after which the trace events collected "
+                      "are written to a file and dropped, 0 to only write them at exit.");
+
+namespace
+{
+std::string& GetTraceOutputPath()
+{
+    // Static accessor method prevents C++ static initialization sadness.
+    static std::string outputPath;
+    return outputPath;
+}
+
+std::once_flag& GetEnableOnceFlag()
+{
+    static std::once_flag onceFlag;
+    return onceFlag;
+}
+
+// Number of locations cooked since the last write, and the number of files
+// written so far.
+std::atomic<int> numTracedLocations{0};
+int numTraceFiles = 0;
+
+std::mutex& GetWriteMutex()
+{
+    static std::mutex writeMutex;
+    return writeMutex;
+}
+
+void WriteTraceAtExit()
+{
+    UsdKatanaWriteTrace();
+}
+
+std::string GetTraceFilePath(const std::string& outputPath, int fileIndex)
+{
+    if (fileIndex == 0)
+    {
+        return outputPath;
+    }
+    const std::string extension = TfGetExtension(outputPath);
+    return extension.empty() ? TfStringPrintf("%s.%d", outputPath.c_str(), fileIndex)
+                             : TfStringPrintf("%s.%d.%s",
+                                              TfStringGetBeforeSuffix(outputPath).c_str(),
+                                              fileIndex, extension.c_str());
+}
+
+}  // namespace
+
+void UsdKatanaEnableTracing(const std::string& outputPath)
+{
+    if (outputPath.empty())
+    {
+        return;
+    }
+    std::call_once(GetEnableOnceFlag(), [&outputPath]() {
+#if defined(_WIN32)
+        const int pid = _getpid();
+#else
+        const int pid = static_cast<int>(getpid());
+#endif
+        GetTraceOutputPath() = TfStringReplace(outputPath, "{pid}", TfStringify(pid));
+        TraceCollector::GetInstance().SetEnabled(true);
+        std::atexit(WriteTraceAtExit);
+        FnLogInfo("Writing trace events to " << GetTraceOutputPath());
+    });
+}
+
+bool UsdKatanaIsTracingEnabled()
+{
+    return TraceCollector::IsEnabled();
+}
+
+bool UsdKatanaWriteTrace()
+{
+    const std::string& outputPath = GetTraceOutputPath();
+    if (outputPath.empty())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(GetWriteMutex());
+    numTracedLocations = 0;
+    const std::string filePath = GetTraceFilePath(outputPath, numTraceFiles++);
+    std::ofstream out(filePath);
+    if (!out)
+    {
+        FnLogWarn("Unable to write trace events to " << filePath);
+        return false;
+    }
+    // Reporting consumes the events of the collector, clearing the tree drops
+    // them from the reporter as well.
+    TraceReporterPtr reporter = TraceReporter::GetGlobalReporter();
+    reporter->ReportChromeTracing(out);
+    reporter->ClearTree();
+    return static_cast<bool>(out);
+}
+
+UsdKatanaTracePrimScope::UsdKatanaTracePrimScope(const TraceStaticKeyData& key,
+                                                 const SdfPath& primPath)
+    : _scope(key, "primPath", primPath.GetString())
+{
+    static const int locationsPerFile = TfGetEnvSetting(USD_KATANA_TRACE_LOCATIONS_PER_FILE);
+    if (TraceCollector::IsEnabled() && locationsPerFile > 0 &&
+        numTracedLocations.fetch_add(1, std::memory_order_relaxed) + 1 == locationsPerFile)
+    {
+        UsdKatanaWriteTrace();
+    }
+}
+
+UsdKatanaTracePrimScope::~UsdKatanaTracePrimScope() = default;
+
+PXR_NAMESPACE_CLOSE_SCOPE
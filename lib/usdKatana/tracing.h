@@ -0,0 +1,87 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_TRACING_H
+#define USDKATANA_TRACING_H
+
+#include <string>
+
+#include <pxr/base/trace/trace.h>
+#include <pxr/pxr.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+class SdfPath;
+
+/// Enable collection of the TRACE_FUNCTION and TRACE_SCOPE events recorded by
+/// UsdIn and the readers, for the rest of the process. The events are written
+/// to \p outputPath as Chrome trace JSON, which can be opened in
+/// chrome://tracing or Perfetto. Any "{pid}" in \p outputPath is replaced
+/// with the process id, so that every process of a render writes its own
+/// file.
+///
+/// So that a long session does not hold every event in memory, the events
+/// are written and dropped every USD_KATANA_TRACE_LOCATIONS_PER_FILE cooked
+/// locations, and when the process exits. See UsdKatanaWriteTrace() for the
+/// files written.
+///
+/// Calls after the first one, and calls with an empty path, are ignored.
+USDKATANA_API void UsdKatanaEnableTracing(const std::string& outputPath);
+
+/// Returns true if trace events are being collected.
+USDKATANA_API bool UsdKatanaIsTracingEnabled();
+
+/// Write the events collected since the last write, and drop them. The first
+/// write goes to the output path given to UsdKatanaEnableTracing(), the
+/// following ones to the same path with ".1", ".2", ... inserted before its
+/// extension. Scopes still open during a write are cut. Returns false if
+/// tracing is disabled or the file could not be written.
+USDKATANA_API bool UsdKatanaWriteTrace();
+
+/// Trace scope for the cook of a location, with the prim path recorded as an
+/// argument of the event, so that the time spent cooking a location can be
+/// attributed to its prim. \p key is the static name of the scope, see
+/// USDKATANA_TRACE_PRIM_SCOPE.
+class UsdKatanaTracePrimScope
+{
+public:
+    USDKATANA_API UsdKatanaTracePrimScope(const TraceStaticKeyData& key, const SdfPath& primPath);
+    USDKATANA_API ~UsdKatanaTracePrimScope();
+
+    UsdKatanaTracePrimScope(const UsdKatanaTracePrimScope&) = delete;
+    UsdKatanaTracePrimScope& operator=(const UsdKatanaTracePrimScope&) = delete;
+
+private:
+    TraceScopeAuto _scope;
+};
+
+/// Opens a UsdKatanaTracePrimScope named \p name, a string literal, until the
+/// end of the enclosing block.
+#define USDKATANA_TRACE_PRIM_SCOPE(name, primPath)                                 \
+    static const TraceStaticKeyData usdKatanaTracePrimScopeKey(name);              \
+    UsdKatanaTracePrimScope usdKatanaTracePrimScope(usdKatanaTracePrimScopeKey, primPath)
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_TRACING_H
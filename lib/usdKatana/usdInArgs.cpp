@@ -29,18 +29,41 @@
 //
 #include "usdKatana/usdInArgs.h"
 
+#include <map>
+#include <mutex>
 #include <set>
 #include <string>
 
 #include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/usd/usdGeom/boundable.h>
+#include <pxr/usd/usdGeom/modelAPI.h>
 
 #include <FnAttribute/FnDataBuilder.h>
 
+#include "usdKatana/cache.h"
+#include "usdKatana/cookCache.h"
 #include "usdKatana/utils.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+namespace
+{
+// The args alive in the process, for reporting the memory of their caches.
+std::mutex& GetLiveArgsMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::set<const UsdKatanaUsdInArgs*>& GetLiveArgs()
+{
+    static std::set<const UsdKatanaUsdInArgs*> liveArgs;
+    return liveArgs;
+}
+
+}  // namespace
+
 UsdKatanaUsdInArgs::UsdKatanaUsdInArgs(UsdStageRefPtr stage,
                                        const std::string& rootLocation,
                                        const std::string& isolatePath,
@@ -57,6 +80,19 @@ UsdKatanaUsdInArgs::UsdKatanaUsdInArgs(UsdStageRefPtr stage,
                                        bool verbose,
                                        const std::set<std::string>& outputTargets,
                                        const bool evaluateUsdSkelBindings,
+                                       const bool deferUsdSkelSkinning,
+                                       const bool useAuthoredExtents,
+                                       const bool authorExtentsHints,
+                                       const bool shareStaticData,
+                                       const bool velocityBlur,
+                                       const std::string& instanceCullingCamera,
+                                       double instanceCullingMargin,
+                                       double instanceCullingMinSize,
+                                       double instanceCullingAspectRatio,
+                                       double instanceCullingOverscan,
+                                       int instanceTileSize,
+                                       const std::string& instanceMode,
+                                       bool remapInstanceIds,
                                        const char* errorMessage)
     : _stage(stage),
       _rootLocation(rootLocation),
@@ -73,70 +109,108 @@ UsdKatanaUsdInArgs::UsdKatanaUsdInArgs(UsdStageRefPtr stage,
       _prePopulate(prePopulate),
       _verbose(verbose),
       _outputTargets(outputTargets),
-      _evaluateUsdSkelBindings(evaluateUsdSkelBindings)
+      _evaluateUsdSkelBindings(evaluateUsdSkelBindings),
+      _deferUsdSkelSkinning(deferUsdSkelSkinning),
+      _useAuthoredExtents(useAuthoredExtents),
+      _authorExtentsHints(authorExtentsHints),
+      _shareStaticData(shareStaticData),
+      _velocityBlur(velocityBlur),
+      _instanceCullingCamera(instanceCullingCamera),
+      _instanceCullingMargin(instanceCullingMargin),
+      _instanceCullingMinSize(instanceCullingMinSize),
+      _instanceCullingAspectRatio(instanceCullingAspectRatio),
+      _instanceCullingOverscan(instanceCullingOverscan),
+      _instanceTileSize(instanceTileSize),
+      _instanceMode(instanceMode),
+      _remapInstanceIds(remapInstanceIds)
 {
     if (errorMessage)
     {
         _errorMessage = errorMessage;
     }
+
+    if (_stage)
+    {
+        UsdKatanaCache::GetInstance().RetainStage(_stage);
+    }
+    _boundsCache = UsdKatanaCache::GetInstance().GetBoundsCache(_stage);
+
+    std::lock_guard<std::mutex> lock(GetLiveArgsMutex());
+    GetLiveArgs().insert(this);
+}
+
+UsdKatanaUsdInArgs::~UsdKatanaUsdInArgs()
+{
+    if (_stage)
+    {
+        UsdKatanaCache::GetInstance().ReleaseStage(_stage);
+    }
+
+    std::lock_guard<std::mutex> lock(GetLiveArgsMutex());
+    GetLiveArgs().erase(this);
 }
 
-UsdKatanaUsdInArgs::~UsdKatanaUsdInArgs() {}
+void UsdKatanaUsdInArgs::ReportMemoryUsage(UsdKatanaCacheMemoryUsageVector* usage)
+{
+    // Both caches can be queried while other threads are filling them. The
+    // bounds caches are shared by the args of a stage, and counted once.
+    std::map<std::string, std::pair<UsdKatanaCacheMemoryUsage, UsdKatanaCacheMemoryUsage>>
+        usagePerStage;
+    std::set<const UsdKatanaBoundsCache*> boundsCaches;
+    {
+        std::lock_guard<std::mutex> lock(GetLiveArgsMutex());
+        for (const UsdKatanaUsdInArgs* args : GetLiveArgs())
+        {
+            const std::string stage = args->_stage ? args->GetFileName() : std::string();
+            auto& stageUsage = usagePerStage[stage];
+            if (boundsCaches.insert(args->_boundsCache.get()).second)
+            {
+                stageUsage.first.bytes += args->_boundsCache->GetMemoryUsage();
+                stageUsage.first.numEntries += args->_boundsCache->GetNumEntries();
+            }
+            stageUsage.second.bytes += args->_skinningCache.GetMemoryUsage();
+            stageUsage.second.numEntries += args->_skinningCache.GetNumEntries();
+        }
+    }
+
+    for (auto& entry : usagePerStage)
+    {
+        entry.second.first.cacheName = "bounds";
+        entry.second.first.stage = entry.first;
+        usage->push_back(entry.second.first);
+        entry.second.second.cacheName = "skinning";
+        entry.second.second.stage = entry.first;
+        usage->push_back(entry.second.second);
+    }
+}
 
 std::vector<GfBBox3d> UsdKatanaUsdInArgs::ComputeBounds(
     const UsdPrim& prim,
     const std::vector<double>& motionSampleTimes,
     bool applyLocalTransform)
 {
-    std::vector<GfBBox3d> ret;
+    TRACE_FUNCTION();
 
-    std::map<double, UsdGeomBBoxCache>& bboxCaches = _bboxCaches.local();
+    std::vector<GfBBox3d> ret;
+    ret.reserve(motionSampleTimes.size());
 
-    TfTokenVector includedPurposes;
+    // XXX: selected purposes should be driven by the UI.
+    // See usdGeom/imageable.h GetPurposeAttr() for allowed values.
+    static const TfTokenVector includedPurposes = {UsdGeomTokens->default_,
+                                                   UsdGeomTokens->render};
 
     for (size_t i = 0; i < motionSampleTimes.size(); i++)
     {
         double relSampleTime = motionSampleTimes[i];
+        const double time = _currentTime + relSampleTime;
+        ret.push_back(_boundsCache->ComputeBound(prim, time, includedPurposes, applyLocalTransform,
+                                                _useAuthoredExtents));
+    }
 
-        std::map<double, UsdGeomBBoxCache>::iterator it =
-            bboxCaches.find(relSampleTime);
-        if (it == bboxCaches.end())
-        {
-            if (includedPurposes.size() == 0)
-            {
-                // XXX: selected purposes should be driven by the UI.
-                // See usdGeom/imageable.h GetPurposeAttr() for allowed values.
-                includedPurposes.push_back(UsdGeomTokens->default_);
-                includedPurposes.push_back(UsdGeomTokens->render);
-            }
-
-            // Initialize the bounding box cache for this time sample if it
-            // hasn't yet been initialized.
-            UsdGeomBBoxCache bboxCache(_currentTime + relSampleTime,
-                                       includedPurposes,
-                                       /* useExtentsHint */ true);
-            bboxCaches.insert(
-                std::pair<double, UsdGeomBBoxCache>(relSampleTime, bboxCache));
-            if (applyLocalTransform)
-            {
-                ret.push_back(bboxCache.ComputeLocalBound(prim));
-            }
-            else
-            {
-                ret.push_back(bboxCache.ComputeUntransformedBound(prim));
-            }
-        }
-        else
-        {
-            if (applyLocalTransform)
-            {
-                ret.push_back(it->second.ComputeLocalBound(prim));
-            }
-            else
-            {
-                ret.push_back(it->second.ComputeUntransformedBound(prim));
-            }
-        }
+    if (_authorExtentsHints && prim.IsModel() && !prim.IsInstanceProxy() &&
+        !prim.IsInPrototype() && !UsdGeomModelAPI(prim).GetExtentsHintAttr().HasAuthoredValue())
+    {
+        _boundsCache->RecordMissingExtentsHint(prim);
     }
 
     return ret;
@@ -152,5 +226,12 @@ UsdPrim UsdKatanaUsdInArgs::GetRootPrim() const
     }
 }
 
+const std::string& UsdKatanaUsdInArgs::GetCookCacheKey()
+{
+    std::call_once(_cookCacheKeyOnce,
+                   [this]() { _cookCacheKey = UsdKatanaCookCache::ComputeFileKey(*this); });
+    return _cookCacheKey;
+}
+
 PXR_NAMESPACE_CLOSE_SCOPE
 
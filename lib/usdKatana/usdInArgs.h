@@ -30,7 +30,11 @@
 #ifndef USDKATANA_USDIN_ARGS_H
 #define USDKATANA_USDIN_ARGS_H
 
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <utility>
 
 #include <pxr/base/tf/refPtr.h>
 #include <pxr/pxr.h>
@@ -40,6 +44,9 @@
 #include <tbb/enumerable_thread_specific.h>
 
 #include "usdKatana/api.h"
+#include "usdKatana/boundsCache.h"
+#include "usdKatana/cache.h"
+#include "usdKatana/skinningCache.h"
 
 /// \brief Reference counted container for op state that should be constructed
 /// at an ops root and passed to read USD prims into Katana attributes.
@@ -111,13 +118,29 @@ public:
         bool verbose,
         const std::set<std::string>& outputTargets,
         const bool evaluateUsdSkelBindings,
+        const bool deferUsdSkelSkinning,
+        const bool useAuthoredExtents,
+        const bool authorExtentsHints,
+        const bool shareStaticData,
+        const bool velocityBlur,
+        const std::string& instanceCullingCamera,
+        double instanceCullingMargin,
+        double instanceCullingMinSize,
+        double instanceCullingAspectRatio,
+        double instanceCullingOverscan,
+        int instanceTileSize,
+        const std::string& instanceMode,
+        bool remapInstanceIds,
         const char* errorMessage = 0)
     {
         return TfCreateRefPtr(new UsdKatanaUsdInArgs(
             stage, rootLocation, isolatePath, sessionLocation, sessionAttr, ignoreLayerRegex,
             currentTime, shutterOpen, shutterClose, motionSampleTimes, extraAttributesOrNamespaces,
             materialBindingPurposes, prePopulate, verbose, outputTargets, evaluateUsdSkelBindings,
-            errorMessage));
+            deferUsdSkelSkinning, useAuthoredExtents, authorExtentsHints, shareStaticData,
+            velocityBlur, instanceCullingCamera, instanceCullingMargin, instanceCullingMinSize,
+            instanceCullingAspectRatio, instanceCullingOverscan, instanceTileSize, instanceMode,
+            remapInstanceIds, errorMessage));
     }
 
     // bounds computation is kind of important, so we centralize it here.
@@ -188,13 +211,24 @@ public:
         return _verbose;
     }
 
+    /// Returns this thread's UsdGeomBBoxCache objects, keyed by relative
+    /// sample time. ComputeBounds() does not use these; it goes through the
+    /// bounds cache shared by all threads, see GetBoundsCache().
     std::map<double, UsdGeomBBoxCache>& GetBBoxCache() {
         return _bboxCaches.local();
     }
 
+    UsdKatanaBoundsCache& GetBoundsCache() {
+        return *_boundsCache;
+    }
+
     UsdSkelCache& GetUsdSkelCache() {
         return _usdSkelCache;
     }
+
+    UsdKatanaSkinningCache& GetSkinningCache() {
+        return _skinningCache;
+    }
     
     const std::set<std::string> & GetOutputTargets() {
         return _outputTargets;
@@ -204,9 +238,96 @@ public:
         return _evaluateUsdSkelBindings;
     }
 
+    bool GetDeferUsdSkelSkinning() const {
+        return _deferUsdSkelSkinning;
+    }
+
+    bool GetUseAuthoredExtents() const {
+        return _useAuthoredExtents;
+    }
+
+    bool GetAuthorExtentsHints() const {
+        return _authorExtentsHints;
+    }
+
+    /// Whether the Katana attributes converted from time invariant USD
+    /// attributes are shared with the cooks of other frames, see
+    /// UsdKatanaStaticAttrCache.
+    bool GetShareStaticData() const {
+        return _shareStaticData;
+    }
+
+    /// Whether the points of gprims with authored velocities are read at a
+    /// single time and extrapolated to the motion sample times, rather than
+    /// read at every motion sample time.
+    bool GetVelocityBlur() const {
+        return _velocityBlur;
+    }
+
+    /// The path of the camera prim against whose frustum the instances of
+    /// point instancers are culled, or empty if they are not culled.
+    const std::string& GetInstanceCullingCamera() const {
+        return _instanceCullingCamera;
+    }
+
+    /// The distance, in world units, by which the bounds of instances are
+    /// padded before they are culled.
+    double GetInstanceCullingMargin() const {
+        return _instanceCullingMargin;
+    }
+
+    /// The size of the bounds of instances, relative to their distance to the
+    /// culling camera, below which they are culled, or 0 to keep instances
+    /// of any size.
+    double GetInstanceCullingMinSize() const {
+        return _instanceCullingMinSize;
+    }
+
+    /// The width over height of the rendered images, to which the window of
+    /// the culling camera is expanded, or 0 to cull against the aperture of
+    /// the camera.
+    double GetInstanceCullingAspectRatio() const {
+        return _instanceCullingAspectRatio;
+    }
+
+    /// The fraction of the width and height of the window of the culling
+    /// camera added on each side of it, as the overscan of the render adds.
+    double GetInstanceCullingOverscan() const {
+        return _instanceCullingOverscan;
+    }
+
+    /// The largest number of instances of a point instancer in a single
+    /// instance array location, or 0 to put all of them in one location.
+    /// Larger point instancers are split into spatial tiles.
+    int GetInstanceTileSize() const {
+        return _instanceTileSize;
+    }
+
+    /// The "instanceMode" of UsdIn: "expanded" or "as sources and
+    /// instances".
+    const std::string& GetInstanceMode() const {
+        return _instanceMode;
+    }
+
+    /// Whether the ids of point instancers which do not fit in 32-bit
+    /// integers are replaced by their index among the sorted unique ids,
+    /// the original ids being written to "info.usd.idsTable".
+    bool GetRemapInstanceIds() const {
+        return _remapInstanceIds;
+    }
+
     const std::string & GetErrorMessage() {
         return _errorMessage;
     }
+
+    /// Returns the name of the file of the on-disk cook cache used for these
+    /// args, computed on first use. See UsdKatanaCookCache::ComputeFileKey().
+    USDKATANA_API const std::string& GetCookCacheKey();
+
+    /// Appends the memory held by the bounds and skinning caches of all the
+    /// UsdKatanaUsdInArgs alive in the process to \p usage, summed per stage.
+    USDKATANA_API static void ReportMemoryUsage(UsdKatanaCacheMemoryUsageVector* usage);
+
 private:
     UsdKatanaUsdInArgs(UsdStageRefPtr stage,
                        const std::string& rootLocation,
@@ -224,6 +345,19 @@ private:
                        bool verbose,
                        const std::set<std::string>& outputTargets,
                        bool evaluateUsdSkelBindings,
+                       bool deferUsdSkelSkinning,
+                       bool useAuthoredExtents,
+                       bool authorExtentsHints,
+                       bool shareStaticData,
+                       bool velocityBlur,
+                       const std::string& instanceCullingCamera,
+                       double instanceCullingMargin,
+                       double instanceCullingMinSize,
+                       double instanceCullingAspectRatio,
+                       double instanceCullingOverscan,
+                       int instanceTileSize,
+                       const std::string& instanceMode,
+                       bool remapInstanceIds,
                        const char* errorMessage = 0);
 
     ~UsdKatanaUsdInArgs();
@@ -255,12 +389,48 @@ private:
     typedef tbb::enumerable_thread_specific< std::map<double, UsdGeomBBoxCache> > _ThreadLocalBBoxCaches;
     _ThreadLocalBBoxCaches _bboxCaches;
 
+    // Bounds shared between all threads cooking locations of the stage, see
+    // UsdKatanaCache::GetBoundsCache().
+    std::shared_ptr<UsdKatanaBoundsCache> _boundsCache;
+
     // Cache for accelerating UsdSkel skinning data calculation.
     UsdSkelCache _usdSkelCache;
+
+    // Skinning transforms shared by all meshes bound to the same skeleton.
+    UsdKatanaSkinningCache _skinningCache;
     
     bool _evaluateUsdSkelBindings{true};
 
+    // Emit rest points and joint data instead of skinned points.
+    bool _deferUsdSkelSkinning{false};
+
+    // Use authored extentsHint and extent values for bounds rather than a
+    // traversal, and optionally record the hints that are missing in the
+    // bounds cache of the stage so that
+    // UsdKatanaCache::AuthorMissingExtentsHints() authors them.
+    bool _useAuthoredExtents{false};
+    bool _authorExtentsHints{false};
+
+    bool _shareStaticData{false};
+
+    bool _velocityBlur{false};
+
+    std::string _instanceCullingCamera;
+    double _instanceCullingMargin{0.0};
+    double _instanceCullingMinSize{0.0};
+    double _instanceCullingAspectRatio{0.0};
+    double _instanceCullingOverscan{0.0};
+
+    int _instanceTileSize{0};
+
+    std::string _instanceMode;
+
+    bool _remapInstanceIds{false};
+
     std::string _errorMessage;
+
+    std::once_flag _cookCacheKeyOnce;
+    std::string _cookCacheKey;
 };
 
 // utility to make it easier to exit earlier from InitUsdInArgs
@@ -282,6 +452,19 @@ struct ArgsBuilder
     bool verbose;
     std::set<std::string> outputTargets;
     bool evaluateUsdSkelBindings;
+    bool deferUsdSkelSkinning;
+    bool useAuthoredExtents;
+    bool authorExtentsHints;
+    bool shareStaticData;
+    bool velocityBlur;
+    std::string instanceCullingCamera;
+    double instanceCullingMargin;
+    double instanceCullingMinSize;
+    double instanceCullingAspectRatio;
+    double instanceCullingOverscan;
+    int instanceTileSize;
+    std::string instanceMode;
+    bool remapInstanceIds;
     const char* errorMessage;
 
     ArgsBuilder()
@@ -291,6 +474,18 @@ struct ArgsBuilder
     , prePopulate(false)
     , verbose(true)
     , evaluateUsdSkelBindings(true)
+    , deferUsdSkelSkinning(false)
+    , useAuthoredExtents(false)
+    , authorExtentsHints(false)
+    , shareStaticData(false)
+    , velocityBlur(false)
+    , instanceCullingMargin(0.0)
+    , instanceCullingMinSize(0.0)
+    , instanceCullingAspectRatio(0.0)
+    , instanceCullingOverscan(0.0)
+    , instanceTileSize(0)
+    , instanceMode("expanded")
+    , remapInstanceIds(false)
     , errorMessage(0)
     {
     }
@@ -302,7 +497,11 @@ struct ArgsBuilder
             sessionAttr.isValid() ? sessionAttr : FnAttribute::GroupAttribute(true),
             ignoreLayerRegex, currentTime, shutterOpen, shutterClose, motionSampleTimes,
             extraAttributesOrNamespaces, materialBindingPurposes, prePopulate, verbose,
-            outputTargets, evaluateUsdSkelBindings, errorMessage);
+            outputTargets, evaluateUsdSkelBindings, deferUsdSkelSkinning, useAuthoredExtents,
+            authorExtentsHints, shareStaticData, velocityBlur, instanceCullingCamera,
+            instanceCullingMargin, instanceCullingMinSize, instanceCullingAspectRatio,
+            instanceCullingOverscan, instanceTileSize, instanceMode, remapInstanceIds,
+            errorMessage);
     }
 
     void update(UsdKatanaUsdInArgsRefPtr other)
@@ -323,6 +522,19 @@ struct ArgsBuilder
         verbose = other->IsVerbose();
         outputTargets = other->GetOutputTargets();
         evaluateUsdSkelBindings = other->GetEvaluateUsdSkelBindings();
+        deferUsdSkelSkinning = other->GetDeferUsdSkelSkinning();
+        useAuthoredExtents = other->GetUseAuthoredExtents();
+        authorExtentsHints = other->GetAuthorExtentsHints();
+        shareStaticData = other->GetShareStaticData();
+        velocityBlur = other->GetVelocityBlur();
+        instanceCullingCamera = other->GetInstanceCullingCamera();
+        instanceCullingMargin = other->GetInstanceCullingMargin();
+        instanceCullingMinSize = other->GetInstanceCullingMinSize();
+        instanceCullingAspectRatio = other->GetInstanceCullingAspectRatio();
+        instanceCullingOverscan = other->GetInstanceCullingOverscan();
+        instanceTileSize = other->GetInstanceTileSize();
+        instanceMode = other->GetInstanceMode();
+        remapInstanceIds = other->GetRemapInstanceIds();
         errorMessage = other->GetErrorMessage().c_str();
     }
 
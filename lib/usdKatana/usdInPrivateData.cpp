@@ -39,6 +39,7 @@
 #include <pystring/pystring.h>
 #include <FnGeolib/util/Path.h>
 
+#include "usdKatana/cookStats.h"
 #include "usdKatana/utils.h"
 
 namespace
@@ -577,6 +578,16 @@ const std::vector<double> UsdKatanaUsdInPrivateData::GetSkelMotionSampleTimes(
 const std::vector<double> UsdKatanaUsdInPrivateData::GetMotionSampleTimes(
     const UsdAttribute& attr,
     bool fallBackToShutterBoundary) const
+{
+    const std::vector<double> result =
+        _ComputeMotionSampleTimes(attr, fallBackToShutterBoundary);
+    UsdKatanaCookStats::RecordMotionSamples(result.size());
+    return result;
+}
+
+std::vector<double> UsdKatanaUsdInPrivateData::_ComputeMotionSampleTimes(
+    const UsdAttribute& attr,
+    bool fallBackToShutterBoundary) const
 {
     static std::vector<double> noMotion = {0.0};
 
@@ -97,6 +97,8 @@ public:
 
     bool GetEvaluateUsdSkelBindings() const { return _evaluateUsdSkelBindings; }
 
+    bool GetDeferUsdSkelSkinning() const { return _usdInArgs->GetDeferUsdSkelSkinning(); }
+
     bool hasOutputTarget(const std::string& renderer) const
     {
         return _outputTargets.find(renderer) != _outputTargets.end();
@@ -200,6 +202,9 @@ public:
 
 private:
 
+    std::vector<double> _ComputeMotionSampleTimes(const UsdAttribute& attr,
+                                                  bool fallBackToShutterBoundary) const;
+
     UsdPrim _prim;
 
     UsdKatanaUsdInArgsRefPtr _usdInArgs;
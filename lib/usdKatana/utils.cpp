@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <cmath>
 #include <map>
+#include <set>
 #include <sstream>
 #include <unordered_map>
 
@@ -42,7 +43,9 @@
 #include <pxr/base/gf/vec3d.h>
 #include <pxr/base/gf/vec3f.h>
 #include <pxr/base/gf/vec3h.h>
+#include <pxr/base/tf/span.h>
 #include <pxr/base/tf/getenv.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/base/vt/array.h>
 #include <pxr/base/vt/value.h>
 #include <pxr/base/work/loops.h>
@@ -86,6 +89,7 @@
 #include "usdKatana/blindDataObject.h"
 #include "usdKatana/childMaterialAPI.h"
 #include "usdKatana/debugCodes.h"
+#include "usdKatana/skinningCache.h"
 
 FnLogSetup("UsdKatanaUtils");
 
@@ -129,7 +133,8 @@ inline bool hasDeprecatedLookAPI(const UsdPrim& prim)
 void ApplyBlendShapeAnimation(const UsdSkelSkinningQuery& skinningQuery,
                               const UsdSkelSkeletonQuery& skelQuery,
                               const double time,
-                              VtVec3fArray& points)
+                              VtVec3fArray& points,
+                              UsdKatanaSkinningCache& skinningCache)
 {
     const UsdSkelBlendShapeQuery blendShapeQuery =
         UsdSkelBindingAPI(skinningQuery.GetPrim());
@@ -158,34 +163,24 @@ void ApplyBlendShapeAnimation(const UsdSkelSkinningQuery& skinningQuery,
                     weightsForPrim, &subShapeWeights, &blendShapeIndices,
                     &subShapeIndices))
             {
-                const std::vector<VtIntArray> blendShapePointIndices =
-                    blendShapeQuery.ComputeBlendShapePointIndices();
-                const std::vector<VtVec3fArray> subShapePointOffsets =
-                    blendShapeQuery.ComputeSubShapePointOffsets();
-
-                blendShapeQuery.ComputeDeformedPoints(
-                    subShapeWeights, blendShapeIndices, subShapeIndices,
-                    blendShapePointIndices, subShapePointOffsets, points);
+                // Point indices and offsets are static, so they come from the
+                // cache rather than being read again for every sample.
+                const UsdKatanaSkinningCache::BlendShapeDataPtr blendShapeData =
+                    skinningCache.GetBlendShapeData(blendShapeQuery, skinningQuery.GetPrim());
+                UsdKatanaSkinningCache::ApplyBlendShapes(
+                    *blendShapeData, TfMakeConstSpan(subShapeWeights),
+                    TfMakeConstSpan(blendShapeIndices), TfMakeConstSpan(subShapeIndices),
+                    TfMakeSpan(points));
             }
         }
     }
 };
 
-void ApplyJointAnimation(const UsdSkelSkinningQuery& skinningQuery,
-                         const UsdSkelSkeletonQuery& skelQuery,
-                         const double time,
-                         VtVec3fArray& points,
-                         const UsdKatanaUsdInPrivateData& data)
-{
-    // Get the skinning transform from the skeleton.
-    VtMatrix4dArray skinningXforms;
-    skelQuery.ComputeSkinningTransforms(&skinningXforms, time);
-    // Get the prim's points first and then skin them.
-    skinningQuery.ComputeSkinnedPoints(skinningXforms, &points, time);
-
-    // Apply transforms to get the points in mesh prim space
-    // instead of skeleton space.
-    UsdGeomXformCache xformCache(time);
+// Returns the skeleton prim outside of any prototype, which identifies the
+// skeleton instance and carries its world transform.
+UsdPrim GetSkelInstancePrim(const UsdSkelSkeletonQuery& skelQuery,
+                            const UsdKatanaUsdInPrivateData& data)
+{
     UsdPrim skelPrim = skelQuery.GetPrim();
     if (skelPrim.IsInPrototype())
     {
@@ -193,26 +188,8 @@ void ApplyJointAnimation(const UsdSkelSkinningQuery& skinningQuery,
             skelPrim.GetPath().ReplacePrefix(data.GetPrototypePath(), data.GetInstancePath());
         skelPrim = skelPrim.GetStage()->GetPrimAtPath(instancePath);
     }
-    const GfMatrix4d skelLocalToWorld =
-        xformCache.GetLocalToWorldTransform(skelPrim);
-    const GfMatrix4d primWorldToLocal =
-        xformCache.GetLocalToWorldTransform(skinningQuery.GetPrim())
-            .GetInverse();
-    const GfMatrix4d skelToPrimLocal = skelLocalToWorld * primWorldToLocal;
-    WorkParallelForN(
-        points.size(),
-        [&](size_t start, size_t end) {
-            for (size_t i = start; i < end; ++i)
-            {
-                GfVec3f& point{points[i]};
-                const GfVec3d transformPoint{skelToPrimLocal.Transform(point)};
-                point.Set(static_cast<float>(transformPoint[0]),
-                          static_cast<float>(transformPoint[1]),
-                          static_cast<float>(transformPoint[2]));
-            }
-        },
-        /*grainSize*/ 1000);
-};
+    return skelPrim;
+}
 }  // namespace
 
 static const std::string _ResolveAssetPath(const SdfAssetPath& assetPath)
@@ -1046,6 +1023,8 @@ _FindCameraPaths_Traversal( const UsdPrim &prim, SdfPathVector *result )
 
 SdfPathVector UsdKatanaUtils::FindCameraPaths(const UsdStageRefPtr& stage)
 {
+    TRACE_FUNCTION();
+
     SdfPathVector result;
     _FindCameraPaths_Traversal( stage->GetPseudoRoot(), &result );
     return result;
@@ -1116,6 +1095,8 @@ _Traverse(const UsdPrim &prim,
 
 SdfPathVector UsdKatanaUtils::FindLightPaths(const UsdStageRefPtr& stage)
 {
+    TRACE_FUNCTION();
+
 /* XXX -- ComputeLightList() doesn't try to maintain an order.  That
           should be okay for lights but it does cause differences in
           the Katana lightList and generated RIB.  These differences
@@ -2015,81 +1996,130 @@ FnKat::GroupAttribute UsdKatanaUtils::BuildInstancePrototypeMapping(const UsdSta
     return gb.build();
 }
 
-FnKat::Attribute UsdKatanaUtils::ApplySkinningToPoints(const UsdGeomPointBased& points,
-                                                       const UsdKatanaUsdInPrivateData& data)
+namespace
 {
-    static const int tupleSize = 3;
-    FnKat::FloatAttribute skinnedPointsAttr;
-    FnKat::DataBuilder<FnKat::FloatAttribute> attrBuilder(tupleSize);
-
-    // Flag to check if we discovered the topology is varying, in
-    // which case we only output the sample at the curent frame.
-    bool varyingTopology = false;
+// State shared by the functions that evaluate the UsdSkel binding of a
+// point based prim.
+struct SkinningContext
+{
+    UsdPrim prim;
+    UsdSkelSkinningQuery skinningQuery;
+    UsdSkelSkeletonQuery skelQuery;
+    UsdPrim skelInstancePrim;
+    UsdKatanaSkinningCache* skinningCache = nullptr;
+    std::vector<double> matchingMotionSamples;
+    std::vector<double> blendShapeMotionSamples;
+    std::vector<double> jointXformMotionSamples;
+    bool hasJointIndicesAttr = false;
+    bool hasBlendShapeTargets = false;
+};
 
+bool InitSkinningContext(const UsdGeomPointBased& points,
+                         const UsdKatanaUsdInPrivateData& data,
+                         SkinningContext& ctx)
+{
     const double currentTime = data.GetCurrentTime();
 
-    const bool isMotionBackward = data.IsMotionBackward();
-
-    UsdPrim prim{points.GetPrim()};
-    if (prim.IsInPrototype())
+    ctx.prim = points.GetPrim();
+    if (ctx.prim.IsInPrototype())
     {
         const SdfPath instancePath =
             points.GetPath().ReplacePrefix(data.GetPrototypePath(), data.GetInstancePath());
-        prim = prim.GetStage()->GetPrimAtPath(instancePath);
+        ctx.prim = ctx.prim.GetStage()->GetPrimAtPath(instancePath);
     }
-    const UsdSkelRoot skelRoot = UsdSkelRoot::Find(prim);
+    const UsdSkelRoot skelRoot = UsdSkelRoot::Find(ctx.prim);
     if (!skelRoot)
     {
-        return skinnedPointsAttr;
+        return false;
     }
-    UsdSkelCache skelCache;
-    skelCache.Populate(skelRoot, UsdTraverseInstanceProxies());
+    // Skeleton data is shared by every mesh cooked by this op.
+    const UsdKatanaUsdInArgsRefPtr usdInArgs = data.GetUsdInArgs();
+    UsdSkelCache& skelCache = usdInArgs->GetUsdSkelCache();
+    ctx.skinningCache = &usdInArgs->GetSkinningCache();
+    ctx.skinningCache->PopulateSkelRoot(skelRoot, skelCache);
 
     // Get skinning query
-    const UsdSkelSkinningQuery skinningQuery = skelCache.GetSkinningQuery(prim);
-    if (!skinningQuery.IsValid())
+    ctx.skinningQuery = skelCache.GetSkinningQuery(ctx.prim);
+    if (!ctx.skinningQuery.IsValid())
     {
-        return skinnedPointsAttr;
+        return false;
     }
 
     // Get skeleton query
-    const UsdSkelSkeleton skel = UsdSkelBindingAPI(prim).GetInheritedSkeleton();
-    const UsdSkelSkeletonQuery skelQuery = skelCache.GetSkelQuery(skel);
-    if (!skelQuery.IsValid())
+    const UsdSkelSkeleton skel = UsdSkelBindingAPI(ctx.prim).GetInheritedSkeleton();
+    ctx.skelQuery = skelCache.GetSkelQuery(skel);
+    if (!ctx.skelQuery.IsValid())
     {
-        return skinnedPointsAttr;
+        return false;
     }
+    ctx.skelInstancePrim = GetSkelInstancePrim(ctx.skelQuery, data);
 
     // Get motion samples from UsdSkel animation query
-    const UsdSkelAnimQuery skelAnimQuery = skelQuery.GetAnimQuery();
-    std::vector<double> blendShapeMotionSamples, jointXformMotionSamples;
-
-    const std::vector<double> matchingMotionSamples = data.GetSkelMotionSampleTimes(
-        skelAnimQuery, blendShapeMotionSamples, jointXformMotionSamples);
+    const UsdSkelAnimQuery skelAnimQuery = ctx.skelQuery.GetAnimQuery();
+    ctx.matchingMotionSamples = data.GetSkelMotionSampleTimes(
+        skelAnimQuery, ctx.blendShapeMotionSamples, ctx.jointXformMotionSamples);
 
     // No guarantee that the GetSkelMotionSamples will populate the
     // blendShapeMotionSamples or jointXformMotionSamples.
     // Ensure we at least look at the current frame.
-    if (blendShapeMotionSamples.empty())
+    if (ctx.blendShapeMotionSamples.empty())
     {
-        blendShapeMotionSamples.push_back(currentTime);
+        ctx.blendShapeMotionSamples.push_back(currentTime);
     }
-    if (jointXformMotionSamples.empty())
+    if (ctx.jointXformMotionSamples.empty())
     {
-        jointXformMotionSamples.push_back(currentTime);
+        ctx.jointXformMotionSamples.push_back(currentTime);
     }
 
     // The boolean values below are for the mesh prim with SkelBindingAPI schema
     // applied which won't have joints indices property when switched to an invalid variant.
     // Adding a check for blendshape targets too. We would want to
     // apply animation only to prims with valid blendshapes and joints!
-    const bool hasJointIndicesAttr = UsdSkelBindingAPI(prim).GetJointIndicesAttr().HasValue();
-    const bool hasBlendShapeTargets =
-        UsdSkelBindingAPI(prim).GetBlendShapeTargetsRel().HasAuthoredTargets();
+    ctx.hasJointIndicesAttr = UsdSkelBindingAPI(ctx.prim).GetJointIndicesAttr().HasValue();
+    ctx.hasBlendShapeTargets =
+        UsdSkelBindingAPI(ctx.prim).GetBlendShapeTargetsRel().HasAuthoredTargets();
+    return true;
+}
+
+inline bool ContainsTime(const std::vector<double>& times, double time)
+{
+    return std::find(times.cbegin(), times.cend(), time) != times.cend();
+}
+
+// Applies the joint animation of the prim at the given time to its points.
+void SkinPointsAtTime(const UsdGeomPointBased& points,
+                      const SkinningContext& ctx,
+                      double time,
+                      VtVec3fArray& skinnedPoints)
+{
+    if (!ctx.skinningCache->SkinPoints(ctx.skinningQuery, ctx.skelQuery, ctx.skelInstancePrim,
+                                       time, skinnedPoints))
+    {
+        FnLogWarn("Cannot apply the skinning of " << points.GetPath().GetString() << " at time "
+                                                  << time << ", its points are not skinned");
+    }
+}
+
+// Evaluates the points of the prim at every skel motion sample, applying
+// blend shapes and, if requested, joint animation.
+FnKat::Attribute BuildSkelPointsAttr(const UsdGeomPointBased& points,
+                                     const UsdKatanaUsdInPrivateData& data,
+                                     const SkinningContext& ctx,
+                                     bool applyJointAnimation)
+{
+    static const int tupleSize = 3;
+
+    const double currentTime = data.GetCurrentTime();
+    const bool isMotionBackward = data.IsMotionBackward();
+    const bool applyJoints = applyJointAnimation && ctx.hasJointIndicesAttr;
+
+    // Flag to check if we discovered the topology is varying, in
+    // which case we only output the sample at the curent frame.
+    bool varyingTopology = false;
 
     std::map<float, VtArray<GfVec3f>> timeToSampleMap;
     // Prioritise JointTransform samples. Could prioritise either
-    for (double relSampleTime : matchingMotionSamples)
+    for (double relSampleTime : ctx.matchingMotionSamples)
     {
         double time = currentTime + relSampleTime;
         VtVec3fArray skinnedPoints;
@@ -2104,21 +2134,14 @@ FnKat::Attribute UsdKatanaUtils::ApplySkinningToPoints(const UsdGeomPointBased&
             }
         }
         // Retrieve the base points again!
-        if (hasBlendShapeTargets)
+        if (ctx.hasBlendShapeTargets && ContainsTime(ctx.blendShapeMotionSamples, time))
         {
-            if (std::find(blendShapeMotionSamples.cbegin(), blendShapeMotionSamples.cend(), time) !=
-                blendShapeMotionSamples.cend())
-            {
-                ApplyBlendShapeAnimation(skinningQuery, skelQuery, time, skinnedPoints);
-            }
+            ApplyBlendShapeAnimation(ctx.skinningQuery, ctx.skelQuery, time, skinnedPoints,
+                                     *ctx.skinningCache);
         }
-        if (hasJointIndicesAttr)
+        if (applyJoints && ContainsTime(ctx.jointXformMotionSamples, time))
         {
-            if (std::find(jointXformMotionSamples.cbegin(), jointXformMotionSamples.cend(), time) !=
-                jointXformMotionSamples.cend())
-            {
-                ApplyJointAnimation(skinningQuery, skelQuery, time, skinnedPoints, data);
-            }
+            SkinPointsAtTime(points, ctx, time, skinnedPoints);
         }
         float correctedSampleTime =
             isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime) : relSampleTime;
@@ -2129,24 +2152,214 @@ FnKat::Attribute UsdKatanaUtils::ApplySkinningToPoints(const UsdGeomPointBased&
         VtVec3fArray skinnedPoints;
         points.GetPointsAttr().Get(&skinnedPoints, currentTime);
         FnKat::DataBuilder<FnKat::FloatAttribute> defaultBuilder(tupleSize);
-        if (hasBlendShapeTargets)
+        if (ctx.hasBlendShapeTargets)
         {
-            ApplyBlendShapeAnimation(skinningQuery, skelQuery, currentTime, skinnedPoints);
+            ApplyBlendShapeAnimation(ctx.skinningQuery, ctx.skelQuery, currentTime,
+                                     skinnedPoints, *ctx.skinningCache);
         }
-        if (hasJointIndicesAttr)
+        if (applyJoints)
         {
-            ApplyJointAnimation(skinningQuery, skelQuery, currentTime, skinnedPoints, data);
+            SkinPointsAtTime(points, ctx, currentTime, skinnedPoints);
         }
         // Package the points in an attribute.
         if (!skinnedPoints.empty())
         {
-            std::vector<float>& attrVec = attrBuilder.get(0);
+            std::vector<float>& attrVec = defaultBuilder.get(0);
             UsdKatanaUtils::ConvertArrayToVector(skinnedPoints, &attrVec);
         }
         return defaultBuilder.build();
     }
+    // A character holding still has the same skinned points at every sample.
+    UsdKatanaUtils::CollapseIdenticalSamples(&timeToSampleMap);
     return VtKatanaMapOrCopy<GfVec3f>(timeToSampleMap);
 }
+}  // namespace
+
+FnKat::Attribute UsdKatanaUtils::ApplySkinningToPoints(const UsdGeomPointBased& points,
+                                                       const UsdKatanaUsdInPrivateData& data)
+{
+    TRACE_FUNCTION();
+
+    SkinningContext ctx;
+    if (!InitSkinningContext(points, data, ctx))
+    {
+        return FnKat::FloatAttribute();
+    }
+    return BuildSkelPointsAttr(points, data, ctx, /* applyJointAnimation */ true);
+}
+
+FnKat::GroupAttribute UsdKatanaUtils::BuildDeferredSkinningAttr(
+    const UsdGeomPointBased& points,
+    const UsdKatanaUsdInPrivateData& data,
+    FnKat::Attribute* restPointsAttr)
+{
+    TRACE_FUNCTION();
+
+    SkinningContext ctx;
+    if (!InitSkinningContext(points, data, ctx) || !ctx.hasJointIndicesAttr ||
+        !UsdKatanaSkinningCache::UsesLinearBlendSkinning(ctx.skinningQuery))
+    {
+        return FnKat::GroupAttribute();
+    }
+
+    const double currentTime = data.GetCurrentTime();
+    const bool isMotionBackward = data.IsMotionBackward();
+
+    VtIntArray jointIndices;
+    VtFloatArray jointWeights;
+    if (!ctx.skinningQuery.ComputeJointInfluences(&jointIndices, &jointWeights, currentTime))
+    {
+        return FnKat::GroupAttribute();
+    }
+    const int numInfluencesPerPoint = ctx.skinningQuery.GetNumInfluencesPerComponent();
+
+    // One matrix per joint of the mesh and per joint motion sample, and the
+    // skeleton to mesh transform per motion sample.
+    FnKat::DoubleBuilder jointMatricesBuilder(16);
+    FnKat::DoubleBuilder skelToPrimMatrixBuilder(16);
+    bool hasJointMatrices = false;
+    std::vector<GfMatrix4d> jointXforms;
+    GfMatrix4d skelToPrimLocal;
+    for (double relSampleTime : ctx.matchingMotionSamples)
+    {
+        const double time = currentTime + relSampleTime;
+        if (!ContainsTime(ctx.jointXformMotionSamples, time) ||
+            !ctx.skinningCache->ComputeJointXforms(ctx.skinningQuery, ctx.skelQuery,
+                                                   ctx.skelInstancePrim, time, &jointXforms,
+                                                   &skelToPrimLocal))
+        {
+            continue;
+        }
+        const float correctedSampleTime =
+            isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime) : relSampleTime;
+        std::vector<double>& matrices = jointMatricesBuilder.get(correctedSampleTime);
+        matrices.resize(jointXforms.size() * 16);
+        for (size_t i = 0; i < jointXforms.size(); ++i)
+        {
+            std::copy(jointXforms[i].data(), jointXforms[i].data() + 16, &matrices[i * 16]);
+        }
+        skelToPrimMatrixBuilder.get(correctedSampleTime)
+            .assign(skelToPrimLocal.data(), skelToPrimLocal.data() + 16);
+        hasJointMatrices = true;
+    }
+    if (!hasJointMatrices)
+    {
+        return FnKat::GroupAttribute();
+    }
+
+    // Blend shapes are still applied here; only joint animation is deferred.
+    if (restPointsAttr)
+    {
+        *restPointsAttr = ctx.hasBlendShapeTargets
+                              ? BuildSkelPointsAttr(points, data, ctx,
+                                                    /* applyJointAnimation */ false)
+                              : FnKat::Attribute();
+    }
+
+    return FnKat::GroupBuilder()
+        .set("method", FnKat::StringAttribute("classicLinear"))
+        .set("numInfluencesPerPoint", FnKat::IntAttribute(numInfluencesPerPoint))
+        .set("constantInfluences",
+             FnKat::IntAttribute(ctx.skinningQuery.IsRigidlyDeformed() ? 1 : 0))
+        .set("jointIndices",
+             FnKat::IntAttribute(jointIndices.cdata(), jointIndices.size(),
+                                 std::max(numInfluencesPerPoint, 1)))
+        .set("jointWeights",
+             FnKat::FloatAttribute(jointWeights.cdata(), jointWeights.size(),
+                                   std::max(numInfluencesPerPoint, 1)))
+        .set("jointMatrices", jointMatricesBuilder.build())
+        .set("skelToPrimMatrix", skelToPrimMatrixBuilder.build())
+        .build();
+}
+
+FnKat::FloatAttribute UsdKatanaUtils::ApplyDeferredSkinning(
+    const FnKat::GroupAttribute& skinningAttr,
+    const FnKat::FloatAttribute& pointsAttr,
+    std::string* errorMessage)
+{
+    TRACE_FUNCTION();
+
+    const FnKat::IntAttribute jointIndicesAttr = skinningAttr.getChildByName("jointIndices");
+    const FnKat::FloatAttribute jointWeightsAttr = skinningAttr.getChildByName("jointWeights");
+    const FnKat::DoubleAttribute jointMatricesAttr = skinningAttr.getChildByName("jointMatrices");
+    const FnKat::DoubleAttribute skelToPrimMatrixAttr =
+        skinningAttr.getChildByName("skelToPrimMatrix");
+    if (!pointsAttr.isValid() || !jointIndicesAttr.isValid() || !jointWeightsAttr.isValid() ||
+        !jointMatricesAttr.isValid())
+    {
+        *errorMessage = "missing points, joint influences or joint matrices";
+        return FnKat::FloatAttribute();
+    }
+    const int numInfluencesPerPoint =
+        FnKat::IntAttribute(skinningAttr.getChildByName("numInfluencesPerPoint"))
+            .getValue(0, false);
+    const bool constantInfluences =
+        FnKat::IntAttribute(skinningAttr.getChildByName("constantInfluences"))
+            .getValue(0, false) != 0;
+
+    FnKat::IntConstVector jointIndices = jointIndicesAttr.getNearestSample(0.0f);
+    FnKat::FloatConstVector jointWeights = jointWeightsAttr.getNearestSample(0.0f);
+    const TfSpan<const int> jointIndicesSpan(jointIndices.data(), jointIndices.size());
+    const TfSpan<const float> jointWeightsSpan(jointWeights.data(), jointWeights.size());
+
+    // Either attribute may have been collapsed to a single sample, e.g. for
+    // a character holding still with animated blend shapes.
+    std::set<float> sampleTimes;
+    for (int64_t i = 0; i < pointsAttr.getNumberOfTimeSamples(); ++i)
+    {
+        sampleTimes.insert(pointsAttr.getSampleTime(i));
+    }
+    for (int64_t i = 0; i < jointMatricesAttr.getNumberOfTimeSamples(); ++i)
+    {
+        sampleTimes.insert(jointMatricesAttr.getSampleTime(i));
+    }
+
+    FnKat::FloatBuilder pointsBuilder(3);
+    std::vector<GfMatrix4d> jointXforms;
+    for (float sampleTime : sampleTimes)
+    {
+        FnKat::DoubleConstVector matrices = jointMatricesAttr.getNearestSample(sampleTime);
+        if (matrices.size() % 16 != 0)
+        {
+            *errorMessage = "joint matrices are not 4x4 matrices";
+            return FnKat::FloatAttribute();
+        }
+        jointXforms.resize(matrices.size() / 16);
+        for (size_t j = 0; j < jointXforms.size(); ++j)
+        {
+            std::copy(&matrices[j * 16], &matrices[j * 16] + 16, jointXforms[j].data());
+        }
+
+        // Without a skeleton to mesh transform, the joint matrices are taken
+        // to be in the local space of the mesh already.
+        GfMatrix4d skelToPrimLocal(1.0);
+        if (skelToPrimMatrixAttr.isValid())
+        {
+            FnKat::DoubleConstVector matrix = skelToPrimMatrixAttr.getNearestSample(sampleTime);
+            if (matrix.size() != 16)
+            {
+                *errorMessage = "the skeleton to prim matrix is not a 4x4 matrix";
+                return FnKat::FloatAttribute();
+            }
+            std::copy(matrix.begin(), matrix.end(), skelToPrimLocal.data());
+        }
+
+        FnKat::FloatConstVector restPoints = pointsAttr.getNearestSample(sampleTime);
+        std::vector<float>& skinnedPoints = pointsBuilder.get(sampleTime);
+        skinnedPoints.assign(restPoints.begin(), restPoints.end());
+        const TfSpan<GfVec3f> pointsSpan(reinterpret_cast<GfVec3f*>(skinnedPoints.data()),
+                                         skinnedPoints.size() / 3);
+        if (!UsdKatanaSkinningCache::SkinPointsLBS(TfMakeConstSpan(jointXforms), skelToPrimLocal,
+                                                    jointIndicesSpan, jointWeightsSpan,
+                                                    numInfluencesPerPoint, constantInfluences,
+                                                    pointsSpan))
+        {
+            *errorMessage = "joint influences do not match the points or the joints";
+            return FnKat::FloatAttribute();
+        }
+    }
+    return pointsBuilder.build();
+}
 
 TfTokenVector UsdKatanaUtils::GetLookTokens()
 {
@@ -2202,15 +2415,21 @@ void update(B& builder, const A& attr)
 UsdKatanaUtilsLightListAccess::UsdKatanaUtilsLightListAccess(
     FnKat::GeolibCookInterface& interface,
     const UsdKatanaUsdInArgsRefPtr& usdInArgs)
-    : _interface(interface), _usdInArgs(usdInArgs)
+    : _interface(&interface), _usdInArgs(usdInArgs)
 {
     // Get the lightList attribute.
-    FnKat::GroupAttribute lightList = _interface.getAttr("lightList");
+    FnKat::GroupAttribute lightList = _interface->getAttr("lightList");
     if (lightList.isValid()) {
         _lightListBuilder.deepUpdate(lightList);
     }
 }
 
+UsdKatanaUtilsLightListAccess::UsdKatanaUtilsLightListAccess(
+    const UsdKatanaUsdInArgsRefPtr& usdInArgs)
+    : _interface(nullptr), _usdInArgs(usdInArgs)
+{
+}
+
 UsdKatanaUtilsLightListAccess::~UsdKatanaUtilsLightListAccess()
 {
     // Do nothing
@@ -2345,7 +2564,8 @@ void UsdKatanaUtilsLightListAccess::AddToCustomStringList(const std::string& tag
     if (_customStringLists.find(tag) == _customStringLists.end()) {
         // This is the first value.  First copy any existing attribute.
         auto& builder = _customStringLists[tag];
-        FnKat::StringAttribute attr = _interface.getAttr(tag);
+        FnKat::StringAttribute attr =
+            _interface ? _interface->getAttr(tag) : FnKat::StringAttribute();
         if (attr.isValid()) {
             update(builder, attr);
         }
@@ -2359,21 +2579,26 @@ void UsdKatanaUtilsLightListAccess::AddToCustomStringList(const std::string& tag
     }
 }
 
-void UsdKatanaUtilsLightListAccess::Build()
+FnKat::GroupAttribute UsdKatanaUtilsLightListAccess::Build()
 {
     FnKat::GroupAttribute lightListAttr = _lightListBuilder.build();
+    if (!_interface) {
+        _customStringLists.clear();
+        return lightListAttr;
+    }
     if (lightListAttr.getNumberOfChildren() > 0) {
-        _interface.setAttr("lightList", lightListAttr);
+        _interface->setAttr("lightList", lightListAttr);
     }
 
     // Add custom string lists.
     for (auto& value: _customStringLists) {
         auto attr = value.second.build();
         if (attr.getNumberOfValues() > 0) {
-            _interface.setAttr(value.first, attr);
+            _interface->setAttr(value.first, attr);
         }
     }
     _customStringLists.clear();
+    return lightListAttr;
 }
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -30,6 +30,9 @@
 #ifndef USDKATANA_ATTRUTILS_H
 #define USDKATANA_ATTRUTILS_H
 
+#include <cstring>
+#include <iterator>
+#include <map>
 #include <type_traits>
 #include <unordered_set>
 #include <vector>
@@ -40,6 +43,7 @@
 
 #include "usdKatana/api.h"
 
+#include <pxr/base/vt/array.h>
 #include <pxr/base/vt/value.h>
 #include <pxr/pxr.h>
 #include <pxr/usd/sdf/path.h>
@@ -95,6 +99,58 @@ struct UsdKatanaUtils
     /// Returns whether the given attribute is varying over time.
     USDKATANA_API static bool IsAttributeVarying(const UsdAttribute &attr, double currentTime);
 
+    /// If \p samples holds several samples with the same bytes, such as
+    /// those of a static cache authored on every frame, replace them by a
+    /// single sample at time 0 and return true. Arrays sharing their buffer
+    /// are not compared. \p T must be comparable with memcmp, as the vector
+    /// and matrix types are.
+    template <typename T>
+    static bool CollapseIdenticalSamples(std::map<float, VtArray<T>>* samples)
+    {
+        if (samples->size() < 2)
+        {
+            return false;
+        }
+        const VtArray<T>& first = samples->begin()->second;
+        for (auto it = std::next(samples->begin()); it != samples->end(); ++it)
+        {
+            const VtArray<T>& sample = it->second;
+            if (!sample.IsIdentical(first) &&
+                (sample.size() != first.size() ||
+                 std::memcmp(sample.cdata(), first.cdata(), first.size() * sizeof(T)) != 0))
+            {
+                return false;
+            }
+        }
+        VtArray<T> value = first;
+        samples->clear();
+        samples->emplace(0.0f, std::move(value));
+        return true;
+    }
+
+    /// As above, for the samples of all the \p times held one after the
+    /// other by \p samples. The first sample is kept in place.
+    template <typename T>
+    static bool CollapseIdenticalSamples(std::vector<float>* times, VtArray<T>* samples)
+    {
+        if (times->size() < 2 || samples->size() % times->size() != 0)
+        {
+            return false;
+        }
+        const size_t sampleSize = samples->size() / times->size();
+        const T* first = samples->cdata();
+        for (size_t i = 1; i < times->size(); ++i)
+        {
+            if (std::memcmp(first + i * sampleSize, first, sampleSize * sizeof(T)) != 0)
+            {
+                return false;
+            }
+        }
+        times->assign(1, 0.0f);
+        samples->resize(sampleSize);
+        return true;
+    }
+
     /// \brief Get the handle for the given shadingNode.
     ///
     /// If \p shadingNode is not a valid prim, this returns "".  Otherwise, this
@@ -225,6 +281,28 @@ struct UsdKatanaUtils
         const UsdGeomPointBased& points,
         const UsdKatanaUsdInPrivateData& data);
 
+    /// Build the "geometry.skinning" group for a prim whose linear blend
+    /// skinning is left to a downstream op or renderer, see the UsdIn
+    /// deferUsdSkelSkinning option. If the prim has blend shapes,
+    /// \p restPointsAttr is set to its points with the blend shapes
+    /// applied, otherwise it is left invalid and the authored points are the
+    /// rest points. Returns an invalid attribute if the prim is not bound to
+    /// a skeleton with linear blend skinning.
+    USDKATANA_API static FnKat::GroupAttribute BuildDeferredSkinningAttr(
+        const UsdGeomPointBased& points,
+        const UsdKatanaUsdInPrivateData& data,
+        FnKat::Attribute* restPointsAttr);
+
+    /// Applies the linear blend skinning described by \p skinningAttr, a
+    /// "geometry.skinning" group built by BuildDeferredSkinningAttr(), to the
+    /// rest points \p pointsAttr. The result has a sample at every sample
+    /// time of the points and of the joint matrices. Returns an invalid
+    /// attribute and sets \p errorMessage if the skinning cannot be applied.
+    USDKATANA_API static FnKat::FloatAttribute ApplyDeferredSkinning(
+        const FnKat::GroupAttribute& skinningAttr,
+        const FnKat::FloatAttribute& pointsAttr,
+        std::string* errorMessage);
+
     USDKATANA_API static TfTokenVector GetLookTokens();
 };
 
@@ -261,20 +339,25 @@ public:
 protected:
     USDKATANA_API UsdKatanaUtilsLightListAccess(FnKat::GeolibCookInterface& interface,
                                                 const UsdKatanaUsdInArgsRefPtr& usdInArgs);
+    /// Access to a light list that is not attached to a cook, starting
+    /// empty, e.g. to measure the light list functions. Custom string lists
+    /// are dropped by Build().
+    USDKATANA_API explicit UsdKatanaUtilsLightListAccess(
+        const UsdKatanaUsdInArgsRefPtr& usdInArgs);
     USDKATANA_API ~UsdKatanaUtilsLightListAccess();
 
     /// Change the light path being accessed.
     USDKATANA_API void SetPath(const SdfPath& lightPath);
 
-    /// Build into \p interface.
-    USDKATANA_API void Build();
+    /// Build into the cook interface, if any, and return the light list.
+    USDKATANA_API FnKat::GroupAttribute Build();
 
 private:
     USDKATANA_API void _Set(const std::string& name, const VtValue& value);
     void _Set(const std::string& name, const FnKat::Attribute& attr);
 
 private:
-    FnKat::GeolibCookInterface& _interface;
+    FnKat::GeolibCookInterface* _interface;
     UsdKatanaUsdInArgsRefPtr _usdInArgs;
     FnKat::GroupBuilder _lightListBuilder;
     std::map<std::string, FnKat::StringBuilder> _customStringLists;
@@ -292,6 +375,11 @@ public:
     {
     }
 
+    explicit UsdKatanaUtilsLightListEditor(const UsdKatanaUsdInArgsRefPtr& usdInArgs)
+        : UsdKatanaUtilsLightListAccess(usdInArgs)
+    {
+    }
+
     // Allow access to protected members.  UsdKatanaUtilsLightListAccess
     // is handed out to calls that need limited access and this class is
     // used for full access.
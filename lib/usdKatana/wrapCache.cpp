@@ -28,6 +28,7 @@
 // language governing permissions and limitations under the Apache License.
 //
 #include "usdKatana/cache.h"
+#include "usdKatana/locks.h"
 
 #include <pxr/base/tf/pyStaticTokens.h>
 
@@ -39,6 +40,40 @@ using namespace boost::python;
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
+static list _GetMemoryUsage(UsdKatanaCache& self)
+{
+    list result;
+    for (const UsdKatanaCacheMemoryUsage& usage : self.GetMemoryUsage())
+    {
+        result.append(usage);
+    }
+    return result;
+}
+
+static SdfLayerRefPtr _FindSessionLayer(UsdKatanaCache& self,
+                                        const std::string& sessionAttrXML,
+                                        const std::string& rootLocation,
+                                        const std::string& isolatePath)
+{
+    FnAttribute::GroupAttribute sessionAttr =
+        FnAttribute::Attribute::parseXML(sessionAttrXML.c_str());
+    return self.FindSessionLayer(
+        sessionAttr.isValid() ? sessionAttr : FnAttribute::GroupAttribute(true), rootLocation,
+        isolatePath);
+}
+
+static list _ReloadChangedLayers(UsdKatanaCache& self, bool compareContents)
+{
+    boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetStageLock());
+    list result;
+    for (const std::string& identifier :
+         self.ReloadChangedLayers(UsdStageRefPtr(), compareContents))
+    {
+        result.append(identifier);
+    }
+    return result;
+}
+
 void wrapUsdKatanaCache() {
     typedef UsdKatanaCache This;
     SdfLayerRefPtr (This::*ThisFindSessionLayer)(const std::string& cacheKey)=
@@ -48,11 +83,26 @@ void wrapUsdKatanaCache() {
         const std::string& sessionAttrXML, const std::string & rootLocation)=
             &This::FindOrCreateSessionLayer;
     
+    class_<UsdKatanaCacheMemoryUsage>("CacheMemoryUsage")
+        .def_readonly("cacheName", &UsdKatanaCacheMemoryUsage::cacheName)
+        .def_readonly("stage", &UsdKatanaCacheMemoryUsage::stage)
+        .def_readonly("bytes", &UsdKatanaCacheMemoryUsage::bytes)
+        .def_readonly("numEntries", &UsdKatanaCacheMemoryUsage::numEntries);
+
     class_<This>("Cache", no_init)
         .def("GetInstance", &UsdKatanaCache::GetInstance,
              return_value_policy<reference_existing_object>())
         .staticmethod("GetInstance")
         .def("FindSessionLayer", ThisFindSessionLayer)
-        .def("FindOrCreateSessionLayer", ThisFindOrCreateSessionLayer);
+        .def("FindSessionLayer", &_FindSessionLayer,
+             (arg("sessionAttrXML"), arg("rootLocation"), arg("isolatePath") = ""))
+        .def("FindOrCreateSessionLayer", ThisFindOrCreateSessionLayer)
+        .def("GetMemoryUsage", &_GetMemoryUsage)
+        .def("GetTotalMemoryUsage", &This::GetTotalMemoryUsage)
+        .def("SetMemoryBudget", &This::SetMemoryBudget)
+        .def("GetMemoryBudget", &This::GetMemoryBudget)
+        .def("EnforceMemoryBudget", &This::EnforceMemoryBudget)
+        .def("ReloadChangedLayers", &_ReloadChangedLayers,
+             (arg("compareContents") = false));
         
 }
@@ -99,6 +99,28 @@ typename VtKatana_GetKatanaAttrType<T>::type VtKatanaMapOrCopy(
         times, values);
 }
 
+template <typename T>
+typename VtKatana_GetKatanaAttrType<T>::type VtKatanaMapOrCopy(
+    const std::vector<float>& times,
+    const VtArray<T>& values) {
+    typedef typename VtKatana_GetKatanaAttrType<T>::type AttrType;
+    if (!std::is_sorted(times.begin(), times.end())) {
+        TF_CODING_ERROR("'times' must be sorted.");
+        return VtKatana_Internal::FailureAttr<AttrType>();
+    }
+    if (times.empty() || values.empty()) {
+        return VtKatana_Internal::EmptyAttr<AttrType>(
+            VtKatana_GetNumericTupleSize<T>::value);
+    }
+    if (values.size() % times.size() != 0) {
+        TF_CODING_ERROR(
+            "'values' array size isn't a multiple of the 'times' array size");
+        return VtKatana_Internal::FailureAttr<AttrType>();
+    }
+    return VtKatana_Internal::VtKatana_FromVtConversion<T>::MapInternalMultiple(
+        times, values);
+}
+
 template <typename T>
 typename VtKatana_GetKatanaAttrType<T>::type VtKatanaCopy(
     const VtArray<T>& value) {
@@ -221,6 +243,9 @@ typename VtKatana_GetKatanaAttrType<T>::type VtKatanaCopy(
     VtKatanaMapOrCopy<T>(const std::vector<float>& times,                  \
                          const typename std::vector<VtArray<T>>& values);  \
     template typename VtKatana_GetKatanaAttrType<T>::type                  \
+    VtKatanaMapOrCopy<T>(const std::vector<float>& times,                  \
+                         const VtArray<T>& values);                        \
+    template typename VtKatana_GetKatanaAttrType<T>::type                  \
     VtKatanaMapOrCopy<T>(const typename std::map<float, VtArray<T>>&);     \
     template VtArray<T> VtKatanaMapOrCopy<T>(                              \
         const typename VtKatana_GetKatanaAttrType<T>::type&, float);       \
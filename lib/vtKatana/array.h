@@ -91,6 +91,22 @@ typename VtKatana_GetKatanaAttrType<T>::type VtKatanaMapOrCopy(
     const std::vector<float>& times,
     const typename std::vector<VtArray<T>>& values);
 
+/// Maps a series of \p times and \p values, holding the samples of all the
+/// times one after the other, to a Katana attribute, minimizing intermediate
+/// copies.
+///
+/// This is preferable to the overload taking a VtArray per time when the
+/// samples are computed together, as they can then be written into a single
+/// buffer. If VTKATANA_ENABLE_ZERO_COPY_ARRAYS is enabled, the attribute
+/// retains a single reference to \p values.
+///
+/// \warn \p times MUST be sorted, and the size of \p values MUST be a
+/// multiple of their number.
+template <typename T>
+typename VtKatana_GetKatanaAttrType<T>::type VtKatanaMapOrCopy(
+    const std::vector<float>& times,
+    const VtArray<T>& values);
+
 /// Create a map containing VtArrays of all motion samples contained
 /// by \p attribute.
 ///
@@ -190,6 +206,10 @@ std::map<float, VtArray<T>> VtKatanaCopy(
         VtKatanaMapOrCopy<T>(                                              \
             const std::vector<float>& times,                               \
             const typename std::vector<VtArray<T>>& values);               \
+    template VTKATANA_API typename VtKatana_GetKatanaAttrType<T>::type     \
+        VtKatanaMapOrCopy<T>(                                              \
+            const std::vector<float>& times,                               \
+            const VtArray<T>& values);                                     \
     template VTKATANA_API typename VtKatana_GetKatanaAttrType<T>::type     \
         VtKatanaMapOrCopy<T>(                                              \
             const typename std::map<float, VtArray<T>>&);                  \
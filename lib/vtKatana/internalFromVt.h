@@ -95,6 +95,48 @@ public:
     }
 };
 
+/// Returns pointers to the \p numSamples samples held one after the other
+/// by \p array.
+template <typename ElementType>
+std::vector<const typename VtKatana_GetNumericScalarType<ElementType>::type*>
+VtKatana_GetSamplePtrs(const VtArray<ElementType>& array, size_t numSamples) {
+    typedef
+        typename VtKatana_GetNumericScalarType<ElementType>::type ScalarType;
+    const size_t sampleSize = array.size() / numSamples *
+                              VtKatana_GetNumericTupleSize<ElementType>::value;
+    const ScalarType* data = VtKatana_GetScalarPtr(array);
+    std::vector<const ScalarType*> ptrs(numSamples);
+    for (size_t i = 0; i < numSamples; ++i) {
+        ptrs[i] = data + i * sampleSize;
+    }
+    return ptrs;
+}
+
+/// Katana attribute zero copy context for a VtArray whose element type
+/// is directly castable, holding multiple time samples one after the other.
+template <typename ElementType,
+          typename = typename std::enable_if<
+              VtKatana_IsNumericCastable<ElementType>::value>::type>
+class VtKatana_SampledContext {
+    typedef
+        typename VtKatana_GetNumericScalarType<ElementType>::type ScalarType;
+    const VtArray<ElementType> _array;
+    const size_t _numSamples;
+
+public:
+    VtKatana_SampledContext(const VtArray<ElementType>& array,
+                            size_t numSamples)
+        : _array(array), _numSamples(numSamples) {}
+
+    std::vector<const ScalarType*> GetData() {
+        return VtKatana_GetSamplePtrs(_array, _numSamples);
+    }
+    static void Free(void* self) {
+        auto context = static_cast<VtKatana_SampledContext*>(self);
+        delete context;
+    }
+};
+
 /// Convert an array of string holders to a vector of c-string pointers
 /// suitable for Katana injection
 template <typename StringType,
@@ -157,6 +199,26 @@ public:
         return attr;
     }
 
+    /// Utility constructing attributes without copies by retaining a
+    /// reference to the originating VtArray, holding the samples of all the
+    /// \p times one after the other
+    template <typename T = ElementType>
+    static typename std::enable_if<VtKatana_IsNumericCastable<T>::value,
+                                   AttrType>::type
+    ZeroCopy(const std::vector<float>& times, const VtArray<T>& values) {
+        TF_VERIFY(!times.empty() && !values.empty());
+        typedef VtKatana_SampledContext<T> ZeroCopyContext;
+        size_t size = values.size() / times.size() *
+                      VtKatana_GetNumericTupleSize<T>::value;
+        std::unique_ptr<ZeroCopyContext> context(
+            new ZeroCopyContext(values, times.size()));
+        auto data = context->GetData();
+        AttrType attr(times.data(), times.size(), data.data(), size,
+                      VtKatana_GetNumericTupleSize<T>::value, context.release(),
+                      ZeroCopyContext::Free);
+        return attr;
+    }
+
     // COPY INTERMEDIATE TO STD::VECTOR IMPLEMENTATIONS
 
     /// Utility for copying numeric types to an intermediate std::vector
@@ -276,6 +338,38 @@ public:
         return attr;
     }
 
+    /// Utility for copying numeric types that don't require an intermediate
+    /// copy, held one time sample after the other in \p values
+    template <typename T = ElementType>
+    static typename std::enable_if<VtKatana_IsNumericCastable<T>::value,
+                                   AttrType>::type
+    Copy(const std::vector<float>& times, const VtArray<T>& values) {
+        TF_VERIFY(!times.empty() && !values.empty());
+        size_t size = values.size() / times.size() *
+                      VtKatana_GetNumericTupleSize<T>::value;
+        auto ptrs = VtKatana_GetSamplePtrs(values, times.size());
+        AttrType attr(times.data(), times.size(), ptrs.data(), size,
+                      VtKatana_GetNumericTupleSize<T>::value);
+        return attr;
+    }
+
+    /// Utility for copying the types that do require intermediate copies,
+    /// held one time sample after the other in \p values, through a VtArray
+    /// per time sample
+    template <typename T = ElementType>
+    static typename std::enable_if<!VtKatana_IsNumericCastable<T>::value,
+                                   AttrType>::type
+    Copy(const std::vector<float>& times, const VtArray<T>& values) {
+        TF_VERIFY(!times.empty() && !values.empty());
+        const size_t sampleSize = values.size() / times.size();
+        std::vector<VtArray<T>> samples(times.size());
+        for (size_t i = 0; i < times.size(); ++i) {
+            samples[i].assign(values.cbegin() + i * sampleSize,
+                              values.cbegin() + (i + 1) * sampleSize);
+        }
+        return Copy(times, samples);
+    }
+
     /// Utility for copying string holder types that don't require
     /// intermediate copies
     template <typename T = ElementType>
@@ -393,6 +487,32 @@ public:
             return Copy(times, values);
     }
 
+    /// Iternals of map for samples held one after the other by types that
+    /// are not castable or are string like, see MapInternalMultiple
+    template <typename T = ElementType>
+    static typename std::enable_if<!VtKatana_IsNumericCastable<T>::value,
+                                   AttrType>::type
+    MapInternalMultiple(const std::vector<float>& times,
+                        const VtArray<T>& values) {
+        return Copy(times, values);
+    }
+
+    /// Iternals of map for samples held one after the other by types that
+    /// do not require an intermediate copy of values to construct an
+    /// attribute (ie. double, GfMatrix4d, GfVec3f)
+    template <typename T = ElementType>
+    static typename std::enable_if<VtKatana_IsNumericCastable<T>::value,
+                                   AttrType>::type
+    MapInternalMultiple(const std::vector<float>& times,
+                        const VtArray<T>& values) {
+        static const bool zeroCopyEnabled =
+            TfGetEnvSetting(VTKATANA_ENABLE_ZERO_COPY_ARRAYS);
+        if (zeroCopyEnabled)
+            return ZeroCopy(times, values);
+        else
+            return Copy(times, values);
+    }
+
     /// Utility for copying string holder types
     template <typename T = ElementType>
     static typename std::enable_if<VtKatana_IsOrHoldsString<T>::value,
@@ -31,10 +31,19 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <sstream>
+#include <string>
+#include <vector>
 
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/tf/getenv.h>
 #include <pxr/base/tf/pathUtils.h>
+#include <pxr/base/tf/span.h>
+#include <pxr/base/trace/trace.h>
 #include <pxr/pxr.h>
 #include <pxr/usd/ar/resolver.h>
 #include <pxr/usd/ar/resolverContextBinder.h>
@@ -57,9 +66,15 @@
 
 #include "usdKatana/blindDataObject.h"
 #include "usdKatana/bootstrap.h"
+#include "usdKatana/boundsCache.h"
 #include "usdKatana/cache.h"
+#include "usdKatana/cookCache.h"
+#include "usdKatana/cookStats.h"
 #include "usdKatana/locks.h"
 #include "usdKatana/readBlindData.h"
+#include "usdKatana/skinningCache.h"
+#include "usdKatana/staticAttrCache.h"
+#include "usdKatana/tracing.h"
 #include "usdKatana/usdInPluginRegistry.h"
 #include "usdKatana/utils.h"
 #include "vtKatana/bootstrap.h"
@@ -76,25 +91,40 @@ namespace FnKat = Foundry::Katana;
     interface.setAttr("errorMessage", Foundry::Katana::StringAttribute(\
         TfStringPrintf(__VA_ARGS__)));
 
-static UsdKatanaUsdInArgsRefPtr InitUsdInArgs(const FnKat::GroupAttribute& opArgs,
-                                              FnKat::GroupAttribute& additionalOpArgs,
-                                              const std::string& rootLocationPath)
+// The op args identifying the stage read by UsdIn, which UsdKatanaCache uses
+// to find or open it.
+struct UsdInStageArgs
 {
-    ArgsBuilder ab;
+    std::string fileName;
+    std::string rootLocation;
+    std::string sessionLocation;
+    FnAttribute::GroupAttribute sessionAttr;
+    std::string isolatePath;
+    std::string ignoreLayerRegex;
+    bool prePopulate = true;
+    ArResolverContext resolverContext;
+};
 
+static bool GetUsdInStageArgs(const FnKat::GroupAttribute& opArgs,
+                              const std::string& rootLocationPath,
+                              UsdInStageArgs* stageArgs,
+                              std::string* errorMessage)
+{
     FnKat::StringAttribute usdFileAttr = opArgs.getChildByName("fileName");
     if (!usdFileAttr.isValid())
     {
-        return ab.buildWithError("UsdIn: USD fileName not specified.");
+        *errorMessage = "UsdIn: USD fileName not specified.";
+        return false;
     }
 
-    std::string fileName = usdFileAttr.getValue();
-        
-    ab.rootLocation = FnKat::StringAttribute(
+    const std::string fileName = usdFileAttr.getValue();
+    stageArgs->fileName = fileName;
+
+    stageArgs->rootLocation = FnKat::StringAttribute(
         opArgs.getChildByName("location")).getValue(
             rootLocationPath, false);
         
-    std::string sessionLocation = ab.rootLocation;
+    std::string sessionLocation = stageArgs->rootLocation;
     FnKat::StringAttribute sessionLocationAttr = 
         opArgs.getChildByName("sessionLocation");
     if (sessionLocationAttr.isValid()) {
@@ -131,9 +161,8 @@ static UsdKatanaUsdInArgsRefPtr InitUsdInArgs(const FnKat::GroupAttribute& opArg
             }
         }
             
-        return ab.buildWithError(
-            TfStringPrintf("UsdIn: Bad variant selection \"%s\"",
-                           selString.c_str()).c_str());
+        *errorMessage = TfStringPrintf("UsdIn: Bad variant selection \"%s\"", selString.c_str());
+        return false;
     }
         
     FnAttribute::GroupAttribute legacyVariants = legacyVariantsGb.build();
@@ -147,12 +176,70 @@ static UsdKatanaUsdInArgsRefPtr InitUsdInArgs(const FnKat::GroupAttribute& opArg
     }
     // XXX END
 
-    ab.sessionLocation = sessionLocation;
-    ab.sessionAttr = sessionAttr;
+    // The load rules are carried by the session so that they are part of the
+    // key of the cached stage.
+    FnAttribute::GroupAttribute loadRulesAttr = opArgs.getChildByName("loadRules");
+    if (loadRulesAttr.getNumberOfChildren() > 0)
+    {
+        sessionAttr = FnAttribute::GroupBuilder()
+            .update(sessionAttr)
+            .set("loadRules", loadRulesAttr)
+            .build();
+    }
+
+    stageArgs->sessionLocation = sessionLocation;
+    stageArgs->sessionAttr = sessionAttr;
 
-    ab.ignoreLayerRegex = FnKat::StringAttribute(
+    stageArgs->ignoreLayerRegex = FnKat::StringAttribute(
         opArgs.getChildByName("ignoreLayerRegex")).getValue("", false);
 
+    // Determine whether to prepopulate the USD stage.
+    stageArgs->prePopulate =
+        FnKat::IntAttribute(opArgs.getChildByName("prePopulate"))
+        .getValue(1 /* default prePopulate=yes */ , false);
+
+    stageArgs->isolatePath = FnKat::StringAttribute(
+        opArgs.getChildByName("isolatePath")).getValue("", false);
+
+    const std::string assetResolverContextStr =
+        FnKat::StringAttribute(opArgs.getChildByName("assetResolverContext"))
+            .getValue("", false);
+    stageArgs->resolverContext =
+        assetResolverContextStr.empty()
+            ? ArGetResolver().CreateDefaultContextForAsset(fileName)
+            : ArGetResolver().CreateContextFromString(assetResolverContextStr);
+    return true;
+}
+
+static UsdKatanaUsdInArgsRefPtr InitUsdInArgs(const FnKat::GroupAttribute& opArgs,
+                                              FnKat::GroupAttribute& additionalOpArgs,
+                                              const std::string& rootLocationPath)
+{
+    // Trace collection is process wide, the first UsdIn that enables it wins.
+    static const std::string traceFileFromEnv = TfGetenv("USD_KATANA_TRACE_FILE");
+    const std::string traceFile =
+        FnKat::StringAttribute(opArgs.getChildByName("traceFile")).getValue("", false);
+    UsdKatanaEnableTracing(traceFile.empty() ? traceFileFromEnv : traceFile);
+    TRACE_FUNCTION();
+
+    ArgsBuilder ab;
+
+    UsdInStageArgs stageArgs;
+    std::string errorMessage;
+    const bool validStageArgs =
+        GetUsdInStageArgs(opArgs, rootLocationPath, &stageArgs, &errorMessage);
+    ab.rootLocation = stageArgs.rootLocation;
+    if (!validStageArgs)
+    {
+        return ab.buildWithError(errorMessage);
+    }
+
+    ab.sessionLocation = stageArgs.sessionLocation;
+    ab.sessionAttr = stageArgs.sessionAttr;
+    ab.ignoreLayerRegex = stageArgs.ignoreLayerRegex;
+    ab.prePopulate = stageArgs.prePopulate;
+    ab.isolatePath = stageArgs.isolatePath;
+
     ab.verbose = FnKat::IntAttribute(
         opArgs.getChildByName("verbose")).getValue(0, false);
 
@@ -206,26 +293,12 @@ static UsdKatanaUsdInArgsRefPtr InitUsdInArgs(const FnKat::GroupAttribute& opArg
         }
     }
 
-    // Determine whether to prepopulate the USD stage.
-    ab.prePopulate =
-        FnKat::IntAttribute(opArgs.getChildByName("prePopulate"))
-        .getValue(1 /* default prePopulate=yes */ , false);
-
-    ab.isolatePath = FnKat::StringAttribute(
-        opArgs.getChildByName("isolatePath")).getValue("", false);
-
     {
-        const std::string assetResolverContextStr =
-            FnKat::StringAttribute(opArgs.getChildByName("assetResolverContext"))
-                .getValue("", false);
-        const ArResolverContext context =
-            assetResolverContextStr.empty()
-                ? ArGetResolver().CreateDefaultContextForAsset(fileName)
-                : ArGetResolver().CreateContextFromString(assetResolverContextStr);
-        const ArResolverContextBinder bind(context);
-        ab.stage = UsdKatanaCache::GetInstance().GetStage(fileName,
-                                                          sessionAttr,
-                                                          sessionLocation,
+        // This waits for the stage if it is being prefetched.
+        const ArResolverContextBinder bind(stageArgs.resolverContext);
+        ab.stage = UsdKatanaCache::GetInstance().GetStage(stageArgs.fileName,
+                                                          stageArgs.sessionAttr,
+                                                          stageArgs.sessionLocation,
                                                           ab.isolatePath,
                                                           ab.ignoreLayerRegex,
                                                           ab.prePopulate);
@@ -236,7 +309,8 @@ static UsdKatanaUsdInArgsRefPtr InitUsdInArgs(const FnKat::GroupAttribute& opArg
     }
 
     FnAttribute::StringAttribute instanceModeAttr = opArgs.getChildByName("instanceMode");
-    if (instanceModeAttr.getValue("expanded", false) == "as sources and instances")
+    ab.instanceMode = instanceModeAttr.getValue("expanded", false);
+    if (ab.instanceMode == "as sources and instances")
     {
         FnKat::GroupAttribute mappingAttr =
             UsdKatanaUtils::BuildInstancePrototypeMapping(ab.stage, SdfPath::AbsoluteRootPath());
@@ -312,6 +386,46 @@ static UsdKatanaUsdInArgsRefPtr InitUsdInArgs(const FnKat::GroupAttribute& opArg
             opArgs.getChildByName("evaluateUsdSkelBindings"))
         .getValue(1, false));
 
+    ab.deferUsdSkelSkinning = static_cast<bool>(
+        FnKat::IntAttribute(
+            opArgs.getChildByName("deferUsdSkelSkinning"))
+        .getValue(0, false));
+
+    const std::string boundsMode =
+        FnKat::StringAttribute(opArgs.getChildByName("boundsMode")).getValue("traverse", false);
+    ab.useAuthoredExtents =
+        boundsMode == "extentsHint" || boundsMode == "extentsHint and author";
+    ab.authorExtentsHints = boundsMode == "extentsHint and author";
+
+    ab.shareStaticData =
+        FnKat::IntAttribute(opArgs.getChildByName("shareStaticDataAcrossFrames"))
+            .getValue(0, false) != 0 ||
+        TfGetenvBool("USD_KATANA_SHARE_STATIC_DATA", false);
+
+    ab.velocityBlur = static_cast<bool>(
+        FnKat::IntAttribute(opArgs.getChildByName("velocityBlur")).getValue(0, false));
+
+    ab.instanceCullingCamera =
+        FnKat::StringAttribute(opArgs.getChildByName("instanceCullingCamera"))
+            .getValue("", false);
+    ab.instanceCullingMargin =
+        FnKat::FloatAttribute(opArgs.getChildByName("instanceCullingMargin"))
+            .getValue(0.0f, false);
+    ab.instanceCullingMinSize =
+        FnKat::FloatAttribute(opArgs.getChildByName("instanceCullingMinSize"))
+            .getValue(0.0f, false);
+    ab.instanceCullingAspectRatio =
+        FnKat::FloatAttribute(opArgs.getChildByName("instanceCullingAspectRatio"))
+            .getValue(0.0f, false);
+    ab.instanceCullingOverscan =
+        FnKat::FloatAttribute(opArgs.getChildByName("instanceCullingOverscan"))
+            .getValue(0.0f, false);
+
+    ab.instanceTileSize =
+        FnKat::IntAttribute(opArgs.getChildByName("instanceTileSize")).getValue(0, false);
+    ab.remapInstanceIds = static_cast<bool>(
+        FnKat::IntAttribute(opArgs.getChildByName("remapInstanceIds")).getValue(0, false));
+
     return ab.build();
 }
 
@@ -334,13 +448,56 @@ public:
 
     static void flush()
     {
+        // Write the new entries of the cook cache and pick up the entries
+        // other processes wrote since.
+        UsdKatanaCookCache::GetInstance().Clear();
+
+        // Reloading only the layers that changed on disk keeps the stages
+        // open, so that only the prims using those layers are recomposed,
+        // and only their static attributes shared across frames are read
+        // again.
+        if (TfGetenvBool("USD_KATANA_FLUSH_RELOADS_CHANGED_LAYERS", false))
+        {
+            boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetStageLock());
+            UsdKatanaCache::GetInstance().ReloadChangedLayers();
+            return;
+        }
+        UsdKatanaStaticAttrCache::GetInstance().Clear();
         UsdKatanaCache::GetInstance().Flush();
     }
 
     static void cook(FnKat::GeolibCookInterface &interface)
     {
-        boost::shared_lock<boost::upgrade_mutex> 
-            readerLock(UsdKatanaGetStageLock());
+        TRACE_FUNCTION();
+
+        if (!FnAttribute::IntAttribute(interface.getOpArg("cookStats")).getValue(0, false))
+        {
+            _Cook(interface);
+            return;
+        }
+
+        // Only the work done for this location is counted here. The
+        // statistics of its descendants are summed by UsdIn.RollUpStats.
+        UsdKatanaCookStats stats;
+        {
+            UsdKatanaCookStatsScope statsScope(&stats);
+            const auto start = std::chrono::steady_clock::now();
+            _Cook(interface);
+            stats.cookSeconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        interface.setAttr("usdIn.stats", stats.BuildAttr());
+    }
+
+private:
+    static void _Cook(FnKat::GeolibCookInterface& interface)
+    {
+        boost::shared_lock<boost::upgrade_mutex>
+            readerLock(UsdKatanaGetStageLock(), boost::defer_lock);
+        {
+            TRACE_SCOPE("UsdIn: wait for stage reader lock");
+            readerLock.lock();
+        }
 
         UsdKatanaUsdInPrivateData* privateData =
             static_cast<UsdKatanaUsdInPrivateData*>(interface.getPrivateData());
@@ -414,6 +571,8 @@ public:
             return;
         }
 
+        USDKATANA_TRACE_PRIM_SCOPE("UsdIn: cook", prim.GetPath());
+
         // Determine if we want to perform the stage-wide queries.
         FnAttribute::IntAttribute processStageWideQueries = 
             opArgs.getChildByName("processStageWideQueries");
@@ -434,6 +593,8 @@ public:
             
             interface.setAttr("info.usdOpArgs", opArgs);
             interface.setAttr("info.usd.outputSession", usdInArgs->GetSessionAttr());
+            interface.setAttr("info.usd.isolatePath",
+                              FnAttribute::StringAttribute(usdInArgs->GetIsolatePath()));
         }
         
         if (FnAttribute::IntAttribute(
@@ -446,6 +607,8 @@ public:
             
             interface.setAttr("info.usdOpArgs", opArgs);
             interface.setAttr("info.usd.outputSession", usdInArgs->GetSessionAttr());
+            interface.setAttr("info.usd.isolatePath",
+                              FnAttribute::StringAttribute(usdInArgs->GetIsolatePath()));
         }
 
         bool verbose = usdInArgs->IsVerbose();
@@ -453,7 +616,10 @@ public:
         // The next section only makes sense to execute on non-pseudoroot prims
         if (prim.GetPath() != SdfPath::AbsoluteRootPath())
         {
-            if (!prim.IsLoaded()) {
+            // Payloads left unloaded by the load rules stay unloaded.
+            if (!prim.IsLoaded() &&
+                !FnAttribute::GroupAttribute(
+                    usdInArgs->GetSessionAttr().getChildByName("loadRules")).isValid()) {
                 SdfPath pathToLoad = prim.GetPath();
                 readerLock.unlock();
                 prim = _LoadPrim(stage, pathToLoad, verbose);
@@ -461,6 +627,7 @@ public:
                     ERROR("load prim %s failed", pathToLoad.GetText());
                     return;
                 }
+                UsdKatanaCookStats::RecordPayloadLoad();
                 readerLock.lock();
             }
 
@@ -549,8 +716,9 @@ public:
 
             if (UsdKatanaUtils::IsBoundable(prim))
             {
-                interface.setAttr("bound",
-                                  _MakeBoundsAttribute(prim, *privateData));
+                const FnKat::DoubleAttribute boundAttr = _MakeBoundsAttribute(prim, *privateData);
+                UsdKatanaCookStats::RecordAttribute(boundAttr);
+                interface.setAttr("bound", boundAttr);
             }
 
             //
@@ -1017,7 +1185,6 @@ public:
         }
     }
 
-private:
     /*
      * Get the write lock and load the USD prim.
      */
@@ -1026,8 +1193,14 @@ private:
             const SdfPath& pathToLoad,
             bool verbose)
     {
+        TRACE_FUNCTION();
+
         boost::unique_lock<boost::upgrade_mutex>
-            writerLock(UsdKatanaGetStageLock());
+            writerLock(UsdKatanaGetStageLock(), boost::defer_lock);
+        {
+            TRACE_SCOPE("UsdIn: wait for stage writer lock");
+            writerLock.lock();
+        }
 
         if (verbose) {
             FnLogInfo(TfStringPrintf(
@@ -1035,7 +1208,19 @@ private:
                         pathToLoad.GetText()).c_str());
         }
 
-        return stage->Load(pathToLoad);
+        // Another cook may have loaded the payload while this one waited.
+        const UsdPrim primToLoad = stage->GetPrimAtPath(pathToLoad);
+        if (primToLoad && primToLoad.IsLoaded())
+        {
+            return primToLoad;
+        }
+        {
+            TRACE_SCOPE("UsdIn: load payload");
+            stage->Load(pathToLoad);
+        }
+        UsdKatanaCache::ExpandPopulationMask(stage, pathToLoad);
+        UsdKatanaCache::GetInstance().RecordPayloadLoad(stage, pathToLoad);
+        return stage->GetPrimAtPath(pathToLoad);
     }
 
     static FnKat::DoubleAttribute _MakeBoundsAttribute(const UsdPrim& prim,
@@ -1261,6 +1446,8 @@ public:
 
     static void cook(FnKat::GeolibCookInterface &interface)
     {
+        TRACE_FUNCTION();
+
         UsdKatanaUsdInPrivateData* privateData =
             static_cast<UsdKatanaUsdInPrivateData*>(interface.getPrivateData());
 
@@ -1457,6 +1644,8 @@ public:
 
     static void cook(FnKat::GeolibCookInterface &interface)
     {
+        TRACE_FUNCTION();
+
         interface.setAttr(
             "proxies",
             UsdKatanaUtils::GetViewerProxyAttr(
@@ -1488,6 +1677,8 @@ public:
 
     static void cook(FnKat::GeolibCookInterface& interface)
     {
+        TRACE_FUNCTION();
+
         interface.stopChildTraversal();
 
         UsdKatanaUsdInPrivateData* privateData =
@@ -1557,6 +1748,160 @@ public:
 
 //------------------------------------------------------------------------------
 
+/*
+ * This op applies the linear blend skinning described by the
+ * "geometry.skinning" attribute authored by UsdIn when deferUsdSkelSkinning
+ * is enabled, replacing "geometry.point.P" with the skinned points. It is a
+ * reference implementation for pipelines whose renderer cannot consume the
+ * skinning attributes directly. UsdIn appends it to its op chain when its
+ * applyDeferredSkinning parameter is enabled; it may otherwise be run further
+ * downstream, e.g. by a GenericOp node, as it needs no op args.
+ */
+class UsdInApplySkinningOp : public FnKat::GeolibOp
+{
+public:
+    static void setup(FnKat::GeolibSetupInterface& interface)
+    {
+        interface.setThreading(FnKat::GeolibSetupInterface::ThreadModeConcurrent);
+    }
+
+    static void cook(FnKat::GeolibCookInterface& interface)
+    {
+        TRACE_FUNCTION();
+
+        FnKat::GroupAttribute skinningAttr = interface.getAttr("geometry.skinning");
+        if (!skinningAttr.isValid())
+        {
+            return;
+        }
+
+        // On failure the rest points and the skinning data are left as they
+        // are, so that a later op or the renderer may still skin them.
+        std::string errorMessage;
+        const FnKat::FloatAttribute skinnedPointsAttr = UsdKatanaUtils::ApplyDeferredSkinning(
+            skinningAttr, interface.getAttr("geometry.point.P"), &errorMessage);
+        if (!skinnedPointsAttr.isValid())
+        {
+            FnLogWarn("UsdIn.ApplySkinning: cannot skin " << interface.getInputLocationPath()
+                                                          << ": " << errorMessage);
+            return;
+        }
+        interface.setAttr("geometry.point.P", skinnedPointsAttr);
+        interface.deleteAttr("geometry.skinning");
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/*
+ * This op sums the "usdIn.stats" written by UsdIn when cookStats is enabled
+ * over the scene graph below the given location, and writes the totals to
+ * "usdIn.stats.rollup" at that location along with the locations and
+ * subtrees that took the longest to cook. Reading the statistics cooks the
+ * whole subtree, so this is meant for diagnosing slow scenes only.
+ */
+class UsdInRollUpStatsOp : public FnKat::GeolibOp
+{
+public:
+    static void setup(FnKat::GeolibSetupInterface& interface)
+    {
+        interface.setThreading(FnKat::GeolibSetupInterface::ThreadModeConcurrent);
+    }
+
+    static void cook(FnKat::GeolibCookInterface& interface)
+    {
+        TRACE_FUNCTION();
+
+        const std::string location =
+            FnKat::StringAttribute(interface.getOpArg("location")).getValue("", false);
+        const std::string outputLocation = interface.getOutputLocationPath();
+        if (outputLocation != location)
+        {
+            if (!FnGeolibUtil::Path::IsAncestor(outputLocation, location))
+            {
+                interface.stopChildTraversal();
+            }
+            return;
+        }
+        interface.stopChildTraversal();
+
+        const int topCount =
+            FnKat::IntAttribute(interface.getOpArg("topCount")).getValue(20, false);
+
+        std::vector<_LocationStats> locations;
+        const UsdKatanaCookStats total = _RollUp(interface, location, &locations);
+
+        // The locations that cost the most on their own, and the subtrees
+        // (typically assets) that cost the most in total.
+        FnKat::GroupBuilder rollupBuilder;
+        rollupBuilder.set("total", total.BuildAttr());
+        rollupBuilder.set("numLocations",
+                          FnKat::IntAttribute(static_cast<int>(locations.size())));
+        rollupBuilder.set("topLocations",
+                          _BuildTopAttr(&locations, topCount, &_LocationStats::selfSeconds));
+        rollupBuilder.set("topSubtrees",
+                          _BuildTopAttr(&locations, topCount, &_LocationStats::subtreeSeconds));
+        interface.setAttr("usdIn.stats.rollup", rollupBuilder.build());
+    }
+
+private:
+    struct _LocationStats
+    {
+        std::string path;
+        double selfSeconds;
+        double subtreeSeconds;
+    };
+
+    static UsdKatanaCookStats _RollUp(FnKat::GeolibCookInterface& interface,
+                                      const std::string& location,
+                                      std::vector<_LocationStats>* locations)
+    {
+        UsdKatanaCookStats subtree =
+            UsdKatanaCookStats::FromAttr(interface.getAttr("usdIn.stats", location));
+        const double selfSeconds = subtree.cookSeconds;
+
+        FnKat::StringAttribute childrenAttr = interface.getPotentialChildren(location);
+        for (const std::string& childName : childrenAttr.getNearestSample(0.0f))
+        {
+            subtree.Add(_RollUp(interface, location + "/" + childName, locations));
+        }
+
+        if (subtree.cookSeconds > 0.0)
+        {
+            locations->push_back({location, selfSeconds, subtree.cookSeconds});
+        }
+        return subtree;
+    }
+
+    static FnKat::GroupAttribute _BuildTopAttr(std::vector<_LocationStats>* locations,
+                                               int topCount,
+                                               double _LocationStats::*seconds)
+    {
+        const size_t count =
+            std::min(locations->size(), static_cast<size_t>(std::max(topCount, 0)));
+        std::partial_sort(locations->begin(), locations->begin() + count, locations->end(),
+                          [seconds](const _LocationStats& a, const _LocationStats& b) {
+                              return a.*seconds > b.*seconds;
+                          });
+
+        std::vector<std::string> paths;
+        std::vector<double> cookSeconds;
+        paths.reserve(count);
+        cookSeconds.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            paths.push_back((*locations)[i].path);
+            cookSeconds.push_back((*locations)[i].*seconds);
+        }
+        return FnKat::GroupBuilder()
+            .set("paths", FnKat::StringAttribute(paths))
+            .set("cookSeconds", FnKat::DoubleAttribute(cookSeconds.data(), cookSeconds.size(), 1))
+            .build();
+    }
+};
+
+//------------------------------------------------------------------------------
+
 class FlushStageFnc : public Foundry::Katana::AttributeFunction
 {
 public:
@@ -1582,13 +1927,120 @@ public:
 
 //-----------------------------------------------------------------------------
 
+/*
+ * Reloads the layers of the stage described by the UsdIn op args which
+ * changed on disk, and returns the identifiers of the reloaded layers. Set
+ * "compareContents" in the args to detect changes from the contents of the
+ * files rather than their modification times.
+ */
+class ReloadStageFnc : public Foundry::Katana::AttributeFunction
+{
+public:
+    static FnAttribute::Attribute run(FnAttribute::Attribute args)
+    {
+        boost::upgrade_lock<boost::upgrade_mutex>
+                readerLock(UsdKatanaGetStageLock());
+
+        FnKat::GroupAttribute additionalOpArgs;
+        auto usdInArgs = InitUsdInArgs(args, additionalOpArgs, "/root");
+        if (!usdInArgs || !usdInArgs->GetStage())
+        {
+            return FnAttribute::Attribute();
+        }
+
+        const FnAttribute::GroupAttribute argsGroup = args;
+        const bool compareContents =
+            FnAttribute::IntAttribute(argsGroup.getChildByName("compareContents"))
+                .getValue(0, false) != 0;
+
+        boost::upgrade_to_unique_lock<boost::upgrade_mutex>
+                writerLock(readerLock);
+        return FnAttribute::StringAttribute(UsdKatanaCache::GetInstance().ReloadChangedLayers(
+            usdInArgs->GetStage(), compareContents));
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+/*
+ * Returns the number of times layers were reloaded in this process. UsdIn
+ * passes it in its op args, so that its locations are cooked again once the
+ * layers of its stage are reloaded.
+ */
+class GetReloadGenerationFnc : public Foundry::Katana::AttributeFunction
+{
+public:
+    static FnAttribute::Attribute run(FnAttribute::Attribute args)
+    {
+        return FnAttribute::IntAttribute(
+            static_cast<int>(UsdKatanaCache::GetInstance().GetReloadGeneration()));
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+/*
+ * Authors the extentsHints UsdIn cooks found missing into a sublayer of the
+ * session layer of their stages, for the models whose bounds do not vary over
+ * time. This
+ * needs the stage lock for writing, so it runs from buildOpChain rather than
+ * from a cook.
+ */
+class AuthorExtentsHintsFnc : public Foundry::Katana::AttributeFunction
+{
+public:
+    static FnAttribute::Attribute run(FnAttribute::Attribute args)
+    {
+        UsdKatanaCache& cache = UsdKatanaCache::GetInstance();
+        if (!cache.HasMissingExtentsHints())
+        {
+            return FnAttribute::IntAttribute(0);
+        }
+
+        boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetStageLock());
+        return FnAttribute::IntAttribute(static_cast<int>(cache.AuthorMissingExtentsHints()));
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+/*
+ * Starts opening the stage described by the UsdIn op args in the background,
+ * so that it is ready, or at least under way, by the time UsdIn cooks.
+ */
+class PrefetchStageFnc : public Foundry::Katana::AttributeFunction
+{
+public:
+    static FnAttribute::Attribute run(FnAttribute::Attribute args)
+    {
+        UsdInStageArgs stageArgs;
+        std::string errorMessage;
+        if (GetUsdInStageArgs(args, "/root", &stageArgs, &errorMessage))
+        {
+            UsdKatanaCache::GetInstance().PrefetchStage(
+                stageArgs.fileName, stageArgs.sessionAttr, stageArgs.sessionLocation,
+                stageArgs.isolatePath, stageArgs.ignoreLayerRegex, stageArgs.prePopulate,
+                stageArgs.resolverContext);
+        }
+        return FnAttribute::Attribute();
+    }
+};
+
+//-----------------------------------------------------------------------------
+
 DEFINE_GEOLIBOP_PLUGIN(UsdInOp)
 DEFINE_GEOLIBOP_PLUGIN(UsdInBootstrapOp)
 DEFINE_GEOLIBOP_PLUGIN(UsdInMaterialGroupBootstrapOp)
 DEFINE_GEOLIBOP_PLUGIN(UsdInBuildIntermediateOp)
 DEFINE_GEOLIBOP_PLUGIN(UsdInAddViewerProxyOp)
 DEFINE_GEOLIBOP_PLUGIN(UsdInUpdateGlobalListsOp);
+DEFINE_GEOLIBOP_PLUGIN(UsdInApplySkinningOp)
+DEFINE_GEOLIBOP_PLUGIN(UsdInRollUpStatsOp)
+DEFINE_ATTRIBUTEFUNCTION_PLUGIN(AuthorExtentsHintsFnc);
 DEFINE_ATTRIBUTEFUNCTION_PLUGIN(FlushStageFnc);
+DEFINE_ATTRIBUTEFUNCTION_PLUGIN(GetReloadGenerationFnc);
+DEFINE_ATTRIBUTEFUNCTION_PLUGIN(PrefetchStageFnc);
+DEFINE_ATTRIBUTEFUNCTION_PLUGIN(ReloadStageFnc);
 
 void registerPlugins()
 {
@@ -1598,7 +2050,13 @@ void registerPlugins()
     REGISTER_PLUGIN(UsdInBuildIntermediateOp, "UsdIn.BuildIntermediate", 0, 1);
     REGISTER_PLUGIN(UsdInAddViewerProxyOp, "UsdIn.AddViewerProxy", 0, 1);
     REGISTER_PLUGIN(UsdInUpdateGlobalListsOp, "UsdIn.UpdateGlobalLists", 0, 1);
+    REGISTER_PLUGIN(UsdInApplySkinningOp, "UsdIn.ApplySkinning", 0, 1);
+    REGISTER_PLUGIN(UsdInRollUpStatsOp, "UsdIn.RollUpStats", 0, 1);
+    REGISTER_PLUGIN(AuthorExtentsHintsFnc, "UsdIn.AuthorExtentsHints", 0, 1);
     REGISTER_PLUGIN(FlushStageFnc, "UsdIn.FlushStage", 0, 1);
+    REGISTER_PLUGIN(GetReloadGenerationFnc, "UsdIn.GetReloadGeneration", 0, 1);
+    REGISTER_PLUGIN(PrefetchStageFnc, "UsdIn.PrefetchStage", 0, 1);
+    REGISTER_PLUGIN(ReloadStageFnc, "UsdIn.ReloadStage", 0, 1);
 
     UsdKatanaBootstrap();
     VtKatanaBootstrap();
@@ -33,6 +33,7 @@
 #include <pxr/usd/usdGeom/basisCurves.h>
 
 #include "usdKatana/attrMap.h"
+#include "usdKatana/cookCache.h"
 #include "usdKatana/readBasisCurves.h"
 
 PXR_NAMESPACE_USING_DIRECTIVE
@@ -41,7 +42,12 @@ USDKATANA_USDIN_PLUGIN_DEFINE(UsdInCore_BasisCurvesOp, privateData, opArgs, inte
 {
     UsdKatanaAttrMap attrs;
 
-    UsdKatanaReadBasisCurves(UsdGeomBasisCurves(privateData.GetUsdPrim()), privateData, attrs);
+    UsdKatanaCookCache::GetInstance().ReadCached(
+        opArgs, "UsdKatanaReadBasisCurves", privateData, attrs,
+        [&](UsdKatanaAttrMap& curvesAttrs) {
+            UsdKatanaReadBasisCurves(
+                UsdGeomBasisCurves(privateData.GetUsdPrim()), privateData, curvesAttrs);
+        });
 
     attrs.toInterface(interface);
 }
@@ -43,6 +43,8 @@
 
 #include "usdKatana/attrMap.h"
 #include "usdKatana/blindDataObject.h"
+#include "usdKatana/cache.h"
+#include "usdKatana/cookStats.h"
 #include "usdKatana/readBlindData.h"
 #include "usdKatana/readMaterial.h"
 
@@ -89,10 +91,12 @@ public:
         
     }
 
-    void insert(const std::string& key, UsdKatanaAttrMapRefPtr value)
+    void insert(const std::string& key, UsdKatanaAttrMapRefPtr value, const std::string& stage)
     {
         //std::cerr << "inserting: " << key << std::endl;
         
+        const size_t bytes = UsdKatanaCookStats::MeasureAttribute(value->build(), nullptr);
+
         boost::upgrade_lock<boost::upgrade_mutex> readerLock(m_mutex);
         
         auto mapI = m_entryIteratorMap.find(key);
@@ -101,7 +105,10 @@ public:
             //replace in-place if it's already there
             boost::upgrade_to_unique_lock<boost::upgrade_mutex>
                     writerLock(readerLock);
-            (*(*mapI).second).value = value;
+            Entry& entry = *(*mapI).second;
+            m_bytes = m_bytes - entry.bytes + bytes;
+            entry.value = value;
+            entry.bytes = bytes;
             return;
         }
         
@@ -112,14 +119,13 @@ public:
         // evict from front
         while (m_entries.size() > m_maxEntries)
         {
-            auto entryI = m_entries.begin();
             //std::cerr << "evicting: " << (*entryI).key << std::endl;
-            m_entryIteratorMap.erase((*entryI).key);
-            m_entries.erase(entryI);
+            evictFront();
         }
         
         m_entryIteratorMap[key] = m_entries.insert(m_entries.end(),
-                Entry(key, value));
+                Entry(key, value, stage, bytes));
+        m_bytes += bytes;
         
     }
     
@@ -131,17 +137,71 @@ public:
         
         m_entryIteratorMap.clear();
         m_entries.clear();
+        m_bytes = 0;
+    }
+
+    // Reports the bytes held per stage.
+    void reportMemoryUsage(UsdKatanaCacheMemoryUsageVector* usage)
+    {
+        boost::shared_lock<boost::upgrade_mutex> readerLock(m_mutex);
+
+        std::map<std::string, UsdKatanaCacheMemoryUsage> usagePerStage;
+        for (const Entry& entry : m_entries)
+        {
+            UsdKatanaCacheMemoryUsage& stageUsage = usagePerStage[entry.stage];
+            stageUsage.bytes += entry.bytes;
+            ++stageUsage.numEntries;
+        }
+        for (auto& stageUsage : usagePerStage)
+        {
+            stageUsage.second.cacheName = "material";
+            stageUsage.second.stage = stageUsage.first;
+            usage->push_back(stageUsage.second);
+        }
+    }
+
+    // Evicts the least recently used entries until at least bytesToFree
+    // bytes are freed, returning the bytes freed.
+    size_t evict(size_t bytesToFree)
+    {
+        boost::upgrade_lock<boost::upgrade_mutex> readerLock(m_mutex);
+        boost::upgrade_to_unique_lock<boost::upgrade_mutex>
+                    writerLock(readerLock);
+
+        const size_t bytesBefore = m_bytes;
+        while (!m_entries.empty() && bytesBefore - m_bytes < bytesToFree)
+        {
+            evictFront();
+        }
+        return bytesBefore - m_bytes;
     }
     
 private:
     
     struct Entry
     {
-        Entry(const std::string& _key, UsdKatanaAttrMapRefPtr _value) : key(_key), value(_value) {}
+        Entry(const std::string& _key,
+              UsdKatanaAttrMapRefPtr _value,
+              const std::string& _stage,
+              size_t _bytes)
+            : key(_key), value(_value), stage(_stage), bytes(_bytes)
+        {
+        }
 
         std::string key;
         UsdKatanaAttrMapRefPtr value;
+        std::string stage;
+        size_t bytes;
     };
+
+    // The write lock must be held.
+    void evictFront()
+    {
+        auto entryI = m_entries.begin();
+        m_bytes -= (*entryI).bytes;
+        m_entryIteratorMap.erase((*entryI).key);
+        m_entries.erase(entryI);
+    }
     
     typedef std::list<Entry> EntryList;
     typedef std::map<std::string, EntryList::iterator> EntryListIteratorMap;
@@ -150,6 +210,7 @@ private:
     EntryListIteratorMap m_entryIteratorMap;
     
     size_t m_maxEntries;
+    size_t m_bytes = 0;
     
     boost::upgrade_mutex m_mutex;
     
@@ -165,6 +226,14 @@ void FlushMaterialCache()
 
 } // anonymous namespace
 
+void registerUsdInShippedMaterialCacheMemoryReporter()
+{
+    UsdKatanaCache::GetInstance().RegisterMemoryReporter(
+        "material",
+        [](UsdKatanaCacheMemoryUsageVector* usage) { g_materialCache.reportMemoryUsage(usage); },
+        [](size_t bytesToFree) { return g_materialCache.evict(bytesToFree); });
+}
+
 USDKATANA_USDIN_PLUGIN_DEFINE_WITH_FLUSH(UsdInCore_LookOp,
                                          privateData,
                                          opArgs,
@@ -258,7 +327,9 @@ USDKATANA_USDIN_PLUGIN_DEFINE_WITH_FLUSH(UsdInCore_LookOp,
                 
                 if (useCache)
                 {
-                    g_materialCache.insert(key, attrs);
+                    g_materialCache.insert(
+                        key, attrs,
+                        privateData.GetUsdPrim().GetStage()->GetRootLayer()->GetIdentifier());
                 }
             }
         }
@@ -33,6 +33,7 @@
 #include <pxr/usd/usdGeom/mesh.h>
 
 #include "usdKatana/attrMap.h"
+#include "usdKatana/cookCache.h"
 #include "usdKatana/readMesh.h"
 
 PXR_NAMESPACE_USING_DIRECTIVE
@@ -43,7 +44,10 @@ USDKATANA_USDIN_PLUGIN_DEFINE(UsdInCore_MeshOp, privateData, opArgs, interface)
 
     const UsdPrim& prim = privateData.GetUsdPrim();
 
-    UsdKatanaReadMesh(UsdGeomMesh(prim), privateData, attrs);
+    UsdKatanaCookCache::GetInstance().ReadCached(
+        opArgs, "UsdKatanaReadMesh", privateData, attrs, [&](UsdKatanaAttrMap& meshAttrs) {
+            UsdKatanaReadMesh(UsdGeomMesh(prim), privateData, meshAttrs);
+        });
 
     attrs.toInterface(interface);
 }
@@ -33,6 +33,7 @@
 #include <pxr/usd/usdGeom/nurbsPatch.h>
 
 #include "usdKatana/attrMap.h"
+#include "usdKatana/cookCache.h"
 #include "usdKatana/readNurbsPatch.h"
 
 PXR_NAMESPACE_USING_DIRECTIVE
@@ -41,7 +42,12 @@ USDKATANA_USDIN_PLUGIN_DEFINE(UsdInCore_NurbsPatchOp, privateData, opArgs, inter
 {
     UsdKatanaAttrMap attrs;
 
-    UsdKatanaReadNurbsPatch(UsdGeomNurbsPatch(privateData.GetUsdPrim()), privateData, attrs);
+    UsdKatanaCookCache::GetInstance().ReadCached(
+        opArgs, "UsdKatanaReadNurbsPatch", privateData, attrs,
+        [&](UsdKatanaAttrMap& patchAttrs) {
+            UsdKatanaReadNurbsPatch(
+                UsdGeomNurbsPatch(privateData.GetUsdPrim()), privateData, patchAttrs);
+        });
 
     attrs.toInterface(interface);
 }
@@ -33,6 +33,7 @@
 #include <pxr/usd/usdGeom/points.h>
 
 #include "usdKatana/attrMap.h"
+#include "usdKatana/cookCache.h"
 #include "usdKatana/readPoints.h"
 
 PXR_NAMESPACE_USING_DIRECTIVE
@@ -41,7 +42,10 @@ USDKATANA_USDIN_PLUGIN_DEFINE(UsdInCore_PointsOp, privateData, opArgs, interface
 {
     UsdKatanaAttrMap attrs;
 
-    UsdKatanaReadPoints(UsdGeomPoints(privateData.GetUsdPrim()), privateData, attrs);
+    UsdKatanaCookCache::GetInstance().ReadCached(
+        opArgs, "UsdKatanaReadPoints", privateData, attrs, [&](UsdKatanaAttrMap& pointsAttrs) {
+            UsdKatanaReadPoints(UsdGeomPoints(privateData.GetUsdPrim()), privateData, pointsAttrs);
+        });
 
     attrs.toInterface(interface);
 }
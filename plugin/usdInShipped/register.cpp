@@ -74,6 +74,7 @@ void registerUsdInShippedLightLightListFnc();
 void registerUsdInShippedLightFilterLightListFnc();
 void registerUsdInShippedUiUtils();
 void registerUsdInResolveMaterialBindingsOp();
+void registerUsdInShippedMaterialCacheMemoryReporter();
 
 DEFINE_GEOLIBOP_PLUGIN(UsdInCore_XformOp)
 DEFINE_GEOLIBOP_PLUGIN(UsdInCore_ScopeOp)
@@ -158,6 +159,7 @@ void registerPlugins()
     registerUsdInShippedLightFilterLightListFnc();
     registerUsdInShippedUiUtils();
     registerUsdInResolveMaterialBindingsOp();
+    registerUsdInShippedMaterialCacheMemoryReporter();
 
     REGISTER_PLUGIN(MaterialReferenceAttrFnc, "UsdInMaterialReference", 0, 1);
     REGISTER_PLUGIN(LibraryMaterialNamesAttrFnc, "UsdInLibraryMaterialNames", 0, 1);
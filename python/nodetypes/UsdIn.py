@@ -69,7 +69,14 @@ nb.setHintsForParameter('location', {
 
 gb.set('isolatePath', '')
 nb.setHintsForParameter('isolatePath', {
-    'help' : 'Load only the USD contents below the specified USD prim path.',
+    'help' : """
+      Load only the USD contents below the specified USD prim path. The
+      prims it targets outside of that path, such as its materials,
+      skeletons and the prims in its light linking collections, are loaded
+      too. Lights outside of that path whose light linking collections
+      include prims below it are not: isolate a common ancestor of both, or
+      add the lights to the locations of a UsdInIsolate node, to keep them.
+    """,
 })
 
 
@@ -107,6 +114,120 @@ nb.setHintsForParameter('motionSampleTimes', {
     'conditionalVisOps' : _offForArchiveCondVis,
 })
 
+gb.set('velocityBlur', 0)
+nb.setHintsForParameter('velocityBlur', {
+    'widget' : 'checkBox',
+    'help' : """
+        If enabled, the points of meshes, curves and point clouds with
+        authored velocities are read at the current time only, then moved to
+        each motion sample time along their velocities and accelerations,
+        as USD does for point instancers. Normals, velocities and
+        accelerations are then read at the current time only too. This
+        avoids reading every motion sample of simulation caches, whose
+        samples at other times may not match the topology of the current
+        one.
+    """,
+    'conditionalVisOps' : _offForArchiveCondVis,
+})
+
+gb.set('instanceCullingCamera', '')
+nb.setHintsForParameter('instanceCullingCamera', {
+    'help' : """
+        The path in the USD stage of a camera prim. If set, the instances of
+        point instancers whose bounds lie outside of the frustum of the
+        camera at the current time, at every motion sample, are added to the
+        <i>geometry.omitList</i> of their instance array, so that they never
+        reach the renderer. Only use this for cameras that see neither the
+        reflections nor the shadows of the culled instances.
+    """,
+    'conditionalVisOps' : _offForArchiveCondVis,
+})
+
+gb.set('instanceCullingMargin', 0.0)
+nb.setHintsForParameter('instanceCullingMargin', {
+    'help' : """
+        The distance, in world units, by which the bounds of instances are
+        padded before they are culled, to keep the instances just outside of
+        the frustum, e.g. those that a moving camera sees during the shutter.
+        The aspect ratio and overscan of the render are accounted for by the
+        parameters below, not by this margin.
+    """,
+    'conditionalVisOp' : 'notEqualTo',
+    'conditionalVisPath' : '../instanceCullingCamera',
+    'conditionalVisValue' : '',
+})
+
+gb.set('instanceCullingMinSize', 0.0)
+nb.setHintsForParameter('instanceCullingMinSize', {
+    'help' : """
+        If greater than 0, instances whose bounds are smaller than this
+        fraction of their distance to the culling camera are culled too.
+    """,
+    'conditionalVisOp' : 'notEqualTo',
+    'conditionalVisPath' : '../instanceCullingCamera',
+    'conditionalVisValue' : '',
+})
+
+gb.set('instanceCullingAspectRatio', 0.0)
+nb.setHintsForParameter('instanceCullingAspectRatio', {
+    'help' : """
+        The width over height of the rendered images, i.e. of the resolution
+        of the render settings. If greater than 0, the frustum of the culling
+        camera is widened or heightened to enclose both its aperture and this
+        aspect ratio, so that instances in a frame wider or taller than the
+        aperture are kept. If 0, the aperture of the camera is used as is.
+    """,
+    'conditionalVisOp' : 'notEqualTo',
+    'conditionalVisPath' : '../instanceCullingCamera',
+    'conditionalVisValue' : '',
+})
+
+gb.set('instanceCullingOverscan', 0.0)
+nb.setHintsForParameter('instanceCullingOverscan', {
+    'help' : """
+        The overscan of the render, as a fraction of the width and height of
+        the frame added on each side of it, e.g. 0.05 for an overscan of 96
+        pixels on each side of a 1920 pixel wide image. The frustum of the
+        culling camera is enlarged by as much.
+    """,
+    'conditionalVisOp' : 'notEqualTo',
+    'conditionalVisPath' : '../instanceCullingCamera',
+    'conditionalVisValue' : '',
+})
+
+gb.set('instanceTileSize', 0)
+nb.setHintsForParameter('instanceTileSize', {
+    'help' : """
+        If greater than 0, point instancers with more instances than this are
+        split into spatial tiles of at most this many instances. The
+        <i>instances</i> location of such an instancer becomes a location of
+        type <i>group</i>, instead of <i>instance array</i>, with one
+        <i>instance array</i> child per tile, named <i>tile0</i>,
+        <i>tile1</i>, and so on, each with its own bound, so that the viewer
+        and renderers can skip the tiles they do not see and load the others
+        in parallel. Omitted instances are left out of the tiles. Ops and
+        scripts that match the <i>instances</i> location by its type, or
+        read its <i>geometry</i> attributes, must look at the tiles instead.
+    """,
+    'conditionalVisOps' : _offForArchiveCondVis,
+})
+
+gb.set('remapInstanceIds', 0)
+nb.setHintsForParameter('remapInstanceIds', {
+    'widget' : 'checkBox',
+    'help' : """
+        If enabled, the <i>ids</i> of point instancers which do not fit in
+        32-bit integers are replaced by their index among the sorted unique
+        ids, so that they keep the order of the original ids. The original
+        ids are written to <i>info.usd.idsTable</i>, sorted, as their high
+        and low 32 bits. The indices are computed from the ids of each
+        frame, so an instance keeps its index across frames only if the set
+        of ids does not change: look up the original id in the table to
+        track instances. If disabled, such ids are not read.
+    """,
+    'conditionalVisOps' : _offForArchiveCondVis,
+})
+
 gb.set('instanceMode', 'expanded')
 nb.setHintsForParameter('instanceMode', {
     'widget' : 'popup',
@@ -122,7 +243,27 @@ nb.setHintsForParameter('instanceMode', {
     'conditionalVisOps' : _offForArchiveCondVis,
 })
 
-
+gb.set('boundsMode', 'traverse')
+nb.setHintsForParameter('boundsMode', {
+    'widget' : 'popup',
+    'options' : ['traverse', 'extentsHint', 'extentsHint and author'],
+    'help' : """
+      When using <i>traverse</i>, bounds are computed from the extents of
+      every gprim below a location, stopping only at models which carry an
+      extentsHint.
+      </p>
+      When using <i>extentsHint</i>, an authored extentsHint on a model or
+      extent on a gprim is used directly, without composing any of its
+      descendants. Locations with neither fall back to <i>traverse</i>.
+      </p>
+      <i>extentsHint and author</i> additionally writes the extentsHints
+      that were missing into an anonymous layer, inserted as a sublayer of
+      the session layer the next time the node's op chain is built, so later
+      cooks of the same stage can use them. Only models whose bounds do not
+      change over time get a hint.
+    """,
+    'conditionalVisOps' : _offForArchiveCondVis,
+})
 
 
 gb.set('usePurposeBasedMaterialBinding', 0)
@@ -154,6 +295,43 @@ nb.setHintsForParameter('prePopulate', {
     'constant' : True,
 
 })
+gb.set('loadRules', '')
+nb.setHintsForParameter('loadRules', {
+    'help' : """
+      Whitespace-separated load rules, each a USD prim path and a rule:
+      <i>all</i>, <i>only</i> or <i>none</i>. Example:
+      /World/set=all /World/set/props=none /World/anim=only
+      Building the node fails on an entry without <i>=</i> or with any
+      other rule.
+      </p>
+      When any load rule, <i>loadMaxDepth</i> or <i>loadStopAtKind</i> is
+      set, the stage is opened with exactly the payloads they describe
+      loaded, <i>prePopulate</i> is ignored and the other payloads stay
+      unloaded rather than being loaded as their locations are cooked.
+    """,
+    'conditionalVisOps' : _offForArchiveCondVis,
+})
+
+gb.set('loadMaxDepth', -1)
+nb.setHintsForParameter('loadMaxDepth', {
+    'help' : """
+      If not negative, payloads on prims more than this many levels deep in
+      the USD stage are not loaded, e.g. with 2, the payload of
+      /World/set is loaded but not the one of /World/set/prop.
+    """,
+    'conditionalVisOps' : _offForArchiveCondVis,
+})
+
+gb.set('loadStopAtKind', '')
+nb.setHintsForParameter('loadStopAtKind', {
+    'help' : """
+      If set, payloads on or below prims of this kind, or a kind derived from
+      it, are not loaded. For example, <i>subcomponent</i> loads payloads
+      down to the components but not inside them. Only kinds authored
+      outside of a prim's own payload are considered.
+    """,
+    'conditionalVisOps' : _offForArchiveCondVis,
+})
 
 gb.set('verbose', 0)
 nb.setHintsForParameter('verbose', {
@@ -199,6 +377,147 @@ nb.setHintsForParameter('evaluateUsdSkelBindings', {
     'constant' : True,
 })
 
+gb.set('deferUsdSkelSkinning', 0)
+nb.setHintsForParameter('deferUsdSkelSkinning', {
+    'widget' : 'checkBox',
+    'help' : """
+        If enabled, linear blend skinning is not applied to the points.
+        Instead, the rest points are written to <i>geometry.point.P</i> (with
+        any blend shapes applied) and the skinning is described by the
+        <i>geometry.skinning</i> attributes: <i>method</i>,
+        <i>numInfluencesPerPoint</i>, <i>constantInfluences</i>,
+        <i>jointIndices</i>, <i>jointWeights</i>, the multi-sampled,
+        per-joint <i>jointMatrices</i>, in skeleton space, and the
+        multi-sampled <i>skelToPrimMatrix</i>, which takes the blended points
+        from skeleton space to the local space of the prim.
+        Renderers that support skinning can consume these directly; the
+        <b>UsdIn.ApplySkinning</b> op applies them otherwise. Prims that
+        do not use linear blend skinning are always skinned by UsdIn.
+    """,
+    'conditionalVisOp' : 'notEqualTo',
+    'conditionalVisPath' : '../evaluateUsdSkelBindings',
+    'conditionalVisValue' : '0',
+    'constant' : True,
+})
+
+gb.set('applyDeferredSkinning', 0)
+nb.setHintsForParameter('applyDeferredSkinning', {
+    'widget' : 'checkBox',
+    'help' : """
+        If enabled, the <b>UsdIn.ApplySkinning</b> op is appended to the op
+        chain of this node, and skins the points from the
+        <i>geometry.skinning</i> attributes. Locations whose skinning cannot
+        be applied keep their rest points and skinning attributes. Leave this
+        disabled to apply the op further downstream, e.g. with a GenericOp
+        node, or when the renderer consumes the skinning attributes.
+    """,
+    'conditionalVisOp' : 'notEqualTo',
+    'conditionalVisPath' : '../deferUsdSkelSkinning',
+    'conditionalVisValue' : '0',
+    'constant' : True,
+})
+
+gb.set('prefetchStage', 0)
+nb.setHintsForParameter('prefetchStage', {
+    'widget' : 'checkBox',
+    'help' : """
+        If enabled, the USD stage starts opening in the background as soon as
+        the node's op chain is built, rather than in the first cook of the
+        scene. Stages of different UsdIn nodes are then opened concurrently.
+        This is off by default, as it opens the stage even when the node is
+        not cooked.
+    """,
+    'constant' : True,
+})
+
+gb.set('shareStaticDataAcrossFrames', 0)
+nb.setHintsForParameter('shareStaticDataAcrossFrames', {
+    'widget' : 'checkBox',
+    'help' : """
+        If enabled, the geometry attributes read from USD attributes that
+        have no time samples, such as the topology, rest points and primvars
+        of static meshes, are converted once and shared by the cooks of every
+        frame in the process. Only animated data is read again at each frame.
+        This helps processes that render a range of frames, at the cost of
+        keeping the static data in memory until UsdIn is flushed. Setting the
+        <i>USD_KATANA_SHARE_STATIC_DATA</i> environment variable enables it for
+        every UsdIn node.
+    """,
+    'constant' : True,
+})
+
+gb.set('cookCacheDir', '')
+nb.setHintsForParameter('cookCacheDir', {
+    'widget' : 'assetIdInput',
+    'dirsOnly' : 'True',
+    'help' : """
+        A directory in which the attributes read for meshes, curves, points
+        and NURBS patches are cached, so that other Katana sessions and render
+        processes reading the same assets reuse them instead of reading them
+        from USD again. Entries are keyed by the contents of the layers each
+        prim is composed from, so edited assets are read again. Falls back to
+        the <i>USD_KATANA_COOK_CACHE_DIR</i> environment variable when empty;
+        the cache is disabled if both are empty. The directory may be
+        pre-warmed with the <i>usdKatanaCookCacheWarm</i> tool.
+    """,
+    'constant' : True,
+})
+
+gb.set('cookCacheReadOnly', 0)
+nb.setHintsForParameter('cookCacheReadOnly', {
+    'widget' : 'checkBox',
+    'help' : """
+        If enabled, entries are read from the cook cache directory but new
+        entries are never written to it, e.g. for a shared pre-warmed cache.
+    """,
+    'conditionalVisOp' : 'notEqualTo',
+    'conditionalVisPath' : '../cookCacheDir',
+    'conditionalVisValue' : '',
+    'constant' : True,
+})
+
+gb.set('cookStats', 0)
+nb.setHintsForParameter('cookStats', {
+    'widget' : 'checkBox',
+    'help' : """
+        If enabled, every location records the statistics of its own cook in
+        the <i>usdIn.stats</i> attributes: <i>cookSeconds</i>,
+        <i>attributeBytes</i>, <i>attributeCount</i>, <i>motionSamples</i>,
+        <i>payloadLoads</i>, <i>cacheHits</i> and <i>cacheMisses</i>. The
+        totals for the whole scene, and the locations and subtrees that took
+        the longest to cook, are written to <i>usdIn.stats.rollup</i> at the
+        scenegraph location. Computing the roll-up cooks the whole scene, so
+        this is meant for diagnosing slow scenes only.
+    """,
+    'constant' : True,
+})
+
+gb.set('traceFile', '')
+nb.setHintsForParameter('traceFile', {
+    'widget' : 'assetIdOutput',
+    'help' : """
+        A file to which USD trace events of the whole process are written in
+        the Chrome tracing format, e.g. to find where a slow scene spends its
+        time. <i>{pid}</i> is replaced by the process id. The events are
+        written when the process exits, and every
+        <i>USD_KATANA_TRACE_LOCATIONS_PER_FILE</i> cooked locations (10000 by
+        default) to the same path with <i>.1</i>, <i>.2</i>, ... inserted
+        before the extension, so they are not all held in memory. Falls back
+        to the <i>USD_KATANA_TRACE_FILE</i> environment variable when empty.
+        Tracing is process wide, and the first UsdIn node to cook with a
+        trace file decides where it is written.
+    """,
+    'constant' : True,
+})
+
+# Set by reloadStage() to the reload generation of the process once layers
+# were reloaded. It is passed in the op args, so that Katana cooks the
+# locations of the node again rather than serving them from its caches.
+gb.set('reloadGeneration', 0)
+nb.setHintsForParameter('reloadGeneration', {
+    'widget' : 'null',
+})
+
 nb.setParametersTemplateAttr(gb.build())
 
 #-----------------------------------------------------------------------------
@@ -230,15 +549,53 @@ def buildUsdInOpArgsAtGraphState(self, graphState):
     gb.set('motionSampleTimes',
             self.getParameter('motionSampleTimes').getValue(frameTime))
 
+    gb.set('velocityBlur',
+            int(self.getParameter('velocityBlur').getValue(frameTime)))
+
+    gb.set('instanceCullingCamera',
+            self.getParameter('instanceCullingCamera').getValue(frameTime))
+    gb.set('instanceCullingMargin', FnAttribute.FloatAttribute(
+            self.getParameter('instanceCullingMargin').getValue(frameTime)))
+    gb.set('instanceCullingMinSize', FnAttribute.FloatAttribute(
+            self.getParameter('instanceCullingMinSize').getValue(frameTime)))
+    gb.set('instanceCullingAspectRatio', FnAttribute.FloatAttribute(
+            self.getParameter('instanceCullingAspectRatio').getValue(frameTime)))
+    gb.set('instanceCullingOverscan', FnAttribute.FloatAttribute(
+            self.getParameter('instanceCullingOverscan').getValue(frameTime)))
+    gb.set('instanceTileSize', int(self.getParameter(
+            'instanceTileSize').getValue(frameTime)))
+    gb.set('remapInstanceIds', int(self.getParameter(
+            'remapInstanceIds').getValue(frameTime)))
+
     gb.set('verbose',
             int(self.getParameter('verbose').getValue(frameTime)))
 
     gb.set('instanceMode',
             self.getParameter('instanceMode').getValue(frameTime))
 
+    gb.set('boundsMode',
+            self.getParameter('boundsMode').getValue(frameTime))
+
     gb.set('prePopulate',
             int(self.getParameter('prePopulate').getValue(frameTime)))
 
+    loadRules = []
+    for entry in self.getParameter('loadRules').getValue(frameTime).split():
+        path, separator, rule = entry.rpartition('=')
+        if not separator or not path or rule not in ('all', 'only', 'none'):
+            raise ValueError('Invalid load rule "%s" in loadRules: expected '
+                    'a prim path, "=" and all, only or none, e.g. '
+                    '/World/set=all' % entry)
+        loadRules.extend([path, rule])
+    loadMaxDepth = int(self.getParameter('loadMaxDepth').getValue(frameTime))
+    loadStopAtKind = self.getParameter('loadStopAtKind').getValue(
+            frameTime).strip()
+    if loadRules or loadMaxDepth >= 0 or loadStopAtKind:
+        if loadRules:
+            gb.set('loadRules.rules', FnAttribute.StringAttribute(loadRules, 2))
+        gb.set('loadRules.maxDepth', loadMaxDepth)
+        gb.set('loadRules.stopAtKind', loadStopAtKind)
+
     loadedRenderers = RenderingAPI.RenderPlugins.GetRendererPluginNames()
     gb.set('outputTargets',
         FnAttribute.StringAttribute(loadedRenderers)
@@ -275,6 +632,20 @@ def buildUsdInOpArgsAtGraphState(self, graphState):
 
     gb.set('evaluateUsdSkelBindings', int(self.getParameter(
         'evaluateUsdSkelBindings').getValue(frameTime)))
+    gb.set('deferUsdSkelSkinning', int(self.getParameter(
+        'deferUsdSkelSkinning').getValue(frameTime)))
+    gb.set('cookStats', int(self.getParameter(
+        'cookStats').getValue(frameTime)))
+    gb.set('traceFile',
+            self.getParameter('traceFile').getValue(frameTime))
+    gb.set('shareStaticDataAcrossFrames', int(self.getParameter(
+        'shareStaticDataAcrossFrames').getValue(frameTime)))
+    gb.set('cookCacheDir',
+            self.getParameter('cookCacheDir').getValue(frameTime))
+    gb.set('cookCacheReadOnly', int(self.getParameter(
+        'cookCacheReadOnly').getValue(frameTime)))
+    gb.set('reloadGeneration', int(self.getParameter(
+        'reloadGeneration').getValue(frameTime)))
 
     argsOverride = graphState.getDynamicEntry('var:pxrUsdInArgs')
     if isinstance(argsOverride, FnAttribute.GroupAttribute):
@@ -342,6 +713,31 @@ def flushStage(self, viewNode, graphState, portIndex=0):
 
 nb.setCustomMethod('flushStage', flushStage)
 
+# Reloads the layers of the stage which changed on disk, so that only the
+# prims using them are recomposed, and has the node cooked again. Returns the
+# identifiers of those layers.
+def reloadStage(self, viewNode, graphState, portIndex=0, compareContents=False):
+    opArgs = self.buildUsdInOpArgsFromDownstreamNode(viewNode, graphState,
+            portIndex=portIndex)
+
+    if isinstance(opArgs, FnAttribute.GroupAttribute):
+        gb = FnAttribute.GroupBuilder()
+        gb.update(opArgs)
+        gb.set('compareContents', int(compareContents))
+        result = FnGeolibServices.AttributeFunctionUtil.Run(
+                "UsdIn.ReloadStage", gb.build())
+        if isinstance(result, FnAttribute.StringAttribute):
+            reloadedLayers = list(result.getNearestSample(0))
+            if reloadedLayers:
+                generation = FnGeolibServices.AttributeFunctionUtil.Run(
+                        "UsdIn.GetReloadGeneration", FnAttribute.GroupAttribute())
+                self.getParameter('reloadGeneration').setValue(
+                        generation.getValue(0, False), 0)
+            return reloadedLayers
+    return []
+
+nb.setCustomMethod('reloadStage', reloadStage)
+
 #-----------------------------------------------------------------------------
 
 def buildOpChain(self, interface):
@@ -389,6 +785,15 @@ def buildOpChain(self, interface):
     if isinstance(argsCookTmpKey, FnAttribute.StringAttribute):
         self._argsCookTmp[argsCookTmpKey.getValue('', False)] = usdInArgs
 
+    if (self.getParameter('boundsMode').getValue(frameTime) ==
+            'extentsHint and author'):
+        FnGeolibServices.AttributeFunctionUtil.Run('UsdIn.AuthorExtentsHints',
+                usdInArgs)
+
+    if self.getParameter('prefetchStage').getValue(frameTime):
+        FnGeolibServices.AttributeFunctionUtil.Run('UsdIn.PrefetchStage',
+                usdInArgs)
+
 
     # our primary op in the chain that will create the root location
     sscb = FnGeolibServices.OpArgsBuilders.StaticSceneCreate(True)
@@ -402,6 +807,16 @@ def buildOpChain(self, interface):
 
     interface.appendOp('StaticSceneCreate', sscb.build())
 
+    if (self.getParameter('deferUsdSkelSkinning').getValue(frameTime) and
+            self.getParameter('applyDeferredSkinning').getValue(frameTime)):
+        interface.appendOp('UsdIn.ApplySkinning',
+                FnAttribute.GroupAttribute())
+
+    if self.getParameter('cookStats').getValue(frameTime):
+        interface.appendOp('UsdIn.RollUpStats', FnAttribute.GroupBuilder()
+            .set('location', self.getScenegraphLocation(frameTime))
+            .build())
+
 nb.setGetScenegraphLocationFnc(getScenegraphLocation)
 nb.setBuildOpChainFnc(buildOpChain)
 
@@ -0,0 +1,294 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// usdKatanaCookCacheWarm fills a UsdIn cook cache directory for a stage
+// ahead of a render, without Katana, by running the readers the cache covers
+// over every mesh, curves, points and NURBS patch prim of the stage. The
+// options must match the UsdIn node reading the stage for its entries to be
+// used: the location, the isolate path, the output targets, the velocity blur
+// mode and, for animated prims, the frames and motion samples.
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/base/work/threadLimits.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/basisCurves.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/nurbsPatch.h>
+#include <pxr/usd/usdGeom/points.h>
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/bootstrap.h"
+#include "usdKatana/cache.h"
+#include "usdKatana/cookCache.h"
+#include "usdKatana/readBasisCurves.h"
+#include "usdKatana/readMesh.h"
+#include "usdKatana/readNurbsPatch.h"
+#include "usdKatana/readPoints.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+#include "vtKatana/bootstrap.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+struct Options
+{
+    std::string fileName;
+    std::string cacheDir;
+    std::string location = "/root/world/geo";
+    std::string isolatePath;
+    std::vector<double> times;
+    std::vector<double> motionSampleTimes;
+    double shutterOpen = 0.0;
+    double shutterClose = 0.0;
+    std::vector<std::string> outputTargets;
+    bool velocityBlur = false;
+    int threads = 0;
+};
+
+// The readers of the shipped UsdIn ops which go through the cook cache, under
+// the names those ops give them.
+struct Reader
+{
+    std::string name;
+    std::function<bool(const UsdPrim&)> matches;
+    std::function<void(const UsdPrim&, const UsdKatanaUsdInPrivateData&, UsdKatanaAttrMap&)>
+        read;
+};
+
+template <typename Schema>
+Reader MakeReader(const std::string& name,
+                  void (*read)(const Schema&, const UsdKatanaUsdInPrivateData&, UsdKatanaAttrMap&))
+{
+    return {name, [](const UsdPrim& prim) { return prim.IsA<Schema>(); },
+            [read](const UsdPrim& prim, const UsdKatanaUsdInPrivateData& data,
+                   UsdKatanaAttrMap& attrs) { read(Schema(prim), data, attrs); }};
+}
+
+const std::vector<Reader>& GetReaders()
+{
+    static const std::vector<Reader> readers = {
+        MakeReader<UsdGeomMesh>("UsdKatanaReadMesh", &UsdKatanaReadMesh),
+        MakeReader<UsdGeomBasisCurves>("UsdKatanaReadBasisCurves", &UsdKatanaReadBasisCurves),
+        MakeReader<UsdGeomNurbsPatch>("UsdKatanaReadNurbsPatch", &UsdKatanaReadNurbsPatch),
+        MakeReader<UsdGeomPoints>("UsdKatanaReadPoints", &UsdKatanaReadPoints),
+    };
+    return readers;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--cacheDir" && hasValue)
+        {
+            options.cacheDir = argv[++i];
+        }
+        else if (arg == "--location" && hasValue)
+        {
+            options.location = argv[++i];
+        }
+        else if (arg == "--isolatePath" && hasValue)
+        {
+            options.isolatePath = argv[++i];
+        }
+        else if (arg == "--time" && hasValue)
+        {
+            options.times.push_back(std::atof(argv[++i]));
+        }
+        else if (arg == "--motionSampleTimes" && hasValue)
+        {
+            for (const std::string& token : TfStringTokenize(argv[++i]))
+            {
+                options.motionSampleTimes.push_back(std::atof(token.c_str()));
+            }
+        }
+        else if (arg == "--shutter" && i + 2 < argc)
+        {
+            options.shutterOpen = std::atof(argv[++i]);
+            options.shutterClose = std::atof(argv[++i]);
+        }
+        else if (arg == "--outputTargets" && hasValue)
+        {
+            options.outputTargets = TfStringTokenize(argv[++i], ",");
+        }
+        else if (arg == "--velocityBlur")
+        {
+            options.velocityBlur = true;
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (options.fileName.empty() && arg.compare(0, 1, "-") != 0)
+        {
+            options.fileName = arg;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (options.times.empty())
+    {
+        options.times.push_back(1.0);
+    }
+    if (options.motionSampleTimes.empty())
+    {
+        options.motionSampleTimes.push_back(0.0);
+    }
+    return !options.fileName.empty() && !options.cacheDir.empty();
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage: usdKatanaCookCacheWarm FILE --cacheDir DIR [--location PATH]\n"
+                 "                              [--isolatePath PATH] [--time T]...\n"
+                 "                              [--motionSampleTimes \"T...\"]\n"
+                 "                              [--shutter OPEN CLOSE]\n"
+                 "                              [--outputTargets A,B] [--velocityBlur]\n"
+                 "                              [--threads N]\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    const char* katanaRoot = std::getenv("KATANA_ROOT");
+    if (!katanaRoot || !FnAttribute::Bootstrap(katanaRoot))
+    {
+        std::cerr << "Failed to bootstrap FnAttribute, set KATANA_ROOT" << std::endl;
+        return 1;
+    }
+    FnAttribute::Initialize(FnAttribute::Attribute::getSuite());
+    UsdKatanaBootstrap(katanaRoot);
+    VtKatanaBootstrap(katanaRoot);
+
+    if (options.threads > 0)
+    {
+        WorkSetConcurrencyLimit(options.threads);
+    }
+
+    UsdStageRefPtr stage = UsdKatanaCache::GetInstance().GetStage(
+        options.fileName, FnAttribute::GroupAttribute(), options.location, options.isolatePath,
+        "", true);
+    if (!stage)
+    {
+        std::cerr << "Unable to open " << options.fileName << std::endl;
+        return 1;
+    }
+
+    const UsdPrim rootPrim = options.isolatePath.empty()
+                                 ? stage->GetPseudoRoot()
+                                 : stage->GetPrimAtPath(SdfPath(options.isolatePath));
+    if (!rootPrim)
+    {
+        std::cerr << "No prim at " << options.isolatePath << std::endl;
+        return 1;
+    }
+
+    // Pair each prim with its reader up front, the traversal is serial.
+    std::vector<std::pair<UsdPrim, const Reader*>> prims;
+    for (const UsdPrim& prim : UsdPrimRange(rootPrim))
+    {
+        for (const Reader& reader : GetReaders())
+        {
+            if (reader.matches(prim))
+            {
+                prims.emplace_back(prim, &reader);
+                break;
+            }
+        }
+    }
+
+    const FnAttribute::GroupAttribute opArgs(
+        "cookCacheDir", FnAttribute::StringAttribute(options.cacheDir), true);
+
+    UsdKatanaCookCache& cookCache = UsdKatanaCookCache::GetInstance();
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    for (double time : options.times)
+    {
+        // Match the arguments UsdIn builds with its default parameters.
+        ArgsBuilder argsBuilder;
+        argsBuilder.stage = stage;
+        argsBuilder.rootLocation = options.location;
+        argsBuilder.sessionLocation = options.location;
+        argsBuilder.isolatePath = options.isolatePath;
+        argsBuilder.currentTime = time;
+        argsBuilder.shutterOpen = options.shutterOpen;
+        argsBuilder.shutterClose = options.shutterClose;
+        argsBuilder.motionSampleTimes = options.motionSampleTimes;
+        argsBuilder.extraAttributesOrNamespaces["userProperties"].push_back("userProperties");
+        argsBuilder.outputTargets.insert(options.outputTargets.begin(),
+                                         options.outputTargets.end());
+        argsBuilder.velocityBlur = options.velocityBlur;
+        // Static attributes of animated prims are converted once for all times.
+        argsBuilder.shareStaticData = true;
+        UsdKatanaUsdInArgsRefPtr usdInArgs = argsBuilder.build();
+
+        WorkParallelForN(prims.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const UsdPrim& prim = prims[i].first;
+                const Reader& reader = *prims[i].second;
+                const UsdKatanaUsdInPrivateData privateData(prim, usdInArgs);
+                UsdKatanaAttrMap attrs;
+                cookCache.ReadCached(opArgs, reader.name, privateData, attrs,
+                                     [&](UsdKatanaAttrMap& readAttrs) {
+                                         reader.read(prim, privateData, readAttrs);
+                                     });
+            }
+        });
+    }
+    const size_t numWritten = cookCache.Flush();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << options.fileName << ": " << prims.size() << " prims at "
+              << options.times.size() << " times, " << cookCache.GetNumHits()
+              << " entries already cached, " << numWritten << " entries written in " << seconds
+              << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,442 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// usdKatanaReaderStats runs the UsdIn readers over every prim of a stage,
+// without Geolib, and reports the time spent, the attribute data produced and
+// the number of attributes per reader. This isolates the cost of the readers
+// from the scheduling of the UsdIn op.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/base/work/threadLimits.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/kind/registry.h>
+#include <pxr/usd/usd/modelAPI.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/basisCurves.h>
+#include <pxr/usd/usdGeom/camera.h>
+#include <pxr/usd/usdGeom/capsule.h>
+#include <pxr/usd/usdGeom/cone.h>
+#include <pxr/usd/usdGeom/cube.h>
+#include <pxr/usd/usdGeom/cylinder.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/nurbsPatch.h>
+#include <pxr/usd/usdGeom/plane.h>
+#include <pxr/usd/usdGeom/pointInstancer.h>
+#include <pxr/usd/usdGeom/points.h>
+#include <pxr/usd/usdGeom/sphere.h>
+#include <pxr/usd/usdGeom/subset.h>
+#include <pxr/usd/usdGeom/xformable.h>
+#include <pxr/usd/usdLux/lightAPI.h>
+#include <pxr/usd/usdLux/lightFilter.h>
+#include <pxr/usd/usdShade/material.h>
+#include <pxr/usd/usdVol/openVDBAsset.h>
+#include <pxr/usd/usdVol/volume.h>
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/bootstrap.h"
+#include "usdKatana/cache.h"
+#include "usdKatana/cookStats.h"
+#include "usdKatana/readBasisCurves.h"
+#include "usdKatana/readCamera.h"
+#include "usdKatana/readGeomSubset.h"
+#include "usdKatana/readLight.h"
+#include "usdKatana/readLightFilter.h"
+#include "usdKatana/readMaterial.h"
+#include "usdKatana/readMesh.h"
+#include "usdKatana/readModel.h"
+#include "usdKatana/readNurbsPatch.h"
+#include "usdKatana/readOpenVDBAsset.h"
+#include "usdKatana/readPointInstancer.h"
+#include "usdKatana/readPoints.h"
+#include "usdKatana/readPrim.h"
+#include "usdKatana/readPrimitive.h"
+#include "usdKatana/readVolume.h"
+#include "usdKatana/readXformable.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+#include "vtKatana/bootstrap.h"
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+struct Options
+{
+    std::string fileName;
+    std::string isolatePath;
+    std::string jsonOutput;
+    double currentTime = 1.0;
+    int threads = 0;
+    bool evaluateUsdSkelBindings = true;
+};
+
+struct ReaderStats
+{
+    size_t prims = 0;
+    // Time spent in the reader and building its attributes, and time spent
+    // measuring them, which is not part of a cook.
+    double seconds = 0.0;
+    double measureSeconds = 0.0;
+    uint64_t bytes = 0;
+    uint64_t attributes = 0;
+};
+
+// Reader invoked for a prim. The attribute maps it fills are measured once it
+// returns.
+using ReadFn = std::function<void(const UsdPrim&,
+                                  const UsdKatanaUsdInPrivateData&,
+                                  std::vector<UsdKatanaAttrMap>&)>;
+
+struct Reader
+{
+    std::string name;
+    std::function<bool(const UsdPrim&)> matches;
+    ReadFn read;
+};
+
+template <typename Schema>
+bool IsA(const UsdPrim& prim)
+{
+    return prim.IsA<Schema>();
+}
+
+// Single attribute map readers taking the typed schema.
+template <typename Schema>
+ReadFn MakeReader(void (*read)(const Schema&, const UsdKatanaUsdInPrivateData&, UsdKatanaAttrMap&))
+{
+    return [read](const UsdPrim& prim, const UsdKatanaUsdInPrivateData& data,
+                  std::vector<UsdKatanaAttrMap>& attrMaps) {
+        attrMaps.resize(1);
+        read(Schema(prim), data, attrMaps[0]);
+    };
+}
+
+// The readers in the order UsdIn resolves them: applied schemas first, then
+// the prim type, then the model kind, then the fallback for unknown types.
+const std::vector<Reader>& GetReaders()
+{
+    static const std::vector<Reader> readers = {
+        {"UsdKatanaReadLight",
+         [](const UsdPrim& prim) { return prim.HasAPI<UsdLuxLightAPI>(); },
+         MakeReader<UsdPrim>(&UsdKatanaReadLight)},
+        {"UsdKatanaReadLightFilter", &IsA<UsdLuxLightFilter>,
+         MakeReader<UsdPrim>(&UsdKatanaReadLightFilter)},
+        {"UsdKatanaReadMesh", &IsA<UsdGeomMesh>, MakeReader<UsdGeomMesh>(&UsdKatanaReadMesh)},
+        {"UsdKatanaReadPoints", &IsA<UsdGeomPoints>,
+         MakeReader<UsdGeomPoints>(&UsdKatanaReadPoints)},
+        {"UsdKatanaReadBasisCurves", &IsA<UsdGeomBasisCurves>,
+         MakeReader<UsdGeomBasisCurves>(&UsdKatanaReadBasisCurves)},
+        {"UsdKatanaReadNurbsPatch", &IsA<UsdGeomNurbsPatch>,
+         MakeReader<UsdGeomNurbsPatch>(&UsdKatanaReadNurbsPatch)},
+        {"UsdKatanaReadVolume", &IsA<UsdVolVolume>,
+         MakeReader<UsdVolVolume>(&UsdKatanaReadVolume)},
+        {"UsdKatanaReadOpenVDBAsset", &IsA<UsdVolOpenVDBAsset>,
+         MakeReader<UsdVolOpenVDBAsset>(&UsdKatanaReadOpenVDBAsset)},
+        {"UsdKatanaReadGeomSubset", &IsA<UsdGeomSubset>,
+         MakeReader<UsdGeomSubset>(&UsdKatanaReadGeomSubset)},
+        {"UsdKatanaReadCamera", &IsA<UsdGeomCamera>,
+         MakeReader<UsdGeomCamera>(&UsdKatanaReadCamera)},
+        {"UsdKatanaReadPointInstancer", &IsA<UsdGeomPointInstancer>,
+         [](const UsdPrim& prim, const UsdKatanaUsdInPrivateData& data,
+            std::vector<UsdKatanaAttrMap>& attrMaps) {
+             attrMaps.resize(4);
+             attrMaps[3].set("outputLocationPath",
+                             FnAttribute::StringAttribute(prim.GetPath().GetString()));
+             UsdKatanaReadPointInstancer(UsdGeomPointInstancer(prim), data, attrMaps[0],
+                                         attrMaps[1], attrMaps[2], attrMaps[3]);
+         }},
+        {"UsdKatanaReadMaterial", &IsA<UsdShadeMaterial>,
+         [](const UsdPrim& prim, const UsdKatanaUsdInPrivateData& data,
+            std::vector<UsdKatanaAttrMap>& attrMaps) {
+             attrMaps.resize(1);
+             UsdKatanaReadMaterial(UsdShadeMaterial(prim), /* flatten */ true, data,
+                                   attrMaps[0]);
+         }},
+        {"UsdKatanaReadPrimitive",
+         [](const UsdPrim& prim) {
+             return prim.IsA<UsdGeomCapsule>() || prim.IsA<UsdGeomCone>() ||
+                    prim.IsA<UsdGeomCube>() || prim.IsA<UsdGeomSphere>() ||
+                    prim.IsA<UsdGeomCylinder>() || prim.IsA<UsdGeomPlane>();
+         },
+         [](const UsdPrim& prim, const UsdKatanaUsdInPrivateData& data,
+            std::vector<UsdKatanaAttrMap>& attrMaps) {
+             attrMaps.resize(1);
+             std::string attrsFilePath;
+             UsdKatanaReadPrimitive(prim, data, attrMaps[0], attrsFilePath);
+         }},
+        {"UsdKatanaReadXformable", &IsA<UsdGeomXformable>,
+         MakeReader<UsdGeomXformable>(&UsdKatanaReadXformable)},
+        {"UsdKatanaReadModel",
+         [](const UsdPrim& prim) { return prim.IsModel() && prim.HasAssetInfo(); },
+         MakeReader<UsdPrim>(&UsdKatanaReadModel)},
+        {"UsdKatanaReadPrim", [](const UsdPrim&) { return true; },
+         MakeReader<UsdPrim>(&UsdKatanaReadPrim)},
+    };
+    return readers;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--isolatePath" && hasValue)
+        {
+            options.isolatePath = argv[++i];
+        }
+        else if (arg == "--time" && hasValue)
+        {
+            options.currentTime = std::atof(argv[++i]);
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (arg == "--json" && hasValue)
+        {
+            options.jsonOutput = argv[++i];
+        }
+        else if (arg == "--evaluateUsdSkelBindings" && hasValue)
+        {
+            options.evaluateUsdSkelBindings = std::atoi(argv[++i]) != 0;
+        }
+        else if (options.fileName.empty() && arg.compare(0, 1, "-") != 0)
+        {
+            options.fileName = arg;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return !options.fileName.empty();
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage: usdKatanaReaderStats FILE [--isolatePath PATH] [--time T]\n"
+                 "                            [--threads N] [--json PATH]\n"
+                 "                            [--evaluateUsdSkelBindings 0|1]\n";
+}
+
+std::string EscapeJson(const std::string& value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            escaped += TfStringPrintf("\\u%04x", c);
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void WriteJson(const std::string& path,
+               const Options& options,
+               double wallSeconds,
+               const std::map<std::string, ReaderStats>& stats)
+{
+    std::ofstream out(path);
+    out << "{\n  \"file\": \"" << EscapeJson(options.fileName) << "\",\n"
+        << "  \"time\": " << options.currentTime << ",\n"
+        << "  \"threads\": " << WorkGetConcurrencyLimit() << ",\n"
+        << "  \"wallSeconds\": " << wallSeconds << ",\n"
+        << "  \"readers\": {";
+    const char* separator = "\n";
+    for (const auto& entry : stats)
+    {
+        const ReaderStats& readerStats = entry.second;
+        out << separator << "    \"" << EscapeJson(entry.first)
+            << "\": {\"prims\": " << readerStats.prims << ", \"seconds\": " << readerStats.seconds
+            << ", \"measureSeconds\": " << readerStats.measureSeconds << ", \"bytes\": "
+            << readerStats.bytes << ", \"attributes\": " << readerStats.attributes << "}";
+        separator = ",\n";
+    }
+    out << "\n  }\n}\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    const char* katanaRoot = std::getenv("KATANA_ROOT");
+    if (!katanaRoot || !FnAttribute::Bootstrap(katanaRoot))
+    {
+        std::cerr << "Failed to bootstrap FnAttribute, set KATANA_ROOT" << std::endl;
+        return 1;
+    }
+    FnAttribute::Initialize(FnAttribute::Attribute::getSuite());
+    UsdKatanaBootstrap(katanaRoot);
+    VtKatanaBootstrap(katanaRoot);
+
+    if (options.threads > 0)
+    {
+        WorkSetConcurrencyLimit(options.threads);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point openStart = Clock::now();
+    UsdStageRefPtr stage = UsdKatanaCache::GetInstance().GetStage(
+        options.fileName, FnAttribute::GroupAttribute(), "/root", options.isolatePath, "", true);
+    if (!stage)
+    {
+        std::cerr << "Unable to open " << options.fileName << std::endl;
+        return 1;
+    }
+    const double openSeconds = std::chrono::duration<double>(Clock::now() - openStart).count();
+
+    ArgsBuilder argsBuilder;
+    argsBuilder.stage = stage;
+    argsBuilder.rootLocation = "/root";
+    argsBuilder.isolatePath = options.isolatePath;
+    argsBuilder.currentTime = options.currentTime;
+    argsBuilder.evaluateUsdSkelBindings = options.evaluateUsdSkelBindings;
+    UsdKatanaUsdInArgsRefPtr usdInArgs = argsBuilder.build();
+
+    const UsdPrim rootPrim = options.isolatePath.empty()
+                                 ? stage->GetPseudoRoot()
+                                 : stage->GetPrimAtPath(SdfPath(options.isolatePath));
+    if (!rootPrim)
+    {
+        std::cerr << "No prim at " << options.isolatePath << std::endl;
+        return 1;
+    }
+    std::vector<UsdPrim> prims;
+    for (const UsdPrim& prim : UsdPrimRange(rootPrim))
+    {
+        if (!prim.IsPseudoRoot())
+        {
+            prims.push_back(prim);
+        }
+    }
+
+    std::mutex statsMutex;
+    std::map<std::string, ReaderStats> stats;
+    const Clock::time_point readStart = Clock::now();
+    WorkParallelForN(prims.size(), [&](size_t begin, size_t end) {
+        std::map<std::string, ReaderStats> localStats;
+        std::vector<UsdKatanaAttrMap> attrMaps;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const UsdPrim& prim = prims[i];
+            const auto& readers = GetReaders();
+            const auto readerIt =
+                std::find_if(readers.begin(), readers.end(),
+                             [&prim](const Reader& reader) { return reader.matches(prim); });
+
+            const Clock::time_point start = Clock::now();
+            const UsdKatanaUsdInPrivateData privateData(prim, usdInArgs);
+            attrMaps.clear();
+            readerIt->read(prim, privateData, attrMaps);
+
+            std::vector<FnAttribute::GroupAttribute> attrs;
+            attrs.reserve(attrMaps.size());
+            for (UsdKatanaAttrMap& attrMap : attrMaps)
+            {
+                attrs.push_back(attrMap.build());
+            }
+            const Clock::time_point measureStart = Clock::now();
+
+            ReaderStats& readerStats = localStats[readerIt->name];
+            for (const FnAttribute::GroupAttribute& attr : attrs)
+            {
+                readerStats.bytes += UsdKatanaCookStats::MeasureAttribute(attr,
+                                                                          &readerStats.attributes);
+            }
+            readerStats.seconds += std::chrono::duration<double>(measureStart - start).count();
+            readerStats.measureSeconds +=
+                std::chrono::duration<double>(Clock::now() - measureStart).count();
+            ++readerStats.prims;
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        for (const auto& entry : localStats)
+        {
+            ReaderStats& readerStats = stats[entry.first];
+            readerStats.prims += entry.second.prims;
+            readerStats.seconds += entry.second.seconds;
+            readerStats.measureSeconds += entry.second.measureSeconds;
+            readerStats.bytes += entry.second.bytes;
+            readerStats.attributes += entry.second.attributes;
+        }
+    });
+    const double readSeconds = std::chrono::duration<double>(Clock::now() - readStart).count();
+
+    std::cout << options.fileName << ": " << prims.size() << " prims, stage open "
+              << openSeconds << " s, readers " << readSeconds << " s on "
+              << WorkGetConcurrencyLimit() << " threads\n\n";
+    std::cout << std::left << std::setw(30) << "reader" << std::right << std::setw(10) << "prims"
+              << std::setw(14) << "cpu seconds" << std::setw(12) << "us/prim" << std::setw(14)
+              << "MiB" << std::setw(14) << "attributes" << "\n";
+    for (const auto& entry : stats)
+    {
+        const ReaderStats& readerStats = entry.second;
+        std::cout << std::left << std::setw(30) << entry.first << std::right << std::setw(10)
+                  << readerStats.prims << std::setw(14) << std::fixed << std::setprecision(3)
+                  << readerStats.seconds << std::setw(12) << std::setprecision(1)
+                  << readerStats.seconds * 1e6 / readerStats.prims << std::setw(14)
+                  << std::setprecision(2) << readerStats.bytes / (1024.0 * 1024.0)
+                  << std::setw(14) << readerStats.attributes << "\n";
+    }
+
+    if (!options.jsonOutput.empty())
+    {
+        WriteJson(options.jsonOutput, options, readSeconds, stats);
+    }
+    return 0;
+}
@@ -0,0 +1,812 @@
+// Copyright (c) 2023 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+
+// usdKatanaStressScene writes procedurally generated, deterministic stages
+// used to measure how UsdIn scales. Every knob has a command line flag, and
+// --scenario selects a preset that the other flags then override. The same
+// flags always produce the same stage.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <pxr/base/gf/math.h>
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/quatf.h>
+#include <pxr/base/gf/quath.h>
+#include <pxr/base/gf/rotation.h>
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/gf/vec3h.h>
+#include <pxr/base/tf/pathUtils.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/vt/array.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/kind/registry.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/types.h>
+#include <pxr/usd/usd/collectionAPI.h>
+#include <pxr/usd/usd/editContext.h>
+#include <pxr/usd/usd/modelAPI.h>
+#include <pxr/usd/usd/payloads.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usd/variantSets.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/pointInstancer.h>
+#include <pxr/usd/usdGeom/primvarsAPI.h>
+#include <pxr/usd/usdGeom/scope.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdGeom/xform.h>
+#include <pxr/usd/usdLux/lightAPI.h>
+#include <pxr/usd/usdLux/sphereLight.h>
+#include <pxr/usd/usdShade/material.h>
+#include <pxr/usd/usdShade/materialBindingAPI.h>
+#include <pxr/usd/usdShade/shader.h>
+#include <pxr/usd/usdSkel/animation.h>
+#include <pxr/usd/usdSkel/bindingAPI.h>
+#include <pxr/usd/usdSkel/blendShape.h>
+#include <pxr/usd/usdSkel/root.h>
+#include <pxr/usd/usdSkel/skeleton.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace
+{
+struct Options
+{
+    std::string output = "stress.usdc";
+    uint64_t seed = 1;
+    int frames = 1;
+
+    // Hierarchy: every group has hierarchyWidth children, and the groups at
+    // hierarchyDepth hold one mesh each.
+    int hierarchyWidth = 4;
+    int hierarchyDepth = 3;
+    int meshFaces = 1024;
+    int primvars = 2;
+    std::string primvarInterpolation = "mixed";
+
+    int instancers = 1;
+    int instances = 10000;
+    int prototypes = 4;
+
+    int crowdAgents = 0;
+    // Agents share crowdSkeletons skeletons, 0 for one skeleton per agent.
+    int crowdSkeletons = 0;
+    int crowdJoints = 32;
+    int crowdBlendShapes = 0;
+
+    int materials = 16;
+    bool materialCollections = false;
+
+    int lights = 8;
+    bool lightLinking = false;
+
+    // Every payloadEvery-th leaf group is moved into a payload, 0 for none.
+    int payloadEvery = 0;
+    int variantSets = 0;
+    int variantsPerSet = 2;
+};
+
+// Scenario presets, applied before the individual flags.
+const std::map<std::string, std::function<void(Options&)>>& GetScenarios()
+{
+    static const std::map<std::string, std::function<void(Options&)>> scenarios = {
+        {"small", [](Options&) {}},
+        {"wide",
+         [](Options& o) {
+             o.hierarchyWidth = 64;
+             o.hierarchyDepth = 2;
+             o.meshFaces = 256;
+         }},
+        {"deep",
+         [](Options& o) {
+             o.hierarchyWidth = 2;
+             o.hierarchyDepth = 12;
+             o.meshFaces = 64;
+         }},
+        {"heavyMeshes",
+         [](Options& o) {
+             o.hierarchyWidth = 4;
+             o.hierarchyDepth = 2;
+             o.meshFaces = 1000000;
+             o.primvars = 8;
+         }},
+        {"instancing",
+         [](Options& o) {
+             o.hierarchyDepth = 1;
+             o.instancers = 4;
+             o.instances = 1000000;
+             o.prototypes = 32;
+         }},
+        {"crowd",
+         [](Options& o) {
+             o.hierarchyDepth = 1;
+             o.instancers = 0;
+             o.crowdAgents = 500;
+             o.crowdSkeletons = 16;
+             o.crowdJoints = 64;
+             o.crowdBlendShapes = 8;
+             o.frames = 3;
+         }},
+        {"lookdev",
+         [](Options& o) {
+             o.hierarchyWidth = 16;
+             o.materials = 2000;
+             o.materialCollections = true;
+         }},
+        {"lighting",
+         [](Options& o) {
+             o.lights = 1000;
+             o.lightLinking = true;
+         }},
+        {"payloads",
+         [](Options& o) {
+             o.hierarchyWidth = 10;
+             o.payloadEvery = 1;
+             o.variantSets = 4;
+             o.variantsPerSet = 4;
+         }},
+    };
+    return scenarios;
+}
+
+void PrintUsage()
+{
+    std::cout
+        << "Usage: usdKatanaStressScene [--scenario NAME] [--FLAG VALUE ...]\n\n"
+           "Scenarios:";
+    for (const auto& scenario : GetScenarios())
+    {
+        std::cout << " " << scenario.first;
+    }
+    std::cout << "\n\nFlags:\n"
+                 "  --output PATH                 .usda or .usdc file to write\n"
+                 "  --seed N                      seed for the generated values\n"
+                 "  --frames N                    number of animated frames\n"
+                 "  --hierarchyWidth N            children per group\n"
+                 "  --hierarchyDepth N            group levels above the meshes\n"
+                 "  --meshFaces N                 faces per mesh\n"
+                 "  --primvars N                  primvars per mesh\n"
+                 "  --primvarInterpolation NAME   constant, uniform, vertex,\n"
+                 "                                faceVarying or mixed\n"
+                 "  --instancers N                number of point instancers\n"
+                 "  --instances N                 instances per point instancer\n"
+                 "  --prototypes N                prototypes per point instancer\n"
+                 "  --crowdAgents N               number of skinned agents\n"
+                 "  --crowdSkeletons N            skeletons shared by the agents,\n"
+                 "                                0 for one per agent\n"
+                 "  --crowdJoints N               joints per agent\n"
+                 "  --crowdBlendShapes N          blend shapes per agent\n"
+                 "  --materials N                 number of materials\n"
+                 "  --materialCollections 0|1     bind materials with collections\n"
+                 "  --lights N                    number of lights\n"
+                 "  --lightLinking 0|1            author light link collections\n"
+                 "  --payloadEvery N              load every Nth leaf group as a\n"
+                 "                                payload, 0 for none\n"
+                 "  --variantSets N               variant sets per leaf group\n"
+                 "  --variantsPerSet N            variants per variant set\n";
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+    std::map<std::string, std::string> flags;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || !TfStringStartsWith(arg, "--") || i + 1 >= argc)
+        {
+            return false;
+        }
+        flags[arg.substr(2)] = argv[++i];
+    }
+
+    auto scenarioIt = flags.find("scenario");
+    if (scenarioIt != flags.end())
+    {
+        auto presetIt = GetScenarios().find(scenarioIt->second);
+        if (presetIt == GetScenarios().end())
+        {
+            std::cerr << "Unknown scenario: " << scenarioIt->second << std::endl;
+            return false;
+        }
+        presetIt->second(options);
+        flags.erase(scenarioIt);
+    }
+
+    const std::map<std::string, int*> intFlags = {
+        {"frames", &options.frames},
+        {"hierarchyWidth", &options.hierarchyWidth},
+        {"hierarchyDepth", &options.hierarchyDepth},
+        {"meshFaces", &options.meshFaces},
+        {"primvars", &options.primvars},
+        {"instancers", &options.instancers},
+        {"instances", &options.instances},
+        {"prototypes", &options.prototypes},
+        {"crowdAgents", &options.crowdAgents},
+        {"crowdSkeletons", &options.crowdSkeletons},
+        {"crowdJoints", &options.crowdJoints},
+        {"crowdBlendShapes", &options.crowdBlendShapes},
+        {"materials", &options.materials},
+        {"lights", &options.lights},
+        {"payloadEvery", &options.payloadEvery},
+        {"variantSets", &options.variantSets},
+        {"variantsPerSet", &options.variantsPerSet},
+    };
+    const std::map<std::string, bool*> boolFlags = {
+        {"materialCollections", &options.materialCollections},
+        {"lightLinking", &options.lightLinking},
+    };
+    for (const auto& flag : flags)
+    {
+        if (flag.first == "output")
+        {
+            options.output = flag.second;
+        }
+        else if (flag.first == "seed")
+        {
+            options.seed = std::strtoull(flag.second.c_str(), nullptr, 10);
+        }
+        else if (flag.first == "primvarInterpolation")
+        {
+            static const std::set<std::string> interpolations = {"constant", "uniform", "vertex",
+                                                                 "faceVarying", "mixed"};
+            if (interpolations.count(flag.second) == 0)
+            {
+                std::cerr << "Unknown primvar interpolation: " << flag.second << std::endl;
+                return false;
+            }
+            options.primvarInterpolation = flag.second;
+        }
+        else if (intFlags.count(flag.first))
+        {
+            *intFlags.at(flag.first) = std::max(0, std::atoi(flag.second.c_str()));
+        }
+        else if (boolFlags.count(flag.first))
+        {
+            *boolFlags.at(flag.first) = std::atoi(flag.second.c_str()) != 0;
+        }
+        else
+        {
+            std::cerr << "Unknown flag: --" << flag.first << std::endl;
+            return false;
+        }
+    }
+    options.frames = std::max(options.frames, 1);
+    options.prototypes = std::max(options.prototypes, 1);
+    options.crowdJoints = std::max(options.crowdJoints, 1);
+    options.variantsPerSet = std::max(options.variantsPerSet, 1);
+    return true;
+}
+
+// Stateless random numbers, so that the values of an element do not depend
+// on the order elements are generated in, nor on the standard library.
+uint64_t Hash(uint64_t seed, uint64_t index)
+{
+    uint64_t z = seed * 0x9E3779B97F4A7C15ull + index + 0x632BE59BD9B4E019ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+float Random(uint64_t seed, uint64_t index)
+{
+    return static_cast<float>(Hash(seed, index) >> 40) / static_cast<float>(1ull << 24);
+}
+
+struct Generator
+{
+    const Options& options;
+    UsdStageRefPtr stage;
+    UsdStageRefPtr payloadStage;
+    SdfPathVector leafPaths;
+    std::vector<UsdShadeMaterial> materials;
+
+    UsdPrim DefineModel(const UsdStageRefPtr& target, const SdfPath& path, const TfToken& kind)
+    {
+        UsdPrim prim = UsdGeomXform::Define(target, path).GetPrim();
+        UsdModelAPI(prim).SetKind(kind);
+        return prim;
+    }
+
+    // A grid mesh of about \p numFaces quads, with the requested primvars.
+    UsdGeomMesh DefineMesh(const UsdStageRefPtr& target,
+                           const SdfPath& path,
+                           int numFaces,
+                           int numPrimvars,
+                           uint64_t index)
+    {
+        const int cells = std::max(1, static_cast<int>(std::ceil(std::sqrt(numFaces))));
+        const int rowSize = cells + 1;
+        VtVec3fArray points(rowSize * rowSize);
+        for (int y = 0; y < rowSize; ++y)
+        {
+            for (int x = 0; x < rowSize; ++x)
+            {
+                const int i = y * rowSize + x;
+                points[i] = GfVec3f(float(x) / cells, float(y) / cells,
+                                    0.05f * Random(options.seed + index, i));
+            }
+        }
+        VtIntArray faceVertexCounts(cells * cells, 4);
+        VtIntArray faceVertexIndices(cells * cells * 4);
+        for (int y = 0; y < cells; ++y)
+        {
+            for (int x = 0; x < cells; ++x)
+            {
+                const int face = y * cells + x;
+                const int i = y * rowSize + x;
+                faceVertexIndices[face * 4 + 0] = i;
+                faceVertexIndices[face * 4 + 1] = i + 1;
+                faceVertexIndices[face * 4 + 2] = i + rowSize + 1;
+                faceVertexIndices[face * 4 + 3] = i + rowSize;
+            }
+        }
+
+        UsdGeomMesh mesh = UsdGeomMesh::Define(target, path);
+        mesh.CreatePointsAttr().Set(points);
+        mesh.CreateFaceVertexCountsAttr().Set(faceVertexCounts);
+        mesh.CreateFaceVertexIndicesAttr().Set(faceVertexIndices);
+        mesh.CreateExtentAttr().Set(VtVec3fArray{GfVec3f(0.0f), GfVec3f(1.0f)});
+
+        static const TfToken interpolations[] = {UsdGeomTokens->constant, UsdGeomTokens->uniform,
+                                                 UsdGeomTokens->vertex,
+                                                 UsdGeomTokens->faceVarying};
+        UsdGeomPrimvarsAPI primvarsAPI(mesh.GetPrim());
+        for (int p = 0; p < numPrimvars; ++p)
+        {
+            const TfToken interpolation =
+                options.primvarInterpolation == "mixed"
+                    ? interpolations[p % 4]
+                    : TfToken(options.primvarInterpolation);
+            size_t size = 1;
+            if (interpolation == UsdGeomTokens->uniform)
+            {
+                size = faceVertexCounts.size();
+            }
+            else if (interpolation == UsdGeomTokens->vertex)
+            {
+                size = points.size();
+            }
+            else if (interpolation == UsdGeomTokens->faceVarying)
+            {
+                size = faceVertexIndices.size();
+            }
+            VtFloatArray values(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                values[i] = Random(options.seed + index + p, i);
+            }
+            primvarsAPI
+                .CreatePrimvar(TfToken("stress" + std::to_string(p)),
+                               SdfValueTypeNames->FloatArray, interpolation)
+                .Set(values);
+        }
+        return mesh;
+    }
+
+    void DefineMaterials()
+    {
+        const SdfPath root("/root/materials");
+        UsdGeomScope::Define(stage, root);
+        for (int i = 0; i < options.materials; ++i)
+        {
+            const SdfPath path = root.AppendChild(TfToken("material" + std::to_string(i)));
+            UsdShadeMaterial material = UsdShadeMaterial::Define(stage, path);
+            UsdShadeShader surface =
+                UsdShadeShader::Define(stage, path.AppendChild(TfToken("surface")));
+            surface.CreateIdAttr(VtValue(TfToken("UsdPreviewSurface")));
+            surface.CreateInput(TfToken("diffuseColor"), SdfValueTypeNames->Color3f)
+                .Set(GfVec3f(Random(options.seed, i * 3), Random(options.seed, i * 3 + 1),
+                             Random(options.seed, i * 3 + 2)));
+            surface.CreateInput(TfToken("roughness"), SdfValueTypeNames->Float)
+                .Set(Random(options.seed + 1, i));
+            surface.CreateOutput(TfToken("surface"), SdfValueTypeNames->Token);
+            material.CreateSurfaceOutput().ConnectToSource(surface.ConnectableAPI(),
+                                                           TfToken("surface"));
+            materials.push_back(material);
+        }
+    }
+
+    // Builds the group hierarchy below \p path, appending the leaf groups to
+    // leafPaths.
+    void DefineHierarchy(const SdfPath& path, int depth)
+    {
+        if (depth == options.hierarchyDepth)
+        {
+            DefineLeaf(path);
+            return;
+        }
+        DefineModel(stage, path, depth == 0 ? KindTokens->assembly : KindTokens->group);
+        for (int i = 0; i < options.hierarchyWidth; ++i)
+        {
+            DefineHierarchy(path.AppendChild(TfToken("g" + std::to_string(i))), depth + 1);
+        }
+    }
+
+    void DefineLeaf(const SdfPath& path)
+    {
+        const uint64_t index = leafPaths.size();
+        leafPaths.push_back(path);
+
+        const bool isPayload = options.payloadEvery > 0 && index % options.payloadEvery == 0;
+        UsdStageRefPtr target = isPayload ? payloadStage : stage;
+        const SdfPath targetPath =
+            isPayload ? SdfPath("/payload" + std::to_string(index)) : path;
+
+        UsdPrim prim = DefineModel(target, targetPath, KindTokens->component);
+        UsdGeomXformable(prim).AddTranslateOp().Set(
+            GfVec3d(1.5 * (index % 1000), 1.5 * (index / 1000), 0.0));
+        UsdGeomMesh mesh = DefineMesh(target, targetPath.AppendChild(TfToken("mesh")),
+                                      options.meshFaces, options.primvars, index);
+
+        for (int s = 0; s < options.variantSets; ++s)
+        {
+            UsdVariantSet variantSet =
+                prim.GetVariantSets().AddVariantSet("stressSet" + std::to_string(s));
+            for (int v = 0; v < options.variantsPerSet; ++v)
+            {
+                const std::string variant = "v" + std::to_string(v);
+                variantSet.AddVariant(variant);
+                variantSet.SetVariantSelection(variant);
+                UsdEditContext context(variantSet.GetVariantEditContext());
+                UsdGeomPrimvarsAPI(mesh.GetPrim())
+                    .CreatePrimvar(TfToken("variant" + std::to_string(s)),
+                                   SdfValueTypeNames->Float, UsdGeomTokens->constant)
+                    .Set(static_cast<float>(v));
+            }
+            variantSet.SetVariantSelection(
+                "v" + std::to_string(Hash(options.seed + s, index) % options.variantsPerSet));
+        }
+
+        if (isPayload)
+        {
+            UsdPrim stub = stage->DefinePrim(path);
+            stub.GetPayloads().AddPayload(
+                TfGetBaseName(payloadStage->GetRootLayer()->GetIdentifier()), targetPath);
+        }
+
+        // The materials live outside of the payloads, where a binding
+        // authored in a payload could not target them, so bindings are
+        // authored in the referencing layer.
+        if (!materials.empty() && !options.materialCollections)
+        {
+            UsdPrim bindingPrim =
+                isPayload ? stage->OverridePrim(path.AppendChild(TfToken("mesh")))
+                          : mesh.GetPrim();
+            UsdShadeMaterialBindingAPI::Apply(bindingPrim)
+                .Bind(materials[index % materials.size()]);
+        }
+    }
+
+    // Material assignments through collections authored on /root/world,
+    // one collection per material.
+    void DefineMaterialCollections()
+    {
+        if (materials.empty() || !options.materialCollections)
+        {
+            return;
+        }
+        UsdPrim world = stage->GetPrimAtPath(SdfPath("/root/world"));
+        UsdShadeMaterialBindingAPI bindingAPI = UsdShadeMaterialBindingAPI::Apply(world);
+        for (size_t m = 0; m < materials.size(); ++m)
+        {
+            const TfToken name("material" + std::to_string(m));
+            UsdCollectionAPI collection = UsdCollectionAPI::Apply(world, name);
+            UsdRelationship includes = collection.CreateIncludesRel();
+            for (size_t leaf = m; leaf < leafPaths.size(); leaf += materials.size())
+            {
+                includes.AddTarget(leafPaths[leaf]);
+            }
+            bindingAPI.Bind(collection, materials[m], name);
+        }
+    }
+
+    void DefineLights()
+    {
+        const SdfPath root("/root/lights");
+        if (options.lights > 0)
+        {
+            DefineModel(stage, root, KindTokens->group);
+        }
+        for (int i = 0; i < options.lights; ++i)
+        {
+            UsdLuxSphereLight light =
+                UsdLuxSphereLight::Define(stage, root.AppendChild(TfToken("light" + std::to_string(i))));
+            light.CreateRadiusAttr().Set(0.1f + Random(options.seed + 2, i));
+            light.CreateIntensityAttr().Set(1.0f + 10.0f * Random(options.seed + 3, i));
+            light.AddTranslateOp().Set(GfVec3d(100.0 * Random(options.seed + 4, i),
+                                               100.0 * Random(options.seed + 5, i), 10.0));
+            if (options.lightLinking && !leafPaths.empty())
+            {
+                // Link each light to a handful of leaf groups.
+                UsdCollectionAPI lightLink = UsdLuxLightAPI(light).GetLightLinkCollectionAPI();
+                lightLink.CreateIncludeRootAttr().Set(false);
+                UsdRelationship includes = lightLink.CreateIncludesRel();
+                for (uint64_t k = 0; k < 4; ++k)
+                {
+                    includes.AddTarget(leafPaths[Hash(options.seed + i, k) % leafPaths.size()]);
+                }
+            }
+        }
+    }
+
+    void DefineInstancers()
+    {
+        const SdfPath root("/root/instancers");
+        if (options.instancers > 0)
+        {
+            DefineModel(stage, root, KindTokens->group);
+        }
+        for (int n = 0; n < options.instancers; ++n)
+        {
+            const SdfPath path = root.AppendChild(TfToken("instancer" + std::to_string(n)));
+            UsdGeomPointInstancer instancer = UsdGeomPointInstancer::Define(stage, path);
+            SdfPathVector prototypePaths;
+            for (int p = 0; p < options.prototypes; ++p)
+            {
+                const SdfPath prototypePath =
+                    path.AppendPath(SdfPath("prototypes/prototype" + std::to_string(p)));
+                UsdGeomXform::Define(stage, prototypePath);
+                DefineMesh(stage, prototypePath.AppendChild(TfToken("mesh")), 16 << (p % 6), 0,
+                           n * options.prototypes + p);
+                prototypePaths.push_back(prototypePath);
+            }
+            instancer.CreatePrototypesRel().SetTargets(prototypePaths);
+
+            const uint64_t seed = options.seed + 100 + n;
+            const float side = std::cbrt(static_cast<float>(options.instances)) * 2.0f;
+            VtIntArray protoIndices(options.instances);
+            VtVec3fArray positions(options.instances);
+            VtQuathArray orientations(options.instances);
+            VtVec3fArray scales(options.instances);
+            for (int i = 0; i < options.instances; ++i)
+            {
+                protoIndices[i] = static_cast<int>(Hash(seed, i) % options.prototypes);
+                positions[i] = GfVec3f(side * Random(seed + 1, i), side * Random(seed + 2, i),
+                                       side * Random(seed + 3, i));
+                orientations[i] = GfQuath(GfQuatf(
+                    GfRotation(GfVec3d::YAxis(), 360.0 * Random(seed + 4, i)).GetQuat()));
+                scales[i] = GfVec3f(0.5f + Random(seed + 5, i));
+            }
+            instancer.CreateProtoIndicesAttr().Set(protoIndices);
+            instancer.CreatePositionsAttr().Set(positions);
+            instancer.CreateOrientationsAttr().Set(orientations);
+            instancer.CreateScalesAttr().Set(scales);
+        }
+    }
+
+    // Skinned agents with blend shapes. The agents are spread over
+    // crowdSkeletons rigs, each a skel root holding a skeleton, its animation
+    // and the meshes of the agents bound to it, so that the skinning
+    // transforms of a skeleton are shared by several meshes.
+    void DefineCrowd()
+    {
+        const SdfPath root("/root/crowd");
+        if (options.crowdAgents > 0)
+        {
+            DefineModel(stage, root, KindTokens->group);
+        }
+
+        const int numJoints = options.crowdJoints;
+        VtTokenArray joints(numJoints);
+        VtMatrix4dArray bindTransforms(numJoints);
+        VtMatrix4dArray restTransforms(numJoints);
+        std::string jointPath;
+        for (int j = 0; j < numJoints; ++j)
+        {
+            jointPath = j == 0 ? "j0" : jointPath + "/j" + std::to_string(j);
+            joints[j] = TfToken(jointPath);
+            bindTransforms[j].SetTranslate(GfVec3d(0.0, double(j) / numJoints, 0.0));
+            restTransforms[j].SetTranslate(GfVec3d(0.0, j == 0 ? 0.0 : 1.0 / numJoints, 0.0));
+        }
+
+        const int numRigs = options.crowdSkeletons > 0
+                                ? std::min(options.crowdSkeletons, options.crowdAgents)
+                                : options.crowdAgents;
+        std::vector<UsdSkelSkeleton> skeletons;
+        VtTokenArray blendShapeNames;
+        for (int b = 0; b < options.crowdBlendShapes; ++b)
+        {
+            blendShapeNames.push_back(TfToken("shape" + std::to_string(b)));
+        }
+        for (int r = 0; r < numRigs; ++r)
+        {
+            const uint64_t seed = options.seed + 1000 + r;
+            const SdfPath path = root.AppendChild(TfToken("rig" + std::to_string(r)));
+            UsdSkelRoot skelRoot = UsdSkelRoot::Define(stage, path);
+            UsdModelAPI(skelRoot.GetPrim()).SetKind(KindTokens->component);
+            skelRoot.AddTranslateOp().Set(GfVec3d(2.0 * (r % 100), 0.0, 2.0 * (r / 100)));
+
+            UsdSkelSkeleton skel =
+                UsdSkelSkeleton::Define(stage, path.AppendChild(TfToken("skel")));
+            skel.CreateJointsAttr().Set(joints);
+            skel.CreateBindTransformsAttr().Set(bindTransforms);
+            skel.CreateRestTransformsAttr().Set(restTransforms);
+
+            UsdSkelAnimation anim =
+                UsdSkelAnimation::Define(stage, path.AppendChild(TfToken("anim")));
+            anim.CreateJointsAttr().Set(joints);
+            VtVec3fArray translations(numJoints, GfVec3f(0.0f, 1.0f / numJoints, 0.0f));
+            translations[0] = GfVec3f(0.0f);
+            anim.CreateTranslationsAttr().Set(translations);
+            anim.CreateScalesAttr().Set(VtVec3hArray(numJoints, GfVec3h(1.0f)));
+            UsdAttribute rotationsAttr = anim.CreateRotationsAttr();
+            const float phase = Random(seed, 0) * 360.0f;
+            for (int f = 0; f < options.frames; ++f)
+            {
+                VtQuatfArray rotations(numJoints);
+                for (int j = 0; j < numJoints; ++j)
+                {
+                    rotations[j] = GfQuatf(
+                        GfRotation(GfVec3d::ZAxis(),
+                                   10.0 * std::sin(GfDegreesToRadians(phase + 20.0 * f + j)))
+                            .GetQuat());
+                }
+                rotationsAttr.Set(rotations, 1.0 + f);
+            }
+            UsdSkelBindingAPI::Apply(skel.GetPrim())
+                .CreateAnimationSourceRel()
+                .SetTargets({anim.GetPath()});
+
+            if (!blendShapeNames.empty())
+            {
+                anim.CreateBlendShapesAttr().Set(blendShapeNames);
+                UsdAttribute weightsAttr = anim.CreateBlendShapeWeightsAttr();
+                for (int f = 0; f < options.frames; ++f)
+                {
+                    VtFloatArray weights(blendShapeNames.size());
+                    for (size_t b = 0; b < weights.size(); ++b)
+                    {
+                        weights[b] = Random(seed + f, b);
+                    }
+                    weightsAttr.Set(weights, 1.0 + f);
+                }
+            }
+            skeletons.push_back(skel);
+        }
+
+        for (int a = 0; a < options.crowdAgents; ++a)
+        {
+            const uint64_t seed = options.seed + 2000 + a;
+            const int rig = a % numRigs;
+            const SdfPath path = skeletons[rig].GetPath().GetParentPath().AppendChild(
+                TfToken("agent" + std::to_string(a)));
+            UsdGeomMesh mesh =
+                DefineMesh(stage, path, options.meshFaces, options.primvars, seed);
+            VtVec3fArray points;
+            mesh.GetPointsAttr().Get(&points);
+            VtIntArray jointIndices(points.size() * 2);
+            VtFloatArray jointWeights(points.size() * 2);
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                const float position = points[i][1] * (numJoints - 1);
+                const int joint = std::min(static_cast<int>(position), numJoints - 1);
+                const float weight = position - joint;
+                jointIndices[i * 2] = joint;
+                jointIndices[i * 2 + 1] = std::min(joint + 1, numJoints - 1);
+                jointWeights[i * 2] = 1.0f - weight;
+                jointWeights[i * 2 + 1] = weight;
+            }
+            // The agents of a rig stand side by side in the space of its
+            // skeleton.
+            UsdSkelBindingAPI binding = UsdSkelBindingAPI::Apply(mesh.GetPrim());
+            binding.CreateSkeletonRel().SetTargets({skeletons[rig].GetPath()});
+            binding.CreateJointIndicesPrimvar(false, 2).Set(jointIndices);
+            binding.CreateJointWeightsPrimvar(false, 2).Set(jointWeights);
+            binding.CreateGeomBindTransformAttr().Set(
+                GfMatrix4d(1.0).SetTranslate(GfVec3d(0.0, 0.0, 0.1 * (a / numRigs))));
+
+            if (!blendShapeNames.empty())
+            {
+                SdfPathVector blendShapeTargets;
+                for (size_t b = 0; b < blendShapeNames.size(); ++b)
+                {
+                    UsdSkelBlendShape blendShape = UsdSkelBlendShape::Define(
+                        stage, mesh.GetPath().AppendChild(blendShapeNames[b]));
+                    // Sparse shapes touching a quarter of the points.
+                    VtIntArray pointIndices;
+                    VtVec3fArray offsets;
+                    for (size_t i = b % 4; i < points.size(); i += 4)
+                    {
+                        pointIndices.push_back(static_cast<int>(i));
+                        offsets.push_back(GfVec3f(0.0f, 0.0f, 0.1f * Random(seed + b, i)));
+                    }
+                    blendShape.CreatePointIndicesAttr().Set(pointIndices);
+                    blendShape.CreateOffsetsAttr().Set(offsets);
+                    blendShapeTargets.push_back(blendShape.GetPath());
+                }
+                binding.CreateBlendShapesAttr().Set(blendShapeNames);
+                binding.CreateBlendShapeTargetsRel().SetTargets(blendShapeTargets);
+            }
+        }
+    }
+
+    bool Run()
+    {
+        stage = UsdStage::CreateNew(options.output);
+        if (!stage)
+        {
+            std::cerr << "Unable to create " << options.output << std::endl;
+            return false;
+        }
+        if (options.payloadEvery > 0)
+        {
+            const std::string extension = TfGetExtension(options.output);
+            const std::string payloadFile =
+                options.output.substr(0, options.output.size() - extension.size() - 1) +
+                "_payloads." + extension;
+            payloadStage = UsdStage::CreateNew(payloadFile);
+            if (!payloadStage)
+            {
+                std::cerr << "Unable to create " << payloadFile << std::endl;
+                return false;
+            }
+        }
+
+        stage->SetStartTimeCode(1.0);
+        stage->SetEndTimeCode(options.frames);
+        DefineModel(stage, SdfPath("/root"), KindTokens->assembly);
+        stage->SetDefaultPrim(stage->GetPrimAtPath(SdfPath("/root")));
+
+        DefineMaterials();
+        DefineHierarchy(SdfPath("/root/world"), 0);
+        DefineMaterialCollections();
+        DefineInstancers();
+        DefineCrowd();
+        DefineLights();
+
+        if (payloadStage)
+        {
+            payloadStage->GetRootLayer()->Save();
+        }
+        stage->GetRootLayer()->Save();
+
+        std::cout << "Wrote " << options.output << ": " << leafPaths.size() << " meshes, "
+                  << options.instancers * options.instances << " instances, "
+                  << options.crowdAgents << " agents, " << materials.size() << " materials, "
+                  << options.lights << " lights" << std::endl;
+        return true;
+    }
+};
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+    Generator generator{options};
+    return generator.Run() ? 0 : 1;
+}